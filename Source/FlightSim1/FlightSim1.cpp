@@ -3,4 +3,6 @@
 #include "FlightSim1.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogFlightSim);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, FlightSim1, "FlightSim1" );
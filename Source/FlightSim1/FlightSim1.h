@@ -3,4 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogFlightSim, Log, All);
+
+// Cycle counters for the batched gameplay systems ("stat FlightSim")
+DECLARE_STATS_GROUP(TEXT("FlightSim"), STATGROUP_FlightSim, STATCAT_Advanced);
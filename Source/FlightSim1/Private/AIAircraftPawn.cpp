@@ -1,21 +1,25 @@
 // Copyright Your Company Name, Inc. All Rights Reserved.
 
 #include "AIAircraftPawn.h"
+#include "AIAircraftSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "RadarSubsystem.h"
+#include "GunfireSubsystem.h"
+#include "EffectsSubsystem.h"
 #include "Components/StaticMeshComponent.h"
 #include "Components/SceneComponent.h"
 #include "HealthComponent.h"
 #include "FighterJetPawn.h"
-#include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Particles/ParticleSystem.h"
 #include "Sound/SoundBase.h"
 #include "TimerManager.h" // --- CHANGE 1: Added include for TimerManager ---
+#include "MissileGuidanceSubsystem.h"
 
 // Sets default values
 AAIAircraftPawn::AAIAircraftPawn()
 {
-    // Set this pawn to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-    PrimaryActorTick.bCanEverTick = true;
+    // UAIAircraftSubsystem updates every AI aircraft in one batch, so the pawn itself never ticks
+    PrimaryActorTick.bCanEverTick = false;
 
     // Create and set the root component
     AircraftMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("AircraftMesh"));
@@ -42,8 +46,27 @@ AAIAircraftPawn::AAIAircraftPawn()
     FireRate = 0.2f;
     LastFireTime = 0.0f;
 
+    AIManager = nullptr;
+    AIHandle = INDEX_NONE;
+    SpatialIndex = nullptr;
+    SpatialHandle = INDEX_NONE;
+    RadarSystem = nullptr;
+    Gunfire = nullptr;
+    Effects = nullptr;
+    bActive = false;
+    bSpawnedForPool = false;
+
+    // Set default physics LOD values
+    bEnablePhysicsLOD = true;
+    FullPhysicsDistance = 300000.0f;
+    PointMassDistance = 400000.0f;
+    VisibleDistanceScale = 2.0f;
+    WeaponProximityDistance = 100000.0f;
+    PhysicsLODInterval = 0.25f;
+
     // Set initial state
     CurrentState = EAIState::Seeking;
+    PhysicsLOD = EAircraftPhysicsLOD::Full;
 }
 
 // Called when the game starts or when spawned
@@ -55,62 +78,176 @@ void AAIAircraftPawn::BeginPlay()
     {
         HealthComponent->OnDamaged.AddDynamic(this, &AAIAircraftPawn::HandleTakeDamage);
     }
+
+    AIManager = GetWorld()->GetSubsystem<UAIAircraftSubsystem>();
+    SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+    RadarSystem = GetWorld()->GetSubsystem<URadarSubsystem>();
+    Gunfire = GetWorld()->GetSubsystem<UGunfireSubsystem>();
+    Effects = GetWorld()->GetSubsystem<UEffectsSubsystem>();
+    MissileGuidance = GetWorld()->GetSubsystem<UMissileGuidanceSubsystem>();
+
+    // Placed in the level; pooled aircraft wait for OnAcquiredFromPool
+    if (!bSpawnedForPool)
+    {
+        ActivateAircraft();
+    }
 }
 
-// Called every frame
-void AAIAircraftPawn::Tick(float DeltaTime)
+void AAIAircraftPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    Super::Tick(DeltaTime);
+    DeactivateAircraft();
 
-    // Execute AI logic every frame
-    MoveAndTurn(DeltaTime);
+    Super::EndPlay(EndPlayReason);
+}
 
-    if (CurrentState == EAIState::Seeking)
-    {
-        CheckAndFire(DeltaTime);
-    }
+void AAIAircraftPawn::OnSpawnedForPool()
+{
+    bSpawnedForPool = true;
 }
 
-void AAIAircraftPawn::MoveAndTurn(float DeltaTime)
+void AAIAircraftPawn::OnAcquiredFromPool()
 {
-    // 1. Apply forward thrust
-    FVector ForwardForce = GetActorForwardVector() * FlightSpeed;
-    AircraftMesh->AddForce(ForwardForce);
+    ActivateAircraft();
+}
+
+void AAIAircraftPawn::OnReturnedToPool()
+{
+    DeactivateAircraft();
+}
 
-    // 2. Clamp the velocity to the speed limit
-    FVector CurrentVelocity = AircraftMesh->GetPhysicsLinearVelocity();
-    if (CurrentVelocity.Size() > MaxSpeed)
+void AAIAircraftPawn::ActivateAircraft()
+{
+    // Already registered and flying
+    if (bActive)
     {
-        AircraftMesh->SetPhysicsLinearVelocity(CurrentVelocity.GetSafeNormal() * MaxSpeed);
+        return;
     }
+    bActive = true;
 
-    // 3. Find the player and turn
-    APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
-    if (PlayerPawn)
+    // Whatever the last life left behind
+    CurrentState = EAIState::Seeking;
+    LastFireTime = 0.0f;
+    PhysicsLOD = EAircraftPhysicsLOD::Full;
+    AircraftMesh->SetSimulatePhysics(true);
+    AircraftMesh->SetPhysicsLinearVelocity(FVector::ZeroVector);
+    AircraftMesh->SetPhysicsAngularVelocityInRadians(FVector::ZeroVector);
+    if (HealthComponent)
     {
-        if (CurrentState == EAIState::Seeking)
+        HealthComponent->ResetHealth();
+    }
+
+    if (AIManager)
+    {
+        AIHandle = AIManager->RegisterAircraft(this);
+    }
+
+    if (SpatialIndex)
+    {
+        SpatialHandle = SpatialIndex->RegisterAircraft(this, AircraftTeams::Hostile, AircraftMesh->Bounds.SphereRadius, AircraftMesh);
+        HealthComponent->RegisterWithLedger(SpatialHandle);
+
+        if (RadarSystem)
         {
-            float DistanceToPlayer = FVector::Dist(GetActorLocation(), PlayerPawn->GetActorLocation());
-            FRotator TargetRotation;
-
-            if (DistanceToPlayer > AvoidanceDistance)
-            {
-                FVector DirectionToPlayer = PlayerPawn->GetActorLocation() - GetActorLocation();
-                TargetRotation = UKismetMathLibrary::MakeRotFromX(DirectionToPlayer);
-            }
-            else
-            {
-                FVector DirectionAwayFromPlayer = GetActorLocation() - PlayerPawn->GetActorLocation();
-                TargetRotation = UKismetMathLibrary::MakeRotFromX(DirectionAwayFromPlayer);
-            }
-
-            FRotator NewRotation = FMath::RInterpTo(GetActorRotation(), TargetRotation, DeltaTime, TurnSpeed);
-            SetActorRotation(NewRotation);
+            RadarSystem->RegisterSensor(SpatialHandle, Radar, AircraftTeams::Player);
         }
-        else // If evading
+    }
+
+    if (bEnablePhysicsLOD && PhysicsLODInterval > 0.0f)
+    {
+        // Random first delay so a wave spawned on one frame doesn't re-evaluate on the same frame forever after
+        GetWorldTimerManager().SetTimer(PhysicsLODTimerHandle, this, &AAIAircraftPawn::UpdatePhysicsLOD, PhysicsLODInterval, true, FMath::FRand() * PhysicsLODInterval);
+    }
+}
+
+void AAIAircraftPawn::DeactivateAircraft()
+{
+    if (!bActive)
+    {
+        return;
+    }
+    bActive = false;
+
+    GetWorldTimerManager().ClearTimer(PhysicsLODTimerHandle);
+    GetWorldTimerManager().ClearTimer(EvasionTimerHandle);
+
+    if (HealthComponent)
+    {
+        HealthComponent->UnregisterFromLedger();
+    }
+
+    if (AIManager)
+    {
+        AIManager->UnregisterAircraft(AIHandle);
+        AIHandle = INDEX_NONE;
+    }
+
+    if (RadarSystem)
+    {
+        RadarSystem->UnregisterSensor(SpatialHandle);
+    }
+
+    if (SpatialIndex)
+    {
+        SpatialIndex->UnregisterAircraft(SpatialHandle);
+        SpatialHandle = INDEX_NONE;
+    }
+
+    // Parked aircraft must not fall through the world while they wait
+    AircraftMesh->SetSimulatePhysics(false);
+}
+
+void AAIAircraftPawn::GatherAgentState(FAIAircraftAgent& OutAgent) const
+{
+    OutAgent.Location = GetActorLocation();
+    OutAgent.Rotation = GetActorRotation();
+    OutAgent.FlightSpeed = FlightSpeed;
+    OutAgent.TurnSpeed = TurnSpeed;
+    OutAgent.AvoidanceDistance = AvoidanceDistance;
+    OutAgent.EvasionTurnSpeed = EvasionTurnSpeed;
+    OutAgent.FireRate = FireRate;
+    OutAgent.LastFireTime = LastFireTime;
+    OutAgent.State = CurrentState;
+}
+
+void AAIAircraftPawn::ExecuteCommand(const FAIAircraftCommand& Command, float DeltaTime, double Time)
+{
+    switch (Command.Type)
+    {
+    case EAIAircraftCommandType::AddThrust:
+        ApplyThrust(Command.Force, DeltaTime);
+        break;
+
+    case EAIAircraftCommandType::SetRotation:
+        SetActorRotation(Command.Rotation);
+        break;
+
+    case EAIAircraftCommandType::Fire:
+        FireWeapon();
+        LastFireTime = Time;
+        break;
+    }
+}
+
+void AAIAircraftPawn::ApplyThrust(const FVector& ForwardForce, float DeltaTime)
+{
+    // 1. Apply forward thrust
+    if (PhysicsLOD == EAircraftPhysicsLOD::PointMass)
+    {
+        // Same thrust, gravity, damping and speed limit as the rigid body, integrated analytically
+        const FVector Location = GetActorLocation();
+        FlightModel::FVec3d Position(Location.X, Location.Y, Location.Z);
+        FlightModel::StepPointMass(PointMassBody, Position, PointMassVelocity, FlightModel::FVec3d(ForwardForce.X, ForwardForce.Y, ForwardForce.Z), DeltaTime);
+        SetActorLocation(FVector(Position.X, Position.Y, Position.Z));
+    }
+    else
+    {
+        AircraftMesh->AddForce(ForwardForce);
+
+        // 2. Clamp the velocity to the speed limit
+        FVector CurrentVelocity = AircraftMesh->GetPhysicsLinearVelocity();
+        if (CurrentVelocity.Size() > MaxSpeed)
         {
-            FRotator EvasionRotation = FRotator(0.0f, EvasionTurnSpeed, 0.0f);
-            AddActorLocalRotation(EvasionRotation);
+            AircraftMesh->SetPhysicsLinearVelocity(CurrentVelocity.GetSafeNormal() * MaxSpeed);
         }
     }
 }
@@ -118,12 +255,69 @@ void AAIAircraftPawn::MoveAndTurn(float DeltaTime)
 // --- CHANGE 2: Added the definitions for the missing functions ---
 void AAIAircraftPawn::HandleTakeDamage(AActor* DamagedActor, float Damage)
 {
+    // Anything that can hit us needs a real collision body
+    SwitchToFullPhysics();
+
+    // Re-plan ahead of the round-robin while we are being shot at
+    if (AIManager)
+    {
+        AIManager->NotifyDamaged(AIHandle);
+    }
+
     if (CurrentState != EAIState::Evading)
     {
         BeginEvasion();
     }
 }
 
+void AAIAircraftPawn::CaptureSnapshot(FlightModel::FAircraftSnapshot& OutSnapshot) const
+{
+    // Off the rigid body, the point-mass integrator holds the velocity and the attitude is held still
+    if (PhysicsLOD == EAircraftPhysicsLOD::PointMass)
+    {
+        OutSnapshot.LinearVelocity = PointMassVelocity;
+        OutSnapshot.AngularVelocity = FlightModel::FVec3d();
+    }
+    else
+    {
+        const FVector Velocity = AircraftMesh->GetPhysicsLinearVelocity();
+        const FVector AngularVelocity = AircraftMesh->GetPhysicsAngularVelocityInRadians();
+        OutSnapshot.LinearVelocity = FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z);
+        OutSnapshot.AngularVelocity = FlightModel::FVec3d(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z);
+    }
+
+    OutSnapshot.TimeSinceFire = GetWorld()->GetTimeSeconds() - LastFireTime;
+    OutSnapshot.AIState = static_cast<uint8>(CurrentState);
+    OutSnapshot.EvasionTimeLeft = CurrentState == EAIState::Evading ? FMath::Max(GetWorldTimerManager().GetTimerRemaining(EvasionTimerHandle), 0.0f) : 0.0f;
+}
+
+void AAIAircraftPawn::RestoreSnapshot(const FlightModel::FAircraftSnapshot& Snapshot)
+{
+    if (PhysicsLOD == EAircraftPhysicsLOD::PointMass)
+    {
+        PointMassVelocity = Snapshot.LinearVelocity;
+    }
+    else
+    {
+        AircraftMesh->SetPhysicsLinearVelocity(FVector(Snapshot.LinearVelocity.X, Snapshot.LinearVelocity.Y, Snapshot.LinearVelocity.Z));
+        AircraftMesh->SetPhysicsAngularVelocityInRadians(FVector(Snapshot.AngularVelocity.X, Snapshot.AngularVelocity.Y, Snapshot.AngularVelocity.Z));
+    }
+
+    LastFireTime = GetWorld()->GetTimeSeconds() - Snapshot.TimeSinceFire;
+
+    // An evasion with no time left would never end, so it has already ended
+    if (Snapshot.AIState == static_cast<uint8>(EAIState::Evading) && Snapshot.EvasionTimeLeft > 0.0f)
+    {
+        CurrentState = EAIState::Evading;
+        GetWorldTimerManager().SetTimer(EvasionTimerHandle, this, &AAIAircraftPawn::EndEvasion, Snapshot.EvasionTimeLeft, false);
+    }
+    else
+    {
+        CurrentState = EAIState::Seeking;
+        GetWorldTimerManager().ClearTimer(EvasionTimerHandle);
+    }
+}
+
 void AAIAircraftPawn::BeginEvasion()
 {
     CurrentState = EAIState::Evading;
@@ -135,63 +329,91 @@ void AAIAircraftPawn::EndEvasion()
     CurrentState = EAIState::Seeking;
 }
 
-void AAIAircraftPawn::CheckAndFire(float DeltaTime)
+void AAIAircraftPawn::UpdatePhysicsLOD()
 {
-    if ((GetWorld()->GetTimeSeconds() - LastFireTime) < FireRate)
+    FVector PlayerLocation;
+    if (!bEnablePhysicsLOD || !AIManager || !SpatialIndex || !AIManager->GetTargetLocation(PlayerLocation))
     {
+        SwitchToFullPhysics();
         return;
     }
 
-    APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
-    if (PlayerPawn)
+    const FVector Location = GetActorLocation();
+    const float Scale = WasRecentlyRendered(PhysicsLODInterval) ? VisibleDistanceScale : 1.0f;
+
+    // Any player aircraft inside the threshold counts, not just the one the AI is chasing
+    const bool bIsPointMass = PhysicsLOD == EAircraftPhysicsLOD::PointMass;
+    const float NearDistance = (bIsPointMass ? FullPhysicsDistance : PointMassDistance) * Scale;
+    SpatialIndex->QueryRadius(Location, NearDistance, AircraftTeams::Player, NearbyPlayers);
+
+    if (NearbyPlayers.Num() > 0)
     {
-        FVector DirectionToPlayer = (PlayerPawn->GetActorLocation() - GetActorLocation()).GetSafeNormal();
-        float DotProduct = FVector::DotProduct(GetActorForwardVector(), DirectionToPlayer);
+        SwitchToFullPhysics();
+        return;
+    }
 
-        if (DotProduct > 0.9f)
-        {
-            FireWeapon();
-            LastFireTime = GetWorld()->GetTimeSeconds();
-        }
+    // Far from the player, but an incoming missile still needs a body to hit. Guidance only holds
+    // missiles in flight, so this is one pass over its positions rather than over every missile actor.
+    if (MissileGuidance && MissileGuidance->IsAnyMissileWithin(Location, WeaponProximityDistance))
+    {
+        SwitchToFullPhysics();
+        return;
     }
+
+    SwitchToPointMass();
 }
 
-void AAIAircraftPawn::FireWeapon()
+void AAIAircraftPawn::SwitchToPointMass()
 {
-    if (MuzzleFlashFX)
+    if (PhysicsLOD == EAircraftPhysicsLOD::PointMass || !AircraftMesh->IsSimulatingPhysics())
     {
-        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MuzzleFlashFX, MuzzleLocation->GetComponentLocation(), MuzzleLocation->GetComponentRotation());
+        return;
     }
 
-    if (FireSound)
+    // Carry the body's current motion and tuning over so the trajectory continues unchanged
+    const FVector Velocity = AircraftMesh->GetPhysicsLinearVelocity();
+    PointMassVelocity = FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z);
+    PointMassBody.Mass = FMath::Max(AircraftMesh->GetMass(), UE_KINDA_SMALL_NUMBER);
+    PointMassBody.LinearDamping = AircraftMesh->GetLinearDamping();
+    PointMassBody.GravityZ = AircraftMesh->IsGravityEnabled() ? GetWorld()->GetGravityZ() : 0.0f;
+    PointMassBody.MaxSpeed = MaxSpeed;
+
+    AircraftMesh->SetSimulatePhysics(false);
+    PhysicsLOD = EAircraftPhysicsLOD::PointMass;
+}
+
+void AAIAircraftPawn::SwitchToFullPhysics()
+{
+    if (PhysicsLOD == EAircraftPhysicsLOD::Full)
     {
-        UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+        return;
     }
 
-    FVector StartLocation = MuzzleLocation->GetComponentLocation();
-    FVector EndLocation = StartLocation + (GetActorForwardVector() * WeaponRange);
-    FHitResult HitResult;
-    FCollisionQueryParams CollisionParams;
-    CollisionParams.AddIgnoredActor(this);
+    AircraftMesh->SetSimulatePhysics(true);
+    AircraftMesh->SetPhysicsLinearVelocity(FVector(PointMassVelocity.X, PointMassVelocity.Y, PointMassVelocity.Z));
+    AircraftMesh->SetPhysicsAngularVelocityInRadians(FVector::ZeroVector);
+    PhysicsLOD = EAircraftPhysicsLOD::Full;
+}
 
-    bool bHit = GetWorld()->LineTraceSingleByChannel(
-        HitResult,
-        StartLocation,
-        EndLocation,
-        ECC_Visibility,
-        CollisionParams
-    );
+void AAIAircraftPawn::FireWeapon()
+{
+    // Queued, so rapid fire coalesces into one flash and one sound per window
+    if (Effects)
+    {
+        Effects->PlayEmitter(MuzzleFlashFX, MuzzleLocation->GetComponentLocation(), MuzzleLocation->GetComponentRotation(), this);
+        Effects->PlaySound(FireSound, GetActorLocation(), this);
+    }
 
-    if (bHit)
+    // Resolved later this frame together with every other gun
+    if (Gunfire)
     {
-        AActor* HitActor = HitResult.GetActor();
-        if (HitActor)
-        {
-            UHealthComponent* TargetHealthComponent = HitActor->FindComponentByClass<UHealthComponent>();
-            if (TargetHealthComponent)
-            {
-                TargetHealthComponent->TakeDamage(10.0f);
-            }
-        }
+        FGunShot Shot;
+        Shot.Origin = MuzzleLocation->GetComponentLocation();
+        Shot.Direction = GetActorForwardVector();
+        Shot.Range = WeaponRange;
+        Shot.Damage = 10.0f;
+        Shot.Shooter = this;
+        Shot.ShooterHandle = SpatialHandle;
+        Gunfire->QueueShot(Shot);
     }
 }
@@ -0,0 +1,613 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "AIAircraftSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "RadarSubsystem.h"
+#include "FlightSim1.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI Gather"), STAT_FlightAIGather, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("AI Plan"), STAT_FlightAIPlan, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("AI Decide"), STAT_FlightAIDecide, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("AI Apply"), STAT_FlightAIApply, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Rigid Bodies"), STAT_FlightAIRigidBodies, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Point Masses"), STAT_FlightAIPointMasses, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Planned"), STAT_FlightAIPlanned, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI Planned (Priority)"), STAT_FlightAIPriorityPlanned, STATGROUP_FlightSim);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("AI Avg Plan Staleness (ms)"), STAT_FlightAIAverageStaleness, STATGROUP_FlightSim);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("AI Max Plan Staleness (ms)"), STAT_FlightAIMaxStaleness, STATGROUP_FlightSim);
+
+static int32 GAIDecideBatchSize = 64;
+static FAutoConsoleVariableRef CVarAIDecideBatchSize(
+	TEXT("FlightSim.AI.DecideBatchSize"),
+	GAIDecideBatchSize,
+	TEXT("Agents per decide task (and per command buffer)."));
+
+static bool GAIParallelDecide = true;
+static FAutoConsoleVariableRef CVarAIParallelDecide(
+	TEXT("FlightSim.AI.ParallelDecide"),
+	GAIParallelDecide,
+	TEXT("Evaluate AI decisions across worker threads. Results are identical either way."));
+
+static float GAIPlanBudgetMs = 1.5f;
+static FAutoConsoleVariableRef CVarAIPlanBudgetMs(
+	TEXT("FlightSim.AI.PlanBudgetMs"),
+	GAIPlanBudgetMs,
+	TEXT("Milliseconds per frame for re-planning AI aircraft; the rest steer on their last plan. 0 re-plans everyone every frame."));
+
+static float GAIPriorityDistance = 150000.0f;
+static FAutoConsoleVariableRef CVarAIPriorityDistance(
+	TEXT("FlightSim.AI.PriorityDistance"),
+	GAIPriorityDistance,
+	TEXT("AI aircraft closer than this to the player are re-planned before the round-robin."));
+
+static float GAIUnderFirePrioritySeconds = 3.0f;
+static FAutoConsoleVariableRef CVarAIUnderFirePrioritySeconds(
+	TEXT("FlightSim.AI.UnderFirePrioritySeconds"),
+	GAIUnderFirePrioritySeconds,
+	TEXT("How long a damaged AI aircraft keeps scheduling priority."));
+
+static float GAIContactMemorySeconds = 8.0f;
+static FAutoConsoleVariableRef CVarAIContactMemorySeconds(
+	TEXT("FlightSim.AI.ContactMemorySeconds"),
+	GAIContactMemorySeconds,
+	TEXT("How long AI aircraft keep chasing the extrapolated position of a contact their radar has lost."));
+
+static float GAIPatrolRadius = 600000.0f;
+static FAutoConsoleVariableRef CVarAIPatrolRadius(
+	TEXT("FlightSim.AI.PatrolRadius"),
+	GAIPatrolRadius,
+	TEXT("AI aircraft with nothing on radar turn back towards the world origin once further away than this. 0 lets them fly on."));
+
+// --- Decision logic ---
+
+void FAIAircraftCommandBuffer::AddThrust(int32 Slot, const FVector& Force)
+{
+	FAIAircraftCommand& Command = Commands.AddDefaulted_GetRef();
+	Command.Slot = Slot;
+	Command.Type = EAIAircraftCommandType::AddThrust;
+	Command.Force = Force;
+}
+
+void FAIAircraftCommandBuffer::SetRotation(int32 Slot, const FQuat& Rotation)
+{
+	FAIAircraftCommand& Command = Commands.AddDefaulted_GetRef();
+	Command.Slot = Slot;
+	Command.Type = EAIAircraftCommandType::SetRotation;
+	Command.Rotation = Rotation;
+}
+
+void FAIAircraftCommandBuffer::Fire(int32 Slot)
+{
+	FAIAircraftCommand& Command = Commands.AddDefaulted_GetRef();
+	Command.Slot = Slot;
+	Command.Type = EAIAircraftCommandType::Fire;
+}
+
+namespace
+{
+	FlightModel::FVec3d ToFlightModel(const FVector& Vector)
+	{
+		return FlightModel::FVec3d(Vector.X, Vector.Y, Vector.Z);
+	}
+
+	FlightModel::FAIPilotAgent ToFlightModel(const FAIAircraftAgent& Agent)
+	{
+		FlightModel::FAIPilotAgent Pilot;
+		Pilot.Location = ToFlightModel(Agent.Location);
+		Pilot.Rotation = FlightModel::FRotatord(Agent.Rotation.Pitch, Agent.Rotation.Yaw, Agent.Rotation.Roll);
+		Pilot.FlightSpeed = Agent.FlightSpeed;
+		Pilot.TurnSpeed = Agent.TurnSpeed;
+		Pilot.AvoidanceDistance = Agent.AvoidanceDistance;
+		Pilot.EvasionTurnSpeed = Agent.EvasionTurnSpeed;
+		Pilot.FireRate = Agent.FireRate;
+		Pilot.LastFireTime = Agent.LastFireTime;
+		Pilot.bEvading = Agent.State == EAIState::Evading;
+		Pilot.bHasContact = Agent.bHasContact;
+		Pilot.ContactLocation = ToFlightModel(Agent.ContactLocation);
+		Pilot.ContactVelocity = ToFlightModel(Agent.ContactVelocity);
+		return Pilot;
+	}
+
+	FlightModel::FAIPilotFrame ToFlightModel(const FAIAircraftFrame& Frame)
+	{
+		FlightModel::FAIPilotFrame Pilot;
+		Pilot.Time = Frame.Time;
+		Pilot.DeltaTime = Frame.DeltaTime;
+		Pilot.ContactMemorySeconds = Frame.ContactMemorySeconds;
+		Pilot.PatrolCenter = ToFlightModel(Frame.PatrolCenter);
+		Pilot.PatrolRadius = Frame.PatrolRadius;
+		return Pilot;
+	}
+}
+
+void AIAircraftLogic::Plan(const FAIAircraftAgent& Agent, const FAIAircraftFrame& Frame, FAIAircraftPlan& InOutPlan)
+{
+	FlightModel::AIPilot::Plan(ToFlightModel(Agent), ToFlightModel(Frame), InOutPlan);
+}
+
+void AIAircraftLogic::Steer(const FAIAircraftAgent& Agent, const FAIAircraftFrame& Frame, FAIAircraftPlan& InOutPlan)
+{
+	FlightModel::AIPilot::Steer(ToFlightModel(Agent), ToFlightModel(Frame), InOutPlan);
+}
+
+void AIAircraftLogic::Decide(int32 Slot, const FAIAircraftAgent& Agent, const FAIAircraftPlan& Plan, const FAIAircraftFrame& Frame, FAIAircraftCommandBuffer& Out)
+{
+	const FlightModel::FAIPilotDecision Decision = FlightModel::AIPilot::Decide(ToFlightModel(Agent), Plan, ToFlightModel(Frame));
+
+	Out.AddThrust(Slot, FVector(Decision.Thrust.X, Decision.Thrust.Y, Decision.Thrust.Z));
+
+	if (Decision.bTurn)
+	{
+		Out.SetRotation(Slot, FRotator(Decision.Rotation.Pitch, Decision.Rotation.Yaw, Decision.Rotation.Roll).Quaternion());
+	}
+
+	if (Decision.bFire)
+	{
+		Out.Fire(Slot);
+	}
+}
+
+void AIAircraftLogic::PlanAll(TArrayView<const FAIAircraftAgent> Agents, const FAIAircraftFrame& Frame,
+	TArrayView<FAIAircraftPlan> Plans, TArrayView<const int32> Slots, bool bSingleThread)
+{
+	// Every listed slot is written by exactly one iteration
+	ParallelFor(TEXT("AIAircraftPlan"), Slots.Num(), 64, [&](int32 Index)
+	{
+		const int32 Slot = Slots[Index];
+		Plan(Agents[Slot], Frame, Plans[Slot]);
+		Steer(Agents[Slot], Frame, Plans[Slot]);
+	}, bSingleThread ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void AIAircraftLogic::DecideAll(TArrayView<const FAIAircraftAgent> Agents, TArrayView<const FAIAircraftPlan> Plans,
+	const FAIAircraftFrame& Frame, TArray<FAIAircraftCommandBuffer>& Batches, int32 BatchSize, bool bSingleThread)
+{
+	const int32 Num = Agents.Num();
+	BatchSize = FMath::Max(1, BatchSize);
+	const int32 NumBatches = FMath::DivideAndRoundUp(Num, BatchSize);
+	Batches.SetNum(NumBatches, EAllowShrinking::No);
+
+	// Batch boundaries depend only on BatchSize, never on how many workers pick them up
+	ParallelFor(TEXT("AIAircraftDecide"), NumBatches, 1, [&](int32 BatchIndex)
+	{
+		FAIAircraftCommandBuffer& Buffer = Batches[BatchIndex];
+		Buffer.Commands.Reset();
+
+		const int32 First = BatchIndex * BatchSize;
+		const int32 Last = FMath::Min(First + BatchSize, Num);
+		for (int32 Slot = First; Slot < Last; ++Slot)
+		{
+			Decide(Slot, Agents[Slot], Plans[Slot], Frame, Buffer);
+		}
+	}, bSingleThread ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+// --- FAIAircraftTickFunction ---
+
+void FAIAircraftTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->UpdateAircraft(DeltaTime);
+	}
+}
+
+FString FAIAircraftTickFunction::DiagnosticMessage()
+{
+	return TEXT("UAIAircraftSubsystem::UpdateAircraft");
+}
+
+// --- UAIAircraftSubsystem ---
+
+bool UAIAircraftSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAIAircraftSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UAIAircraftSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	Super::Deinitialize();
+}
+
+int32 UAIAircraftSubsystem::RegisterAircraft(AAIAircraftPawn* Pawn)
+{
+	if (!Pawn)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Handle;
+	if (FreeHandles.Num() > 0)
+	{
+		Handle = FreeHandles.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Handle = HandleToSlot.Add(INDEX_NONE);
+	}
+
+	const int32 Slot = Pawns.Add(Pawn);
+	Agents.AddDefaulted();
+	Plans.AddDefaulted();
+	SlotToHandle.Add(Handle);
+	HandleToSlot[Handle] = Slot;
+
+	return Handle;
+}
+
+void UAIAircraftSubsystem::UnregisterAircraft(int32 Handle)
+{
+	if (!HandleToSlot.IsValidIndex(Handle) || HandleToSlot[Handle] == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 Slot = HandleToSlot[Handle];
+	if (bApplying)
+	{
+		// Apply is walking the dense arrays; blank the slot now and compact once it is done
+		Pawns[Slot] = nullptr;
+		PendingRemovals.Add(Handle);
+		return;
+	}
+
+	// Swap the last slot into the hole and patch its handle
+	const int32 LastSlot = Pawns.Num() - 1;
+	if (Slot != LastSlot)
+	{
+		HandleToSlot[SlotToHandle[LastSlot]] = Slot;
+	}
+
+	Pawns.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Agents.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Plans.RemoveAtSwap(Slot, EAllowShrinking::No);
+	SlotToHandle.RemoveAtSwap(Slot, EAllowShrinking::No);
+
+	HandleToSlot[Handle] = INDEX_NONE;
+	FreeHandles.Add(Handle);
+}
+
+bool UAIAircraftSubsystem::GetTargetLocation(FVector& OutLocation) const
+{
+	OutLocation = Frame.TargetLocation;
+	return Frame.bHasTarget;
+}
+
+void UAIAircraftSubsystem::NotifyDamaged(int32 Handle)
+{
+	if (HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE)
+	{
+		const UWorld* World = GetWorld();
+		Plans[HandleToSlot[Handle]].PriorityUntil = (World ? World->GetTimeSeconds() : 0.0) + GAIUnderFirePrioritySeconds;
+	}
+}
+
+void UAIAircraftSubsystem::UpdateAircraft(float DeltaTime)
+{
+	Gather(DeltaTime);
+	Schedule();
+	Decide();
+	Apply();
+}
+
+void UAIAircraftSubsystem::Gather(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightAIGather);
+
+	// Shared inputs, once per frame rather than once per aircraft
+	UWorld* World = GetWorld();
+	const APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+	Frame.bHasTarget = PlayerPawn != nullptr;
+	Frame.TargetLocation = PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector;
+	Frame.TargetVelocity = PlayerPawn ? PlayerPawn->GetVelocity() : FVector::ZeroVector;
+	Frame.Time = World->GetTimeSeconds();
+	Frame.DeltaTime = DeltaTime;
+	Frame.ContactMemorySeconds = GAIContactMemorySeconds;
+	Frame.PatrolCenter = FVector::ZeroVector;
+	Frame.PatrolRadius = GAIPatrolRadius;
+
+	// Only the pawn's own state here; the radar contact is looked up for the agents Schedule re-plans
+	for (int32 i = 0; i < Pawns.Num(); ++i)
+	{
+		if (const AAIAircraftPawn* Pawn = Pawns[i].Get())
+		{
+			Pawn->GatherAgentState(Agents[i]);
+
+			if (Pawn->GetPhysicsLOD() == EAircraftPhysicsLOD::Full)
+			{
+				INC_DWORD_STAT(STAT_FlightAIRigidBodies);
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_FlightAIPointMasses);
+			}
+		}
+	}
+}
+
+void UAIAircraftSubsystem::Schedule()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightAIPlan);
+
+	const int32 Num = Agents.Num();
+	PlanSlots.Reset();
+	NormalCandidates.Reset();
+
+	int32 MaxPlans = Num;
+	if (GAIPlanBudgetMs > 0.0f && Num > 0)
+	{
+		MaxPlans = FMath::Clamp(FMath::FloorToInt32(GAIPlanBudgetMs * 0.001 / SecondsPerPlan), 1, Num);
+	}
+
+	// One pass in round-robin order, so priority agents beyond the budget also take turns
+	const double PriorityDistanceSq = FMath::Square(double(GAIPriorityDistance));
+	RoundRobinCursor = Num > 0 ? RoundRobinCursor % Num : 0;
+	for (int32 Offset = 0; Offset < Num; ++Offset)
+	{
+		const int32 Slot = (RoundRobinCursor + Offset) % Num;
+		const FAIAircraftPlan& Plan = Plans[Slot];
+		// Agents without a plan take their round-robin turn like the rest, or searchers could starve everyone else
+		const bool bPriority = Plan.PriorityUntil > Frame.Time
+			|| (Frame.bHasTarget && FVector::DistSquared(Agents[Slot].Location, Frame.TargetLocation) < PriorityDistanceSq);
+
+		if (bPriority)
+		{
+			if (PlanSlots.Num() < MaxPlans)
+			{
+				PlanSlots.Add(Slot);
+			}
+		}
+		else
+		{
+			NormalCandidates.Add(Slot);
+		}
+	}
+
+	const int32 NumPriority = PlanSlots.Num();
+	const int32 NumNormal = FMath::Min(NormalCandidates.Num(), MaxPlans - NumPriority);
+	PlanSlots.Append(NormalCandidates.GetData(), NumNormal);
+	if (NumNormal > 0)
+	{
+		// Carry on after the last agent the round-robin reached
+		RoundRobinCursor = NormalCandidates[NumNormal - 1] + 1;
+	}
+	else if (NumPriority > 0 && NumPriority == MaxPlans)
+	{
+		// Priority agents alone filled the budget; rotate through them instead
+		RoundRobinCursor = PlanSlots[NumPriority - 1] + 1;
+	}
+
+	const double Start = FPlatformTime::Seconds();
+
+	// Agents only know about the player through their own radar
+	const URadarSubsystem* Radar = GetWorld()->GetSubsystem<URadarSubsystem>();
+	FRadarContact Contact;
+	for (int32 Slot : PlanSlots)
+	{
+		FAIAircraftAgent& Agent = Agents[Slot];
+		const AAIAircraftPawn* Pawn = Pawns[Slot].Get();
+		Agent.bHasContact = Radar && Pawn && Radar->GetNearestContact(Pawn->GetSpatialHandle(), AircraftTeams::Player, Contact);
+		Agent.ContactLocation = Agent.bHasContact ? Contact.Location : FVector::ZeroVector;
+		Agent.ContactVelocity = Agent.bHasContact ? Contact.Velocity : FVector::ZeroVector;
+	}
+
+	AIAircraftLogic::PlanAll(Agents, Frame, Plans, PlanSlots, !GAIParallelDecide);
+	const double Elapsed = FPlatformTime::Seconds() - Start;
+
+	if (PlanSlots.Num() > 0)
+	{
+		SecondsPerPlan = FMath::Lerp(SecondsPerPlan, FMath::Max(Elapsed / PlanSlots.Num(), 1.0e-9), 0.1);
+	}
+
+	double TotalStaleness = 0.0;
+	double MaxStaleness = 0.0;
+	for (const FAIAircraftPlan& Plan : Plans)
+	{
+		const double Staleness = Plan.bValid ? Frame.Time - Plan.PlanTime : 0.0;
+		TotalStaleness += Staleness;
+		MaxStaleness = FMath::Max(MaxStaleness, Staleness);
+	}
+
+	ScheduleStats.NumAgents = Num;
+	ScheduleStats.NumPlanned = PlanSlots.Num();
+	ScheduleStats.NumPriorityPlanned = NumPriority;
+	ScheduleStats.AverageStalenessSeconds = Num > 0 ? float(TotalStaleness / Num) : 0.0f;
+	ScheduleStats.MaxStalenessSeconds = float(MaxStaleness);
+	ScheduleStats.PlanMilliseconds = float(Elapsed * 1000.0);
+
+	INC_DWORD_STAT_BY(STAT_FlightAIPlanned, ScheduleStats.NumPlanned);
+	INC_DWORD_STAT_BY(STAT_FlightAIPriorityPlanned, ScheduleStats.NumPriorityPlanned);
+	SET_FLOAT_STAT(STAT_FlightAIAverageStaleness, ScheduleStats.AverageStalenessSeconds * 1000.0f);
+	SET_FLOAT_STAT(STAT_FlightAIMaxStaleness, ScheduleStats.MaxStalenessSeconds * 1000.0f);
+}
+
+void UAIAircraftSubsystem::Decide()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightAIDecide);
+
+	AIAircraftLogic::DecideAll(Agents, Plans, Frame, CommandBatches, GAIDecideBatchSize, !GAIParallelDecide);
+}
+
+void UAIAircraftSubsystem::Apply()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightAIApply);
+
+	// Firing can kill an aircraft, whose EndPlay unregisters it while we are still iterating
+	bApplying = true;
+	for (const FAIAircraftCommandBuffer& Buffer : CommandBatches)
+	{
+		for (const FAIAircraftCommand& Command : Buffer.Commands)
+		{
+			if (AAIAircraftPawn* Pawn = Pawns[Command.Slot].Get())
+			{
+				Pawn->ExecuteCommand(Command, Frame.DeltaTime, Frame.Time);
+			}
+		}
+	}
+	bApplying = false;
+
+	for (int32 Handle : PendingRemovals)
+	{
+		UnregisterAircraft(Handle);
+	}
+	PendingRemovals.Reset();
+}
+
+// --- Determinism test ---
+
+namespace AIAircraftDeterminismTest
+{
+	// Runs a synthetic fight through the decide phase and replays the commands onto the agents
+	// the way the pawns would, recording every command in replay order
+	static void Simulate(TArray<FAIAircraftAgent> Agents, int32 Frames, int32 BatchSize, bool bSingleThread, TArray<FAIAircraftCommand>& OutCommands)
+	{
+		TArray<FAIAircraftCommandBuffer> Batches;
+		TArray<FAIAircraftPlan> Plans;
+		Plans.SetNum(Agents.Num());
+		TArray<int32> PlanSlots;
+		FAIAircraftFrame Frame;
+		Frame.bHasTarget = true;
+		Frame.DeltaTime = 1.0f / 60.0f;
+		Frame.ContactMemorySeconds = 0.5f;
+		Frame.PatrolRadius = 600000.0f;
+
+		for (int32 FrameIndex = 0; FrameIndex < Frames; ++FrameIndex)
+		{
+			Frame.Time = FrameIndex * double(Frame.DeltaTime);
+			Frame.TargetLocation = FVector(200000.0 * FMath::Cos(Frame.Time * 0.3), 200000.0 * FMath::Sin(Frame.Time * 0.3), 500000.0);
+			Frame.TargetVelocity = FVector(-60000.0 * FMath::Sin(Frame.Time * 0.3), 60000.0 * FMath::Cos(Frame.Time * 0.3), 0.0);
+
+			// Every other agent has the target on radar, so lost-contact and search paths are exercised too
+			for (int32 Slot = 0; Slot < Agents.Num(); ++Slot)
+			{
+				FAIAircraftAgent& Agent = Agents[Slot];
+				Agent.bHasContact = ((Slot + FrameIndex / 60) & 1) == 0;
+				Agent.ContactLocation = Frame.TargetLocation;
+				Agent.ContactVelocity = Frame.TargetVelocity;
+			}
+
+			// A fixed quarter of the agents is re-planned each frame so extrapolated plans are exercised too
+			PlanSlots.Reset();
+			for (int32 Slot = FrameIndex % 4; Slot < Agents.Num(); Slot += 4)
+			{
+				PlanSlots.Add(Slot);
+			}
+			AIAircraftLogic::PlanAll(Agents, Frame, Plans, PlanSlots, bSingleThread);
+			AIAircraftLogic::DecideAll(Agents, Plans, Frame, Batches, BatchSize, bSingleThread);
+
+			for (const FAIAircraftCommandBuffer& Buffer : Batches)
+			{
+				for (const FAIAircraftCommand& Command : Buffer.Commands)
+				{
+					FAIAircraftAgent& Agent = Agents[Command.Slot];
+					switch (Command.Type)
+					{
+					case EAIAircraftCommandType::AddThrust:
+						Agent.Location += Command.Force * Frame.DeltaTime;
+						break;
+					case EAIAircraftCommandType::SetRotation:
+						Agent.Rotation = Command.Rotation.Rotator();
+						break;
+					case EAIAircraftCommandType::Fire:
+						Agent.LastFireTime = Frame.Time;
+						break;
+					}
+					OutCommands.Add(Command);
+				}
+			}
+		}
+	}
+
+	static bool IsIdentical(const FAIAircraftCommand& A, const FAIAircraftCommand& B)
+	{
+		// Bitwise float comparison is the point: any reordering of math would show up here
+		return A.Slot == B.Slot && A.Type == B.Type
+			&& FMemory::Memcmp(&A.Force, &B.Force, sizeof(FVector)) == 0
+			&& FMemory::Memcmp(&A.Rotation, &B.Rotation, sizeof(FQuat)) == 0;
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		const int32 NumAgents = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4096;
+		const int32 Frames = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 300;
+		const int32 BatchSize = 16;
+
+		FRandomStream Random(4242);
+		TArray<FAIAircraftAgent> Agents;
+		Agents.SetNum(NumAgents);
+		for (FAIAircraftAgent& Agent : Agents)
+		{
+			Agent.Location = Random.GetUnitVector() * Random.FRandRange(10000.0f, 800000.0f);
+			Agent.Rotation = FRotator(Random.FRandRange(-60.0f, 60.0f), Random.FRandRange(-180.0f, 180.0f), 0.0f);
+			Agent.FlightSpeed = 5000.0f;
+			Agent.TurnSpeed = 2.0f;
+			Agent.AvoidanceDistance = 15000.0f;
+			Agent.EvasionTurnSpeed = 8.0f;
+			Agent.FireRate = 0.2f;
+			Agent.State = Random.FRand() < 0.2f ? EAIState::Evading : EAIState::Seeking;
+		}
+
+		TArray<FAIAircraftCommand> SingleThreaded;
+		TArray<FAIAircraftCommand> MultiThreaded;
+
+		double Start = FPlatformTime::Seconds();
+		Simulate(Agents, Frames, BatchSize, true, SingleThreaded);
+		const double SingleSeconds = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		Simulate(Agents, Frames, BatchSize, false, MultiThreaded);
+		const double MultiSeconds = FPlatformTime::Seconds() - Start;
+
+		int32 FirstMismatch = SingleThreaded.Num() == MultiThreaded.Num() ? INDEX_NONE : FMath::Min(SingleThreaded.Num(), MultiThreaded.Num());
+		for (int32 i = 0; i < FMath::Min(SingleThreaded.Num(), MultiThreaded.Num()); ++i)
+		{
+			if (!IsIdentical(SingleThreaded[i], MultiThreaded[i]))
+			{
+				FirstMismatch = i;
+				break;
+			}
+		}
+
+		UE_LOG(LogFlightSim, Display, TEXT("AIDeterminism: %d agents x %d frames, %d commands, %d worker threads"),
+			NumAgents, Frames, SingleThreaded.Num(), FTaskGraphInterface::Get().GetNumWorkerThreads());
+		UE_LOG(LogFlightSim, Display, TEXT("  1 thread: %.2f ms/frame, N threads: %.2f ms/frame"),
+			SingleSeconds * 1000.0 / Frames, MultiSeconds * 1000.0 / Frames);
+		if (FirstMismatch == INDEX_NONE)
+		{
+			UE_LOG(LogFlightSim, Display, TEXT("  PASS: command streams are bit-identical"));
+		}
+		else
+		{
+			UE_LOG(LogFlightSim, Error, TEXT("  FAIL: command streams diverge at command %d"), FirstMismatch);
+		}
+	}
+
+	static FAutoConsoleCommand DeterminismCommand(
+		TEXT("FlightSim.TestAIDeterminism"),
+		TEXT("Runs the AI decide phase on 1 thread and on all workers and checks the replayed commands are identical. Usage: FlightSim.TestAIDeterminism [NumAgents] [Frames]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Run));
+}
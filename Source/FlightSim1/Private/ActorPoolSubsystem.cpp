@@ -0,0 +1,214 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "ActorPoolSubsystem.h"
+#include "FlightSim1.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Spawns"), STAT_FlightActorPoolSpawns, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Reuses"), STAT_FlightActorPoolReuses, STATGROUP_FlightSim);
+
+static int32 GActorPoolMaxFreePerClass = 64;
+static FAutoConsoleVariableRef CVarActorPoolMaxFreePerClass(
+	TEXT("FlightSim.ActorPool.MaxFreePerClass"),
+	GActorPoolMaxFreePerClass,
+	TEXT("Parked actors kept per class; anything released beyond this is destroyed."));
+
+bool UActorPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	// The world is going away and takes the parked actors with it
+	Buckets.Empty();
+
+	Super::Deinitialize();
+}
+
+AActor* UActorPoolSubsystem::SpawnPooled(UClass* Class, const FTransform& Transform, FActorPoolBucket& Bucket)
+{
+	// Deferred so the actor hears it belongs to the pool before BeginPlay, and leaves starting up to Acquire
+	AActor* Actor = GetWorld()->SpawnActorDeferred<AActor>(Class, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	if (IPooledActor* Pooled = Cast<IPooledActor>(Actor))
+	{
+		Pooled->OnSpawnedForPool();
+	}
+	Actor->FinishSpawning(Transform);
+
+	++Bucket.Stats.NumSpawned;
+	INC_DWORD_STAT(STAT_FlightActorPoolSpawns);
+	return Actor;
+}
+
+void UActorPoolSubsystem::Park(AActor* Actor)
+{
+	if (IPooledActor* Pooled = Cast<IPooledActor>(Actor))
+	{
+		Pooled->OnReturnedToPool();
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> Class, int32 Count)
+{
+	if (!Class)
+	{
+		return;
+	}
+
+	FActorPoolBucket& Bucket = Buckets.FindOrAdd(Class.Get());
+	Count = FMath::Min(Count, GActorPoolMaxFreePerClass);
+	while (Bucket.Free.Num() < Count)
+	{
+		AActor* Actor = SpawnPooled(Class.Get(), FTransform::Identity, Bucket);
+		if (!Actor)
+		{
+			return;
+		}
+
+		Park(Actor);
+		Bucket.Free.Add(Actor);
+	}
+	Bucket.Stats.NumFree = Bucket.Free.Num();
+}
+
+AActor* UActorPoolSubsystem::Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+	if (!Class)
+	{
+		return nullptr;
+	}
+
+	FActorPoolBucket& Bucket = Buckets.FindOrAdd(Class.Get());
+
+	// Parked actors can still be destroyed from outside (e.g. streaming); skip those
+	AActor* Actor = nullptr;
+	while (!Actor && Bucket.Free.Num() > 0)
+	{
+		AActor* Candidate = Bucket.Free.Pop(EAllowShrinking::No);
+		if (IsValid(Candidate))
+		{
+			Actor = Candidate;
+		}
+	}
+
+	if (Actor)
+	{
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		++Bucket.Stats.NumReused;
+		INC_DWORD_STAT(STAT_FlightActorPoolReuses);
+	}
+	else
+	{
+		Actor = SpawnPooled(Class.Get(), Transform, Bucket);
+		if (!Actor)
+		{
+			return nullptr;
+		}
+	}
+
+	Actor->SetOwner(Owner);
+	Actor->SetInstigator(Instigator);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(true);
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	if (IPooledActor* Pooled = Cast<IPooledActor>(Actor))
+	{
+		Pooled->OnAcquiredFromPool();
+	}
+
+	FActorPoolStats& Stats = Bucket.Stats;
+	++Stats.NumAcquired;
+	++Stats.NumActive;
+	Stats.PeakActive = FMath::Max(Stats.PeakActive, Stats.NumActive);
+	Stats.NumFree = Bucket.Free.Num();
+	return Actor;
+}
+
+void UActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	FActorPoolBucket& Bucket = Buckets.FindOrAdd(Actor->GetClass());
+	if (Bucket.Free.Contains(Actor))
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("ActorPool: %s released twice"), *Actor->GetName());
+		return;
+	}
+
+	FActorPoolStats& Stats = Bucket.Stats;
+	++Stats.NumReleased;
+	Stats.NumActive = FMath::Max(Stats.NumActive - 1, 0);
+
+	if (Bucket.Free.Num() >= GActorPoolMaxFreePerClass)
+	{
+		++Stats.NumDestroyed;
+		Actor->Destroy();
+		return;
+	}
+
+	Park(Actor);
+	Bucket.Free.Add(Actor);
+	Stats.NumFree = Bucket.Free.Num();
+}
+
+FActorPoolStats UActorPoolSubsystem::GetStats(TSubclassOf<AActor> Class) const
+{
+	const FActorPoolBucket* Bucket = Buckets.Find(Class.Get());
+	return Bucket ? Bucket->Stats : FActorPoolStats();
+}
+
+FActorPoolStats UActorPoolSubsystem::GetTotalStats() const
+{
+	FActorPoolStats Total;
+	for (const TPair<UClass*, FActorPoolBucket>& Pair : Buckets)
+	{
+		const FActorPoolStats& Stats = Pair.Value.Stats;
+		Total.NumSpawned += Stats.NumSpawned;
+		Total.NumAcquired += Stats.NumAcquired;
+		Total.NumReused += Stats.NumReused;
+		Total.NumReleased += Stats.NumReleased;
+		Total.NumDestroyed += Stats.NumDestroyed;
+		Total.NumActive += Stats.NumActive;
+		Total.NumFree += Stats.NumFree;
+		Total.PeakActive += Stats.PeakActive;
+	}
+	return Total;
+}
+
+void UActorPoolSubsystem::LogStats() const
+{
+	for (const TPair<UClass*, FActorPoolBucket>& Pair : Buckets)
+	{
+		const FActorPoolStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogFlightSim, Display, TEXT("ActorPool %s: %d active (peak %d), %d free, %d spawned, %d acquired (%d reused), %d released, %d destroyed"),
+			*GetNameSafe(Pair.Key), Stats.NumActive, Stats.PeakActive, Stats.NumFree, Stats.NumSpawned,
+			Stats.NumAcquired, Stats.NumReused, Stats.NumReleased, Stats.NumDestroyed);
+	}
+}
+
+static FAutoConsoleCommandWithWorld GActorPoolStatsCommand(
+	TEXT("FlightSim.ActorPool.Stats"),
+	TEXT("Logs the actor pool counters for every pooled class."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+		{
+			Pool->LogStats();
+		}
+	}));
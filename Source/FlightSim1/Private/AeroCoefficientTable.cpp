@@ -0,0 +1,135 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "AeroCoefficientTable.h"
+#include "FlightSim1.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Aircraft, and the physics thread flying them, only hold baked tables in a game or PIE world
+	bool IsAnyGameWorldPlaying()
+	{
+		if (!GEngine)
+		{
+			return false;
+		}
+
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			const UWorld* World = Context.World();
+			if (World && (Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && World->HasBegunPlay())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+void UAeroCoefficientTable::PostLoad()
+{
+	Super::PostLoad();
+
+	// Bake once at load so the flight model never touches the authored arrays
+	Bake();
+}
+
+#if WITH_EDITOR
+void UAeroCoefficientTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	Bake();
+}
+#endif
+
+const FlightModel::FAeroTable* UAeroCoefficientTable::GetBakedTable() const
+{
+	if (!Baked)
+	{
+		// Assets created at runtime never go through PostLoad
+		const_cast<UAeroCoefficientTable*>(this)->Bake();
+	}
+	return Baked->IsValid() ? Baked.Get() : nullptr;
+}
+
+void UAeroCoefficientTable::ResetToGenericFighter()
+{
+	Modify();
+
+	const FlightModel::FAeroTableSource Source = FlightModel::MakeGenericFighterTable();
+
+	AngleOfAttackDegrees.Reset(static_cast<int32>(Source.AngleOfAttack.size()));
+	for (double Radians : Source.AngleOfAttack)
+	{
+		AngleOfAttackDegrees.Add(FMath::RadiansToDegrees(Radians));
+	}
+
+	MachNumbers.Reset(static_cast<int32>(Source.Mach.size()));
+	for (double Mach : Source.Mach)
+	{
+		MachNumbers.Add(Mach);
+	}
+
+	Points.Reset(static_cast<int32>(Source.Points.size()));
+	for (const FlightModel::FAeroTablePoint& SourcePoint : Source.Points)
+	{
+		FAeroCoefficientPoint& Point = Points.AddDefaulted_GetRef();
+		Point.CL = SourcePoint.CL;
+		Point.CD = SourcePoint.CD;
+		Point.Cm = SourcePoint.Cm;
+		Point.CLPerDeflection = SourcePoint.CLPerDeflection;
+		Point.CDPerDeflectionSq = SourcePoint.CDPerDeflectionSq;
+		Point.CmPerDeflection = SourcePoint.CmPerDeflection;
+	}
+
+	Bake();
+}
+
+void UAeroCoefficientTable::Bake()
+{
+	FlightModel::FAeroTableSource Source;
+	Source.AngleOfAttack.reserve(AngleOfAttackDegrees.Num());
+	for (float Degrees : AngleOfAttackDegrees)
+	{
+		Source.AngleOfAttack.push_back(FMath::DegreesToRadians(Degrees));
+	}
+
+	Source.Mach.assign(MachNumbers.GetData(), MachNumbers.GetData() + MachNumbers.Num());
+
+	Source.Points.reserve(Points.Num());
+	for (const FAeroCoefficientPoint& Point : Points)
+	{
+		FlightModel::FAeroTablePoint& SourcePoint = Source.Points.emplace_back();
+		SourcePoint.CL = Point.CL;
+		SourcePoint.CD = Point.CD;
+		SourcePoint.Cm = Point.Cm;
+		SourcePoint.CLPerDeflection = Point.CLPerDeflection;
+		SourcePoint.CDPerDeflectionSq = Point.CDPerDeflectionSq;
+		SourcePoint.CmPerDeflection = Point.CmPerDeflection;
+	}
+
+	TUniquePtr<FlightModel::FAeroTable> NewTable = MakeUnique<FlightModel::FAeroTable>();
+	if (!NewTable->Bake(Source))
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("%s: aero table needs strictly ascending AoA/Mach axes and %d x %d points (has %d), falling back to scalar coefficients"),
+			*GetName(), MachNumbers.Num(), AngleOfAttackDegrees.Num(), Points.Num());
+	}
+	else if (ForceScale <= 0.0f || MomentScale <= 0.0f)
+	{
+		UE_LOG(LogFlightSim, Error, TEXT("%s: aero table ForceScale (%g) and MomentScale (%g) must be positive, aircraft using it get no lift, drag or pitching moment"),
+			*GetName(), ForceScale, MomentScale);
+	}
+
+	// A valid table may already be in an airframe; keep it alive rather than free it under the physics thread.
+	// With nothing playing no airframe can hold one, so this and every earlier bake can go.
+	if (!IsAnyGameWorldPlaying())
+	{
+		RetiredBakes.Reset();
+	}
+	else if (Baked && Baked->IsValid())
+	{
+		RetiredBakes.Add(MoveTemp(Baked));
+	}
+	Baked = MoveTemp(NewTable);
+}
@@ -0,0 +1,389 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "AircraftSpatialSubsystem.h"
+#include "FlightSim1.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/HitResult.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "Algo/Sort.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spatial Index Update"), STAT_FlightSpatialUpdate, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spatial Index Cell Moves"), STAT_FlightSpatialCellMoves, STATGROUP_FlightSim);
+
+static float GAircraftGridCellSize = 100000.0f;
+static FAutoConsoleVariableRef CVarAircraftGridCellSize(
+	TEXT("FlightSim.Spatial.CellSize"),
+	GAircraftGridCellSize,
+	TEXT("Edge length of the aircraft spatial grid cells, in cm. Read when a world starts."));
+
+// --- FAircraftSpatialTickFunction ---
+
+void FAircraftSpatialTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->UpdateIndex(DeltaTime);
+	}
+}
+
+FString FAircraftSpatialTickFunction::DiagnosticMessage()
+{
+	return TEXT("UAircraftSpatialSubsystem::UpdateIndex");
+}
+
+// --- UAircraftSpatialSubsystem ---
+
+bool UAircraftSpatialSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UAircraftSpatialSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	CellSize = FMath::Max(GAircraftGridCellSize, 1000.0f);
+	InvCellSize = 1.0f / CellSize;
+}
+
+void UAircraftSpatialSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UAircraftSpatialSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	ObjectHandles.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UAircraftSpatialSubsystem::RegisterAircraft(AActor* Aircraft, uint32 TeamMask, float Radius, UPrimitiveComponent* Body)
+{
+	if (!Aircraft)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Handle;
+	if (FreeHandles.Num() > 0)
+	{
+		Handle = FreeHandles.Pop(EAllowShrinking::No);
+		++HandleGenerations[Handle];
+	}
+	else
+	{
+		Handle = HandleToSlot.Add(INDEX_NONE);
+		Bodies.AddDefaulted();
+		ActorKeys.Add(nullptr);
+		BodyKeys.Add(nullptr);
+		HandleGenerations.Add(0);
+	}
+
+	// Visible to queries straight away rather than from the next update
+	const FVector Location = Aircraft->GetActorLocation();
+	const FIntVector Cell = CellOf(Location);
+
+	const int32 Slot = Actors.Add(Aircraft);
+	Locations.Add(Location);
+	Velocities.Add(Aircraft->GetVelocity());
+	Radii.Add(Radius);
+	TeamMasks.Add(TeamMask);
+	CellKeys.Add(Cell);
+	SlotToHandle.Add(Handle);
+	HandleToSlot[Handle] = Slot;
+
+	Bodies[Handle] = Body;
+	ActorKeys[Handle] = Aircraft;
+	BodyKeys[Handle] = Body;
+	ObjectHandles.Add(Aircraft, Handle);
+	if (Body)
+	{
+		ObjectHandles.Add(Body, Handle);
+	}
+
+	AddToCell(Cell, Handle);
+	return Handle;
+}
+
+void UAircraftSpatialSubsystem::UnregisterAircraft(int32 Handle)
+{
+	if (!IsValidHandle(Handle))
+	{
+		return;
+	}
+
+	const int32 Slot = HandleToSlot[Handle];
+	RemoveFromCell(CellKeys[Slot], Handle);
+
+	// Swap the last slot into the hole and patch its handle
+	const int32 LastSlot = Actors.Num() - 1;
+	if (Slot != LastSlot)
+	{
+		HandleToSlot[SlotToHandle[LastSlot]] = Slot;
+	}
+
+	Actors.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Locations.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Radii.RemoveAtSwap(Slot, EAllowShrinking::No);
+	TeamMasks.RemoveAtSwap(Slot, EAllowShrinking::No);
+	CellKeys.RemoveAtSwap(Slot, EAllowShrinking::No);
+	SlotToHandle.RemoveAtSwap(Slot, EAllowShrinking::No);
+
+	ObjectHandles.Remove(ActorKeys[Handle]);
+	if (BodyKeys[Handle])
+	{
+		ObjectHandles.Remove(BodyKeys[Handle]);
+	}
+	Bodies[Handle].Reset();
+	ActorKeys[Handle] = nullptr;
+	BodyKeys[Handle] = nullptr;
+
+	HandleToSlot[Handle] = INDEX_NONE;
+	FreeHandles.Add(Handle);
+}
+
+void UAircraftSpatialSubsystem::UpdateIndex(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightSpatialUpdate);
+
+	const float InvDeltaTime = DeltaTime > UE_SMALL_NUMBER ? 1.0f / DeltaTime : 0.0f;
+	int32 NumMoves = 0;
+
+	for (int32 Slot = 0; Slot < Actors.Num(); ++Slot)
+	{
+		const AActor* Aircraft = Actors[Slot].Get();
+		if (!Aircraft)
+		{
+			continue;
+		}
+
+		// Differencing works the same for rigid bodies and kinematically moved aircraft
+		const FVector Location = Aircraft->GetActorLocation();
+		Velocities[Slot] = (Location - Locations[Slot]) * InvDeltaTime;
+		Locations[Slot] = Location;
+
+		const FIntVector Cell = CellOf(Location);
+		if (Cell != CellKeys[Slot])
+		{
+			const int32 Handle = SlotToHandle[Slot];
+			RemoveFromCell(CellKeys[Slot], Handle);
+			AddToCell(Cell, Handle);
+			CellKeys[Slot] = Cell;
+			++NumMoves;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_FlightSpatialCellMoves, NumMoves);
+}
+
+FIntVector UAircraftSpatialSubsystem::CellOf(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X * InvCellSize),
+		FMath::FloorToInt32(Location.Y * InvCellSize),
+		FMath::FloorToInt32(Location.Z * InvCellSize));
+}
+
+void UAircraftSpatialSubsystem::AddToCell(const FIntVector& Cell, int32 Handle)
+{
+	Cells.FindOrAdd(Cell).Add(Handle);
+}
+
+void UAircraftSpatialSubsystem::RemoveFromCell(const FIntVector& Cell, int32 Handle)
+{
+	if (TArray<int32>* Bucket = Cells.Find(Cell))
+	{
+		Bucket->RemoveSingleSwap(Handle, EAllowShrinking::No);
+		if (Bucket->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+template<typename VisitorType>
+void UAircraftSpatialSubsystem::ForEachInBox(const FVector& Min, const FVector& Max, uint32 TeamMask, VisitorType&& Visitor) const
+{
+	// Count in double first: huge boxes must not overflow the cell coordinates
+	const double SpanX = FMath::FloorToDouble(Max.X * InvCellSize) - FMath::FloorToDouble(Min.X * InvCellSize) + 1.0;
+	const double SpanY = FMath::FloorToDouble(Max.Y * InvCellSize) - FMath::FloorToDouble(Min.Y * InvCellSize) + 1.0;
+	const double SpanZ = FMath::FloorToDouble(Max.Z * InvCellSize) - FMath::FloorToDouble(Min.Z * InvCellSize) + 1.0;
+
+	if (SpanX * SpanY * SpanZ > double(Actors.Num()))
+	{
+		// Cheaper to walk the dense arrays than to probe that many cells
+		for (int32 Slot = 0; Slot < Actors.Num(); ++Slot)
+		{
+			if (TeamMasks[Slot] & TeamMask)
+			{
+				Visitor(Slot);
+			}
+		}
+		return;
+	}
+
+	const FIntVector MinCell = CellOf(Min);
+	const FIntVector MaxCell = CellOf(Max);
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const TArray<int32>* Bucket = Cells.Find(FIntVector(X, Y, Z));
+				if (!Bucket)
+				{
+					continue;
+				}
+
+				for (int32 Handle : *Bucket)
+				{
+					const int32 Slot = HandleToSlot[Handle];
+					if (TeamMasks[Slot] & TeamMask)
+					{
+						Visitor(Slot);
+					}
+				}
+			}
+		}
+	}
+}
+
+void UAircraftSpatialSubsystem::QueryRadius(const FVector& Center, float Radius, uint32 TeamMask, TArray<int32>& OutHandles) const
+{
+	OutHandles.Reset();
+
+	const double RadiusSq = FMath::Square(double(Radius));
+	ForEachInBox(Center - FVector(Radius), Center + FVector(Radius), TeamMask, [&](int32 Slot)
+	{
+		if (FVector::DistSquared(Locations[Slot], Center) <= RadiusSq)
+		{
+			OutHandles.Add(SlotToHandle[Slot]);
+		}
+	});
+}
+
+void UAircraftSpatialSubsystem::QueryCone(const FVector& Origin, const FVector& Direction, float MinCosAngle, float Range, uint32 TeamMask, TArray<int32>& OutHandles) const
+{
+	OutHandles.Reset();
+
+	const double RangeSq = FMath::Square(double(Range));
+	ForEachInBox(Origin - FVector(Range), Origin + FVector(Range), TeamMask, [&](int32 Slot)
+	{
+		const FVector ToAircraft = Locations[Slot] - Origin;
+		const double DistanceSq = ToAircraft.SizeSquared();
+		if (DistanceSq > RangeSq || DistanceSq < UE_SMALL_NUMBER)
+		{
+			return;
+		}
+
+		// dot(dir, v) > cos * |v|, without the square root when the sign already decides it
+		const double Along = FVector::DotProduct(Direction, ToAircraft);
+		if (MinCosAngle >= 0.0f ? (Along > 0.0 && Along * Along > MinCosAngle * MinCosAngle * DistanceSq)
+			: Along > MinCosAngle * FMath::Sqrt(DistanceSq))
+		{
+			OutHandles.Add(SlotToHandle[Slot]);
+		}
+	});
+}
+
+void UAircraftSpatialSubsystem::QueryNearest(const FVector& Center, int32 K, float MaxRadius, uint32 TeamMask, TArray<int32>& OutHandles) const
+{
+	OutHandles.Reset();
+	if (K <= 0 || Actors.Num() == 0)
+	{
+		return;
+	}
+
+	// Grow the search sphere until it holds K aircraft; every aircraft inside it is closer than any outside
+	double Radius = CellSize;
+	for (;;)
+	{
+		const double CellsAcross = 2.0 * FMath::CeilToDouble(Radius * InvCellSize) + 1.0;
+		const bool bFinal = Radius >= MaxRadius || CellsAcross * CellsAcross * CellsAcross > double(Actors.Num());
+
+		QueryRadius(Center, bFinal ? MaxRadius : float(Radius), TeamMask, OutHandles);
+		if (bFinal || OutHandles.Num() >= K)
+		{
+			break;
+		}
+		Radius *= 2.0;
+	}
+
+	// Nearest first, ties broken by handle so results never depend on bucket order
+	Algo::Sort(OutHandles, [this, &Center](int32 A, int32 B)
+	{
+		const double DistanceA = FVector::DistSquared(Locations[HandleToSlot[A]], Center);
+		const double DistanceB = FVector::DistSquared(Locations[HandleToSlot[B]], Center);
+		return DistanceA < DistanceB || (DistanceA == DistanceB && A < B);
+	});
+
+	if (OutHandles.Num() > K)
+	{
+		OutHandles.SetNum(K, EAllowShrinking::No);
+	}
+}
+
+AActor* UAircraftSpatialSubsystem::GetActor(int32 Handle) const
+{
+	return IsValidHandle(Handle) ? Actors[HandleToSlot[Handle]].Get() : nullptr;
+}
+
+UPrimitiveComponent* UAircraftSpatialSubsystem::GetBody(int32 Handle) const
+{
+	return IsValidHandle(Handle) ? Bodies[Handle].Get() : nullptr;
+}
+
+int32 UAircraftSpatialSubsystem::FindHandle(const AActor* Aircraft) const
+{
+	const int32* Handle = Aircraft ? ObjectHandles.Find(Aircraft) : nullptr;
+	return Handle ? *Handle : INDEX_NONE;
+}
+
+int32 UAircraftSpatialSubsystem::FindHandle(const UPrimitiveComponent* Body) const
+{
+	const int32* Handle = Body ? ObjectHandles.Find(Body) : nullptr;
+	return Handle ? *Handle : INDEX_NONE;
+}
+
+int32 UAircraftSpatialSubsystem::FindHandle(const FHitResult& Hit) const
+{
+	const int32 Handle = FindHandle(Hit.GetComponent());
+	return Handle != INDEX_NONE ? Handle : FindHandle(Hit.GetActor());
+}
+
+FVector UAircraftSpatialSubsystem::GetLocation(int32 Handle) const
+{
+	return IsValidHandle(Handle) ? Locations[HandleToSlot[Handle]] : FVector::ZeroVector;
+}
+
+FVector UAircraftSpatialSubsystem::GetVelocity(int32 Handle) const
+{
+	return IsValidHandle(Handle) ? Velocities[HandleToSlot[Handle]] : FVector::ZeroVector;
+}
+
+float UAircraftSpatialSubsystem::GetRadius(int32 Handle) const
+{
+	return IsValidHandle(Handle) ? Radii[HandleToSlot[Handle]] : 0.0f;
+}
+
+uint32 UAircraftSpatialSubsystem::GetTeamMask(int32 Handle) const
+{
+	return IsValidHandle(Handle) ? TeamMasks[HandleToSlot[Handle]] : 0u;
+}
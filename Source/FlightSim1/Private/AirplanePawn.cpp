@@ -8,6 +8,9 @@
 #include "EnhancedInputComponent.h"
 #include "InputActionValue.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "FlightPhysicsSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "AeroCoefficientTable.h"
 
 // Sets default values
 AAirplanePawn::AAirplanePawn()
@@ -45,6 +48,36 @@ void AAirplanePawn::BeginPlay()
 			Subsystem->AddMappingContext(IMC_FlightControls, 0);
 		}
 	}
+
+	// Hand our physics body to the batched flight model
+	FlightPhysics = GetWorld()->GetSubsystem<UFlightPhysicsSubsystem>();
+	if (FlightPhysics)
+	{
+		AeroHandle = FlightPhysics->RegisterAircraft(this, AirframeMesh, MakeAirframe());
+	}
+
+	SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+	if (SpatialIndex)
+	{
+		SpatialHandle = SpatialIndex->RegisterAircraft(this, AircraftTeams::Player, AirframeMesh->Bounds.SphereRadius);
+	}
+}
+
+void AAirplanePawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (FlightPhysics)
+	{
+		FlightPhysics->UnregisterAircraft(AeroHandle);
+		AeroHandle = INDEX_NONE;
+	}
+
+	if (SpatialIndex)
+	{
+		SpatialIndex->UnregisterAircraft(SpatialHandle);
+		SpatialHandle = INDEX_NONE;
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -60,36 +93,40 @@ void AAirplanePawn::Tick(float DeltaTime)
 	CurrentThrottle = FMath::FInterpTo(CurrentThrottle, TargetThrottle, DeltaTime, ThrottleChangeSpeed);
 
 	// --- Physics Forces ---
-	if (AirframeMesh)
+	// Thrust, lift, drag and the control torques are summed by the flight physics subsystem
+	// for every aircraft in one batched pass on the physics thread; we only publish our commands.
+	if (FlightPhysics)
+	{
+		FlightPhysics->SetAirframe(AeroHandle, MakeAirframe());
+
+		FlightModel::FControls Controls;
+		Controls.Thrust = CurrentThrottle * EnginePower;
+		Controls.PitchTorque = PitchInput * ControlStrength;
+		Controls.RollTorque = RollInput * ControlStrength;
+		Controls.YawTorque = YawInput * ControlStrength;
+		Controls.Elevator = PitchInput;
+		FlightPhysics->SetControls(AeroHandle, Controls);
+	}
+}
+
+FlightModel::FAirframe AAirplanePawn::MakeAirframe() const
+{
+	// Coefficients work on raw cm/s velocity, lift follows the airframe's up vector
+	FlightModel::FAirframe Airframe;
+	Airframe.SpeedScale = 1.0;
+	Airframe.LiftCoefficient = LiftCoefficient;
+	Airframe.DragCoefficient = DragCoefficient;
+	Airframe.bLiftAlongVelocityNormal = false;
+	Airframe.bTorqueAsAcceleration = false;
+
+	if (AeroTable)
 	{
-		// 1. THRUST
-		const FVector ThrustForce = AirframeMesh->GetForwardVector() * CurrentThrottle * EnginePower;
-		AirframeMesh->AddForce(ThrustForce);
-
-		// 2. LIFT
-		const FVector Velocity = AirframeMesh->GetPhysicsLinearVelocity();
-		const double SpeedSquared = Velocity.SizeSquared();
-		const FVector LiftDirection = AirframeMesh->GetUpVector();
-		const FVector LiftForce = LiftDirection * SpeedSquared * LiftCoefficient;
-		AirframeMesh->AddForce(LiftForce);
-
-		// 3. DRAG
-		const FVector DragForce = -Velocity * Velocity.Size() * DragCoefficient;
-		AirframeMesh->AddForce(DragForce);
-
-		// 4. CONTROL TORQUES (Pitch, Roll, Yaw)
-		// Pitch
-		const FVector PitchTorque = AirframeMesh->GetRightVector() * PitchInput * ControlStrength;
-		AirframeMesh->AddTorqueInRadians(PitchTorque);
-
-		// Roll
-		const FVector RollTorque = AirframeMesh->GetForwardVector() * RollInput * ControlStrength;
-		AirframeMesh->AddTorqueInRadians(RollTorque);
-
-		// Yaw
-		const FVector YawTorque = AirframeMesh->GetUpVector() * YawInput * ControlStrength;
-		AirframeMesh->AddTorqueInRadians(YawTorque);
+		Airframe.AeroTable = AeroTable->GetBakedTable();
+		Airframe.TableForceScale = AeroTable->ForceScale;
+		Airframe.TableMomentScale = AeroTable->MomentScale;
+		Airframe.MaxElevatorDeflection = FMath::DegreesToRadians(AeroTable->MaxElevatorDeflectionDegrees);
 	}
+	return Airframe;
 }
 
 // Called to bind functionality to input
@@ -0,0 +1,250 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "DamageLedgerSubsystem.h"
+#include "FlightSim1.h"
+#include "AircraftSpatialSubsystem.h"
+#include "FlightRecorderSubsystem.h"
+#include "HealthComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/HitResult.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_FlightDamageResolve, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Events"), STAT_FlightDamageEvents, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Victims"), STAT_FlightDamageVictims, STATGROUP_FlightSim);
+
+// --- FDamageLedgerTickFunction ---
+
+void FDamageLedgerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->ResolveDamage();
+	}
+}
+
+FString FDamageLedgerTickFunction::DiagnosticMessage()
+{
+	return TEXT("UDamageLedgerSubsystem::ResolveDamage");
+}
+
+// --- UDamageLedgerSubsystem ---
+
+bool UDamageLedgerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDamageLedgerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+
+	Recorder = InWorld.GetSubsystem<UFlightRecorderSubsystem>();
+}
+
+void UDamageLedgerSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	Health.Empty();
+	MaxHealth.Empty();
+	PendingDamage.Empty();
+	Components.Empty();
+	Damaged.Empty();
+	Resolved.Empty();
+
+	Super::Deinitialize();
+}
+
+void UDamageLedgerSubsystem::RegisterAircraft(int32 AircraftHandle, UHealthComponent* InHealth, float CurrentHealth, float InMaxHealth)
+{
+	if (AircraftHandle < 0 || !InHealth)
+	{
+		return;
+	}
+
+	if (AircraftHandle >= Components.Num())
+	{
+		const int32 NewNum = AircraftHandle + 1;
+		Health.SetNumZeroed(NewNum);
+		MaxHealth.SetNumZeroed(NewNum);
+		PendingDamage.SetNumZeroed(NewNum);
+		Components.SetNum(NewNum);
+	}
+
+	Health[AircraftHandle] = CurrentHealth;
+	MaxHealth[AircraftHandle] = InMaxHealth;
+	Components[AircraftHandle] = InHealth;
+
+	// Damage queued for whoever had the handle before is not ours
+	PendingDamage[AircraftHandle] = 0.0f;
+}
+
+void UDamageLedgerSubsystem::UnregisterAircraft(int32 AircraftHandle, const UHealthComponent* InHealth)
+{
+	if (!Components.IsValidIndex(AircraftHandle) || Components[AircraftHandle].Get() != InHealth)
+	{
+		return;
+	}
+
+	// Left in Damaged if it is there; a zero entry with no component is skipped when resolving
+	Components[AircraftHandle].Reset();
+	Health[AircraftHandle] = 0.0f;
+	PendingDamage[AircraftHandle] = 0.0f;
+}
+
+void UDamageLedgerSubsystem::QueueDamage(int32 AircraftHandle, float Damage)
+{
+	if (!IsRegistered(AircraftHandle) || Damage <= 0.0f)
+	{
+		return;
+	}
+
+	// A zero total means this is the aircraft's first hit of the frame
+	if (PendingDamage[AircraftHandle] == 0.0f)
+	{
+		Damaged.Add(AircraftHandle);
+	}
+	PendingDamage[AircraftHandle] += Damage;
+	++NumEventsThisFrame;
+}
+
+void UDamageLedgerSubsystem::CancelPending()
+{
+	for (const int32 Handle : Damaged)
+	{
+		PendingDamage[Handle] = 0.0f;
+	}
+	Damaged.Reset();
+	NumEventsThisFrame = 0;
+}
+
+void UDamageLedgerSubsystem::ResolveDamage()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightDamageResolve);
+	const double Start = FPlatformTime::Seconds();
+
+	Stats.NumEvents = NumEventsThisFrame;
+	Stats.NumVictims = 0;
+	Stats.NumDeaths = 0;
+	NumEventsThisFrame = 0;
+
+	// Settle every aircraft's health before anyone hears about it
+	Resolved.Reset();
+	for (const int32 Handle : Damaged)
+	{
+		const float Damage = PendingDamage[Handle];
+		PendingDamage[Handle] = 0.0f;
+
+		// Unregistered since it was hit, or already dead and waiting to be destroyed
+		if (Damage <= 0.0f || !Components[Handle].IsValid() || Health[Handle] <= 0.0f)
+		{
+			continue;
+		}
+
+		Health[Handle] = FMath::Clamp(Health[Handle] - Damage, 0.0f, MaxHealth[Handle]);
+
+		FResolvedDamage& Entry = Resolved.AddDefaulted_GetRef();
+		Entry.Component = Components[Handle];
+		Entry.Damage = Damage;
+		Entry.NewHealth = Health[Handle];
+
+		if (Recorder)
+		{
+			Recorder->RecordDamage(Handle, Damage);
+		}
+	}
+	Damaged.Reset();
+
+	// Handlers and deaths may queue damage, destroy aircraft or spawn new ones; all of that lands in the next resolve
+	for (const FResolvedDamage& Entry : Resolved)
+	{
+		if (UHealthComponent* Component = Entry.Component.Get())
+		{
+			++Stats.NumVictims;
+			Stats.NumDeaths += Entry.NewHealth <= 0.0f;
+			Component->ApplyResolvedDamage(Entry.Damage, Entry.NewHealth);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_FlightDamageEvents, Stats.NumEvents);
+	INC_DWORD_STAT_BY(STAT_FlightDamageVictims, Stats.NumVictims);
+	Stats.ResolveMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+// --- Benchmark ---
+
+namespace HitResolveBenchmark
+{
+	// From a hit on an aircraft's body to its health: walking the actor's components, against the handle registry
+	static void Run(const TArray<FString>& Args, UWorld* World)
+	{
+		const UAircraftSpatialSubsystem* SpatialIndex = World ? World->GetSubsystem<UAircraftSpatialSubsystem>() : nullptr;
+		const UDamageLedgerSubsystem* DamageLedger = World ? World->GetSubsystem<UDamageLedgerSubsystem>() : nullptr;
+		if (!SpatialIndex || !DamageLedger || SpatialIndex->GetNumAircraft() == 0)
+		{
+			UE_LOG(LogFlightSim, Warning, TEXT("BenchHitResolve: needs a game world with aircraft"));
+			return;
+		}
+
+		const int32 NumLookups = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000000;
+		const int32 NumAircraft = SpatialIndex->GetNumAircraft();
+
+		// What a trace against each aircraft's body would return, visited in random order
+		TArray<FHitResult> HitResults;
+		for (int32 Slot = 0; Slot < NumAircraft; ++Slot)
+		{
+			const int32 Handle = SpatialIndex->GetHandleOfSlot(Slot);
+			HitResults.Emplace(SpatialIndex->GetActor(Handle), SpatialIndex->GetBody(Handle), SpatialIndex->GetLocation(Handle), FVector::UpVector);
+		}
+		FRandomStream Random(1234);
+		TArray<int32> Order;
+		Order.SetNumUninitialized(NumLookups);
+		for (int32& Index : Order)
+		{
+			Index = Random.RandRange(0, NumAircraft - 1);
+		}
+
+		double Start = FPlatformTime::Seconds();
+		int32 WalkFound = 0;
+		for (const int32 Index : Order)
+		{
+			const AActor* Victim = HitResults[Index].GetActor();
+			WalkFound += Victim && Victim->FindComponentByClass<UHealthComponent>() != nullptr;
+		}
+		const double WalkSeconds = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		int32 RegistryFound = 0;
+		for (const int32 Index : Order)
+		{
+			RegistryFound += DamageLedger->GetHealthComponent(SpatialIndex->FindHandle(HitResults[Index])) != nullptr;
+		}
+		const double RegistrySeconds = FPlatformTime::Seconds() - Start;
+
+		UE_LOG(LogFlightSim, Display, TEXT("BenchHitResolve: %d lookups over %d aircraft"), NumLookups, NumAircraft);
+		UE_LOG(LogFlightSim, Display, TEXT("  FindComponentByClass: %.2f M hits/s, %d found"),
+			NumLookups / FMath::Max(WalkSeconds * 1.0e6, 1.0e-9), WalkFound);
+		UE_LOG(LogFlightSim, Display, TEXT("  handle registry:      %.2f M hits/s, %d found"),
+			NumLookups / FMath::Max(RegistrySeconds * 1.0e6, 1.0e-9), RegistryFound);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchCommand(
+		TEXT("FlightSim.BenchHitResolve"),
+		TEXT("Times resolving hits on aircraft to their health, by component search and by handle. Usage: FlightSim.BenchHitResolve [NumLookups]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Run));
+}
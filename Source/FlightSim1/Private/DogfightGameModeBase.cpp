@@ -2,6 +2,8 @@
 
 #include "DogfightGameModeBase.h"
 #include "AIAircraftPawn.h"
+#include "AircraftSpatialSubsystem.h"
+#include "MissionResetSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/Engine.h"
 #include "Blueprint/UserWidget.h" // Needed for widgets
@@ -14,6 +16,25 @@ void ADogfightGameModeBase::BeginPlay()
     SpawnEnemies();
 
     AliveEnemiesCount = NumberOfEnemiesToSpawn;
+
+    if (UMissionResetSubsystem* MissionReset = GetWorld()->GetSubsystem<UMissionResetSubsystem>())
+    {
+        MissionReset->OnMissionReset.AddUObject(this, &ADogfightGameModeBase::HandleMissionReset);
+    }
+}
+
+FAircraftSpawnWave ADogfightGameModeBase::MakeEnemyWave() const
+{
+    FAircraftSpawnWave Wave;
+    Wave.AircraftClass = AIPawnClass;
+    Wave.Count = NumberOfEnemiesToSpawn;
+    Wave.Pattern = SpawnPattern;
+    Wave.Center = FVector(0.0f, 0.0f, SpawnAltitude);
+    Wave.Radius = SpawnRadius;
+    Wave.FormationSize = FormationSize;
+    Wave.FormationSpacing = FormationSpacing;
+    Wave.Seed = SpawnSeed;
+    return Wave;
 }
 
 void ADogfightGameModeBase::SpawnEnemies()
@@ -23,19 +44,21 @@ void ADogfightGameModeBase::SpawnEnemies()
         return;
     }
 
-    for (int32 i = 0; i < NumberOfEnemiesToSpawn; ++i)
+    USpawnDirectorSubsystem* SpawnDirector = GetWorld()->GetSubsystem<USpawnDirectorSubsystem>();
+    if (!SpawnDirector)
     {
-        float Angle = FMath::FRandRange(0.f, 360.f);
-        FVector SpawnLocation = FVector(SpawnRadius * FMath::Cos(Angle), SpawnRadius * FMath::Sin(Angle), 5000.0f);
-        FRotator SpawnRotation = FRotator(0.0f, FMath::FRandRange(0.f, 360.f), 0.0f);
-
-        GetWorld()->SpawnActor<AAIAircraftPawn>(AIPawnClass, SpawnLocation, SpawnRotation);
+        return;
     }
+
+    // Spread over the next frames, so the level is playable straight away
+    SpawnDirector->QueueWave(MakeEnemyWave());
+    SpawnDirector->PrewarmPool(AIPawnClass, SparesToPrewarm);
 }
 
 void ADogfightGameModeBase::EnemyDestroyed()
 {
     AliveEnemiesCount--;
+    OnEnemyDestroyed.Broadcast();
     CheckWinCondition();
 }
 
@@ -53,9 +76,17 @@ void ADogfightGameModeBase::CheckWinCondition()
 // --- CHANGE 3: Implemented the PlayerDied function ---
 void ADogfightGameModeBase::PlayerDied()
 {
-    if (GameOverWidgetClass)
+    OnPlayerDied.Broadcast();
+
+    if (bRestartOnPlayerDeath)
     {
-        UUserWidget* GameOverWidget = CreateWidget<UUserWidget>(GetWorld(), GameOverWidgetClass);
+        RestartMission();
+        return;
+    }
+
+    if (GameOverWidgetClass && !GameOverWidget)
+    {
+        GameOverWidget = CreateWidget<UUserWidget>(GetWorld(), GameOverWidgetClass);
         if (GameOverWidget)
         {
             GameOverWidget->AddToViewport();
@@ -69,3 +100,50 @@ void ADogfightGameModeBase::PlayerDied()
         PlayerController->bShowMouseCursor = true;
     }
 }
+
+void ADogfightGameModeBase::RestartMission()
+{
+    // Deferred to the start of the next frame: we may be inside damage resolution right now
+    if (UMissionResetSubsystem* MissionReset = GetWorld()->GetSubsystem<UMissionResetSubsystem>())
+    {
+        MissionReset->RequestReset();
+    }
+}
+
+void ADogfightGameModeBase::RestartMissionWithSeed(int32 Seed)
+{
+    UMissionResetSubsystem* MissionReset = GetWorld()->GetSubsystem<UMissionResetSubsystem>();
+    if (!MissionReset)
+    {
+        return;
+    }
+
+    // Only the placement changes: the same aircraft come back out of the pool, somewhere else on the ring
+    FAircraftSpawnWave Wave = MakeEnemyWave();
+    Wave.Seed = Seed;
+    TArray<FTransform> Placement;
+    USpawnDirectorSubsystem::PlaceWave(Wave, Placement);
+    MissionReset->PlaceSnapshotAircraft(AircraftTeams::Hostile, Placement);
+    MissionReset->RequestReset();
+}
+
+void ADogfightGameModeBase::HandleMissionReset()
+{
+    if (const UMissionResetSubsystem* MissionReset = GetWorld()->GetSubsystem<UMissionResetSubsystem>())
+    {
+        AliveEnemiesCount = MissionReset->GetNumSnapshotAircraft(AircraftTeams::Hostile);
+    }
+
+    if (GameOverWidget)
+    {
+        GameOverWidget->RemoveFromParent();
+        GameOverWidget = nullptr;
+    }
+
+    APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+    if (PlayerController)
+    {
+        PlayerController->SetPause(false);
+        PlayerController->bShowMouseCursor = false;
+    }
+}
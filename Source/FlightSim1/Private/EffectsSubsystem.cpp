@@ -0,0 +1,354 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "EffectsSubsystem.h"
+#include "FlightSim1.h"
+#include "DamageLedgerSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Sound/SoundBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("Effects Dispatch"), STAT_FlightEffectsDispatch, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Played"), STAT_FlightEffectsPlayed, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Culled"), STAT_FlightEffectsCulled, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Components Spawned"), STAT_FlightEffectsSpawned, STATGROUP_FlightSim);
+
+static float GEffectsCullDistance = 300000.0f;
+static FAutoConsoleVariableRef CVarEffectsCullDistance(
+	TEXT("FlightSim.Effects.CullDistance"),
+	GEffectsCullDistance,
+	TEXT("Emitters further than this from the view are not played, cm."));
+
+static float GEffectsSoundCullDistance = 200000.0f;
+static FAutoConsoleVariableRef CVarEffectsSoundCullDistance(
+	TEXT("FlightSim.Effects.SoundCullDistance"),
+	GEffectsSoundCullDistance,
+	TEXT("Sounds further than this from the view are not played, cm."));
+
+static float GEffectsViewCullRadius = 5000.0f;
+static FAutoConsoleVariableRef CVarEffectsViewCullRadius(
+	TEXT("FlightSim.Effects.ViewCullRadius"),
+	GEffectsViewCullRadius,
+	TEXT("Emitters behind the camera are culled unless within this distance of it, cm (their smoke can still drift into view)."));
+
+static float GEffectsCoalesceSeconds = 0.15f;
+static FAutoConsoleVariableRef CVarEffectsCoalesceSeconds(
+	TEXT("FlightSim.Effects.CoalesceSeconds"),
+	GEffectsCoalesceSeconds,
+	TEXT("The same effect from the same instigator plays at most once per this many seconds. 0 disables coalescing."));
+
+static int32 GEffectsMaxPerEffect = 16;
+static FAutoConsoleVariableRef CVarEffectsMaxPerEffect(
+	TEXT("FlightSim.Effects.MaxPerEffect"),
+	GEffectsMaxPerEffect,
+	TEXT("Instances of one particle system or sound playing at once; also the size its pool grows to."));
+
+static int32 GEffectsMaxPerFrame = 24;
+static FAutoConsoleVariableRef CVarEffectsMaxPerFrame(
+	TEXT("FlightSim.Effects.MaxPerFrame"),
+	GEffectsMaxPerFrame,
+	TEXT("Effects started per frame, nearest to the view first; the rest are dropped."));
+
+// --- FEffectsTickFunction ---
+
+void FEffectsTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->DispatchEffects();
+	}
+}
+
+FString FEffectsTickFunction::DiagnosticMessage()
+{
+	return TEXT("UEffectsSubsystem::DispatchEffects");
+}
+
+// --- UEffectsSubsystem ---
+
+bool UEffectsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEffectsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<UDamageLedgerSubsystem>();
+}
+
+void UEffectsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+
+	// Death explosions are requested while the ledger resolves, in the same tick group
+	if (UDamageLedgerSubsystem* DamageLedger = InWorld.GetSubsystem<UDamageLedgerSubsystem>())
+	{
+		TickFunction.AddPrerequisite(DamageLedger, DamageLedger->GetTickFunction());
+	}
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UEffectsSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	// The world is going away and takes the pooled components with it
+	Pools.Empty();
+	Requests.Empty();
+	LastPlayed.Empty();
+
+	Super::Deinitialize();
+}
+
+void UEffectsSubsystem::PlayEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, const AActor* Instigator)
+{
+	if (!Template)
+	{
+		return;
+	}
+
+	FEffectRequest& Request = Requests.AddDefaulted_GetRef();
+	Request.Asset = Template;
+	Request.Location = Location;
+	Request.Rotation = Rotation;
+	Request.Instigator = Instigator;
+}
+
+void UEffectsSubsystem::PlaySound(USoundBase* Sound, const FVector& Location, const AActor* Instigator)
+{
+	if (!Sound)
+	{
+		return;
+	}
+
+	FEffectRequest& Request = Requests.AddDefaulted_GetRef();
+	Request.Asset = Sound;
+	Request.Location = Location;
+	Request.Instigator = Instigator;
+	Request.bSound = true;
+}
+
+bool UEffectsSubsystem::Play(UObject* Asset, const FEffectRequest& Request)
+{
+	FEffectPool& Pool = Pools.FindOrAdd(Asset);
+
+	// Anything no longer playing is free; components destroyed from outside are dropped on the way
+	for (int32 i = Pool.Components.Num() - 1; i >= 0; --i)
+	{
+		USceneComponent* Component = Pool.Components[i];
+		if (!IsValid(Component))
+		{
+			Pool.Components.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		if (Request.bSound)
+		{
+			UAudioComponent* Audio = CastChecked<UAudioComponent>(Component);
+			if (!Audio->IsPlaying())
+			{
+				Audio->SetWorldLocation(Request.Location);
+				Audio->Play();
+				++Stats.NumReused;
+				return true;
+			}
+		}
+		else
+		{
+			UParticleSystemComponent* Emitter = CastChecked<UParticleSystemComponent>(Component);
+			if (!Emitter->IsActive())
+			{
+				Emitter->SetWorldLocationAndRotation(Request.Location, Request.Rotation);
+				Emitter->ActivateSystem(true);
+				++Stats.NumReused;
+				return true;
+			}
+		}
+	}
+
+	if (Pool.Components.Num() >= GEffectsMaxPerEffect)
+	{
+		return false;
+	}
+
+	// Kept after it finishes, for the next request of the same effect
+	USceneComponent* Component = nullptr;
+	if (Request.bSound)
+	{
+		Component = UGameplayStatics::SpawnSoundAtLocation(GetWorld(), CastChecked<USoundBase>(Asset), Request.Location,
+			FRotator::ZeroRotator, 1.0f, 1.0f, 0.0f, nullptr, nullptr, false);
+	}
+	else
+	{
+		Component = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), CastChecked<UParticleSystem>(Asset), Request.Location,
+			Request.Rotation, FVector::OneVector, false, EPSCPoolMethod::None, true);
+	}
+
+	if (!Component)
+	{
+		return false;
+	}
+
+	Pool.Components.Add(Component);
+	++Stats.NumSpawned;
+	INC_DWORD_STAT(STAT_FlightEffectsSpawned);
+	return true;
+}
+
+void UEffectsSubsystem::DispatchEffects()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightEffectsDispatch);
+	const double Start = FPlatformTime::Seconds();
+
+	Stats.NumRequested += Requests.Num();
+
+	// The local player's view; with none (e.g. a dedicated server) nothing is culled
+	UWorld* World = GetWorld();
+	FVector ViewLocation = FVector::ZeroVector;
+	FVector ViewDirection = FVector::ForwardVector;
+	float MinViewCos = -1.0f;
+	bool bHasView = false;
+	if (APlayerController* PlayerController = World->GetFirstPlayerController())
+	{
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		ViewDirection = ViewRotation.Vector();
+		bHasView = true;
+
+		// Half the horizontal FOV, widened for the vertical extent and some margin
+		const float HalfFov = PlayerController->PlayerCameraManager ? PlayerController->PlayerCameraManager->GetFOVAngle() * 0.5f : 45.0f;
+		MinViewCos = FMath::Cos(FMath::DegreesToRadians(FMath::Min(HalfFov * 1.5f, 89.0f)));
+	}
+
+	const double CullDistanceSq = FMath::Square(double(GEffectsCullDistance));
+	const double SoundCullDistanceSq = FMath::Square(double(GEffectsSoundCullDistance));
+	const double ViewCullRadiusSq = FMath::Square(double(GEffectsViewCullRadius));
+	int32 NumCulled = 0;
+
+	Visible.Reset();
+	for (FEffectRequest& Request : Requests)
+	{
+		const FVector ToEffect = Request.Location - ViewLocation;
+		Request.DistanceSq = bHasView ? ToEffect.SizeSquared() : 0.0;
+		if (Request.DistanceSq > (Request.bSound ? SoundCullDistanceSq : CullDistanceSq))
+		{
+			++Stats.NumCulledDistance;
+			++NumCulled;
+			continue;
+		}
+
+		// Sounds are heard all round; emitters only where the camera looks
+		if (bHasView && !Request.bSound && Request.DistanceSq > ViewCullRadiusSq
+			&& FVector::DotProduct(ToEffect, ViewDirection) < MinViewCos * FMath::Sqrt(Request.DistanceSq))
+		{
+			++Stats.NumCulledView;
+			++NumCulled;
+			continue;
+		}
+
+		Visible.Add(Request);
+	}
+	Requests.Reset();
+
+	// Nearest first, so the budget goes to what the player is most likely to notice
+	Visible.Sort([](const FEffectRequest& A, const FEffectRequest& B) { return A.DistanceSq < B.DistanceSq; });
+
+	const double Now = World->GetTimeSeconds();
+	const double CoalesceSeconds = FMath::Max(GEffectsCoalesceSeconds, 0.0f);
+	int32 NumPlayed = 0;
+	for (const FEffectRequest& Request : Visible)
+	{
+		UObject* Asset = Request.Asset.Get();
+		if (!Asset)
+		{
+			continue;
+		}
+
+		const TPair<const UObject*, const AActor*> Key(Asset, Request.Instigator);
+		const bool bCoalesce = CoalesceSeconds > 0.0 && Request.Instigator;
+		if (bCoalesce)
+		{
+			const double* LastTime = LastPlayed.Find(Key);
+			if (LastTime && Now - *LastTime < CoalesceSeconds)
+			{
+				++Stats.NumCoalesced;
+				continue;
+			}
+		}
+
+		if (NumPlayed >= GEffectsMaxPerFrame)
+		{
+			++Stats.NumOverBudget;
+			continue;
+		}
+
+		if (Play(Asset, Request))
+		{
+			++NumPlayed;
+
+			// Only an effect that actually played opens a coalescing window; a dropped one must not hide the next
+			if (bCoalesce)
+			{
+				LastPlayed.Add(Key, Now);
+			}
+		}
+		else
+		{
+			++Stats.NumCapped;
+		}
+	}
+
+	// Entries older than the window can no longer coalesce anything
+	for (auto It = LastPlayed.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value() >= CoalesceSeconds)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_FlightEffectsPlayed, NumPlayed);
+	SET_DWORD_STAT(STAT_FlightEffectsCulled, NumCulled);
+	Stats.DispatchMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+void UEffectsSubsystem::LogStats() const
+{
+	int32 NumPooled = 0;
+	for (const TPair<UObject*, FEffectPool>& Pair : Pools)
+	{
+		NumPooled += Pair.Value.Components.Num();
+	}
+
+	UE_LOG(LogFlightSim, Display, TEXT("Effects: %d requested, %d spawned, %d reused, %d culled by distance, %d culled by view, %d coalesced, %d capped, %d over budget; %d pooled components over %d effects"),
+		Stats.NumRequested, Stats.NumSpawned, Stats.NumReused, Stats.NumCulledDistance, Stats.NumCulledView, Stats.NumCoalesced,
+		Stats.NumCapped, Stats.NumOverBudget, NumPooled, Pools.Num());
+}
+
+static FAutoConsoleCommandWithWorld GEffectsStatsCommand(
+	TEXT("FlightSim.Effects.Stats"),
+	TEXT("Logs the effects dispatcher's counters."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UEffectsSubsystem* Effects = World ? World->GetSubsystem<UEffectsSubsystem>() : nullptr)
+		{
+			Effects->LogStats();
+		}
+	}));
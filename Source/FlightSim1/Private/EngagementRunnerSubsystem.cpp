@@ -0,0 +1,731 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "EngagementRunnerSubsystem.h"
+#include "FlightSim1.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DogfightGameModeBase.h"
+#include "FighterJetPawn.h"
+#include "MissileGuidanceSubsystem.h"
+#include "MissionResetSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+static float GMonteCarloPilotGain = 3.0f;
+static FAutoConsoleVariableRef CVarMonteCarloPilotGain(
+	TEXT("FlightSim.MonteCarlo.PilotGain"),
+	GMonteCarloPilotGain,
+	TEXT("How hard the Monte Carlo autopilot steers: control input per radian of error, before clamping to full deflection."));
+
+static float GMonteCarloGunCone = 2.0f;
+static FAutoConsoleVariableRef CVarMonteCarloGunCone(
+	TEXT("FlightSim.MonteCarlo.GunCone"),
+	GMonteCarloGunCone,
+	TEXT("Degrees off the nose inside which the Monte Carlo autopilot fires the gun at a target in range."));
+
+static float GMonteCarloMissileInterval = 4.0f;
+static FAutoConsoleVariableRef CVarMonteCarloMissileInterval(
+	TEXT("FlightSim.MonteCarlo.MissileInterval"),
+	GMonteCarloMissileInterval,
+	TEXT("Seconds the Monte Carlo autopilot waits between missile launches while it holds a lock."));
+
+static float GMonteCarloMinAltitude = 300.0f;
+static FAutoConsoleVariableRef CVarMonteCarloMinAltitude(
+	TEXT("FlightSim.MonteCarlo.MinAltitude"),
+	GMonteCarloMinAltitude,
+	TEXT("Altitude, m, below which the Monte Carlo autopilot stops chasing and climbs."));
+
+namespace EngagementCsv
+{
+	static const TCHAR* const ResultNames[] = { TEXT("Win"), TEXT("Loss"), TEXT("Timeout") };
+
+	static double Ratio(double Numerator, double Denominator)
+	{
+		return Denominator > 0.0 ? Numerator / Denominator : 0.0;
+	}
+
+	// Blank for an engagement without the event, so a spreadsheet's averages skip it
+	static FString OptionalSeconds(bool bHas, double Seconds)
+	{
+		return bHas ? FString::Printf(TEXT("%.3f"), Seconds) : FString();
+	}
+}
+
+// --- FEngagementOutcome ---
+
+const TCHAR* FEngagementOutcome::CsvHeader()
+{
+	return TEXT("Run,Seed,Result,Seconds,Enemies,Kills,FirstKillSeconds,MeanKillSeconds,PlayerMissiles,PlayerMissileHits,EnemyMissiles,EnemyMissileHits,WallSeconds");
+}
+
+FString FEngagementOutcome::ToCsv() const
+{
+	return FString::Printf(TEXT("%d,%d,%s,%.3f,%d,%d,%s,%s,%d,%d,%d,%d,%.3f"),
+		Run, Seed, EngagementCsv::ResultNames[int32(Result)], Seconds, Enemies, Kills,
+		*EngagementCsv::OptionalSeconds(Kills > 0, FirstKillSeconds),
+		*EngagementCsv::OptionalSeconds(Kills > 0, EngagementCsv::Ratio(KillSecondsSum, Kills)),
+		PlayerMissiles, PlayerMissileHits, EnemyMissiles, EnemyMissileHits, WallSeconds);
+}
+
+bool FEngagementOutcome::FromCsv(const FString& Line)
+{
+	TArray<FString> Fields;
+	Line.ParseIntoArray(Fields, TEXT(","), false);
+	if (Fields.Num() != 13)
+	{
+		return false;
+	}
+
+	int32 Found = INDEX_NONE;
+	for (int32 Index = 0; Index < int32(UE_ARRAY_COUNT(EngagementCsv::ResultNames)); ++Index)
+	{
+		if (Fields[2] == EngagementCsv::ResultNames[Index])
+		{
+			Found = Index;
+		}
+	}
+	if (Found == INDEX_NONE)
+	{
+		return false;
+	}
+
+	Run = FCString::Atoi(*Fields[0]);
+	Seed = FCString::Atoi(*Fields[1]);
+	Result = EEngagementResult(Found);
+	Seconds = FCString::Atof(*Fields[3]);
+	Enemies = FCString::Atoi(*Fields[4]);
+	Kills = FCString::Atoi(*Fields[5]);
+	FirstKillSeconds = FCString::Atof(*Fields[6]);
+	KillSecondsSum = FCString::Atof(*Fields[7]) * Kills;
+	PlayerMissiles = FCString::Atoi(*Fields[8]);
+	PlayerMissileHits = FCString::Atoi(*Fields[9]);
+	EnemyMissiles = FCString::Atoi(*Fields[10]);
+	EnemyMissileHits = FCString::Atoi(*Fields[11]);
+	WallSeconds = FCString::Atof(*Fields[12]);
+	return true;
+}
+
+// --- FEngagementSummary ---
+
+void FEngagementSummary::Add(const FEngagementOutcome& Outcome)
+{
+	++Runs;
+	Wins += Outcome.Result == EEngagementResult::Win;
+	Losses += Outcome.Result == EEngagementResult::Loss;
+	Timeouts += Outcome.Result == EEngagementResult::Timeout;
+	Kills += Outcome.Kills;
+	if (Outcome.Kills > 0)
+	{
+		++RunsWithKill;
+		FirstKillSecondsSum += Outcome.FirstKillSeconds;
+		KillSecondsSum += Outcome.KillSecondsSum;
+	}
+	Seconds += Outcome.Seconds;
+	PlayerMissiles += Outcome.PlayerMissiles;
+	PlayerMissileHits += Outcome.PlayerMissileHits;
+	EnemyMissiles += Outcome.EnemyMissiles;
+	EnemyMissileHits += Outcome.EnemyMissileHits;
+}
+
+FString FEngagementSummary::ToCsv(double WallSeconds) const
+{
+	using namespace EngagementCsv;
+
+	// The kill ratio is kills per player loss, counting a batch without losses as one
+	FString Csv = TEXT("Runs,Wins,Losses,Timeouts,WinRate,Kills,KillRatio,KillsPerRun,MeanFirstKillSeconds,MeanKillSeconds,MeanEngagementSeconds,")
+		TEXT("PlayerMissiles,PlayerMissileHits,PlayerMissileHitRate,EnemyMissiles,EnemyMissileHits,EnemyMissileHitRate,SimSeconds,WallSeconds,SpeedUp") LINE_TERMINATOR;
+	Csv += FString::Printf(TEXT("%d,%d,%d,%d,%.4f,%d,%.4f,%.4f,%s,%s,%.3f,%d,%d,%.4f,%d,%d,%.4f,%.1f,%.1f,%.2f") LINE_TERMINATOR,
+		Runs, Wins, Losses, Timeouts, Ratio(Wins, Runs),
+		Kills, double(Kills) / FMath::Max(Losses, 1), Ratio(Kills, Runs),
+		*OptionalSeconds(RunsWithKill > 0, Ratio(FirstKillSecondsSum, RunsWithKill)),
+		*OptionalSeconds(Kills > 0, Ratio(KillSecondsSum, Kills)),
+		Ratio(Seconds, Runs),
+		PlayerMissiles, PlayerMissileHits, Ratio(PlayerMissileHits, PlayerMissiles),
+		EnemyMissiles, EnemyMissileHits, Ratio(EnemyMissileHits, EnemyMissiles),
+		Seconds, WallSeconds, Ratio(Seconds, WallSeconds));
+	return Csv;
+}
+
+// --- FEngagementRunSettings ---
+
+void FEngagementRunSettings::ParseCommandLine(const TCHAR* CommandLine)
+{
+	FParse::Value(CommandLine, TEXT("MonteCarloRuns="), NumRuns);
+	FParse::Value(CommandLine, TEXT("MonteCarloWorkers="), NumWorkers);
+	FParse::Value(CommandLine, TEXT("MonteCarloSeed="), BaseSeed);
+	FParse::Value(CommandLine, TEXT("MonteCarloFirst="), FirstRun);
+	FParse::Value(CommandLine, TEXT("MonteCarloMaxSeconds="), MaxSeconds);
+	FParse::Value(CommandLine, TEXT("MonteCarloStepHz="), StepHz);
+	FParse::Value(CommandLine, TEXT("MonteCarloOut="), OutPath);
+}
+
+// --- FEngagementRunnerTickFunction ---
+
+void FEngagementRunnerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->Update(DeltaTime);
+	}
+}
+
+FString FEngagementRunnerTickFunction::DiagnosticMessage()
+{
+	return TEXT("UEngagementRunnerSubsystem::Update");
+}
+
+// --- UEngagementRunnerSubsystem ---
+
+bool UEngagementRunnerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEngagementRunnerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	MissionReset = Collection.InitializeDependency<UMissionResetSubsystem>();
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	MissileGuidance = Collection.InitializeDependency<UMissileGuidanceSubsystem>();
+}
+
+void UEngagementRunnerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Ticks while paused too: the coordinator pauses its own world, and Game Over pauses until the next reset
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = true;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+
+	GameMode = InWorld.GetAuthGameMode<ADogfightGameModeBase>();
+	if (ADogfightGameModeBase* Mode = GameMode.Get())
+	{
+		EnemyDestroyedHandle = Mode->OnEnemyDestroyed.AddUObject(this, &UEngagementRunnerSubsystem::HandleEnemyDestroyed);
+		PlayerDiedHandle = Mode->OnPlayerDied.AddUObject(this, &UEngagementRunnerSubsystem::HandlePlayerDied);
+	}
+	if (MissionReset)
+	{
+		MissionResetHandle = MissionReset->OnMissionReset.AddUObject(this, &UEngagementRunnerSubsystem::HandleMissionReset);
+	}
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	if (FParse::Param(CommandLine, TEXT("MonteCarlo")))
+	{
+		FEngagementRunSettings CommandLineSettings;
+		CommandLineSettings.NumWorkers = FPlatformMisc::NumberOfCores();
+		CommandLineSettings.ParseCommandLine(CommandLine);
+
+		bExitWhenDone = true;
+		if (!StartBatch(CommandLineSettings))
+		{
+			FPlatformMisc::RequestExitWithStatus(false, 1);
+		}
+	}
+}
+
+void UEngagementRunnerSubsystem::Deinitialize()
+{
+	// Nobody is left to merge what the workers write
+	for (FProcHandle& Worker : Workers)
+	{
+		if (Worker.IsValid())
+		{
+			FPlatformProcess::TerminateProc(Worker, true);
+			FPlatformProcess::CloseProc(Worker);
+		}
+	}
+	Workers.Empty();
+
+	if (Results)
+	{
+		Results.Reset();
+		FApp::SetBenchmarking(false);
+		FApp::SetUseFixedTimeStep(false);
+	}
+
+	if (ADogfightGameModeBase* Mode = GameMode.Get())
+	{
+		Mode->OnEnemyDestroyed.Remove(EnemyDestroyedHandle);
+		Mode->OnPlayerDied.Remove(PlayerDiedHandle);
+	}
+	if (MissionReset)
+	{
+		MissionReset->OnMissionReset.Remove(MissionResetHandle);
+	}
+
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	Super::Deinitialize();
+}
+
+FString UEngagementRunnerSubsystem::GetWorkerPath(int32 Worker) const
+{
+	return FPaths::GetPath(Settings.OutPath) / FString::Printf(TEXT("%s.worker%d.csv"), *FPaths::GetBaseFilename(Settings.OutPath), Worker);
+}
+
+FString UEngagementRunnerSubsystem::GetSummaryPath() const
+{
+	return FPaths::GetPath(Settings.OutPath) / FPaths::GetBaseFilename(Settings.OutPath) + TEXT(".summary.csv");
+}
+
+bool UEngagementRunnerSubsystem::StartBatch(const FEngagementRunSettings& InSettings)
+{
+	if (Stats.bRunning)
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("MonteCarlo: a batch is already running"));
+		return false;
+	}
+
+	// Seed 0 would have the spawn director pick one at random
+	Settings = InSettings;
+	Settings.NumRuns = FMath::Max(Settings.NumRuns, 1);
+	Settings.NumWorkers = FMath::Clamp(Settings.NumWorkers, 1, Settings.NumRuns);
+	Settings.BaseSeed = FMath::Max(Settings.BaseSeed, 1);
+	Settings.FirstRun = FMath::Max(Settings.FirstRun, 0);
+	Settings.MaxSeconds = FMath::Max(Settings.MaxSeconds, 1.0f);
+	Settings.StepHz = FMath::Clamp(Settings.StepHz, 10.0f, 1000.0f);
+	if (Settings.OutPath.IsEmpty())
+	{
+		Settings.OutPath = FPaths::ProjectSavedDir() / TEXT("MonteCarlo") / FString::Printf(TEXT("Engagements-%s.csv"), *FDateTime::Now().ToString());
+	}
+	Settings.OutPath = FPaths::ConvertRelativePathToFull(Settings.OutPath);
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Settings.OutPath), true);
+
+	Summary = FEngagementSummary();
+	Stats = FEngagementRunnerStats();
+	Stats.NumRuns = Settings.NumRuns;
+	RunIndex = 0;
+	BatchStartWallTime = FPlatformTime::Seconds();
+
+	if (Settings.NumWorkers > 1)
+	{
+		if (!LaunchWorkers())
+		{
+			return false;
+		}
+		Stats.bRunning = true;
+		Phase = EPhase::Waiting;
+
+		// This world only waits; it should not take a core from the workers
+		UGameplayStatics::SetGamePaused(GetWorld(), true);
+		if (GEngine)
+		{
+			GEngine->SetMaxFPS(10.0f);
+		}
+		return true;
+	}
+
+	if (!GameMode.IsValid() || !MissionReset || !SpatialIndex)
+	{
+		UE_LOG(LogFlightSim, Error, TEXT("MonteCarlo: needs a world running ADogfightGameModeBase"));
+		return false;
+	}
+
+	Results.Reset(IFileManager::Get().CreateFileWriter(*Settings.OutPath));
+	if (!Results)
+	{
+		UE_LOG(LogFlightSim, Error, TEXT("MonteCarlo: cannot write %s"), *Settings.OutPath);
+		return false;
+	}
+	FTCHARToUTF8 Header(*(FString(FEngagementOutcome::CsvHeader()) + LINE_TERMINATOR));
+	Results->Serialize(const_cast<ANSICHAR*>(Header.Get()), Header.Length());
+
+	// A fixed step, and no waiting for the frame time: the simulation runs as fast as it can be computed
+	FApp::SetBenchmarking(true);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / Settings.StepHz);
+
+	UE_LOG(LogFlightSim, Log, TEXT("MonteCarlo: running %d engagements from run %d at %.0f Hz into %s"),
+		Settings.NumRuns, Settings.FirstRun, Settings.StepHz, *Settings.OutPath);
+
+	Stats.bRunning = true;
+	Phase = EPhase::WaitingForMission;
+	if (MissionReset->HasSnapshot())
+	{
+		StartNextRun();
+	}
+	return true;
+}
+
+void UEngagementRunnerSubsystem::Update(float DeltaTime)
+{
+	switch (Phase)
+	{
+	case EPhase::Waiting:
+		UpdateWorkers();
+		break;
+
+	case EPhase::WaitingForMission:
+		if (MissionReset->HasSnapshot())
+		{
+			StartNextRun();
+		}
+		break;
+
+	case EPhase::Fighting:
+		if (GetWorld()->GetTimeSeconds() - RunStartTime >= Settings.MaxSeconds)
+		{
+			FinishRun(EEngagementResult::Timeout);
+		}
+		else if (AFighterJetPawn* Jet = Cast<AFighterJetPawn>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0)))
+		{
+			FlyPlayer(Jet);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+// --- Engagements in this world ---
+
+void UEngagementRunnerSubsystem::StartNextRun()
+{
+	ADogfightGameModeBase* Mode = GameMode.Get();
+	if (!Mode)
+	{
+		FinishBatch();
+		return;
+	}
+
+	Outcome = FEngagementOutcome();
+	Outcome.Run = Settings.FirstRun + RunIndex;
+	Outcome.Seed = Settings.BaseSeed + Outcome.Run;
+
+	// The engagement starts once the reset has put the world back, at the start of the next frame
+	Phase = EPhase::Resetting;
+	Mode->RestartMissionWithSeed(Outcome.Seed);
+}
+
+void UEngagementRunnerSubsystem::HandleMissionReset()
+{
+	if (Phase != EPhase::Resetting)
+	{
+		return;
+	}
+
+	// Whatever else draws random numbers this engagement draws the same ones for the same seed
+	FMath::RandInit(Outcome.Seed);
+	FMath::SRandInit(Outcome.Seed);
+
+	RunStartTime = GetWorld()->GetTimeSeconds();
+	RunStartWallTime = FPlatformTime::Seconds();
+	LastMissileTime = RunStartTime - GMonteCarloMissileInterval;
+	Outcome.Enemies = MissionReset->GetNumSnapshotAircraft(AircraftTeams::Hostile);
+
+	if (MissileGuidance)
+	{
+		PlayerMissilesBefore = MissileGuidance->GetNumLaunched(AircraftTeams::Player);
+		PlayerHitsBefore = MissileGuidance->GetNumHits(AircraftTeams::Player);
+		EnemyMissilesBefore = MissileGuidance->GetNumLaunched(AircraftTeams::Hostile);
+		EnemyHitsBefore = MissileGuidance->GetNumHits(AircraftTeams::Hostile);
+	}
+
+	Phase = EPhase::Fighting;
+}
+
+void UEngagementRunnerSubsystem::HandleEnemyDestroyed()
+{
+	if (Phase != EPhase::Fighting)
+	{
+		return;
+	}
+
+	const float KillSeconds = float(GetWorld()->GetTimeSeconds() - RunStartTime);
+	if (Outcome.Kills == 0)
+	{
+		Outcome.FirstKillSeconds = KillSeconds;
+	}
+	++Outcome.Kills;
+	Outcome.KillSecondsSum += KillSeconds;
+
+	if (Outcome.Kills >= Outcome.Enemies)
+	{
+		FinishRun(EEngagementResult::Win);
+	}
+}
+
+void UEngagementRunnerSubsystem::HandlePlayerDied()
+{
+	if (Phase == EPhase::Fighting)
+	{
+		FinishRun(EEngagementResult::Loss);
+	}
+}
+
+void UEngagementRunnerSubsystem::FinishRun(EEngagementResult Result)
+{
+	Outcome.Result = Result;
+	Outcome.Seconds = float(GetWorld()->GetTimeSeconds() - RunStartTime);
+	Outcome.WallSeconds = float(FPlatformTime::Seconds() - RunStartWallTime);
+	if (MissileGuidance)
+	{
+		Outcome.PlayerMissiles = MissileGuidance->GetNumLaunched(AircraftTeams::Player) - PlayerMissilesBefore;
+		Outcome.PlayerMissileHits = MissileGuidance->GetNumHits(AircraftTeams::Player) - PlayerHitsBefore;
+		Outcome.EnemyMissiles = MissileGuidance->GetNumLaunched(AircraftTeams::Hostile) - EnemyMissilesBefore;
+		Outcome.EnemyMissileHits = MissileGuidance->GetNumHits(AircraftTeams::Hostile) - EnemyHitsBefore;
+	}
+
+	if (Results)
+	{
+		FTCHARToUTF8 Row(*(Outcome.ToCsv() + LINE_TERMINATOR));
+		Results->Serialize(const_cast<ANSICHAR*>(Row.Get()), Row.Length());
+		Results->Flush();
+	}
+
+	Summary.Add(Outcome);
+	++RunIndex;
+	Stats.NumDone = Summary.Runs;
+	Stats.NumWins = Summary.Wins;
+	Stats.NumLosses = Summary.Losses;
+	Stats.NumTimeouts = Summary.Timeouts;
+	Stats.SpeedUp = float(Summary.Seconds / FMath::Max(FPlatformTime::Seconds() - BatchStartWallTime, UE_SMALL_NUMBER));
+
+	UE_LOG(LogFlightSim, Log, TEXT("MonteCarlo: run %d (seed %d) %s after %.1f s with %d/%d kills; %d/%d done at %.1fx real time"),
+		Outcome.Run, Outcome.Seed, EngagementCsv::ResultNames[int32(Result)], Outcome.Seconds, Outcome.Kills, Outcome.Enemies,
+		Stats.NumDone, Stats.NumRuns, Stats.SpeedUp);
+
+	if (RunIndex >= Settings.NumRuns)
+	{
+		FinishBatch();
+	}
+	else
+	{
+		StartNextRun();
+	}
+}
+
+void UEngagementRunnerSubsystem::FinishBatch()
+{
+	const double WallSeconds = FPlatformTime::Seconds() - BatchStartWallTime;
+	const bool bComplete = Summary.Runs == Settings.NumRuns;
+
+	if (Results)
+	{
+		Results->Close();
+		Results.Reset();
+		FApp::SetBenchmarking(false);
+		FApp::SetUseFixedTimeStep(false);
+	}
+
+	FFileHelper::SaveStringToFile(Summary.ToCsv(WallSeconds), *GetSummaryPath());
+
+	UE_LOG(LogFlightSim, Log, TEXT("MonteCarlo: %d engagements (%d won, %d lost, %d timed out) in %.0f s, %.1fx real time, into %s"),
+		Summary.Runs, Summary.Wins, Summary.Losses, Summary.Timeouts, WallSeconds, EngagementCsv::Ratio(Summary.Seconds, WallSeconds), *Settings.OutPath);
+
+	Phase = EPhase::Idle;
+	Stats.bRunning = false;
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bComplete ? 0 : 1);
+	}
+}
+
+void UEngagementRunnerSubsystem::FlyPlayer(AFighterJetPawn* Jet)
+{
+	const FVector Location = Jet->GetActorLocation();
+	const FVector Forward = Jet->GetActorForwardVector();
+	const FVector Right = Jet->GetActorRightVector();
+	const FVector Up = Jet->GetActorUpVector();
+
+	FFighterPilotCommand Command;
+	Command.Throttle = 1.0f;
+
+	// The nearest enemy, straight at it: gunfire is hitscan unless FlightSim.Gunfire.Ballistic is on
+	FVector ToAim = Forward;
+	float Distance = TNumericLimits<float>::Max();
+	SpatialIndex->QueryNearest(Location, 1, TNumericLimits<float>::Max(), AircraftTeams::Hostile, Nearest);
+	if (Nearest.Num() > 0)
+	{
+		const FVector ToTarget = SpatialIndex->GetLocation(Nearest[0]) - Location;
+		Distance = ToTarget.Size();
+		ToAim = ToTarget.GetSafeNormal(UE_SMALL_NUMBER, Forward);
+	}
+
+	// Too low to fight: climb out at 30 degrees first
+	if (Jet->Altitude < GMonteCarloMinAltitude)
+	{
+		const FVector Level = FVector(Forward.X, Forward.Y, 0.0f).GetSafeNormal(UE_SMALL_NUMBER, FVector::ForwardVector);
+		ToAim = Level * 0.866f + FVector::UpVector * 0.5f;
+		Distance = TNumericLimits<float>::Max();
+	}
+
+	// Turning about Forward x ToAim swings the nose onto the aim; with it behind, pull towards whichever side it is on.
+	// Rolling about Up x Lateral brings the lift vector round to it, so the pull does the turning.
+	const float Along = FVector::DotProduct(ToAim, Forward);
+	const FVector Lateral = (ToAim - Forward * Along).GetSafeNormal();
+	const FVector TurnAxis = FVector::CrossProduct(Forward, Along > 0.0f ? ToAim : Lateral);
+	const FVector BankAxis = FVector::CrossProduct(Up, Lateral);
+	Command.Pitch = GMonteCarloPilotGain * FVector::DotProduct(TurnAxis, Right);
+	Command.Yaw = GMonteCarloPilotGain * FVector::DotProduct(TurnAxis, Up);
+	Command.Roll = GMonteCarloPilotGain * FVector::DotProduct(BankAxis, Forward);
+
+	Command.bFireGun = Distance <= Jet->WeaponRange && Along >= FMath::Cos(FMath::DegreesToRadians(GMonteCarloGunCone));
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Jet->LockedTarget && Now - LastMissileTime >= GMonteCarloMissileInterval)
+	{
+		Command.bFireMissile = true;
+		LastMissileTime = Now;
+	}
+
+	Jet->ApplyPilotCommand(Command);
+}
+
+// --- Worker processes ---
+
+bool UEngagementRunnerSubsystem::LaunchWorkers()
+{
+	// The same game on the same map; an editor build needs the project and -game as well
+	const FString Executable = FPlatformProcess::ExecutablePath();
+	FString BaseArgs;
+#if WITH_EDITOR
+	BaseArgs = FString::Printf(TEXT("\"%s\" -game "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+#endif
+	BaseArgs += GetWorld()->GetOutermost()->GetName();
+
+	// Contiguous shares: with thousands of runs the longest share is only a few engagements longer than the shortest
+	Workers.Reset();
+	for (int32 Worker = 0; Worker < Settings.NumWorkers; ++Worker)
+	{
+		const int32 First = int32(int64(Settings.NumRuns) * Worker / Settings.NumWorkers);
+		const int32 Count = int32(int64(Settings.NumRuns) * (Worker + 1) / Settings.NumWorkers) - First;
+		const FString WorkerPath = GetWorkerPath(Worker);
+
+		const FString Args = BaseArgs + FString::Printf(
+			TEXT(" -MonteCarlo -MonteCarloWorkers=1 -MonteCarloFirst=%d -MonteCarloRuns=%d -MonteCarloSeed=%d -MonteCarloMaxSeconds=%g -MonteCarloStepHz=%g")
+			TEXT(" -MonteCarloOut=\"%s\" -abslog=\"%s\" -nullrhi -nosound -unattended -nosplash"),
+			Settings.FirstRun + First, Count, Settings.BaseSeed, Settings.MaxSeconds, Settings.StepHz,
+			*WorkerPath, *FPaths::ChangeExtension(WorkerPath, TEXT("log")));
+
+		FProcHandle Handle = FPlatformProcess::CreateProc(*Executable, *Args, false, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Handle.IsValid())
+		{
+			UE_LOG(LogFlightSim, Error, TEXT("MonteCarlo: could not start worker %d: %s %s"), Worker, *Executable, *Args);
+			for (FProcHandle& Started : Workers)
+			{
+				FPlatformProcess::TerminateProc(Started, true);
+				FPlatformProcess::CloseProc(Started);
+			}
+			Workers.Reset();
+			return false;
+		}
+		Workers.Add(Handle);
+	}
+
+	UE_LOG(LogFlightSim, Log, TEXT("MonteCarlo: %d engagements over %d worker processes into %s"), Settings.NumRuns, Settings.NumWorkers, *Settings.OutPath);
+	return true;
+}
+
+void UEngagementRunnerSubsystem::UpdateWorkers()
+{
+	int32 NumRunning = 0;
+	for (int32 Worker = 0; Worker < Workers.Num(); ++Worker)
+	{
+		FProcHandle& Handle = Workers[Worker];
+		if (!Handle.IsValid())
+		{
+			continue;
+		}
+		if (FPlatformProcess::IsProcRunning(Handle))
+		{
+			++NumRunning;
+			continue;
+		}
+
+		int32 ReturnCode = 0;
+		FPlatformProcess::GetProcReturnCode(Handle, &ReturnCode);
+		FPlatformProcess::CloseProc(Handle);
+		Handle = FProcHandle();
+		UE_LOG(LogFlightSim, Log, TEXT("MonteCarlo: worker %d finished with code %d"), Worker, ReturnCode);
+	}
+
+	if (NumRunning == 0)
+	{
+		Workers.Reset();
+		MergeWorkerResults();
+		FinishBatch();
+	}
+}
+
+void UEngagementRunnerSubsystem::MergeWorkerResults()
+{
+	// Shares are contiguous and each worker writes in run order, so the merged rows are in run order too
+	FString Merged = FString(FEngagementOutcome::CsvHeader()) + LINE_TERMINATOR;
+	TArray<FString> Lines;
+	for (int32 Worker = 0; Worker < Settings.NumWorkers; ++Worker)
+	{
+		const FString WorkerPath = GetWorkerPath(Worker);
+		Lines.Reset();
+		if (!FFileHelper::LoadFileToStringArray(Lines, *WorkerPath))
+		{
+			UE_LOG(LogFlightSim, Warning, TEXT("MonteCarlo: worker %d left no results"), Worker);
+			continue;
+		}
+
+		for (int32 Index = 1; Index < Lines.Num(); ++Index)
+		{
+			FEngagementOutcome Row;
+			if (Row.FromCsv(Lines[Index]))
+			{
+				Summary.Add(Row);
+				Merged += Lines[Index];
+				Merged += LINE_TERMINATOR;
+			}
+		}
+		// The worker's own summary only covers its share
+		IFileManager::Get().Delete(*WorkerPath);
+		IFileManager::Get().Delete(*(FPaths::GetPath(WorkerPath) / FPaths::GetBaseFilename(WorkerPath) + TEXT(".summary.csv")));
+	}
+
+	if (Summary.Runs < Settings.NumRuns)
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("MonteCarlo: only %d of %d engagements finished; see the worker logs next to %s"),
+			Summary.Runs, Settings.NumRuns, *Settings.OutPath);
+	}
+	FFileHelper::SaveStringToFile(Merged, *Settings.OutPath);
+
+	Stats.NumDone = Summary.Runs;
+	Stats.NumWins = Summary.Wins;
+	Stats.NumLosses = Summary.Losses;
+	Stats.NumTimeouts = Summary.Timeouts;
+	Stats.SpeedUp = float(Summary.Seconds / FMath::Max(FPlatformTime::Seconds() - BatchStartWallTime, UE_SMALL_NUMBER));
+}
+
+// --- Console ---
+
+namespace EngagementRunnerCommands
+{
+	static FAutoConsoleCommandWithWorldAndArgs RunCommand(
+		TEXT("FlightSim.MonteCarlo.Run"),
+		TEXT("Runs seeded engagements back to back in this world and writes their results under Saved/MonteCarlo. Usage: FlightSim.MonteCarlo.Run [Runs] [Seed]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UEngagementRunnerSubsystem* Runner = World ? World->GetSubsystem<UEngagementRunnerSubsystem>() : nullptr)
+			{
+				FEngagementRunSettings Settings;
+				Settings.NumRuns = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : Settings.NumRuns;
+				Settings.BaseSeed = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : Settings.BaseSeed;
+				Runner->StartBatch(Settings);
+			}
+		}));
+}
@@ -3,7 +3,14 @@
 #include "FighterJetPawn.h"
 #include "HealthComponent.h"
 #include "Missile.h"
-#include "AIAircraftPawn.h"
+#include "FlightPhysicsSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "RadarSubsystem.h"
+#include "GunfireSubsystem.h"
+#include "EffectsSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "AeroCoefficientTable.h"
+#include "DogfightGameModeBase.h"
 #include "Components/StaticMeshComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
@@ -15,7 +22,6 @@
 #include "Blueprint/UserWidget.h"
 #include "UObject/ConstructorHelpers.h"
 #include "Particles/ParticleSystem.h"
-#include "Kismet/GameplayStatics.h"
 #include "Sound/SoundBase.h"
 
 // Sets default values
@@ -33,6 +39,9 @@ AFighterJetPawn::AFighterJetPawn()
     AircraftMesh->SetLinearDamping(0.1f);
 
     HealthComponent = CreateDefaultSubobject<UHealthComponent>(TEXT("HealthComponent"));
+    // A mission reset puts us back where we started rather than spawning a new jet
+    HealthComponent->bDestroyOwnerOnDeath = false;
+    TargetingComponent = CreateDefaultSubobject<UTargetingComponent>(TEXT("TargetingComponent"));
 
     MuzzleLocation = CreateDefaultSubobject<USceneComponent>(TEXT("MuzzleLocation"));
     MuzzleLocation->SetupAttachment(AircraftMesh);
@@ -65,6 +74,7 @@ AFighterJetPawn::AFighterJetPawn()
 
     LiftCoefficient = 0.1f;
     DragCoefficient = 0.005f;
+    AeroTable = nullptr;
 
     // --- Weapon Defaults ---
     WeaponRange = 50000.0f;
@@ -82,6 +92,16 @@ AFighterJetPawn::AFighterJetPawn()
     bIsFiring = false;
     LastFireTime = 0.0f;
     LockedTarget = nullptr;
+    FlightPhysics = nullptr;
+    AeroHandle = INDEX_NONE;
+    SpatialIndex = nullptr;
+    SpatialHandle = INDEX_NONE;
+    RadarSystem = nullptr;
+    Gunfire = nullptr;
+    Effects = nullptr;
+    ActorPool = nullptr;
+    MissilePoolPrewarm = 8;
+    Radar.Range = 1000000.0f;
 
     // --- Find the HUD Widget Blueprint ---
     static ConstructorHelpers::FClassFinder<UUserWidget> HUDWidgetFinder(TEXT("/Game/Blueprints/WBP_FighterHUD"));
@@ -105,6 +125,62 @@ void AFighterJetPawn::BeginPlay()
             HUDWidgetInstance->AddToViewport();
         }
     }
+
+    // --- Hand our physics body to the batched flight model ---
+    FlightPhysics = GetWorld()->GetSubsystem<UFlightPhysicsSubsystem>();
+    if (FlightPhysics)
+    {
+        AeroHandle = FlightPhysics->RegisterAircraft(this, AircraftMesh, MakeAirframe());
+    }
+
+    SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+    if (SpatialIndex)
+    {
+        SpatialHandle = SpatialIndex->RegisterAircraft(this, AircraftTeams::Player, AircraftMesh->Bounds.SphereRadius, AircraftMesh);
+        HealthComponent->RegisterWithLedger(SpatialHandle);
+
+        RadarSystem = GetWorld()->GetSubsystem<URadarSubsystem>();
+        if (RadarSystem)
+        {
+            RadarSystem->RegisterSensor(SpatialHandle, Radar, AircraftTeams::Hostile);
+        }
+        TargetingComponent->SetOwnerAircraft(SpatialHandle);
+    }
+
+    Gunfire = GetWorld()->GetSubsystem<UGunfireSubsystem>();
+    Effects = GetWorld()->GetSubsystem<UEffectsSubsystem>();
+
+    // Build the missiles for a salvo now rather than on the frame the trigger is pulled
+    ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+    if (ActorPool && MissileClass)
+    {
+        ActorPool->Prewarm(MissileClass, MissilePoolPrewarm);
+    }
+
+    // Targeting runs first so Tick and the weapons see this frame's result
+    AddTickPrerequisiteComponent(TargetingComponent);
+}
+
+void AFighterJetPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (FlightPhysics)
+    {
+        FlightPhysics->UnregisterAircraft(AeroHandle);
+        AeroHandle = INDEX_NONE;
+    }
+
+    if (RadarSystem)
+    {
+        RadarSystem->UnregisterSensor(SpatialHandle);
+    }
+
+    if (SpatialIndex)
+    {
+        SpatialIndex->UnregisterAircraft(SpatialHandle);
+        SpatialHandle = INDEX_NONE;
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -114,14 +190,16 @@ void AFighterJetPawn::Tick(float DeltaTime)
     CheckIfOnGround();
     ApplyAerodynamics(DeltaTime);
 
-    // --- Automatically update the locked target every frame ---
-    UpdateLockedTarget();
+    // --- Pick up this frame's lock (the component has already ticked) ---
+    const FTargetingResult& Targeting = TargetingComponent->GetResult();
+    LockedTarget = Targeting.bLocked ? Targeting.Target : nullptr;
 
     // --- Update HUD values every frame ---
-    if (AircraftMesh)
+    // Both come back from the physics thread, as of the latest physics step
+    if (FlightPhysics)
     {
-        Airspeed = AircraftMesh->GetPhysicsLinearVelocity().Size() * 0.036f;
-        Altitude = GetActorLocation().Z / 100.0f;
+        Airspeed = FlightPhysics->GetSpeed(AeroHandle) * 0.036f;
+        Altitude = FlightPhysics->GetAltitude(AeroHandle) / 100.0f;
     }
 
     if (bIsFiring && (GetWorld()->GetTimeSeconds() - LastFireTime) > FireRate)
@@ -192,49 +270,31 @@ void AFighterJetPawn::FireWeapon()
 {
     if (!AircraftMesh) return;
 
-    if (MuzzleFlashFX)
+    // Queued, so rapid fire coalesces into one flash and one sound per window
+    if (Effects)
     {
-        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MuzzleFlashFX, MuzzleLocation->GetComponentLocation(), MuzzleLocation->GetComponentRotation());
+        Effects->PlayEmitter(MuzzleFlashFX, MuzzleLocation->GetComponentLocation(), MuzzleLocation->GetComponentRotation(), this);
+        Effects->PlaySound(FireSound, GetActorLocation(), this);
     }
 
-    if (FireSound)
+    // Resolved later this frame together with every other gun
+    if (Gunfire)
     {
-        UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
-    }
-
-    FVector StartLocation = AircraftMesh->GetComponentLocation();
-    FVector ForwardVector = AircraftMesh->GetForwardVector();
-    FVector EndLocation = StartLocation + (ForwardVector * WeaponRange);
-
-    FHitResult HitResult;
-    FCollisionQueryParams CollisionParams;
-    CollisionParams.AddIgnoredActor(this);
-
-    bool bHit = GetWorld()->LineTraceSingleByChannel(
-        HitResult,
-        StartLocation,
-        EndLocation,
-        ECC_Visibility,
-        CollisionParams
-    );
-
-    if (bHit)
-    {
-        AActor* HitActor = HitResult.GetActor();
-        if (HitActor)
-        {
-            UHealthComponent* TargetHealthComponent = HitActor->FindComponentByClass<UHealthComponent>();
-            if (TargetHealthComponent)
-            {
-                TargetHealthComponent->TakeDamage(10.0f);
-            }
-        }
+        FGunShot Shot;
+        Shot.Origin = AircraftMesh->GetComponentLocation();
+        Shot.Direction = AircraftMesh->GetForwardVector();
+        Shot.Range = WeaponRange;
+        Shot.Damage = 10.0f;
+        Shot.Shooter = this;
+        Shot.ShooterHandle = SpatialHandle;
+        Gunfire->QueueShot(Shot);
     }
 }
 
 void AFighterJetPawn::FireMissile()
 {
-    if (!MissileClass || !LockedTarget)
+    const FTargetingResult& Targeting = TargetingComponent->GetResult();
+    if (!MissileClass || !Targeting.bLocked)
     {
         // Can't fire if we don't have a missile class or a locked target
         return;
@@ -243,54 +303,15 @@ void AFighterJetPawn::FireMissile()
     FVector SpawnLocation = MuzzleLocation->GetComponentLocation();
     FRotator SpawnRotation = GetActorRotation();
 
-    AMissile* SpawnedMissile = GetWorld()->SpawnActor<AMissile>(MissileClass, SpawnLocation, SpawnRotation);
+    // Reuses a parked missile when there is one instead of constructing a new actor
+    AMissile* SpawnedMissile = ActorPool
+        ? ActorPool->Acquire<AMissile>(MissileClass, FTransform(SpawnRotation, SpawnLocation), this, this)
+        : GetWorld()->SpawnActor<AMissile>(MissileClass, SpawnLocation, SpawnRotation);
     if (SpawnedMissile)
     {
         // Set the missile's target to our automatically locked target
-        SpawnedMissile->SetTarget(LockedTarget);
-    }
-}
-
-void AFighterJetPawn::UpdateLockedTarget()
-{
-    TArray<AActor*> FoundActors;
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AAIAircraftPawn::StaticClass(), FoundActors);
-
-    AActor* BestTarget = nullptr;
-    float BestTargetScore = -1.0f; // Use a score instead of just distance
-
-    for (AActor* Actor : FoundActors)
-    {
-        // Check if the actor pointer is valid. This is the correct way to ensure the actor exists.
-        if (!Actor)
-        {
-            continue;
-        }
-
-        // Calculate direction and distance to the potential target
-        FVector DirectionToTarget = (Actor->GetActorLocation() - GetActorLocation()).GetSafeNormal();
-        float DistanceToTarget = FVector::Dist(GetActorLocation(), Actor->GetActorLocation());
-
-        // Calculate the dot product to see how far in front of us the target is
-        // A value of 1 means it's directly in front, -1 is directly behind.
-        float DotProduct = FVector::DotProduct(GetActorForwardVector(), DirectionToTarget);
-
-        // We only consider targets that are in front of us (DotProduct > 0)
-        if (DotProduct > 0)
-        {
-            // Simple scoring: prioritize targets that are more directly in front of us
-            // and closer.
-            float Score = DotProduct / DistanceToTarget;
-
-            if (Score > BestTargetScore)
-            {
-                BestTargetScore = Score;
-                BestTarget = Actor;
-            }
-        }
+        SpawnedMissile->SetTarget(Targeting.Target, Targeting.TargetHandle);
     }
-
-    LockedTarget = BestTarget;
 }
 
 
@@ -310,53 +331,136 @@ void AFighterJetPawn::CheckIfOnGround()
         CollisionParams
     );
 
-    if (bHit && !bIsOnGround)
+    const double HeightAboveGround = bHit ? Start.Z - HitResult.ImpactPoint.Z : -1.0;
+    const FlightModel::FGroundContact Contact = FlightModel::EvaluateGroundContact(
+        HeightAboveGround, AircraftMesh->GetPhysicsLinearVelocity().Z, bIsOnGround);
+
+    if (Contact.bHardLanding)
     {
-        float ImpactSpeed = -AircraftMesh->GetPhysicsLinearVelocity().Z;
-        if (ImpactSpeed > 500.0f)
-        {
-            HealthComponent->TakeDamage(100.0f);
-        }
+        HealthComponent->TakeDamage(100.0f);
     }
 
-    bIsOnGround = bHit;
+    bIsOnGround = Contact.bOnGround;
 }
 
 
 void AFighterJetPawn::ApplyAerodynamics(float DeltaTime)
 {
-    if (!AircraftMesh) return;
-    FVector Velocity = AircraftMesh->GetPhysicsLinearVelocity();
-    FVector ThrustForce = AircraftMesh->GetForwardVector() * CurrentThrottle * MaxThrust;
-    AircraftMesh->AddForce(ThrustForce);
-    if (Airspeed > 0.01f)
-    {
-        FVector DragForce = -Velocity.GetSafeNormal() * Airspeed * Airspeed * DragCoefficient;
-        AircraftMesh->AddForce(DragForce);
-    }
-    if (!bIsOnGround)
+    if (!FlightPhysics) return;
+
+    // The subsystem sums thrust, lift, drag and control torques for every aircraft in one pass
+    // on the physics thread at the fixed physics rate, so here we only publish this frame's commands.
+    FlightPhysics->SetAirframe(AeroHandle, MakeAirframe());
+
+    FlightModel::FControls Controls;
+    Controls.Thrust = CurrentThrottle * MaxThrust;
+    Controls.PitchTorque = FMath::DegreesToRadians(PitchInput * PitchSpeed);
+    Controls.RollTorque = FMath::DegreesToRadians(RollInput * RollSpeed);
+    Controls.YawTorque = FMath::DegreesToRadians(bIsOnGround ? GroundSteerInput * GroundSteerSpeed : YawInput * YawSpeed);
+    Controls.Elevator = PitchInput;
+    Controls.bLiftEnabled = !bIsOnGround;
+    FlightPhysics->SetControls(AeroHandle, Controls);
+}
+
+FlightModel::FAirframe AFighterJetPawn::MakeAirframe() const
+{
+    // Coefficients are tuned against airspeed in km/h, and control torques are angular accelerations
+    FlightModel::FAirframe Airframe;
+    Airframe.SpeedScale = 0.036;
+    Airframe.LiftCoefficient = LiftCoefficient;
+    Airframe.DragCoefficient = DragCoefficient;
+    Airframe.bLiftAlongVelocityNormal = true;
+    Airframe.bTorqueAsAcceleration = true;
+
+    if (AeroTable)
     {
-        FVector LiftDirection = FVector::CrossProduct(Velocity.GetSafeNormal(), AircraftMesh->GetRightVector()).GetSafeNormal();
-        float LiftMagnitude = Airspeed * Airspeed * LiftCoefficient;
-        FVector LiftForce = LiftDirection * LiftMagnitude;
-        AircraftMesh->AddForce(LiftForce);
+        Airframe.AeroTable = AeroTable->GetBakedTable();
+        Airframe.TableForceScale = AeroTable->ForceScale;
+        Airframe.TableMomentScale = AeroTable->MomentScale;
+        Airframe.MaxElevatorDeflection = FMath::DegreesToRadians(AeroTable->MaxElevatorDeflectionDegrees);
     }
-    FVector RightVector = AircraftMesh->GetRightVector();
-    FVector UpVector = AircraftMesh->GetUpVector();
-    FVector ForwardVector = AircraftMesh->GetForwardVector();
-    AircraftMesh->AddTorqueInDegrees(RightVector * PitchInput * PitchSpeed, NAME_None, true);
-    AircraftMesh->AddTorqueInDegrees(ForwardVector * RollInput * RollSpeed, NAME_None, true);
-    if (bIsOnGround)
+
+    // Matches the body setup in the constructor, used when the model integrates itself
+    Airframe.Mass = 15000.0;
+    Airframe.LinearDamping = 0.1;
+    Airframe.AngularDamping = 0.5;
+    return Airframe;
+}
+
+void AFighterJetPawn::HandleDeath()
+{
+    // Soft reset in place instead of reloading the level
+    if (ADogfightGameModeBase* GameMode = GetWorld()->GetAuthGameMode<ADogfightGameModeBase>())
     {
-        AircraftMesh->AddTorqueInDegrees(UpVector * GroundSteerInput * GroundSteerSpeed, NAME_None, true);
+        GameMode->RestartMission();
     }
-    else
+}
+
+void AFighterJetPawn::ResetForMission()
+{
+    CurrentThrottle = 0.0f;
+    PitchInput = 0.0f;
+    RollInput = 0.0f;
+    YawInput = 0.0f;
+    GroundSteerInput = 0.0f;
+    bIsOnGround = false;
+    bIsFiring = false;
+    LastFireTime = 0.0f;
+    LockedTarget = nullptr;
+
+    // Death turned the body off
+    AircraftMesh->SetSimulatePhysics(true);
+}
+
+void AFighterJetPawn::ApplyPilotCommand(const FFighterPilotCommand& Command)
+{
+    CurrentThrottle = FMath::Clamp(Command.Throttle, 0.0f, 1.0f);
+    PitchInput = FMath::Clamp(Command.Pitch, -1.0f, 1.0f);
+    RollInput = FMath::Clamp(Command.Roll, -1.0f, 1.0f);
+    YawInput = FMath::Clamp(Command.Yaw, -1.0f, 1.0f);
+    GroundSteerInput = YawInput;
+    bIsFiring = Command.bFireGun;
+
+    if (Command.bFireMissile)
     {
-        AircraftMesh->AddTorqueInDegrees(UpVector * YawInput * YawSpeed, NAME_None, true);
+        FireMissile();
     }
 }
 
-void AFighterJetPawn::HandleDeath()
+void AFighterJetPawn::CaptureSnapshot(FlightModel::FAircraftSnapshot& OutSnapshot) const
+{
+    const FVector Velocity = AircraftMesh->GetPhysicsLinearVelocity();
+    const FVector AngularVelocity = AircraftMesh->GetPhysicsAngularVelocityInRadians();
+    OutSnapshot.LinearVelocity = FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z);
+    OutSnapshot.AngularVelocity = FlightModel::FVec3d(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z);
+
+    OutSnapshot.Throttle = CurrentThrottle;
+    OutSnapshot.Pitch = PitchInput;
+    OutSnapshot.Roll = RollInput;
+    OutSnapshot.Yaw = YawInput;
+    OutSnapshot.bFiring = bIsFiring;
+    OutSnapshot.TimeSinceFire = GetWorld()->GetTimeSeconds() - LastFireTime;
+
+    const FTargetingResult& Targeting = TargetingComponent->GetResult();
+    OutSnapshot.LockTarget = Targeting.Target ? Targeting.TargetHandle : INDEX_NONE;
+    OutSnapshot.LockProgress = Targeting.LockProgress;
+    OutSnapshot.bLocked = Targeting.bLocked;
+}
+
+void AFighterJetPawn::RestoreSnapshot(const FlightModel::FAircraftSnapshot& Snapshot)
 {
-    UGameplayStatics::OpenLevel(this, FName(*GetWorld()->GetName()), false);
+    AircraftMesh->SetPhysicsLinearVelocity(FVector(Snapshot.LinearVelocity.X, Snapshot.LinearVelocity.Y, Snapshot.LinearVelocity.Z));
+    AircraftMesh->SetPhysicsAngularVelocityInRadians(FVector(Snapshot.AngularVelocity.X, Snapshot.AngularVelocity.Y, Snapshot.AngularVelocity.Z));
+
+    CurrentThrottle = Snapshot.Throttle;
+    PitchInput = Snapshot.Pitch;
+    RollInput = Snapshot.Roll;
+    YawInput = Snapshot.Yaw;
+    bIsFiring = Snapshot.bFiring;
+    LastFireTime = GetWorld()->GetTimeSeconds() - Snapshot.TimeSinceFire;
+
+    // The handle may name a different aircraft by now, or none
+    AActor* Target = SpatialIndex && SpatialIndex->IsValidHandle(Snapshot.LockTarget) ? SpatialIndex->GetActor(Snapshot.LockTarget) : nullptr;
+    TargetingComponent->RestoreTarget(Target, Snapshot.LockTarget, Snapshot.LockProgress);
+    LockedTarget = TargetingComponent->GetResult().bLocked ? Target : nullptr;
 }
@@ -0,0 +1,80 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/AIPilot.h"
+
+namespace FlightModel
+{
+	namespace AIPilot
+	{
+		void Plan(const FAIPilotAgent& Agent, const FAIPilotFrame& Frame, FAIPilotPlan& InOutPlan)
+		{
+			if (!Agent.bHasContact)
+			{
+				// Keep chasing where the contact should be for a while, then give up on it
+				InOutPlan.bValid = InOutPlan.bValid && Frame.Time - InOutPlan.PlanTime <= Frame.ContactMemorySeconds;
+				return;
+			}
+
+			// Close in on the contact until inside the avoidance distance, then turn away from it
+			InOutPlan.TargetLocation = Agent.ContactLocation;
+			InOutPlan.TargetVelocity = Agent.ContactVelocity;
+			InOutPlan.PlanTime = Frame.Time;
+			InOutPlan.bAvoid = (Agent.ContactLocation - Agent.Location).SizeSquared() <= Agent.AvoidanceDistance * Agent.AvoidanceDistance;
+			InOutPlan.bValid = true;
+		}
+
+		void Steer(const FAIPilotAgent& Agent, const FAIPilotFrame& Frame, FAIPilotPlan& InOutPlan)
+		{
+			InOutPlan.ServiceTime = Frame.Time;
+			InOutPlan.bFire = false;
+
+			if (!InOutPlan.bValid)
+			{
+				// Searching: hold course, but head back towards the patrol area once outside it
+				const FVec3d ToCenter = Frame.PatrolCenter - Agent.Location;
+				InOutPlan.bSteer = Frame.PatrolRadius > 0.0 && ToCenter.SizeSquared() > Frame.PatrolRadius * Frame.PatrolRadius;
+				if (InOutPlan.bSteer)
+				{
+					InOutPlan.SteerRotation = FRotatord::FromDirection(ToCenter);
+				}
+				return;
+			}
+
+			// Where the planned target should be by now, assuming it held its course
+			const FVec3d PredictedTarget = InOutPlan.TargetLocation + InOutPlan.TargetVelocity * (Frame.Time - InOutPlan.PlanTime);
+			const FVec3d Heading = InOutPlan.bAvoid ? Agent.Location - PredictedTarget : PredictedTarget - Agent.Location;
+			InOutPlan.SteerRotation = FRotatord::FromDirection(Heading);
+			InOutPlan.bSteer = true;
+
+			// Fire along this frame's new heading once the gun has cycled and the contact is roughly ahead
+			if (!Agent.bEvading && Agent.bHasContact && Frame.Time - Agent.LastFireTime >= Agent.FireRate)
+			{
+				const FRotatord NewRotation = RInterpTo(Agent.Rotation, InOutPlan.SteerRotation, Frame.DeltaTime, Agent.TurnSpeed);
+				InOutPlan.bFire = FVec3d::Dot(NewRotation.Vector(), (Agent.ContactLocation - Agent.Location).GetSafeNormal()) > 0.9;
+			}
+		}
+
+		FAIPilotDecision Decide(const FAIPilotAgent& Agent, const FAIPilotPlan& Plan, const FAIPilotFrame& Frame)
+		{
+			FAIPilotDecision Decision;
+			Decision.Thrust = Agent.Rotation.Vector() * Agent.FlightSpeed;
+
+			if (Plan.bValid && Agent.bEvading)
+			{
+				// Evading: keep yawing in the aircraft's own frame
+				Decision.Rotation = FRotatord::FromQuat(Agent.Rotation.Quaternion() * FRotatord(0.0, Agent.EvasionTurnSpeed, 0.0).Quaternion());
+				Decision.bTurn = true;
+				return Decision;
+			}
+
+			if (Plan.bSteer)
+			{
+				Decision.Rotation = RInterpTo(Agent.Rotation, Plan.SteerRotation, Frame.DeltaTime, Agent.TurnSpeed);
+				Decision.bTurn = true;
+			}
+
+			Decision.bFire = Plan.bFire && Plan.ServiceTime == Frame.Time;
+			return Decision;
+		}
+	}
+}
@@ -0,0 +1,242 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/AeroTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace FlightModel
+{
+	namespace
+	{
+		constexpr double Pi = 3.14159265358979323846;
+		constexpr double DegToRad = Pi / 180.0;
+
+		// Bracket Value in an ascending axis: index of the lower sample and the blend towards the next
+		void FindBracket(const std::vector<double>& Axis, double Value, int& OutIndex, double& OutAlpha)
+		{
+			const int Last = static_cast<int>(Axis.size()) - 1;
+			if (Last <= 0 || Value <= Axis.front())
+			{
+				OutIndex = 0;
+				OutAlpha = 0.0;
+				return;
+			}
+			if (Value >= Axis.back())
+			{
+				OutIndex = Last - 1;
+				OutAlpha = 1.0;
+				return;
+			}
+
+			const int Upper = static_cast<int>(std::upper_bound(Axis.begin(), Axis.end(), Value) - Axis.begin());
+			OutIndex = Upper - 1;
+			OutAlpha = (Value - Axis[OutIndex]) / (Axis[Upper] - Axis[OutIndex]);
+		}
+
+		FAeroTablePoint Blend(const FAeroTablePoint& A, const FAeroTablePoint& B, double Alpha)
+		{
+			FAeroTablePoint Out;
+			Out.CL = A.CL + (B.CL - A.CL) * Alpha;
+			Out.CD = A.CD + (B.CD - A.CD) * Alpha;
+			Out.Cm = A.Cm + (B.Cm - A.Cm) * Alpha;
+			Out.CLPerDeflection = A.CLPerDeflection + (B.CLPerDeflection - A.CLPerDeflection) * Alpha;
+			Out.CDPerDeflectionSq = A.CDPerDeflectionSq + (B.CDPerDeflectionSq - A.CDPerDeflectionSq) * Alpha;
+			Out.CmPerDeflection = A.CmPerDeflection + (B.CmPerDeflection - A.CmPerDeflection) * Alpha;
+			return Out;
+		}
+
+		// Bilinear sample of the authored (possibly non-uniform) grid; only used while baking
+		FAeroTablePoint SampleSource(const FAeroTableSource& Source, double AngleOfAttack, double Mach)
+		{
+			const int NumAoA = static_cast<int>(Source.AngleOfAttack.size());
+			const int NumMach = static_cast<int>(Source.Mach.size());
+
+			int A, M;
+			double AlphaA, AlphaM;
+			FindBracket(Source.AngleOfAttack, AngleOfAttack, A, AlphaA);
+			FindBracket(Source.Mach, Mach, M, AlphaM);
+
+			const int A1 = std::min(A + 1, NumAoA - 1);
+			const int M1 = std::min(M + 1, NumMach - 1);
+
+			const FAeroTablePoint Low = Blend(Source.Points[M * NumAoA + A], Source.Points[M * NumAoA + A1], AlphaA);
+			const FAeroTablePoint High = Blend(Source.Points[M1 * NumAoA + A], Source.Points[M1 * NumAoA + A1], AlphaA);
+			return Blend(Low, High, AlphaM);
+		}
+
+		// Smallest gap between neighbouring samples, so the uniform grid keeps the authored detail
+		int ChooseSampleCount(const std::vector<double>& Axis, int MaxSamples)
+		{
+			if (Axis.size() < 2)
+			{
+				return 2;
+			}
+
+			const int Limit = std::max(2, MaxSamples);
+			double MinStep = Axis.back() - Axis.front();
+			for (size_t i = 1; i < Axis.size(); ++i)
+			{
+				MinStep = std::min(MinStep, Axis[i] - Axis[i - 1]);
+			}
+
+			// Bake rejects repeated samples, but never divide by a zero or NaN step
+			if (!(MinStep > 0.0))
+			{
+				return Limit;
+			}
+
+			// Clamped before the conversion, which is undefined for anything an int cannot hold
+			const double Wanted = std::ceil((Axis.back() - Axis.front()) / MinStep) + 1.0;
+			return static_cast<int>(std::clamp(Wanted, 2.0, static_cast<double>(Limit)));
+		}
+
+		// Finite, with no sample repeated or out of order
+		bool IsStrictlyAscending(const std::vector<double>& Axis)
+		{
+			return std::all_of(Axis.begin(), Axis.end(), [](double Value) { return std::isfinite(Value); })
+				&& std::adjacent_find(Axis.begin(), Axis.end(), std::greater_equal<>()) == Axis.end();
+		}
+
+		double SmoothStep(double Edge0, double Edge1, double X)
+		{
+			const double T = std::clamp((X - Edge0) / (Edge1 - Edge0), 0.0, 1.0);
+			return T * T * (3.0 - 2.0 * T);
+		}
+	}
+
+	bool FAeroTable::Bake(const FAeroTableSource& Source, int MaxAoASamples, int MaxMachSamples)
+	{
+		Nodes.clear();
+		NumAoA = NumMach = 0;
+
+		const size_t SourceAoA = Source.AngleOfAttack.size();
+		const size_t SourceMach = Source.Mach.size();
+		if (SourceAoA == 0 || SourceMach == 0 || Source.Points.size() != SourceAoA * SourceMach)
+		{
+			return false;
+		}
+		if (!IsStrictlyAscending(Source.AngleOfAttack) || !IsStrictlyAscending(Source.Mach))
+		{
+			return false;
+		}
+
+		NumAoA = ChooseSampleCount(Source.AngleOfAttack, MaxAoASamples);
+		NumMach = ChooseSampleCount(Source.Mach, MaxMachSamples);
+
+		// A single authored sample becomes a flat table over a tiny range
+		AoAMin = Source.AngleOfAttack.front();
+		const double AoARange = std::max(Source.AngleOfAttack.back() - AoAMin, 1.e-6);
+		MachMin = Source.Mach.front();
+		const double MachRange = std::max(Source.Mach.back() - MachMin, 1.e-6);
+
+		AoAInvStep = (NumAoA - 1) / AoARange;
+		MachInvStep = (NumMach - 1) / MachRange;
+
+		// Keep the upper neighbour of the last cell inside the table
+		AoAMaxIndex = (NumAoA - 1) - 1.e-6;
+		MachMaxIndex = (NumMach - 1) - 1.e-6;
+
+		Nodes.resize(static_cast<size_t>(NumAoA) * NumMach);
+		for (int M = 0; M < NumMach; ++M)
+		{
+			const double Mach = MachMin + MachRange * M / (NumMach - 1);
+			for (int A = 0; A < NumAoA; ++A)
+			{
+				const double AngleOfAttack = AoAMin + AoARange * A / (NumAoA - 1);
+				const FAeroTablePoint Point = SampleSource(Source, AngleOfAttack, Mach);
+
+				FNode& Node = Nodes[static_cast<size_t>(M) * NumAoA + A];
+				Node.CL = static_cast<float>(Point.CL);
+				Node.CD = static_cast<float>(Point.CD);
+				Node.Cm = static_cast<float>(Point.Cm);
+				Node.CLPerDeflection = static_cast<float>(Point.CLPerDeflection);
+				Node.CDPerDeflectionSq = static_cast<float>(Point.CDPerDeflectionSq);
+				Node.CmPerDeflection = static_cast<float>(Point.CmPerDeflection);
+				Node.Padding[0] = Node.Padding[1] = 0.0f;
+			}
+		}
+		return true;
+	}
+
+	FAeroCoefficients FAeroTable::Lookup(double AngleOfAttack, double Mach, double Deflection) const
+	{
+		// max(0, x) first also turns NaN into 0
+		const double FA = std::min(std::max(0.0, (AngleOfAttack - AoAMin) * AoAInvStep), AoAMaxIndex);
+		const double FM = std::min(std::max(0.0, (Mach - MachMin) * MachInvStep), MachMaxIndex);
+		const int IA = static_cast<int>(FA);
+		const int IM = static_cast<int>(FM);
+		const float TA = static_cast<float>(FA - IA);
+		const float TM = static_cast<float>(FM - IM);
+
+		const FNode* Row0 = &Nodes[static_cast<size_t>(IM) * NumAoA + IA];
+		const FNode* Row1 = Row0 + NumAoA;
+
+		const float W00 = (1.0f - TA) * (1.0f - TM);
+		const float W01 = TA * (1.0f - TM);
+		const float W10 = (1.0f - TA) * TM;
+		const float W11 = TA * TM;
+
+		const float CL = W00 * Row0[0].CL + W01 * Row0[1].CL + W10 * Row1[0].CL + W11 * Row1[1].CL;
+		const float CD = W00 * Row0[0].CD + W01 * Row0[1].CD + W10 * Row1[0].CD + W11 * Row1[1].CD;
+		const float Cm = W00 * Row0[0].Cm + W01 * Row0[1].Cm + W10 * Row1[0].Cm + W11 * Row1[1].Cm;
+		const float CLd = W00 * Row0[0].CLPerDeflection + W01 * Row0[1].CLPerDeflection + W10 * Row1[0].CLPerDeflection + W11 * Row1[1].CLPerDeflection;
+		const float CDd = W00 * Row0[0].CDPerDeflectionSq + W01 * Row0[1].CDPerDeflectionSq + W10 * Row1[0].CDPerDeflectionSq + W11 * Row1[1].CDPerDeflectionSq;
+		const float Cmd = W00 * Row0[0].CmPerDeflection + W01 * Row0[1].CmPerDeflection + W10 * Row1[0].CmPerDeflection + W11 * Row1[1].CmPerDeflection;
+
+		FAeroCoefficients Out;
+		Out.CL = CL + CLd * Deflection;
+		Out.CD = CD + CDd * Deflection * Deflection;
+		Out.Cm = Cm + Cmd * Deflection;
+		return Out;
+	}
+
+	FAeroTableSource MakeGenericFighterTable()
+	{
+		FAeroTableSource Source;
+		for (double Degrees = -30.0; Degrees <= 60.0 + 1.e-9; Degrees += 2.5)
+		{
+			Source.AngleOfAttack.push_back(Degrees * DegToRad);
+		}
+		Source.Mach = { 0.0, 0.4, 0.6, 0.8, 0.85, 0.9, 0.95, 1.0, 1.05, 1.1, 1.2, 1.4, 1.6, 2.0 };
+
+		const double LiftSlope = 4.5;				// per radian, incompressible
+		const double StallAngle = 15.0 * DegToRad;
+
+		for (double Mach : Source.Mach)
+		{
+			// Prandtl-Glauert up to 0.85, then the lift slope falls off through the transonic range
+			const double Compressibility = Mach <= 0.85
+				? 1.0 / std::sqrt(1.0 - Mach * Mach)
+				: (Mach <= 1.2 ? 1.898 + (1.0 - 1.898) * (Mach - 0.85) / 0.35 : 1.2 / Mach);
+			const double CD0 = 0.018 + 0.035 * SmoothStep(0.85, 1.05, Mach) - 0.01 * SmoothStep(1.2, 2.0, Mach);
+			const double ElevatorEffectiveness = Mach > 1.0 ? 0.6 : 1.0;
+
+			for (double AngleOfAttack : Source.AngleOfAttack)
+			{
+				const double Slope = LiftSlope * Compressibility;
+				const double AbsAoA = std::fabs(AngleOfAttack);
+				double CL = Slope * AngleOfAttack;
+				if (AbsAoA > StallAngle)
+				{
+					// Past the stall lift drops to roughly half of CLmax
+					const double CLMax = Slope * StallAngle;
+					CL = std::copysign(CLMax * (0.55 + 0.45 * std::exp(-(AbsAoA - StallAngle) / (5.0 * DegToRad))), AngleOfAttack);
+				}
+
+				const double SinAoA = std::sin(AngleOfAttack);
+
+				FAeroTablePoint Point;
+				Point.CL = CL;
+				Point.CD = CD0 + 0.12 * CL * CL + 0.8 * SinAoA * SinAoA;
+				Point.Cm = -0.6 * AngleOfAttack;
+				Point.CLPerDeflection = 0.5;
+				Point.CDPerDeflectionSq = 0.08;
+				Point.CmPerDeflection = -1.1 * ElevatorEffectiveness;
+				Source.Points.push_back(Point);
+			}
+		}
+		return Source;
+	}
+}
@@ -0,0 +1,254 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/Ballistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace FlightModel
+{
+	void FBallisticPool::Initialize(int InCapacity)
+	{
+		Capacity = std::max(InCapacity, 0);
+		NumLive = 0;
+		NumExpired = 0;
+
+		for (std::vector<float>* Stream : { &PositionX, &PositionY, &PositionZ, &VelocityX, &VelocityY, &VelocityZ, &Age, &Lifetime,
+			&TerrainTime, &Damage, &SegmentX, &SegmentY, &SegmentZ, &InvSegmentLengthSq, &HitFraction })
+		{
+			Stream->assign(Capacity, 0.0f);
+		}
+		Owner.assign(Capacity, -1);
+		IndexToId.assign(Capacity, -1);
+		HitSphere.assign(Capacity, -1);
+
+		IdToIndex.assign(Capacity, -1);
+		Generations.assign(Capacity, 0);
+		FreeIds.resize(Capacity);
+		for (int i = 0; i < Capacity; ++i)
+		{
+			// Popped from the back, so low ids go first
+			FreeIds[i] = Capacity - 1 - i;
+		}
+	}
+
+	void FBallisticPool::Clear()
+	{
+		while (NumLive > 0)
+		{
+			Retire(NumLive - 1);
+		}
+		NumExpired = 0;
+	}
+
+	int FBallisticPool::Spawn(const FVec3d& Origin, const FVec3d& Velocity, float InDamage, float InLifetime, int InOwner)
+	{
+		if (FreeIds.empty())
+		{
+			return -1;
+		}
+
+		const int Id = FreeIds.back();
+		FreeIds.pop_back();
+
+		const int Index = NumLive++;
+		PositionX[Index] = static_cast<float>(Origin.X);
+		PositionY[Index] = static_cast<float>(Origin.Y);
+		PositionZ[Index] = static_cast<float>(Origin.Z);
+		VelocityX[Index] = static_cast<float>(Velocity.X);
+		VelocityY[Index] = static_cast<float>(Velocity.Y);
+		VelocityZ[Index] = static_cast<float>(Velocity.Z);
+		Age[Index] = 0.0f;
+		Lifetime[Index] = InLifetime;
+		TerrainTime[Index] = std::numeric_limits<float>::infinity();
+		Damage[Index] = InDamage;
+		Owner[Index] = InOwner;
+		IndexToId[Index] = Id;
+		IdToIndex[Id] = Index;
+		return Id;
+	}
+
+	void FBallisticPool::SetTerrainTime(int Id, uint16_t Generation, float Time)
+	{
+		if (Id < 0 || Id >= Capacity || Generations[Id] != Generation || IdToIndex[Id] < 0)
+		{
+			return;
+		}
+
+		float& Current = TerrainTime[IdToIndex[Id]];
+		Current = std::min(Current, Time);
+	}
+
+	FVec3d FBallisticPool::GetPosition(int Id) const
+	{
+		const int Index = IdToIndex[Id];
+		return Index < 0 ? FVec3d() : FVec3d(PositionX[Index], PositionY[Index], PositionZ[Index]);
+	}
+
+	void FBallisticPool::Retire(int Index)
+	{
+		const int Id = IndexToId[Index];
+		IdToIndex[Id] = -1;
+		++Generations[Id];
+		FreeIds.push_back(Id);
+
+		const int Last = --NumLive;
+		if (Index != Last)
+		{
+			PositionX[Index] = PositionX[Last];
+			PositionY[Index] = PositionY[Last];
+			PositionZ[Index] = PositionZ[Last];
+			VelocityX[Index] = VelocityX[Last];
+			VelocityY[Index] = VelocityY[Last];
+			VelocityZ[Index] = VelocityZ[Last];
+			Age[Index] = Age[Last];
+			Lifetime[Index] = Lifetime[Last];
+			TerrainTime[Index] = TerrainTime[Last];
+			Damage[Index] = Damage[Last];
+			Owner[Index] = Owner[Last];
+			IndexToId[Index] = IndexToId[Last];
+			IdToIndex[IndexToId[Index]] = Index;
+		}
+	}
+
+	void FBallisticPool::Step(double DeltaTime, const FVec3d& Gravity, const FSphereSet& Spheres, const int* SphereOwners,
+		std::vector<FBallisticImpact>& OutImpacts)
+	{
+		NumExpired = 0;
+		const int Count = NumLive;
+		if (Count == 0 || DeltaTime <= 0.0)
+		{
+			return;
+		}
+
+		float* Px = PositionX.data();
+		float* Py = PositionY.data();
+		float* Pz = PositionZ.data();
+		float* Vx = VelocityX.data();
+		float* Vy = VelocityY.data();
+		float* Vz = VelocityZ.data();
+		float* Sx = SegmentX.data();
+		float* Sy = SegmentY.data();
+		float* Sz = SegmentZ.data();
+		float* InvLengthSq = InvSegmentLengthSq.data();
+		float* BestFraction = HitFraction.data();
+		int* BestSphere = HitSphere.data();
+		const int* RoundOwner = Owner.data();
+
+		// Constant gravity, so the step is exact: the segment is the chord of this step's arc
+		const float Dt = static_cast<float>(DeltaTime);
+		const float Gx = static_cast<float>(Gravity.X);
+		const float Gy = static_cast<float>(Gravity.Y);
+		const float Gz = static_cast<float>(Gravity.Z);
+		const float HalfDtSq = 0.5f * Dt * Dt;
+		float MaxSegmentLengthSq = 0.0f;
+		for (int i = 0; i < Count; ++i)
+		{
+			Sx[i] = Vx[i] * Dt + Gx * HalfDtSq;
+			Sy[i] = Vy[i] * Dt + Gy * HalfDtSq;
+			Sz[i] = Vz[i] * Dt + Gz * HalfDtSq;
+			Vx[i] += Gx * Dt;
+			Vy[i] += Gy * Dt;
+			Vz[i] += Gz * Dt;
+
+			const float LengthSq = Sx[i] * Sx[i] + Sy[i] * Sy[i] + Sz[i] * Sz[i];
+			InvLengthSq[i] = LengthSq > 0.0f ? 1.0f / LengthSq : 0.0f;
+			MaxSegmentLengthSq = std::max(MaxSegmentLengthSq, LengthSq);
+			BestFraction[i] = 2.0f;
+			BestSphere[i] = -1;
+		}
+
+		float MaxRadius = 0.0f;
+		for (int s = 0; s < Spheres.Num(); ++s)
+		{
+			MaxRadius = std::max(MaxRadius, Spheres.Radius[s]);
+		}
+		SphereGrid.Build(Spheres.X.data(), Spheres.Y.data(), Spheres.Z.data(), Spheres.Num(), MaxRadius + std::sqrt(MaxSegmentLengthSq) * 0.5f);
+
+		// Closest approach of each segment to the centre of every sphere filed under the
+		// segment's midpoint cell, clamped to the segment. Swept, so nothing tunnels however fast.
+		for (int i = 0; i < Count; ++i)
+		{
+			int NumCandidates = 0;
+			const int* Candidates = SphereGrid.Find(Px[i] + 0.5f * Sx[i], Py[i] + 0.5f * Sy[i], Pz[i] + 0.5f * Sz[i], NumCandidates);
+			for (int Entry = 0; Entry < NumCandidates; ++Entry)
+			{
+				const int s = Candidates[Entry];
+				if (SphereOwners && SphereOwners[s] == RoundOwner[i])
+				{
+					continue;
+				}
+
+				const float Dx = Spheres.X[s] - Px[i];
+				const float Dy = Spheres.Y[s] - Py[i];
+				const float Dz = Spheres.Z[s] - Pz[i];
+				float T = (Dx * Sx[i] + Dy * Sy[i] + Dz * Sz[i]) * InvLengthSq[i];
+				T = std::min(std::max(T, 0.0f), 1.0f);
+				const float Qx = Dx - Sx[i] * T;
+				const float Qy = Dy - Sy[i] * T;
+				const float Qz = Dz - Sz[i] * T;
+				if (Qx * Qx + Qy * Qy + Qz * Qz <= Spheres.Radius[s] * Spheres.Radius[s] && T < BestFraction[i])
+				{
+					BestFraction[i] = T;
+					BestSphere[i] = s;
+				}
+			}
+		}
+
+		// Backwards, so retiring (which moves the last round into the hole) only touches finished rounds
+		for (int i = Count - 1; i >= 0; --i)
+		{
+			Age[i] += Dt;
+
+			const FVec3d Start(Px[i], Py[i], Pz[i]);
+			const FVec3d Segment(Sx[i], Sy[i], Sz[i]);
+			const bool bTerrain = TerrainTime[i] <= Age[i];
+			const double TerrainFraction = bTerrain ? std::max(0.0, 1.0 - double(Age[i] - TerrainTime[i]) / DeltaTime) : 2.0;
+
+			double SphereFraction = 2.0;
+			if (BestSphere[i] >= 0)
+			{
+				// Where the segment enters the sphere; 0 if it starts inside
+				const int s = BestSphere[i];
+				const FVec3d ToStart = Start - FVec3d(Spheres.X[s], Spheres.Y[s], Spheres.Z[s]);
+				const double A = Segment.SizeSquared();
+				const double B = FVec3d::Dot(ToStart, Segment);
+				const double C = ToStart.SizeSquared() - double(Spheres.Radius[s]) * Spheres.Radius[s];
+				const double Disc = B * B - A * C;
+				SphereFraction = C <= 0.0 || A <= 0.0 ? 0.0 : (Disc > 0.0 ? std::max(0.0, (-B - std::sqrt(Disc)) / A) : BestFraction[i]);
+			}
+
+			if (SphereFraction <= 1.0 && SphereFraction <= TerrainFraction)
+			{
+				FBallisticImpact& Impact = OutImpacts.emplace_back();
+				Impact.Type = EBallisticImpact::Sphere;
+				Impact.Sphere = BestSphere[i];
+				Impact.Owner = RoundOwner[i];
+				Impact.Damage = Damage[i];
+				Impact.Location = Start + Segment * SphereFraction;
+			}
+			else if (bTerrain)
+			{
+				FBallisticImpact& Impact = OutImpacts.emplace_back();
+				Impact.Type = EBallisticImpact::Terrain;
+				Impact.Owner = RoundOwner[i];
+				Impact.Damage = Damage[i];
+				Impact.Location = Start + Segment * std::min(TerrainFraction, 1.0);
+			}
+			else if (Age[i] >= Lifetime[i])
+			{
+				++NumExpired;
+			}
+			else
+			{
+				Px[i] += Sx[i];
+				Py[i] += Sy[i];
+				Pz[i] += Sz[i];
+				continue;
+			}
+
+			Retire(i);
+		}
+	}
+}
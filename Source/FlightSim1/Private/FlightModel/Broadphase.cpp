@@ -0,0 +1,228 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/Broadphase.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace FlightModel
+{
+	void FSphereSet::Reset()
+	{
+		X.clear();
+		Y.clear();
+		Z.clear();
+		Radius.clear();
+	}
+
+	void FSphereSet::Reserve(int Num)
+	{
+		X.reserve(Num);
+		Y.reserve(Num);
+		Z.reserve(Num);
+		Radius.reserve(Num);
+	}
+
+	void FSphereSet::Add(const FVec3d& Center, double InRadius)
+	{
+		X.push_back(static_cast<float>(Center.X));
+		Y.push_back(static_cast<float>(Center.Y));
+		Z.push_back(static_cast<float>(Center.Z));
+		Radius.push_back(static_cast<float>(InRadius));
+	}
+
+	void FRayBroadphase::Intersect(const FSphereSet& Spheres, const FRay* Rays, int NumRays, FRayHit* OutHits)
+	{
+		const int NumSpheres = Spheres.Num();
+		Discriminants.resize(NumSpheres);
+
+		const float* SphereX = Spheres.X.data();
+		const float* SphereY = Spheres.Y.data();
+		const float* SphereZ = Spheres.Z.data();
+		const float* SphereRadius = Spheres.Radius.data();
+		float* Disc = Discriminants.data();
+
+		for (int RayIndex = 0; RayIndex < NumRays; ++RayIndex)
+		{
+			const FRay& Ray = Rays[RayIndex];
+			const float Ox = static_cast<float>(Ray.Origin.X);
+			const float Oy = static_cast<float>(Ray.Origin.Y);
+			const float Oz = static_cast<float>(Ray.Origin.Z);
+			const float Dx = static_cast<float>(Ray.Direction.X);
+			const float Dy = static_cast<float>(Ray.Direction.Y);
+			const float Dz = static_cast<float>(Ray.Direction.Z);
+			const float Length = static_cast<float>(Ray.Length);
+
+			// With b = dot(D, C - O) the ray is inside the sphere over b -/+ sqrt(disc), where
+			// disc = r^2 - (distance from the centre to the ray)^2. That distance is taken from the
+			// perpendicular offset rather than as b^2 - |C - O|^2 + r^2, which loses everything to
+			// cancellation in float at combat ranges. The span overlaps [0, Length] iff disc >= 0,
+			// the exit is ahead (b >= 0 or the origin is inside) and the entry is not beyond Length
+			// (b <= Length or (b - Length)^2 <= disc). No square roots here.
+			for (int i = 0; i < NumSpheres; ++i)
+			{
+				const float Cx = SphereX[i] - Ox;
+				const float Cy = SphereY[i] - Oy;
+				const float Cz = SphereZ[i] - Oz;
+				const float B = Cx * Dx + Cy * Dy + Cz * Dz;
+				const float Px = Cx - B * Dx;
+				const float Py = Cy - B * Dy;
+				const float Pz = Cz - B * Dz;
+				const float RadiusSq = SphereRadius[i] * SphereRadius[i];
+				const float D = RadiusSq - (Px * Px + Py * Py + Pz * Pz);
+				const float C = Cx * Cx + Cy * Cy + Cz * Cz - RadiusSq;
+				const float BeyondEnd = B - Length;
+
+				const bool bHit = (D >= 0.0f) & ((B >= 0.0f) | (C <= 0.0f)) & ((BeyondEnd <= 0.0f) | (BeyondEnd * BeyondEnd <= D));
+				Disc[i] = bHit ? D : -1.0f;
+			}
+
+			// Only the spheres actually touched need the entry distance
+			FRayHit Hit;
+			float BestEntry = Length;
+			for (int i = 0; i < NumSpheres; ++i)
+			{
+				if (Disc[i] < 0.0f || i == Ray.IgnoreIndex)
+				{
+					continue;
+				}
+
+				const float B = (SphereX[i] - Ox) * Dx + (SphereY[i] - Oy) * Dy + (SphereZ[i] - Oz) * Dz;
+				const float Root = std::sqrt(Disc[i]);
+				const float Entry = std::max(B - Root, 0.0f);
+				if (Hit.Index < 0 || Entry < BestEntry)
+				{
+					BestEntry = Entry;
+					Hit.Index = i;
+					Hit.EntryDistance = Entry;
+					Hit.ExitDistance = B + Root;
+				}
+			}
+
+			OutHits[RayIndex] = Hit;
+		}
+	}
+
+	namespace
+	{
+		constexpr int64_t EmptyCell = std::numeric_limits<int64_t>::min();
+
+		// 21 bits per axis; coordinates far enough apart to wrap just share a cell, which only adds candidates
+		int64_t PackCell(int64_t X, int64_t Y, int64_t Z)
+		{
+			return ((X & 0x1FFFFF) << 42) | ((Y & 0x1FFFFF) << 21) | (Z & 0x1FFFFF);
+		}
+
+		uint32_t HashCell(int64_t Key)
+		{
+			return static_cast<uint32_t>((static_cast<uint64_t>(Key) * 0x9E3779B97F4A7C15ull) >> 32);
+		}
+	}
+
+	void FSphereGrid::Build(const float* X, const float* Y, const float* Z, int Num, float Reach)
+	{
+		CellSize = std::max(2.0f * Reach, 1.0f);
+		const float InvCellSize = 1.0f / CellSize;
+
+		int TableSize = 16;
+		while (TableSize < Num * 16)
+		{
+			TableSize *= 2;
+		}
+		CellKeys.assign(TableSize, EmptyCell);
+		CellStart.assign(TableSize, 0);
+		CellCount.assign(TableSize, 0);
+
+		// Two passes over the same cells: count, then fill the packed sphere lists
+		for (int Pass = 0; Pass < 2; ++Pass)
+		{
+			for (int s = 0; s < Num; ++s)
+			{
+				const int64_t MinCellX = static_cast<int64_t>(std::floor((X[s] - Reach) * InvCellSize));
+				const int64_t MinCellY = static_cast<int64_t>(std::floor((Y[s] - Reach) * InvCellSize));
+				const int64_t MinCellZ = static_cast<int64_t>(std::floor((Z[s] - Reach) * InvCellSize));
+				const int64_t MaxCellX = static_cast<int64_t>(std::floor((X[s] + Reach) * InvCellSize));
+				const int64_t MaxCellY = static_cast<int64_t>(std::floor((Y[s] + Reach) * InvCellSize));
+				const int64_t MaxCellZ = static_cast<int64_t>(std::floor((Z[s] + Reach) * InvCellSize));
+				for (int64_t CellX = MinCellX; CellX <= MaxCellX; ++CellX)
+				{
+					for (int64_t CellY = MinCellY; CellY <= MaxCellY; ++CellY)
+					{
+						for (int64_t CellZ = MinCellZ; CellZ <= MaxCellZ; ++CellZ)
+						{
+							const int64_t Key = PackCell(CellX, CellY, CellZ);
+							uint32_t Slot = HashCell(Key) & (TableSize - 1);
+							while (CellKeys[Slot] != EmptyCell && CellKeys[Slot] != Key)
+							{
+								Slot = (Slot + 1) & (TableSize - 1);
+							}
+							CellKeys[Slot] = Key;
+
+							if (Pass == 0)
+							{
+								++CellCount[Slot];
+							}
+							else
+							{
+								CellSpheres[CellStart[Slot] + CellCount[Slot]++] = s;
+							}
+						}
+					}
+				}
+			}
+
+			if (Pass == 0)
+			{
+				int Total = 0;
+				for (int Slot = 0; Slot < TableSize; ++Slot)
+				{
+					CellStart[Slot] = Total;
+					Total += CellCount[Slot];
+					CellCount[Slot] = 0;
+				}
+				CellSpheres.resize(Total);
+			}
+		}
+	}
+
+	const int* FSphereGrid::Find(float X, float Y, float Z, int& OutNum) const
+	{
+		OutNum = 0;
+		if (CellKeys.empty())
+		{
+			return nullptr;
+		}
+
+		const float InvCellSize = 1.0f / CellSize;
+		const int64_t Key = PackCell(static_cast<int64_t>(std::floor(X * InvCellSize)),
+			static_cast<int64_t>(std::floor(Y * InvCellSize)), static_cast<int64_t>(std::floor(Z * InvCellSize)));
+
+		const uint32_t Mask = static_cast<uint32_t>(CellKeys.size()) - 1;
+		for (uint32_t Slot = HashCell(Key) & Mask; CellKeys[Slot] != EmptyCell; Slot = (Slot + 1) & Mask)
+		{
+			if (CellKeys[Slot] == Key)
+			{
+				OutNum = CellCount[Slot];
+				return CellSpheres.data() + CellStart[Slot];
+			}
+		}
+		return nullptr;
+	}
+
+	bool IntersectRaySphere(const FRay& Ray, const FVec3d& Center, double Radius, double& OutEntry, double& OutExit)
+	{
+		const FVec3d ToCenter = Center - Ray.Origin;
+		const double B = FVec3d::Dot(Ray.Direction, ToCenter);
+		const double D = Radius * Radius - (ToCenter - Ray.Direction * B).SizeSquared();
+		if (D < 0.0)
+		{
+			return false;
+		}
+
+		const double Root = std::sqrt(D);
+		OutEntry = std::max(B - Root, 0.0);
+		OutExit = B + Root;
+		return OutExit >= 0.0 && B - Root <= Ray.Length;
+	}
+}
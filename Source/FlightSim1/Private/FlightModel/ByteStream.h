@@ -0,0 +1,123 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Byte-level helpers shared by the snapshot codec and the flight recorder's file
+// format: fixed-step quantization, zigzag varints and little-endian fixed-width
+// integers, and a bounds-checked reader over a borrowed buffer.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FlightModel
+{
+	// Keeps garbage input from overflowing differences; about 600 km in 1/64 cm steps
+	constexpr double MaxSteps = 4.0e15;
+
+	inline int64_t ToSteps(double Value, double Scale)
+	{
+		const double Scaled = Value * Scale;
+		if (std::isnan(Scaled))
+		{
+			return 0;
+		}
+		return std::llround(std::clamp(Scaled, -MaxSteps, MaxSteps));
+	}
+
+	inline double FromSteps(int64_t Steps, double Scale)
+	{
+		return static_cast<double>(Steps) / Scale;
+	}
+
+	inline float FromStepsF(int64_t Steps, double Scale)
+	{
+		return static_cast<float>(FromSteps(Steps, Scale));
+	}
+
+	inline uint64_t ZigZag(int64_t Value)
+	{
+		return (static_cast<uint64_t>(Value) << 1) ^ static_cast<uint64_t>(Value >> 63);
+	}
+
+	inline int64_t UnZigZag(uint64_t Value)
+	{
+		return static_cast<int64_t>(Value >> 1) ^ -static_cast<int64_t>(Value & 1);
+	}
+
+	inline void WriteVarint(std::vector<uint8_t>& Out, uint64_t Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.push_back(static_cast<uint8_t>(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.push_back(static_cast<uint8_t>(Value));
+	}
+
+	// Little-endian whatever the host
+	inline void WriteFixed(std::vector<uint8_t>& Out, uint64_t Value, int NumBytes)
+	{
+		for (int i = 0; i < NumBytes; ++i)
+		{
+			Out.push_back(static_cast<uint8_t>(Value >> (8 * i)));
+		}
+	}
+
+	// Overwrites bytes already written, e.g. a size known only once what follows it is done
+	inline void PatchFixed(std::vector<uint8_t>& Out, size_t Offset, uint64_t Value, int NumBytes)
+	{
+		for (int i = 0; i < NumBytes; ++i)
+		{
+			Out[Offset + i] = static_cast<uint8_t>(Value >> (8 * i));
+		}
+	}
+
+	// Reads fail softly: past the end every value is 0 and bOk goes false, checked once per section
+	struct FByteReader
+	{
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+		size_t Offset = 0;
+		bool bOk = true;
+
+		uint64_t ReadFixed(int NumBytes)
+		{
+			if (Size - Offset < size_t(NumBytes))
+			{
+				bOk = false;
+				Offset = Size;
+				return 0;
+			}
+			uint64_t Value = 0;
+			for (int i = 0; i < NumBytes; ++i)
+			{
+				Value |= uint64_t(Data[Offset++]) << (8 * i);
+			}
+			return Value;
+		}
+
+		uint64_t ReadVarint()
+		{
+			uint64_t Value = 0;
+			for (int Shift = 0; Shift < 64; Shift += 7)
+			{
+				if (Offset >= Size)
+				{
+					bOk = false;
+					return 0;
+				}
+				const uint8_t Byte = Data[Offset++];
+				Value |= uint64_t(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return Value;
+				}
+			}
+			bOk = false;
+			return 0;
+		}
+	};
+}
@@ -0,0 +1,635 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/DogfightEnv.h"
+#include "FlightModel/Broadphase.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace FlightModel
+{
+	namespace
+	{
+		constexpr double Pi = 3.14159265358979323846;
+		constexpr double DegToRad = Pi / 180.0;
+		constexpr double RadToDeg = 180.0 / Pi;
+
+		// Observation scales: positions in km, velocities in 100 m/s
+		constexpr double PositionScale = 1.0e-5;
+		constexpr double VelocityScale = 1.0e-4;
+
+		// splitmix64: one word of state per engagement, and a good stream from any seed
+		uint64_t NextRandom(uint64_t& State)
+		{
+			uint64_t Z = (State += 0x9E3779B97F4A7C15ull);
+			Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+			return Z ^ (Z >> 31);
+		}
+
+		// Uniform in [0, 1)
+		double RandomUnit(uint64_t& State)
+		{
+			return static_cast<double>(NextRandom(State) >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		// UTargetingComponent::ScoreOf: nearer and more central scores higher, -1 outside the radar
+		double LockScore(const FVec3d& Origin, const FVec3d& Forward, const FVec3d& Target, double Range, double MinCosAngle)
+		{
+			const FVec3d ToTarget = Target - Origin;
+			const double Distance = ToTarget.Size();
+			if (Distance < 1.e-4 || Distance > Range)
+			{
+				return -1.0;
+			}
+
+			const double CosAngle = FVec3d::Dot(Forward, ToTarget) / Distance;
+			if (CosAngle <= 0.0 || CosAngle < MinCosAngle)
+			{
+				return -1.0;
+			}
+			return CosAngle / Distance;
+		}
+	}
+
+	FDogfightJetParams::FDogfightJetParams()
+	{
+		Airframe.SpeedScale = 0.036;
+		Airframe.LiftCoefficient = 0.1;
+		Airframe.DragCoefficient = 0.005;
+		Airframe.bLiftAlongVelocityNormal = true;
+		Airframe.bTorqueAsAcceleration = true;
+		Airframe.Mass = 15000.0;
+		Airframe.LinearDamping = 0.1;
+		Airframe.AngularDamping = 0.5;
+	}
+
+	FDogfightAIParams::FDogfightAIParams()
+	{
+		// The pawn's mass comes from its mesh; at 1 kg FlightSpeed is the acceleration, and the AI
+		// reaches MaxSpeed in a couple of seconds
+		Body.Mass = 1.0;
+		Body.MaxSpeed = 10000.0;
+	}
+
+	FDogfightEnv::FDogfightEnv(const FDogfightEnvConfig& InConfig)
+		: Config(InConfig)
+	{
+		Config.NumEnvs = std::max(Config.NumEnvs, 1);
+		Config.NumEnemies = std::max(Config.NumEnemies, 1);
+		Config.NumThreads = std::clamp(Config.NumThreads, 1, Config.NumEnvs);
+		Config.ActionRepeat = std::max(Config.ActionRepeat, 1);
+		Config.Jet.MaxMissilesInFlight = std::max(Config.Jet.MaxMissilesInFlight, 0);
+
+		ObservationSize = DogfightObservation::NumAgent + Config.NumEnemies * DogfightObservation::NumPerEnemy;
+
+		const size_t NumEnvs = static_cast<size_t>(Config.NumEnvs);
+		Engagements.resize(NumEnvs);
+		Enemies.resize(NumEnvs * Config.NumEnemies);
+		for (FEngagement& Engagement : Engagements)
+		{
+			Engagement.Missiles.Reserve(Config.Jet.MaxMissilesInFlight);
+			Engagement.MissileTargets.reserve(Config.Jet.MaxMissilesInFlight);
+			Engagement.MissileEvents.reserve(Config.Jet.MaxMissilesInFlight);
+		}
+
+		Actions.assign(NumEnvs * DogfightAction::Num, 0.0f);
+		Observations.assign(NumEnvs * ObservationSize, 0.0f);
+		FinalObservations.assign(NumEnvs * ObservationSize, 0.0f);
+		Rewards.assign(NumEnvs, 0.0f);
+		Terminated.assign(NumEnvs, 0);
+		Truncated.assign(NumEnvs, 0);
+		Outcomes.assign(NumEnvs, static_cast<uint8_t>(EDogfightOutcome::None));
+		EpisodeReturns.assign(NumEnvs, 0.0f);
+		EpisodeLengths.assign(NumEnvs, 0);
+
+		Workers.reserve(Config.NumThreads - 1);
+		for (int Worker = 1; Worker < Config.NumThreads; ++Worker)
+		{
+			Workers.emplace_back(&FDogfightEnv::WorkerLoop, this, Worker);
+		}
+
+		Reset(0);
+	}
+
+	FDogfightEnv::~FDogfightEnv()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(WorkMutex);
+			bStopping = true;
+		}
+		WorkReady.notify_all();
+		for (std::thread& Worker : Workers)
+		{
+			Worker.join();
+		}
+	}
+
+	void FDogfightEnv::Reset(uint64_t Seed)
+	{
+		for (int Env = 0; Env < Config.NumEnvs; ++Env)
+		{
+			// Mixed once, so neighbouring seeds and neighbouring engagements start far apart in the stream
+			uint64_t Mix = Seed ^ (static_cast<uint64_t>(Env) * 0xD1B54A32D192ED03ull);
+			Engagements[Env].Random = NextRandom(Mix);
+
+			ResetEngagement(Env);
+			WriteObservation(Env, &Observations[static_cast<size_t>(Env) * ObservationSize]);
+		}
+
+		std::fill(Rewards.begin(), Rewards.end(), 0.0f);
+		std::fill(Terminated.begin(), Terminated.end(), uint8_t(0));
+		std::fill(Truncated.begin(), Truncated.end(), uint8_t(0));
+		std::fill(Outcomes.begin(), Outcomes.end(), static_cast<uint8_t>(EDogfightOutcome::None));
+		std::fill(EpisodeReturns.begin(), EpisodeReturns.end(), 0.0f);
+		std::fill(EpisodeLengths.begin(), EpisodeLengths.end(), 0);
+	}
+
+	void FDogfightEnv::Step()
+	{
+		if (Workers.empty())
+		{
+			StepSlice(0);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(WorkMutex);
+			++WorkGeneration;
+			WorkPending = static_cast<int>(Workers.size());
+		}
+		WorkReady.notify_all();
+
+		StepSlice(0);
+
+		std::unique_lock<std::mutex> Lock(WorkMutex);
+		WorkDone.wait(Lock, [this] { return WorkPending == 0; });
+	}
+
+	void FDogfightEnv::WorkerLoop(int Worker)
+	{
+		uint64_t SeenGeneration = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> Lock(WorkMutex);
+				WorkReady.wait(Lock, [this, SeenGeneration] { return bStopping || WorkGeneration != SeenGeneration; });
+				if (bStopping)
+				{
+					return;
+				}
+				SeenGeneration = WorkGeneration;
+			}
+
+			StepSlice(Worker);
+
+			std::lock_guard<std::mutex> Lock(WorkMutex);
+			if (--WorkPending == 0)
+			{
+				WorkDone.notify_one();
+			}
+		}
+	}
+
+	void FDogfightEnv::StepSlice(int Slice)
+	{
+		// Fixed slices, so an engagement is always stepped by the same thread
+		const int64_t NumEnvs = Config.NumEnvs;
+		const int Begin = static_cast<int>(NumEnvs * Slice / Config.NumThreads);
+		const int End = static_cast<int>(NumEnvs * (Slice + 1) / Config.NumThreads);
+		for (int Env = Begin; Env < End; ++Env)
+		{
+			StepEngagement(Env);
+		}
+	}
+
+	void FDogfightEnv::StepEngagement(int Env)
+	{
+		FEngagement& Engagement = Engagements[Env];
+
+		double Reward = Config.Rewards.Step;
+		EDogfightOutcome Outcome = EDogfightOutcome::None;
+		for (int Repeat = 0; Repeat < Config.ActionRepeat && Outcome == EDogfightOutcome::None; ++Repeat)
+		{
+			Reward += Simulate(Env, Outcome);
+		}
+
+		++Engagement.NumSteps;
+		Engagement.Return += Reward;
+		if (Outcome == EDogfightOutcome::None && Engagement.Time >= Config.MaxEpisodeSeconds - 0.5 * Config.StepSize)
+		{
+			Outcome = EDogfightOutcome::Timeout;
+		}
+
+		Rewards[Env] = static_cast<float>(Reward);
+		Terminated[Env] = Outcome == EDogfightOutcome::Win || Outcome == EDogfightOutcome::Loss;
+		Truncated[Env] = Outcome == EDogfightOutcome::Timeout;
+		Outcomes[Env] = static_cast<uint8_t>(Outcome);
+
+		float* Observation = &Observations[static_cast<size_t>(Env) * ObservationSize];
+		if (Outcome != EDogfightOutcome::None)
+		{
+			EpisodeReturns[Env] = static_cast<float>(Engagement.Return);
+			EpisodeLengths[Env] = Engagement.NumSteps;
+			WriteObservation(Env, &FinalObservations[static_cast<size_t>(Env) * ObservationSize]);
+			ResetEngagement(Env);
+		}
+		WriteObservation(Env, Observation);
+	}
+
+	double FDogfightEnv::Simulate(int Env, EDogfightOutcome& OutOutcome)
+	{
+		FEngagement& Engagement = Engagements[Env];
+		FEnemy* EngagementEnemies = &Enemies[static_cast<size_t>(Env) * Config.NumEnemies];
+		const float* Action = &Actions[static_cast<size_t>(Env) * DogfightAction::Num];
+		const FDogfightJetParams& Jet = Config.Jet;
+		double Reward = 0.0;
+
+		// The pilot's inputs, mapped onto the airframe as AFighterJetPawn::ApplyAerodynamics does in the air
+		const double Pitch = std::clamp(static_cast<double>(Action[DogfightAction::Pitch]), -1.0, 1.0);
+		Engagement.Throttle = std::clamp(static_cast<double>(Action[DogfightAction::Throttle]), 0.0, 1.0);
+		FControls Controls;
+		Controls.Thrust = Engagement.Throttle * Jet.MaxThrust;
+		Controls.PitchTorque = Pitch * Jet.PitchSpeed * DegToRad;
+		Controls.RollTorque = std::clamp(static_cast<double>(Action[DogfightAction::Roll]), -1.0, 1.0) * Jet.RollSpeed * DegToRad;
+		Controls.YawTorque = std::clamp(static_cast<double>(Action[DogfightAction::Yaw]), -1.0, 1.0) * Jet.YawSpeed * DegToRad;
+		Controls.Elevator = Pitch;
+		FlightModel::Step(Jet.Airframe, Engagement.Jet, Controls, Config.StepSize);
+
+		// Gun: hitscan along the nose at the nearest aircraft, as UGunfireSubsystem resolves a shot
+		if (Action[DogfightAction::FireGun] > 0.5f && Engagement.Time - Engagement.LastFireTime > Jet.FireRate)
+		{
+			Engagement.LastFireTime = Engagement.Time;
+
+			FRay Ray;
+			Ray.Origin = Engagement.Jet.Position;
+			Ray.Direction = Engagement.Jet.Attitude.GetForwardVector();
+			Ray.Length = Jet.WeaponRange;
+			FEnemy* Hit = nullptr;
+			double HitDistance = Ray.Length;
+			for (int Index = 0; Index < Config.NumEnemies; ++Index)
+			{
+				double Entry;
+				double Exit;
+				FEnemy& Enemy = EngagementEnemies[Index];
+				if (Enemy.bAlive && IntersectRaySphere(Ray, Enemy.Position, Config.AircraftRadius, Entry, Exit) && Entry <= HitDistance)
+				{
+					Hit = &Enemy;
+					HitDistance = Entry;
+				}
+			}
+			if (Hit)
+			{
+				Reward += DamageEnemy(Engagement, *Hit, Jet.GunDamage);
+			}
+		}
+
+		FlyEnemies(Engagement, EngagementEnemies, Reward);
+		UpdateLock(Engagement, EngagementEnemies);
+
+		// One launch per press, at the locked target, as AFighterJetPawn::FireMissile
+		const bool bMissilePressed = Action[DogfightAction::FireMissile] > 0.5f;
+		const bool bLocked = Engagement.LockTarget >= 0 && Engagement.LockHeldTime >= Jet.LockAcquireTime;
+		if (bMissilePressed && !Engagement.bMissileHeld && bLocked && Engagement.Missiles.Num() < Jet.MaxMissilesInFlight)
+		{
+			const FEnemy& Target = EngagementEnemies[Engagement.LockTarget];
+			const FVec3d Velocity = Engagement.Jet.Attitude.GetForwardVector() * Jet.MissileLaunchSpeed + Engagement.Jet.Velocity;
+			const int Missile = Engagement.Missiles.Add(Engagement.Jet.Position, Velocity, Jet.Missile);
+			Engagement.Missiles.SetTarget(Missile, Target.Position, Target.Velocity);
+			Engagement.MissileTargets.push_back(Engagement.LockTarget);
+		}
+		Engagement.bMissileHeld = bMissilePressed;
+
+		FlyMissiles(Engagement, EngagementEnemies, Reward);
+
+		Engagement.Time += Config.StepSize;
+
+		if (Engagement.JetHealth <= 0.0 || Engagement.Jet.Position.Z < Config.GroundZ)
+		{
+			OutOutcome = EDogfightOutcome::Loss;
+			Reward += Config.Rewards.Loss;
+		}
+		else if (Engagement.NumAlive == 0)
+		{
+			OutOutcome = EDogfightOutcome::Win;
+			Reward += Config.Rewards.Win;
+		}
+		return Reward;
+	}
+
+	void FDogfightEnv::FlyEnemies(FEngagement& Engagement, FEnemy* EngagementEnemies, double& InOutReward)
+	{
+		const FDogfightAIParams& AI = Config.AI;
+		const double Dt = Config.StepSize;
+		const double MinCosAngle = std::cos(AI.RadarConeHalfAngle * DegToRad);
+		const FVec3d JetPosition = Engagement.Jet.Position;
+
+		FAIPilotFrame Frame;
+		Frame.Time = Engagement.Time;
+		Frame.DeltaTime = Dt;
+		Frame.ContactMemorySeconds = AI.ContactMemorySeconds;
+		Frame.PatrolCenter = FVec3d(0.0, 0.0, Config.SpawnAltitude);
+		Frame.PatrolRadius = AI.PatrolRadius;
+
+		FAIPilotAgent Agent;
+		Agent.FlightSpeed = AI.FlightSpeed;
+		Agent.TurnSpeed = AI.TurnSpeed;
+		Agent.AvoidanceDistance = AI.AvoidanceDistance;
+		Agent.EvasionTurnSpeed = AI.EvasionTurnSpeed;
+		Agent.FireRate = AI.FireRate;
+		Agent.ContactLocation = JetPosition;
+		Agent.ContactVelocity = Engagement.Jet.Velocity;
+
+		for (int Index = 0; Index < Config.NumEnemies; ++Index)
+		{
+			FEnemy& Enemy = EngagementEnemies[Index];
+			if (!Enemy.bAlive)
+			{
+				continue;
+			}
+
+			// Radar contact: the jet inside the cone around the nose and in range
+			const FVec3d ToJet = JetPosition - Enemy.Position;
+			const double DistanceSquared = ToJet.SizeSquared();
+			Agent.bHasContact = DistanceSquared <= AI.RadarRange * AI.RadarRange
+				&& FVec3d::Dot(Enemy.Rotation.Vector(), ToJet) >= MinCosAngle * std::sqrt(DistanceSquared);
+
+			Agent.Location = Enemy.Position;
+			Agent.Rotation = Enemy.Rotation;
+			Agent.LastFireTime = Enemy.LastFireTime;
+			Agent.bEvading = Frame.Time < Enemy.EvadeUntil;
+
+			// Every enemy is re-planned every step, as the game does for aircraft near the player
+			AIPilot::Plan(Agent, Frame, Enemy.Plan);
+			AIPilot::Steer(Agent, Frame, Enemy.Plan);
+			const FAIPilotDecision Decision = AIPilot::Decide(Agent, Enemy.Plan, Frame);
+			if (Decision.bTurn)
+			{
+				Enemy.Rotation = Decision.Rotation;
+			}
+
+			if (Decision.bFire)
+			{
+				Enemy.LastFireTime = Frame.Time;
+
+				// The nearest aircraft along the new heading, the other AI included
+				FRay Ray;
+				Ray.Origin = Enemy.Position;
+				Ray.Direction = Enemy.Rotation.Vector();
+				Ray.Length = AI.WeaponRange;
+				int Hit = -1;
+				double HitDistance = Ray.Length;
+				double Entry;
+				double Exit;
+				if (IntersectRaySphere(Ray, JetPosition, Config.AircraftRadius, Entry, Exit))
+				{
+					HitDistance = Entry;
+					Hit = Config.NumEnemies;
+				}
+				for (int Other = 0; Other < Config.NumEnemies; ++Other)
+				{
+					const FEnemy& OtherEnemy = EngagementEnemies[Other];
+					if (Other != Index && OtherEnemy.bAlive && IntersectRaySphere(Ray, OtherEnemy.Position, Config.AircraftRadius, Entry, Exit)
+						&& Entry < HitDistance)
+					{
+						HitDistance = Entry;
+						Hit = Other;
+					}
+				}
+
+				if (Hit == Config.NumEnemies)
+				{
+					Engagement.JetHealth -= AI.GunDamage;
+					InOutReward += Config.Rewards.DamageTaken * AI.GunDamage;
+				}
+				else if (Hit >= 0)
+				{
+					DamageEnemy(Engagement, EngagementEnemies[Hit], AI.GunDamage);
+				}
+			}
+
+			StepPointMass(AI.Body, Enemy.Position, Enemy.Velocity, Decision.Thrust, Dt);
+		}
+	}
+
+	double FDogfightEnv::DamageEnemy(FEngagement& Engagement, FEnemy& Enemy, double Damage)
+	{
+		if (!Enemy.bAlive)
+		{
+			return 0.0;
+		}
+
+		// The reward for the agent's hits; the AI's shots at each other discard it
+		const double Dealt = std::min(Damage, Enemy.Health);
+		double Reward = Config.Rewards.DamageDealt * Dealt;
+		Enemy.Health -= Damage;
+		if (Enemy.Health <= 0.0)
+		{
+			Enemy.bAlive = false;
+			--Engagement.NumAlive;
+			return Reward + Config.Rewards.Kill;
+		}
+
+		// AAIAircraftPawn::HandleTakeDamage
+		if (Engagement.Time >= Enemy.EvadeUntil)
+		{
+			Enemy.EvadeUntil = Engagement.Time + Config.AI.EvasionDuration;
+		}
+		return Reward;
+	}
+
+	void FDogfightEnv::UpdateLock(FEngagement& Engagement, const FEnemy* EngagementEnemies)
+	{
+		const FDogfightJetParams& Jet = Config.Jet;
+		const double Dt = Config.StepSize;
+		const FVec3d Origin = Engagement.Jet.Position;
+		const FVec3d Forward = Engagement.Jet.Attitude.GetForwardVector();
+		const double MinCosAngle = std::cos(Jet.RadarConeHalfAngle * DegToRad);
+
+		// Hold the current target while it stays in the cone, and let go once it has been out too long
+		if (Engagement.LockTarget >= 0)
+		{
+			const FEnemy& Target = EngagementEnemies[Engagement.LockTarget];
+			const double Score = Target.bAlive ? LockScore(Origin, Forward, Target.Position, Jet.RadarRange, MinCosAngle) : -1.0;
+			if (Score > 0.0)
+			{
+				Engagement.LockScore = Score;
+				Engagement.LockOutOfConeTime = 0.0;
+				Engagement.LockHeldTime += Dt;
+			}
+			else
+			{
+				Engagement.LockOutOfConeTime += Dt;
+				if (!Target.bAlive || Engagement.LockOutOfConeTime > Jet.BreakLockTime)
+				{
+					Engagement.LockTarget = -1;
+				}
+			}
+		}
+
+		// Switch only to a clearly better candidate
+		double BestScore = Engagement.LockTarget >= 0 ? Engagement.LockScore * std::max(Jet.SwitchScoreRatio, 1.0) : 0.0;
+		int Best = -1;
+		for (int Index = 0; Index < Config.NumEnemies; ++Index)
+		{
+			const FEnemy& Enemy = EngagementEnemies[Index];
+			const double Score = Enemy.bAlive && Index != Engagement.LockTarget ? LockScore(Origin, Forward, Enemy.Position, Jet.RadarRange, MinCosAngle) : -1.0;
+			if (Score > BestScore)
+			{
+				BestScore = Score;
+				Best = Index;
+			}
+		}
+		if (Best >= 0)
+		{
+			Engagement.LockTarget = Best;
+			Engagement.LockScore = BestScore;
+			Engagement.LockHeldTime = 0.0;
+			Engagement.LockOutOfConeTime = 0.0;
+		}
+	}
+
+	void FDogfightEnv::FlyMissiles(FEngagement& Engagement, FEnemy* EngagementEnemies, double& InOutReward)
+	{
+		FMissileBatch& Missiles = Engagement.Missiles;
+		if (Missiles.Num() == 0)
+		{
+			return;
+		}
+
+		// Guided at where the target is now; one shot down meanwhile leaves its missiles unguided
+		for (int Missile = 0; Missile < Missiles.Num(); ++Missile)
+		{
+			int& Target = Engagement.MissileTargets[Missile];
+			if (Target >= 0 && EngagementEnemies[Target].bAlive)
+			{
+				Missiles.SetTarget(Missile, EngagementEnemies[Target].Position, EngagementEnemies[Target].Velocity);
+			}
+			else if (Target >= 0)
+			{
+				Missiles.ClearTarget(Missile);
+				Target = -1;
+			}
+		}
+
+		Engagement.MissileEvents.clear();
+		Missiles.Step(Config.StepSize, FVec3d(0.0, 0.0, Config.Jet.Airframe.GravityZ), Engagement.MissileEvents);
+
+		// Events are in ascending index order, so removing from the back keeps the rest where they are
+		for (auto It = Engagement.MissileEvents.rbegin(); It != Engagement.MissileEvents.rend(); ++It)
+		{
+			const int Target = Engagement.MissileTargets[It->Index];
+			if (It->Type == EMissileEvent::Detonated && Target >= 0)
+			{
+				InOutReward += DamageEnemy(Engagement, EngagementEnemies[Target], Config.Jet.MissileDamage);
+			}
+
+			Missiles.RemoveAtSwap(It->Index);
+			Engagement.MissileTargets[It->Index] = Engagement.MissileTargets.back();
+			Engagement.MissileTargets.pop_back();
+		}
+	}
+
+	void FDogfightEnv::ResetEngagement(int Env)
+	{
+		FEngagement& Engagement = Engagements[Env];
+		FEnemy* EngagementEnemies = &Enemies[static_cast<size_t>(Env) * Config.NumEnemies];
+
+		Engagement.Time = 0.0;
+		Engagement.NumSteps = 0;
+		Engagement.Return = 0.0;
+		Engagement.JetHealth = Config.Jet.MaxHealth;
+		Engagement.Throttle = 0.0;
+		Engagement.LastFireTime = 0.0;
+		Engagement.bMissileHeld = false;
+		Engagement.LockTarget = -1;
+		Engagement.LockScore = 0.0;
+		Engagement.LockHeldTime = 0.0;
+		Engagement.LockOutOfConeTime = 0.0;
+		while (Engagement.Missiles.Num() > 0)
+		{
+			Engagement.Missiles.RemoveAtSwap(Engagement.Missiles.Num() - 1);
+		}
+		Engagement.MissileTargets.clear();
+
+		// Level at the centre on a random heading
+		const double Heading = 2.0 * Pi * RandomUnit(Engagement.Random);
+		Engagement.Jet = FBodyState();
+		Engagement.Jet.Position = FVec3d(0.0, 0.0, Config.SpawnAltitude);
+		Engagement.Jet.Attitude = FQuatd::FromAxisAngle(FVec3d(0.0, 0.0, 1.0), Heading);
+		Engagement.Jet.Velocity = Engagement.Jet.Attitude.GetForwardVector() * Config.StartSpeed;
+
+		// USpawnDirectorSubsystem::PlaceWave's ring: evenly round it with each position jittered, facing the centre
+		const double Jitter = std::clamp(Config.SpawnAngleJitter, 0.0, 1.0);
+		for (int Index = 0; Index < Config.NumEnemies; ++Index)
+		{
+			const double Angle = 2.0 * Pi * (Index + Jitter * (RandomUnit(Engagement.Random) - 0.5)) / Config.NumEnemies;
+			FEnemy& Enemy = EngagementEnemies[Index];
+			Enemy = FEnemy();
+			Enemy.Position = FVec3d(std::cos(Angle) * Config.SpawnRadius, std::sin(Angle) * Config.SpawnRadius, Config.SpawnAltitude);
+			Enemy.Rotation.Yaw = FRotatord::NormalizeAxis(Angle * RadToDeg + 180.0);
+			Enemy.Velocity = Enemy.Rotation.Vector() * Config.AI.Body.MaxSpeed;
+			Enemy.Health = Config.AI.MaxHealth;
+			Enemy.bAlive = true;
+		}
+		Engagement.NumAlive = Config.NumEnemies;
+	}
+
+	void FDogfightEnv::WriteObservation(int Env, float* Out) const
+	{
+		using namespace DogfightObservation;
+
+		const FEngagement& Engagement = Engagements[Env];
+		const FEnemy* EngagementEnemies = &Enemies[static_cast<size_t>(Env) * Config.NumEnemies];
+		const FBodyState& Jet = Engagement.Jet;
+		const FQuatd& Attitude = Jet.Attitude;
+
+		const FVec3d Velocity = Attitude.UnrotateVector(Jet.Velocity) * VelocityScale;
+		const FVec3d Up = Attitude.UnrotateVector(FVec3d(0.0, 0.0, 1.0));
+		const FVec3d AngularVelocity = Attitude.UnrotateVector(Jet.AngularVelocity);
+		Out[VelocityX] = static_cast<float>(Velocity.X);
+		Out[VelocityY] = static_cast<float>(Velocity.Y);
+		Out[VelocityZ] = static_cast<float>(Velocity.Z);
+		Out[Altitude] = static_cast<float>((Jet.Position.Z - Config.GroundZ) * PositionScale);
+		Out[UpX] = static_cast<float>(Up.X);
+		Out[UpY] = static_cast<float>(Up.Y);
+		Out[UpZ] = static_cast<float>(Up.Z);
+		Out[AngularVelocityX] = static_cast<float>(AngularVelocity.X);
+		Out[AngularVelocityY] = static_cast<float>(AngularVelocity.Y);
+		Out[AngularVelocityZ] = static_cast<float>(AngularVelocity.Z);
+		Out[Throttle] = static_cast<float>(Engagement.Throttle);
+		Out[Health] = static_cast<float>(std::max(Engagement.JetHealth, 0.0) / Config.Jet.MaxHealth);
+		Out[GunReady] = Engagement.Time - Engagement.LastFireTime > Config.Jet.FireRate ? 1.0f : 0.0f;
+		const double LockAcquireTime = std::max(Config.Jet.LockAcquireTime, 1.e-6);
+		Out[LockProgress] = Engagement.LockTarget >= 0 ? static_cast<float>(std::min(Engagement.LockHeldTime / LockAcquireTime, 1.0)) : 0.0f;
+		Out[MissilesInFlight] = Config.Jet.MaxMissilesInFlight > 0 ? static_cast<float>(Engagement.Missiles.Num()) / Config.Jet.MaxMissilesInFlight : 0.0f;
+		Out[TimeLeft] = static_cast<float>(std::max(1.0 - Engagement.Time / Config.MaxEpisodeSeconds, 0.0));
+
+		float* EnemyOut = Out + NumAgent;
+		for (int Index = 0; Index < Config.NumEnemies; ++Index, EnemyOut += NumPerEnemy)
+		{
+			const FEnemy& Enemy = EngagementEnemies[Index];
+			if (!Enemy.bAlive)
+			{
+				std::fill(EnemyOut, EnemyOut + NumPerEnemy, 0.0f);
+				continue;
+			}
+
+			const FVec3d Position = Attitude.UnrotateVector(Enemy.Position - Jet.Position) * PositionScale;
+			const FVec3d RelativeVelocity = Attitude.UnrotateVector(Enemy.Velocity - Jet.Velocity) * VelocityScale;
+			const FVec3d Forward = Attitude.UnrotateVector(Enemy.Rotation.Vector());
+			EnemyOut[Alive] = 1.0f;
+			EnemyOut[RelativePositionX] = static_cast<float>(Position.X);
+			EnemyOut[RelativePositionY] = static_cast<float>(Position.Y);
+			EnemyOut[RelativePositionZ] = static_cast<float>(Position.Z);
+			EnemyOut[RelativeVelocityX] = static_cast<float>(RelativeVelocity.X);
+			EnemyOut[RelativeVelocityY] = static_cast<float>(RelativeVelocity.Y);
+			EnemyOut[RelativeVelocityZ] = static_cast<float>(RelativeVelocity.Z);
+			EnemyOut[ForwardX] = static_cast<float>(Forward.X);
+			EnemyOut[ForwardY] = static_cast<float>(Forward.Y);
+			EnemyOut[ForwardZ] = static_cast<float>(Forward.Z);
+			EnemyOut[EnemyHealth] = static_cast<float>(Enemy.Health / Config.AI.MaxHealth);
+			EnemyOut[IsLockTarget] = Index == Engagement.LockTarget ? 1.0f : 0.0f;
+		}
+	}
+}
@@ -0,0 +1,172 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/FlightDynamics.h"
+
+#include <cmath>
+
+namespace FlightModel
+{
+	double ComputeAngleOfAttack(const FVec3d& LocalVelocity)
+	{
+		// Body Z is up, so flying nose-high puts the relative wind below the nose
+		return std::atan2(-LocalVelocity.Z, LocalVelocity.X);
+	}
+
+	FAeroCoefficients SampleCoefficients(const FAirframe& Airframe, const FVec3d& LocalVelocity, double Elevator)
+	{
+		const double Mach = LocalVelocity.Size() / SpeedOfSound;
+		return Airframe.AeroTable->Lookup(ComputeAngleOfAttack(LocalVelocity), Mach, Elevator * Airframe.MaxElevatorDeflection);
+	}
+
+	FLoads ComputeLoads(const FAirframe& Airframe, const FBodyState& State, const FControls& Controls)
+	{
+		const FVec3d Forward = State.Attitude.GetForwardVector();
+		const FVec3d Right = State.Attitude.GetRightVector();
+		const FVec3d Up = State.Attitude.GetUpVector();
+
+		const FVec3d Direction = State.Velocity.GetSafeNormal();
+		const double Airspeed = State.Velocity.Size() * Airframe.SpeedScale;
+		const double Q = Airspeed * Airspeed;
+
+		FLoads Loads;
+
+		// 1. Thrust
+		Loads.Force = Forward * Controls.Thrust;
+
+		if (Airframe.AeroTable)
+		{
+			// Lift, drag and the pitching moment all come from the table at the current AoA/Mach
+			const FAeroCoefficients Coefficients = SampleCoefficients(Airframe, State.Attitude.UnrotateVector(State.Velocity), Controls.Elevator);
+			const double SpeedSquared = State.Velocity.SizeSquared();
+			const double ForceScale = SpeedSquared * Airframe.TableForceScale;
+
+			if (Controls.bLiftEnabled)
+			{
+				Loads.Force += FVec3d::Cross(Direction, Right).GetSafeNormal() * (ForceScale * Coefficients.CL);
+			}
+			Loads.Force -= Direction * (ForceScale * Coefficients.CD);
+
+			// Positive Cm is nose up, which is a negative rotation about the right axis. The moment is a real
+			// torque; an airframe whose torques are accelerations gets it through its pitch inertia.
+			double PitchTorque = -SpeedSquared * Airframe.TableMomentScale * Coefficients.Cm;
+			if (Airframe.bTorqueAsAcceleration)
+			{
+				PitchTorque /= Airframe.Inertia.Y;
+			}
+			Loads.Torque = Right * PitchTorque + Forward * Controls.RollTorque + Up * Controls.YawTorque;
+			return Loads;
+		}
+
+		// 2. Lift
+		if (Controls.bLiftEnabled)
+		{
+			const FVec3d LiftDirection = Airframe.bLiftAlongVelocityNormal
+				? FVec3d::Cross(Direction, Right).GetSafeNormal()
+				: Up;
+			Loads.Force += LiftDirection * (Q * Airframe.LiftCoefficient);
+		}
+
+		// 3. Drag
+		Loads.Force -= Direction * (Q * Airframe.DragCoefficient);
+
+		// 4. Control torques (pitch, roll, yaw)
+		Loads.Torque = Right * Controls.PitchTorque + Forward * Controls.RollTorque + Up * Controls.YawTorque;
+
+		return Loads;
+	}
+
+	void Step(const FAirframe& Airframe, FBodyState& State, const FControls& Controls, double StepSize)
+	{
+		const FLoads Loads = ComputeLoads(Airframe, State, Controls);
+
+		// Linear: velocity first, then position with the new velocity
+		FVec3d LinearAcceleration = Loads.Force / Airframe.Mass;
+		LinearAcceleration.Z += Airframe.GravityZ;
+		State.Velocity += LinearAcceleration * StepSize;
+		State.Velocity *= 1.0 / (1.0 + Airframe.LinearDamping * StepSize);
+		State.Position += State.Velocity * StepSize;
+
+		// Angular: torques are world space, the inertia tensor is diagonal in body space
+		FVec3d AngularAcceleration;
+		if (Airframe.bTorqueAsAcceleration)
+		{
+			AngularAcceleration = Loads.Torque;
+		}
+		else
+		{
+			const FVec3d LocalTorque = State.Attitude.UnrotateVector(Loads.Torque);
+			const FVec3d LocalAcceleration(
+				LocalTorque.X / Airframe.Inertia.X,
+				LocalTorque.Y / Airframe.Inertia.Y,
+				LocalTorque.Z / Airframe.Inertia.Z);
+			AngularAcceleration = State.Attitude.RotateVector(LocalAcceleration);
+		}
+		State.AngularVelocity += AngularAcceleration * StepSize;
+		State.AngularVelocity *= 1.0 / (1.0 + Airframe.AngularDamping * StepSize);
+
+		// q' = q + 0.5 * dt * (w, 0) * q
+		const FVec3d& W = State.AngularVelocity;
+		const FQuatd Spin = FQuatd(W.X, W.Y, W.Z, 0.0) * State.Attitude;
+		const double HalfStep = 0.5 * StepSize;
+		State.Attitude.X += Spin.X * HalfStep;
+		State.Attitude.Y += Spin.Y * HalfStep;
+		State.Attitude.Z += Spin.Z * HalfStep;
+		State.Attitude.W += Spin.W * HalfStep;
+		State.Attitude.Normalize();
+	}
+
+	void StepPointMass(const FPointMass& Body, FVec3d& Position, FVec3d& Velocity, const FVec3d& Force, double StepSize)
+	{
+		FVec3d Acceleration = Force / Body.Mass;
+		Acceleration.Z += Body.GravityZ;
+		Velocity += Acceleration * StepSize;
+		Velocity *= 1.0 / (1.0 + Body.LinearDamping * StepSize);
+
+		if (Body.MaxSpeed > 0.0)
+		{
+			const double SpeedSquared = Velocity.SizeSquared();
+			if (SpeedSquared > Body.MaxSpeed * Body.MaxSpeed)
+			{
+				Velocity *= Body.MaxSpeed / std::sqrt(SpeedSquared);
+			}
+		}
+
+		Position += Velocity * StepSize;
+	}
+
+	FGroundContact EvaluateGroundContact(double HeightAboveGround, double VerticalSpeed, bool bWasOnGround,
+		double ContactHeight, double MaxLandingSpeed)
+	{
+		FGroundContact Contact;
+		Contact.bOnGround = HeightAboveGround >= 0.0 && HeightAboveGround <= ContactHeight;
+
+		// Only the frame we touch down counts, rolling along the runway is fine
+		Contact.bHardLanding = Contact.bOnGround && !bWasOnGround && -VerticalSpeed > MaxLandingSpeed;
+		return Contact;
+	}
+
+	FFixedStepClock::FFixedStepClock(double InStepSize, int InMaxStepsPerFrame)
+		: StepSize(InStepSize)
+		, Accumulator(0.0)
+		, MaxStepsPerFrame(InMaxStepsPerFrame)
+	{
+	}
+
+	int FFixedStepClock::Advance(double FrameSeconds)
+	{
+		Accumulator += FrameSeconds > 0.0 ? FrameSeconds : 0.0;
+
+		int NumSteps = static_cast<int>(Accumulator / StepSize);
+		if (NumSteps > MaxStepsPerFrame)
+		{
+			// Drop the backlog rather than spiralling after a hitch
+			NumSteps = MaxStepsPerFrame;
+			Accumulator = 0.0;
+		}
+		else
+		{
+			Accumulator -= NumSteps * StepSize;
+		}
+		return NumSteps;
+	}
+}
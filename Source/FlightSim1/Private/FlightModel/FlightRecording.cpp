@@ -0,0 +1,464 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/FlightRecording.h"
+#include "FlightModel/ByteStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace FlightModel
+{
+	namespace
+	{
+		constexpr uint32_t ChunkMagic = 0x4B4E4843u;
+		constexpr uint32_t IndexMagic = 0x58444E49u;
+		constexpr uint32_t TrailerMagic = 0x444E4546u;
+
+		// Magic, version, flags
+		constexpr size_t FileHeaderSize = 8;
+
+		// Magic, payload size, first frame, frame count, start and end time
+		constexpr size_t ChunkHeaderSize = 32;
+		constexpr size_t ChunkSizeOffset = 4;
+		constexpr size_t ChunkNumFramesOffset = 12;
+		constexpr size_t ChunkEndTimeOffset = 24;
+
+		// Offset, size, first frame, frame count, start and end time
+		constexpr size_t IndexEntrySize = 36;
+
+		// Index offset and magic, the last bytes of a finished file
+		constexpr size_t TrailerSize = 12;
+
+		// Where a snapshot buffer keeps its time; see FWorldSnapshotCodec::Encode
+		constexpr size_t SnapshotTimeOffset = 16;
+
+		// Steps per unit, as in the snapshot codec
+		constexpr double PositionScale = 64.0;
+		constexpr double VectorScale = 1024.0;
+		constexpr double ValueScale = 64.0;
+		constexpr double TimeScale = 1024.0;
+
+		// The smallest an encoded event can be, which bounds what a corrupt count can make us allocate
+		constexpr uint64_t MinEventSize = 11;
+
+		uint64_t TimeBits(double Time)
+		{
+			uint64_t Bits;
+			std::memcpy(&Bits, &Time, sizeof(Bits));
+			return Bits;
+		}
+
+		double TimeFromBits(uint64_t Bits)
+		{
+			double Time;
+			std::memcpy(&Time, &Bits, sizeof(Time));
+			return Time;
+		}
+
+		uint64_t WriteId(int Id)
+		{
+			return Id >= 0 ? uint64_t(Id) + 1 : 0;
+		}
+
+		int ReadId(uint64_t Value)
+		{
+			return static_cast<int>(static_cast<int64_t>(Value) - 1);
+		}
+
+		void WriteVector(std::vector<uint8_t>& Out, const FVec3d& Vector, double Scale)
+		{
+			WriteVarint(Out, ZigZag(ToSteps(Vector.X, Scale)));
+			WriteVarint(Out, ZigZag(ToSteps(Vector.Y, Scale)));
+			WriteVarint(Out, ZigZag(ToSteps(Vector.Z, Scale)));
+		}
+
+		FVec3d ReadVector(FByteReader& Reader, double Scale)
+		{
+			const double X = FromSteps(UnZigZag(Reader.ReadVarint()), Scale);
+			const double Y = FromSteps(UnZigZag(Reader.ReadVarint()), Scale);
+			const double Z = FromSteps(UnZigZag(Reader.ReadVarint()), Scale);
+			return FVec3d(X, Y, Z);
+		}
+
+		void WriteEvents(std::vector<uint8_t>& Out, double FrameTime, const FRecordedEvent* Events, size_t NumEvents)
+		{
+			WriteVarint(Out, NumEvents);
+			for (size_t i = 0; i < NumEvents; ++i)
+			{
+				const FRecordedEvent& Event = Events[i];
+				Out.push_back(static_cast<uint8_t>(Event.Type));
+				WriteVarint(Out, ZigZag(ToSteps(Event.Time - FrameTime, TimeScale)));
+				WriteVarint(Out, WriteId(Event.Subject));
+				WriteVarint(Out, WriteId(Event.Other));
+				WriteVector(Out, Event.Position, PositionScale);
+				WriteVector(Out, Event.Vector, VectorScale);
+				WriteVarint(Out, ZigZag(ToSteps(Event.Value, ValueScale)));
+			}
+		}
+
+		bool ReadEvents(FByteReader& Reader, double FrameTime, std::vector<FRecordedEvent>& Events)
+		{
+			const uint64_t NumEvents = Reader.ReadVarint();
+			if (!Reader.bOk || NumEvents > (Reader.Size - Reader.Offset) / MinEventSize)
+			{
+				return false;
+			}
+
+			Events.resize(static_cast<size_t>(NumEvents));
+			for (FRecordedEvent& Event : Events)
+			{
+				const uint8_t Type = static_cast<uint8_t>(Reader.ReadFixed(1));
+				if (Type >= static_cast<uint8_t>(ERecordedEventType::Count))
+				{
+					return false;
+				}
+				Event.Type = static_cast<ERecordedEventType>(Type);
+				Event.Time = FrameTime + FromSteps(UnZigZag(Reader.ReadVarint()), TimeScale);
+				Event.Subject = ReadId(Reader.ReadVarint());
+				Event.Other = ReadId(Reader.ReadVarint());
+				Event.Position = ReadVector(Reader, PositionScale);
+				Event.Vector = ReadVector(Reader, VectorScale);
+				Event.Value = FromStepsF(UnZigZag(Reader.ReadVarint()), ValueScale);
+			}
+			return Reader.bOk;
+		}
+	}
+
+	// --- FFlightRecordWriter ---
+
+	void FFlightRecordWriter::Begin(std::vector<uint8_t>& Out, const FRecordingSettings& InSettings)
+	{
+		Settings = InSettings;
+		Settings.MaxFramesPerChunk = std::max(Settings.MaxFramesPerChunk, 1u);
+		Previous.Reset();
+		Chunk.clear();
+		Chunks.clear();
+		NumFrames = 0;
+
+		WriteFixed(Out, Magic, 4);
+		WriteFixed(Out, Version, 2);
+		WriteFixed(Out, 0, 2);
+		FileSize = FileHeaderSize;
+	}
+
+	void FFlightRecordWriter::AddFrame(const FWorldSnapshot& Snapshot, const FRecordedEvent* Events, size_t NumEvents, std::vector<uint8_t>& Out)
+	{
+		if (Chunk.empty())
+		{
+			// Sizes, frame count and end time are patched in when the chunk is flushed
+			OpenChunk = FRecordingChunkInfo();
+			OpenChunk.Offset = FileSize;
+			OpenChunk.FirstFrame = NumFrames;
+			OpenChunk.StartTime = Snapshot.Time;
+			WriteFixed(Chunk, ChunkMagic, 4);
+			WriteFixed(Chunk, 0, 4);
+			WriteFixed(Chunk, OpenChunk.FirstFrame, 4);
+			WriteFixed(Chunk, 0, 4);
+			WriteFixed(Chunk, TimeBits(Snapshot.Time), 8);
+			WriteFixed(Chunk, 0, 8);
+
+			// Every chunk opens with a keyframe, so it decodes on its own
+			Codec.Encode(Snapshot, nullptr, Chunk);
+		}
+		else
+		{
+			Codec.Encode(Snapshot, &Previous, Chunk);
+		}
+		WriteEvents(Chunk, Snapshot.Time, Events, NumEvents);
+
+		++OpenChunk.NumFrames;
+		OpenChunk.EndTime = Snapshot.Time;
+		++NumFrames;
+		Previous = Snapshot;
+
+		if (OpenChunk.NumFrames >= Settings.MaxFramesPerChunk || Chunk.size() >= Settings.MaxChunkBytes)
+		{
+			FlushChunk(Out);
+		}
+	}
+
+	void FFlightRecordWriter::FlushChunk(std::vector<uint8_t>& Out)
+	{
+		if (Chunk.empty())
+		{
+			return;
+		}
+
+		PatchFixed(Chunk, ChunkSizeOffset, Chunk.size() - ChunkHeaderSize, 4);
+		PatchFixed(Chunk, ChunkNumFramesOffset, OpenChunk.NumFrames, 4);
+		PatchFixed(Chunk, ChunkEndTimeOffset, TimeBits(OpenChunk.EndTime), 8);
+		OpenChunk.Size = static_cast<uint32_t>(Chunk.size());
+		Chunks.push_back(OpenChunk);
+
+		Out.insert(Out.end(), Chunk.begin(), Chunk.end());
+		FileSize += Chunk.size();
+		Chunk.clear();
+	}
+
+	void FFlightRecordWriter::Finish(std::vector<uint8_t>& Out)
+	{
+		FlushChunk(Out);
+
+		const size_t Start = Out.size();
+		const uint64_t IndexOffset = FileSize;
+		WriteFixed(Out, IndexMagic, 4);
+		WriteFixed(Out, Chunks.size(), 4);
+		for (const FRecordingChunkInfo& Info : Chunks)
+		{
+			WriteFixed(Out, Info.Offset, 8);
+			WriteFixed(Out, Info.Size, 4);
+			WriteFixed(Out, Info.FirstFrame, 4);
+			WriteFixed(Out, Info.NumFrames, 4);
+			WriteFixed(Out, TimeBits(Info.StartTime), 8);
+			WriteFixed(Out, TimeBits(Info.EndTime), 8);
+		}
+		WriteFixed(Out, IndexOffset, 8);
+		WriteFixed(Out, TrailerMagic, 4);
+		FileSize += Out.size() - Start;
+	}
+
+	// --- FFlightRecordReader ---
+
+	bool FFlightRecordReader::Open(const uint8_t* InData, size_t InSize)
+	{
+		Close();
+
+		FByteReader Reader;
+		Reader.Data = InData;
+		Reader.Size = InData ? InSize : 0;
+		const uint32_t ReadMagic = static_cast<uint32_t>(Reader.ReadFixed(4));
+		const uint16_t ReadVersion = static_cast<uint16_t>(Reader.ReadFixed(2));
+		if (!Reader.bOk || ReadMagic != FFlightRecordWriter::Magic || ReadVersion != FFlightRecordWriter::Version)
+		{
+			return false;
+		}
+
+		Data = InData;
+		Size = InSize;
+		if (!ReadIndex())
+		{
+			RebuildIndex();
+		}
+		return true;
+	}
+
+	void FFlightRecordReader::Close()
+	{
+		Data = nullptr;
+		Size = 0;
+		bRecovered = false;
+		Chunks.clear();
+		Current.Reset();
+		Events.clear();
+		ChunkIndex = -1;
+		Cursor = 0;
+		ChunkEnd = 0;
+		FramesLeft = 0;
+		bHasFrame = false;
+	}
+
+	bool FFlightRecordReader::ReadIndex()
+	{
+		if (Size < FileHeaderSize + TrailerSize)
+		{
+			return false;
+		}
+
+		FByteReader Trailer;
+		Trailer.Data = Data + Size - TrailerSize;
+		Trailer.Size = TrailerSize;
+		const uint64_t IndexOffset = Trailer.ReadFixed(8);
+		if (Trailer.ReadFixed(4) != TrailerMagic || IndexOffset < FileHeaderSize || IndexOffset > Size - TrailerSize)
+		{
+			return false;
+		}
+
+		FByteReader Reader;
+		Reader.Data = Data;
+		Reader.Size = Size - TrailerSize;
+		Reader.Offset = static_cast<size_t>(IndexOffset);
+		const uint32_t ReadMagic = static_cast<uint32_t>(Reader.ReadFixed(4));
+		const uint64_t NumChunks = Reader.ReadFixed(4);
+		if (!Reader.bOk || ReadMagic != IndexMagic || NumChunks > (Reader.Size - Reader.Offset) / IndexEntrySize)
+		{
+			return false;
+		}
+
+		// Chunks must sit in order, back to back, between the header and the index
+		Chunks.resize(static_cast<size_t>(NumChunks));
+		uint64_t Expected = FileHeaderSize;
+		for (FRecordingChunkInfo& Info : Chunks)
+		{
+			Info.Offset = Reader.ReadFixed(8);
+			Info.Size = static_cast<uint32_t>(Reader.ReadFixed(4));
+			Info.FirstFrame = static_cast<uint32_t>(Reader.ReadFixed(4));
+			Info.NumFrames = static_cast<uint32_t>(Reader.ReadFixed(4));
+			Info.StartTime = TimeFromBits(Reader.ReadFixed(8));
+			Info.EndTime = TimeFromBits(Reader.ReadFixed(8));
+			if (Info.Offset != Expected || Info.Size < ChunkHeaderSize || Info.NumFrames == 0)
+			{
+				Chunks.clear();
+				return false;
+			}
+			Expected += Info.Size;
+		}
+		if (!Reader.bOk || Expected != IndexOffset)
+		{
+			Chunks.clear();
+			return false;
+		}
+		return true;
+	}
+
+	void FFlightRecordReader::RebuildIndex()
+	{
+		bRecovered = true;
+		Chunks.clear();
+
+		// Chunks were written whole, so only the last one can be short
+		size_t Offset = FileHeaderSize;
+		while (Size - Offset >= ChunkHeaderSize)
+		{
+			FByteReader Reader;
+			Reader.Data = Data + Offset;
+			Reader.Size = ChunkHeaderSize;
+			const uint32_t ReadMagic = static_cast<uint32_t>(Reader.ReadFixed(4));
+			const uint64_t PayloadSize = Reader.ReadFixed(4);
+			FRecordingChunkInfo Info;
+			Info.Offset = Offset;
+			Info.FirstFrame = static_cast<uint32_t>(Reader.ReadFixed(4));
+			Info.NumFrames = static_cast<uint32_t>(Reader.ReadFixed(4));
+			Info.StartTime = TimeFromBits(Reader.ReadFixed(8));
+			Info.EndTime = TimeFromBits(Reader.ReadFixed(8));
+			if (ReadMagic != ChunkMagic || Info.NumFrames == 0 || PayloadSize > Size - Offset - ChunkHeaderSize)
+			{
+				break;
+			}
+			Info.Size = static_cast<uint32_t>(ChunkHeaderSize + PayloadSize);
+			Chunks.push_back(Info);
+			Offset += Info.Size;
+		}
+	}
+
+	uint32_t FFlightRecordReader::GetNumFrames() const
+	{
+		return Chunks.empty() ? 0 : Chunks.back().FirstFrame + Chunks.back().NumFrames;
+	}
+
+	int FFlightRecordReader::FindChunk(double Time) const
+	{
+		if (Chunks.empty())
+		{
+			return -1;
+		}
+		const auto It = std::upper_bound(Chunks.begin(), Chunks.end(), Time,
+			[](double Value, const FRecordingChunkInfo& Info) { return Value < Info.StartTime; });
+		return std::max(static_cast<int>(It - Chunks.begin()) - 1, 0);
+	}
+
+	bool FFlightRecordReader::EnterChunk(int Index)
+	{
+		if (Index < 0 || Index >= static_cast<int>(Chunks.size()))
+		{
+			return false;
+		}
+		const FRecordingChunkInfo& Info = Chunks[Index];
+		ChunkIndex = Index;
+		Cursor = static_cast<size_t>(Info.Offset) + ChunkHeaderSize;
+		ChunkEnd = static_cast<size_t>(Info.Offset) + Info.Size;
+		FramesLeft = Info.NumFrames;
+		return true;
+	}
+
+	bool FFlightRecordReader::DecodeFrame()
+	{
+		if (FramesLeft == 0)
+		{
+			return false;
+		}
+
+		// A keyframe ignores the baseline; a delta needs the frame before it, which is Current
+		size_t BytesRead = 0;
+		if (!Codec.Decode(Data + Cursor, ChunkEnd - Cursor, bHasFrame ? &Current : nullptr, Decoding, &BytesRead))
+		{
+			FramesLeft = 0;
+			return false;
+		}
+		std::swap(Current, Decoding);
+		bHasFrame = true;
+
+		FByteReader Reader;
+		Reader.Data = Data;
+		Reader.Size = ChunkEnd;
+		Reader.Offset = Cursor + BytesRead;
+		if (!ReadEvents(Reader, Current.Time, Events))
+		{
+			Events.clear();
+			FramesLeft = 0;
+			return false;
+		}
+
+		Cursor = Reader.Offset;
+		--FramesLeft;
+		return true;
+	}
+
+	bool FFlightRecordReader::Next()
+	{
+		if (!Data)
+		{
+			return false;
+		}
+		if (FramesLeft == 0 && !EnterChunk(ChunkIndex + 1))
+		{
+			return false;
+		}
+		return DecodeFrame();
+	}
+
+	bool FFlightRecordReader::PeekNextTime(double& OutTime) const
+	{
+		if (!Data)
+		{
+			return false;
+		}
+		if (FramesLeft == 0)
+		{
+			if (ChunkIndex + 1 >= static_cast<int>(Chunks.size()))
+			{
+				return false;
+			}
+			OutTime = Chunks[ChunkIndex + 1].StartTime;
+			return true;
+		}
+		if (ChunkEnd - Cursor < SnapshotTimeOffset + 8)
+		{
+			return false;
+		}
+
+		FByteReader Reader;
+		Reader.Data = Data + Cursor + SnapshotTimeOffset;
+		Reader.Size = 8;
+		OutTime = TimeFromBits(Reader.ReadFixed(8));
+		return true;
+	}
+
+	bool FFlightRecordReader::Seek(double Time)
+	{
+		if (!EnterChunk(FindChunk(Time)) || !DecodeFrame())
+		{
+			return false;
+		}
+
+		double NextTime;
+		while (FramesLeft > 0 && PeekNextTime(NextTime) && NextTime <= Time)
+		{
+			if (!DecodeFrame())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
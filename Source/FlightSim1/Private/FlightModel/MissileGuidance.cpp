@@ -0,0 +1,411 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/MissileGuidance.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace FlightModel
+{
+	namespace
+	{
+		template<typename T, typename FunctionType>
+		void ForEachStream(FunctionType&& Function, std::vector<T>& First)
+		{
+			Function(First);
+		}
+
+		template<typename T, typename FunctionType, typename... RestType>
+		void ForEachStream(FunctionType&& Function, std::vector<T>& First, RestType&... Rest)
+		{
+			Function(First);
+			ForEachStream(Function, Rest...);
+		}
+	}
+
+	void FMissileProxySet::Reset()
+	{
+		X.clear();
+		Y.clear();
+		Z.clear();
+		VelocityX.clear();
+		VelocityY.clear();
+		VelocityZ.clear();
+		Radius.clear();
+		Owner.clear();
+	}
+
+	void FMissileProxySet::Reserve(int Num)
+	{
+		X.reserve(Num);
+		Y.reserve(Num);
+		Z.reserve(Num);
+		VelocityX.reserve(Num);
+		VelocityY.reserve(Num);
+		VelocityZ.reserve(Num);
+		Radius.reserve(Num);
+		Owner.reserve(Num);
+	}
+
+	void FMissileProxySet::Add(const FVec3d& Center, const FVec3d& Velocity, double InRadius, int InOwner)
+	{
+		X.push_back(static_cast<float>(Center.X));
+		Y.push_back(static_cast<float>(Center.Y));
+		Z.push_back(static_cast<float>(Center.Z));
+		VelocityX.push_back(static_cast<float>(Velocity.X));
+		VelocityY.push_back(static_cast<float>(Velocity.Y));
+		VelocityZ.push_back(static_cast<float>(Velocity.Z));
+		Radius.push_back(static_cast<float>(InRadius));
+		Owner.push_back(InOwner);
+	}
+
+	void FMissileBatch::Reserve(int Capacity)
+	{
+		auto ReserveStream = [Capacity](auto& Stream) { Stream.reserve(Capacity); };
+		ForEachStream(ReserveStream, PositionX, PositionY, PositionZ, VelocityX, VelocityY, VelocityZ, Age,
+			TargetX, TargetY, TargetZ, TargetVelocityX, TargetVelocityY, TargetVelocityZ, HasTarget,
+			NavigationConstant, MaxAcceleration, MotorAcceleration, BurnTime, DragCoefficient, FuzeRadius, ArmTime, MaxFlightTime,
+			Owner, ClosestFraction, MissDistance, StepStartX, StepStartY, StepStartZ, HitProxy);
+		Outcome.reserve(Capacity);
+	}
+
+	int FMissileBatch::Add(const FVec3d& Position, const FVec3d& Velocity, const FMissileParams& Params, int InOwner)
+	{
+		PositionX.push_back(static_cast<float>(Position.X));
+		PositionY.push_back(static_cast<float>(Position.Y));
+		PositionZ.push_back(static_cast<float>(Position.Z));
+		VelocityX.push_back(static_cast<float>(Velocity.X));
+		VelocityY.push_back(static_cast<float>(Velocity.Y));
+		VelocityZ.push_back(static_cast<float>(Velocity.Z));
+		Age.push_back(0.0f);
+
+		TargetX.push_back(0.0f);
+		TargetY.push_back(0.0f);
+		TargetZ.push_back(0.0f);
+		TargetVelocityX.push_back(0.0f);
+		TargetVelocityY.push_back(0.0f);
+		TargetVelocityZ.push_back(0.0f);
+		HasTarget.push_back(0.0f);
+
+		NavigationConstant.push_back(static_cast<float>(Params.NavigationConstant));
+		MaxAcceleration.push_back(static_cast<float>(Params.MaxG * 980.0));
+		MotorAcceleration.push_back(static_cast<float>(Params.MotorAcceleration));
+		BurnTime.push_back(static_cast<float>(Params.BurnTime));
+		DragCoefficient.push_back(static_cast<float>(Params.DragCoefficient));
+		FuzeRadius.push_back(static_cast<float>(Params.FuzeRadius));
+		ArmTime.push_back(static_cast<float>(Params.ArmTime));
+		MaxFlightTime.push_back(static_cast<float>(Params.MaxFlightTime));
+		Owner.push_back(InOwner);
+
+		Outcome.push_back(0);
+		ClosestFraction.push_back(0.0f);
+		MissDistance.push_back(0.0f);
+		StepStartX.push_back(0.0f);
+		StepStartY.push_back(0.0f);
+		StepStartZ.push_back(0.0f);
+		HitProxy.push_back(-1);
+		return Num() - 1;
+	}
+
+	void FMissileBatch::RemoveAtSwap(int Index)
+	{
+		auto SwapOut = [Index](auto& Stream)
+		{
+			Stream[Index] = Stream.back();
+			Stream.pop_back();
+		};
+		ForEachStream(SwapOut, PositionX, PositionY, PositionZ, VelocityX, VelocityY, VelocityZ, Age,
+			TargetX, TargetY, TargetZ, TargetVelocityX, TargetVelocityY, TargetVelocityZ, HasTarget,
+			NavigationConstant, MaxAcceleration, MotorAcceleration, BurnTime, DragCoefficient, FuzeRadius, ArmTime, MaxFlightTime,
+			Owner, ClosestFraction, MissDistance, StepStartX, StepStartY, StepStartZ, HitProxy);
+		SwapOut(Outcome);
+	}
+
+	void FMissileBatch::SetState(int Index, const FVec3d& Position, const FVec3d& Velocity, float InAge)
+	{
+		PositionX[Index] = StepStartX[Index] = static_cast<float>(Position.X);
+		PositionY[Index] = StepStartY[Index] = static_cast<float>(Position.Y);
+		PositionZ[Index] = StepStartZ[Index] = static_cast<float>(Position.Z);
+		VelocityX[Index] = static_cast<float>(Velocity.X);
+		VelocityY[Index] = static_cast<float>(Velocity.Y);
+		VelocityZ[Index] = static_cast<float>(Velocity.Z);
+		Age[Index] = InAge;
+	}
+
+	void FMissileBatch::SetTarget(int Index, const FVec3d& Position, const FVec3d& Velocity)
+	{
+		TargetX[Index] = static_cast<float>(Position.X);
+		TargetY[Index] = static_cast<float>(Position.Y);
+		TargetZ[Index] = static_cast<float>(Position.Z);
+		TargetVelocityX[Index] = static_cast<float>(Velocity.X);
+		TargetVelocityY[Index] = static_cast<float>(Velocity.Y);
+		TargetVelocityZ[Index] = static_cast<float>(Velocity.Z);
+		HasTarget[Index] = 1.0f;
+	}
+
+	void FMissileBatch::ClearTarget(int Index)
+	{
+		HasTarget[Index] = 0.0f;
+	}
+
+	bool FMissileBatch::AnyWithin(const FVec3d& Point, double Radius) const
+	{
+		const float X = static_cast<float>(Point.X);
+		const float Y = static_cast<float>(Point.Y);
+		const float Z = static_cast<float>(Point.Z);
+		const float RadiusSq = static_cast<float>(Radius * Radius);
+
+		const int Count = Num();
+		for (int i = 0; i < Count; ++i)
+		{
+			const float Dx = PositionX[i] - X;
+			const float Dy = PositionY[i] - Y;
+			const float Dz = PositionZ[i] - Z;
+			if (Dx * Dx + Dy * Dy + Dz * Dz < RadiusSq)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void FMissileBatch::Step(double DeltaTime, const FVec3d& Gravity, std::vector<FMissileEvent>& OutEvents)
+	{
+		static const FMissileProxySet NoProxies;
+		Step(DeltaTime, Gravity, NoProxies, OutEvents);
+	}
+
+	void FMissileBatch::Step(double DeltaTime, const FVec3d& Gravity, const FMissileProxySet& Proxies, std::vector<FMissileEvent>& OutEvents)
+	{
+		const int Count = Num();
+		if (Count == 0 || DeltaTime <= 0.0)
+		{
+			return;
+		}
+
+		const float Dt = static_cast<float>(DeltaTime);
+		const float Gx = static_cast<float>(Gravity.X);
+		const float Gy = static_cast<float>(Gravity.Y);
+		const float Gz = static_cast<float>(Gravity.Z);
+
+		float* Px = PositionX.data();
+		float* Py = PositionY.data();
+		float* Pz = PositionZ.data();
+		float* Vx = VelocityX.data();
+		float* Vy = VelocityY.data();
+		float* Vz = VelocityZ.data();
+		float* Ages = Age.data();
+		float* Tx = TargetX.data();
+		float* Ty = TargetY.data();
+		float* Tz = TargetZ.data();
+		const float* Tvx = TargetVelocityX.data();
+		const float* Tvy = TargetVelocityY.data();
+		const float* Tvz = TargetVelocityZ.data();
+		const float* Steer = HasTarget.data();
+		uint8_t* Outcomes = Outcome.data();
+		float* Fractions = ClosestFraction.data();
+		float* Misses = MissDistance.data();
+		float* Sx = StepStartX.data();
+		float* Sy = StepStartY.data();
+		float* Sz = StepStartZ.data();
+
+		for (int i = 0; i < Count; ++i)
+		{
+			// Line of sight and its rotation rate: Omega = (R x Vr) / |R|^2
+			const float Rx = Tx[i] - Px[i];
+			const float Ry = Ty[i] - Py[i];
+			const float Rz = Tz[i] - Pz[i];
+			const float Rvx = Tvx[i] - Vx[i];
+			const float Rvy = Tvy[i] - Vy[i];
+			const float Rvz = Tvz[i] - Vz[i];
+			const float InvRangeSq = 1.0f / (Rx * Rx + Ry * Ry + Rz * Rz + 1.0f);
+			const float Ox = (Ry * Rvz - Rz * Rvy) * InvRangeSq;
+			const float Oy = (Rz * Rvx - Rx * Rvz) * InvRangeSq;
+			const float Oz = (Rx * Rvy - Ry * Rvx) * InvRangeSq;
+
+			// Proportional navigation, a = N * (Omega x V): turns the velocity at N times the sight-line rate
+			const float N = NavigationConstant[i];
+			float Ax = N * (Oy * Vz[i] - Oz * Vy[i]);
+			float Ay = N * (Oz * Vx[i] - Ox * Vz[i]);
+			float Az = N * (Ox * Vy[i] - Oy * Vx[i]);
+
+			const float Speed = std::sqrt(Vx[i] * Vx[i] + Vy[i] * Vy[i] + Vz[i] * Vz[i]);
+			const float InvSpeed = 1.0f / std::max(Speed, 1.0f);
+			const float Hx = Vx[i] * InvSpeed;
+			const float Hy = Vy[i] * InvSpeed;
+			const float Hz = Vz[i] * InvSpeed;
+
+			// Only the lateral part steers; clamp it to the g-limit, and drop it with no target
+			const float Along = Ax * Hx + Ay * Hy + Az * Hz;
+			Ax -= Along * Hx;
+			Ay -= Along * Hy;
+			Az -= Along * Hz;
+			const float Lateral = std::sqrt(Ax * Ax + Ay * Ay + Az * Az);
+			const float Scale = Steer[i] * std::min(1.0f, MaxAcceleration[i] / std::max(Lateral, 1.0e-3f));
+
+			// Boost then coast, against quadratic drag
+			const float Thrust = Ages[i] < BurnTime[i] ? MotorAcceleration[i] : 0.0f;
+			const float Tangential = Thrust - DragCoefficient[i] * Speed * Speed;
+
+			Sx[i] = Px[i];
+			Sy[i] = Py[i];
+			Sz[i] = Pz[i];
+			Vx[i] += (Ax * Scale + Hx * Tangential + Gx) * Dt;
+			Vy[i] += (Ay * Scale + Hy * Tangential + Gy) * Dt;
+			Vz[i] += (Az * Scale + Hz * Tangential + Gz) * Dt;
+			Px[i] += Vx[i] * Dt;
+			Py[i] += Vy[i] * Dt;
+			Pz[i] += Vz[i] * Dt;
+			Ages[i] += Dt;
+
+			// Fuze on the closest approach over the whole step, relative to the target moving with it,
+			// so a 3 km/s head-on pass cannot skip over the fuze radius between frames
+			const float NextTx = Tx[i] + Tvx[i] * Dt;
+			const float NextTy = Ty[i] + Tvy[i] * Dt;
+			const float NextTz = Tz[i] + Tvz[i] * Dt;
+			const float R0x = Sx[i] - Tx[i];
+			const float R0y = Sy[i] - Ty[i];
+			const float R0z = Sz[i] - Tz[i];
+			const float Dx = (Px[i] - NextTx) - R0x;
+			const float Dy = (Py[i] - NextTy) - R0y;
+			const float Dz = (Pz[i] - NextTz) - R0z;
+			const float DSq = Dx * Dx + Dy * Dy + Dz * Dz;
+			float T = -(R0x * Dx + R0y * Dy + R0z * Dz) / std::max(DSq, 1.0e-6f);
+			T = std::min(std::max(T, 0.0f), 1.0f);
+			const float Cx = R0x + Dx * T;
+			const float Cy = R0y + Dy * T;
+			const float Cz = R0z + Dz * T;
+			const float Miss = std::sqrt(Cx * Cx + Cy * Cy + Cz * Cz);
+
+			Tx[i] = NextTx;
+			Ty[i] = NextTy;
+			Tz[i] = NextTz;
+
+			const bool bDetonate = (Steer[i] > 0.0f) & (Ages[i] >= ArmTime[i]) & (Miss <= FuzeRadius[i]);
+			const bool bExpire = Ages[i] >= MaxFlightTime[i];
+			Outcomes[i] = bDetonate ? 1 : (bExpire ? 2 : 0);
+			Fractions[i] = T;
+			Misses[i] = Miss;
+			HitProxy[i] = -1;
+		}
+
+		SweepProxies(Dt, Proxies);
+
+		for (int i = 0; i < Count; ++i)
+		{
+			if (Outcomes[i] == 0)
+			{
+				continue;
+			}
+
+			FMissileEvent& Event = OutEvents.emplace_back();
+			Event.Index = i;
+			Event.Type = Outcomes[i] == 1 ? EMissileEvent::Detonated : EMissileEvent::Expired;
+			const FVec3d Start(Sx[i], Sy[i], Sz[i]);
+			Event.Location = Start + (GetPosition(i) - Start) * (Outcomes[i] == 1 ? Fractions[i] : 1.0f);
+			Event.MissDistance = Misses[i];
+			Event.Proxy = HitProxy[i];
+		}
+	}
+
+	void FMissileBatch::SweepProxies(float Dt, const FMissileProxySet& Proxies)
+	{
+		const int NumProxies = Proxies.Num();
+		const int Count = Num();
+		if (NumProxies == 0)
+		{
+			return;
+		}
+
+		// Proxies are filed at their mid-step centre. A contact at any point in the step is then within
+		// radius + fuze + half the proxy's travel + half the missile's of the missile's mid-step point.
+		ProxyMidX.resize(NumProxies);
+		ProxyMidY.resize(NumProxies);
+		ProxyMidZ.resize(NumProxies);
+		float MaxProxyReach = 0.0f;
+		for (int p = 0; p < NumProxies; ++p)
+		{
+			const float Hx = 0.5f * Proxies.VelocityX[p] * Dt;
+			const float Hy = 0.5f * Proxies.VelocityY[p] * Dt;
+			const float Hz = 0.5f * Proxies.VelocityZ[p] * Dt;
+			ProxyMidX[p] = Proxies.X[p] + Hx;
+			ProxyMidY[p] = Proxies.Y[p] + Hy;
+			ProxyMidZ[p] = Proxies.Z[p] + Hz;
+			MaxProxyReach = std::max(MaxProxyReach, Proxies.Radius[p] + std::sqrt(Hx * Hx + Hy * Hy + Hz * Hz));
+		}
+
+		float MaxMissileReach = 0.0f;
+		for (int i = 0; i < Count; ++i)
+		{
+			const float Mx = PositionX[i] - StepStartX[i];
+			const float My = PositionY[i] - StepStartY[i];
+			const float Mz = PositionZ[i] - StepStartZ[i];
+			MaxMissileReach = std::max(MaxMissileReach, FuzeRadius[i] + 0.5f * std::sqrt(Mx * Mx + My * My + Mz * Mz));
+		}
+
+		ProxyGrid.Build(ProxyMidX.data(), ProxyMidY.data(), ProxyMidZ.data(), NumProxies, MaxProxyReach + MaxMissileReach);
+
+		for (int i = 0; i < Count; ++i)
+		{
+			const float Sx = StepStartX[i];
+			const float Sy = StepStartY[i];
+			const float Sz = StepStartZ[i];
+			const float Mx = PositionX[i] - Sx;
+			const float My = PositionY[i] - Sy;
+			const float Mz = PositionZ[i] - Sz;
+
+			int NumCandidates = 0;
+			const int* Candidates = ProxyGrid.Find(Sx + 0.5f * Mx, Sy + 0.5f * My, Sz + 0.5f * Mz, NumCandidates);
+			if (NumCandidates == 0)
+			{
+				continue;
+			}
+
+			const float Fuze = Age[i] >= ArmTime[i] ? FuzeRadius[i] : 0.0f;
+			int Best = -1;
+			float BestFraction = Outcome[i] == 1 ? ClosestFraction[i] : 2.0f;
+			float BestMissSq = 0.0f;
+
+			// Closest approach of the missile to each proxy over the step, both moving in straight lines:
+			// relative start R0, relative displacement D, fraction T minimising |R0 + D T|
+			for (int Entry = 0; Entry < NumCandidates; ++Entry)
+			{
+				const int p = Candidates[Entry];
+				if (Proxies.Owner[p] == Owner[i])
+				{
+					continue;
+				}
+
+				const float R0x = Sx - Proxies.X[p];
+				const float R0y = Sy - Proxies.Y[p];
+				const float R0z = Sz - Proxies.Z[p];
+				const float Dx = Mx - Proxies.VelocityX[p] * Dt;
+				const float Dy = My - Proxies.VelocityY[p] * Dt;
+				const float Dz = Mz - Proxies.VelocityZ[p] * Dt;
+				const float DSq = Dx * Dx + Dy * Dy + Dz * Dz;
+				float T = -(R0x * Dx + R0y * Dy + R0z * Dz) / std::max(DSq, 1.0e-6f);
+				T = std::min(std::max(T, 0.0f), 1.0f);
+				const float Ex = R0x + Dx * T;
+				const float Ey = R0y + Dy * T;
+				const float Ez = R0z + Dz * T;
+				const float MissSq = Ex * Ex + Ey * Ey + Ez * Ez;
+				const float Reach = Proxies.Radius[p] + Fuze;
+				if (MissSq <= Reach * Reach && T < BestFraction)
+				{
+					Best = p;
+					BestFraction = T;
+					BestMissSq = MissSq;
+				}
+			}
+
+			// Reached a proxy before the target fuze, if that fired at all
+			if (Best >= 0)
+			{
+				Outcome[i] = 1;
+				ClosestFraction[i] = BestFraction;
+				MissDistance[i] = std::sqrt(BestMissSq);
+				HitProxy[i] = Best;
+			}
+		}
+	}
+}
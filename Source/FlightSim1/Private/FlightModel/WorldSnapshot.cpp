@@ -0,0 +1,453 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightModel/WorldSnapshot.h"
+#include "FlightModel/ByteStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace FlightModel
+{
+	namespace
+	{
+		// Steps per unit. Positions, velocities, health and times are powers of two, so they come back exactly
+		constexpr double PositionScale = 64.0;
+		constexpr double VelocityScale = 16.0;
+		constexpr double AngularVelocityScale = 1024.0;
+		constexpr double AttitudeScale = 32767.0;
+		constexpr double ControlScale = 4095.0;
+		constexpr double HealthScale = 64.0;
+		constexpr double TimeScale = 1024.0;
+		constexpr double LockProgressScale = 255.0;
+		constexpr double MaxTimeSinceFire = 60.0;
+
+		// Position steps covered in a second at one velocity step
+		constexpr int64_t PositionStepsPerVelocityStep = 4;
+		static_assert(PositionScale == VelocityScale * PositionStepsPerVelocityStep, "prediction assumes these scales");
+
+		// Prediction is skipped past these, so the product stays inside 64 bits
+		constexpr int64_t MaxPredictedVelocity = 0x7FFFFFFF;
+		constexpr int64_t MaxPredictedMicros = 100000000;
+
+		// Ids beyond this are written in full rather than matched against the baseline
+		constexpr int MaxMatchedId = 1 << 20;
+
+		constexpr uint16_t FlagDelta = 1;
+
+		enum EAircraftField
+		{
+			AircraftPosition = 0,
+			AircraftAttitude = 3,
+			AircraftVelocity = 7,
+			AircraftAngularVelocity = 10,
+			AircraftThrottle = 13,
+			AircraftPitch,
+			AircraftRoll,
+			AircraftYaw,
+			AircraftHealth,
+			AircraftTimeSinceFire,
+			AircraftAIState,
+			AircraftEvasionTimeLeft,
+			AircraftLockTarget,
+			AircraftLockProgress,
+			AircraftFlags,
+			AircraftGeneration,
+			NumAircraftFields
+		};
+
+		enum EMissileField
+		{
+			MissileOwner = 0,
+			MissileTarget,
+			MissilePosition,
+			MissileVelocity = MissilePosition + 3,
+			MissileAge = MissileVelocity + 3,
+			MissileGeneration,
+			NumMissileFields
+		};
+
+		static_assert(NumAircraftFields <= 32 && NumMissileFields <= 32, "a field mask is 32 bits");
+
+		constexpr int64_t FlagLocked = 1;
+		constexpr int64_t FlagFiring = 2;
+
+		// Rounds half away from zero, the same on every platform
+		int64_t DivideRounded(int64_t Value, int64_t Divisor)
+		{
+			return Value >= 0 ? (Value + Divisor / 2) / Divisor : -((-Value + Divisor / 2) / Divisor);
+		}
+
+		void ToFields(const FAircraftSnapshot& Aircraft, int64_t* Fields)
+		{
+			Fields[AircraftPosition + 0] = ToSteps(Aircraft.Position.X, PositionScale);
+			Fields[AircraftPosition + 1] = ToSteps(Aircraft.Position.Y, PositionScale);
+			Fields[AircraftPosition + 2] = ToSteps(Aircraft.Position.Z, PositionScale);
+
+			// q and -q are the same rotation; W kept non-negative so the sign never flips between snapshots
+			const double Sign = Aircraft.Attitude.W < 0.0 ? -1.0 : 1.0;
+			Fields[AircraftAttitude + 0] = ToSteps(Sign * Aircraft.Attitude.X, AttitudeScale);
+			Fields[AircraftAttitude + 1] = ToSteps(Sign * Aircraft.Attitude.Y, AttitudeScale);
+			Fields[AircraftAttitude + 2] = ToSteps(Sign * Aircraft.Attitude.Z, AttitudeScale);
+			Fields[AircraftAttitude + 3] = ToSteps(Sign * Aircraft.Attitude.W, AttitudeScale);
+
+			Fields[AircraftVelocity + 0] = ToSteps(Aircraft.LinearVelocity.X, VelocityScale);
+			Fields[AircraftVelocity + 1] = ToSteps(Aircraft.LinearVelocity.Y, VelocityScale);
+			Fields[AircraftVelocity + 2] = ToSteps(Aircraft.LinearVelocity.Z, VelocityScale);
+			Fields[AircraftAngularVelocity + 0] = ToSteps(Aircraft.AngularVelocity.X, AngularVelocityScale);
+			Fields[AircraftAngularVelocity + 1] = ToSteps(Aircraft.AngularVelocity.Y, AngularVelocityScale);
+			Fields[AircraftAngularVelocity + 2] = ToSteps(Aircraft.AngularVelocity.Z, AngularVelocityScale);
+
+			Fields[AircraftThrottle] = ToSteps(std::clamp(Aircraft.Throttle, 0.0f, 1.0f), ControlScale);
+			Fields[AircraftPitch] = ToSteps(std::clamp(Aircraft.Pitch, -1.0f, 1.0f), ControlScale);
+			Fields[AircraftRoll] = ToSteps(std::clamp(Aircraft.Roll, -1.0f, 1.0f), ControlScale);
+			Fields[AircraftYaw] = ToSteps(std::clamp(Aircraft.Yaw, -1.0f, 1.0f), ControlScale);
+
+			Fields[AircraftHealth] = ToSteps(Aircraft.Health, HealthScale);
+			Fields[AircraftTimeSinceFire] = ToSteps(std::clamp(static_cast<double>(Aircraft.TimeSinceFire), 0.0, MaxTimeSinceFire), TimeScale);
+			Fields[AircraftAIState] = Aircraft.AIState;
+			Fields[AircraftEvasionTimeLeft] = ToSteps(std::max(Aircraft.EvasionTimeLeft, 0.0f), TimeScale);
+			Fields[AircraftLockTarget] = Aircraft.LockTarget >= 0 ? int64_t(Aircraft.LockTarget) + 1 : 0;
+			Fields[AircraftLockProgress] = ToSteps(std::clamp(Aircraft.LockProgress, 0.0f, 1.0f), LockProgressScale);
+			Fields[AircraftFlags] = (Aircraft.bLocked ? FlagLocked : 0) | (Aircraft.bFiring ? FlagFiring : 0);
+			Fields[AircraftGeneration] = Aircraft.Generation;
+		}
+
+		void FromFields(const int64_t* Fields, FAircraftSnapshot& Aircraft)
+		{
+			Aircraft.Position = FVec3d(FromSteps(Fields[AircraftPosition + 0], PositionScale), FromSteps(Fields[AircraftPosition + 1], PositionScale),
+				FromSteps(Fields[AircraftPosition + 2], PositionScale));
+
+			// Not renormalized, so quantizing again gives the same steps
+			Aircraft.Attitude = FQuatd(FromSteps(Fields[AircraftAttitude + 0], AttitudeScale), FromSteps(Fields[AircraftAttitude + 1], AttitudeScale),
+				FromSteps(Fields[AircraftAttitude + 2], AttitudeScale), FromSteps(Fields[AircraftAttitude + 3], AttitudeScale));
+
+			Aircraft.LinearVelocity = FVec3d(FromSteps(Fields[AircraftVelocity + 0], VelocityScale), FromSteps(Fields[AircraftVelocity + 1], VelocityScale),
+				FromSteps(Fields[AircraftVelocity + 2], VelocityScale));
+			Aircraft.AngularVelocity = FVec3d(FromSteps(Fields[AircraftAngularVelocity + 0], AngularVelocityScale),
+				FromSteps(Fields[AircraftAngularVelocity + 1], AngularVelocityScale), FromSteps(Fields[AircraftAngularVelocity + 2], AngularVelocityScale));
+
+			Aircraft.Throttle = FromStepsF(Fields[AircraftThrottle], ControlScale);
+			Aircraft.Pitch = FromStepsF(Fields[AircraftPitch], ControlScale);
+			Aircraft.Roll = FromStepsF(Fields[AircraftRoll], ControlScale);
+			Aircraft.Yaw = FromStepsF(Fields[AircraftYaw], ControlScale);
+
+			Aircraft.Health = FromStepsF(Fields[AircraftHealth], HealthScale);
+			Aircraft.TimeSinceFire = FromStepsF(Fields[AircraftTimeSinceFire], TimeScale);
+			Aircraft.AIState = static_cast<uint8_t>(Fields[AircraftAIState]);
+			Aircraft.EvasionTimeLeft = FromStepsF(Fields[AircraftEvasionTimeLeft], TimeScale);
+			Aircraft.LockTarget = static_cast<int>(Fields[AircraftLockTarget] - 1);
+			Aircraft.LockProgress = FromStepsF(Fields[AircraftLockProgress], LockProgressScale);
+			Aircraft.bLocked = (Fields[AircraftFlags] & FlagLocked) != 0;
+			Aircraft.bFiring = (Fields[AircraftFlags] & FlagFiring) != 0;
+			Aircraft.Generation = static_cast<uint32_t>(Fields[AircraftGeneration]);
+		}
+
+		void ToFields(const FMissileSnapshot& Missile, int64_t* Fields)
+		{
+			Fields[MissileOwner] = Missile.Owner >= 0 ? int64_t(Missile.Owner) + 1 : 0;
+			Fields[MissileTarget] = Missile.Target >= 0 ? int64_t(Missile.Target) + 1 : 0;
+			Fields[MissilePosition + 0] = ToSteps(Missile.Position.X, PositionScale);
+			Fields[MissilePosition + 1] = ToSteps(Missile.Position.Y, PositionScale);
+			Fields[MissilePosition + 2] = ToSteps(Missile.Position.Z, PositionScale);
+			Fields[MissileVelocity + 0] = ToSteps(Missile.Velocity.X, VelocityScale);
+			Fields[MissileVelocity + 1] = ToSteps(Missile.Velocity.Y, VelocityScale);
+			Fields[MissileVelocity + 2] = ToSteps(Missile.Velocity.Z, VelocityScale);
+			Fields[MissileAge] = ToSteps(std::max(Missile.Age, 0.0f), TimeScale);
+			Fields[MissileGeneration] = Missile.Generation;
+		}
+
+		void FromFields(const int64_t* Fields, FMissileSnapshot& Missile)
+		{
+			Missile.Owner = static_cast<int>(Fields[MissileOwner] - 1);
+			Missile.Target = static_cast<int>(Fields[MissileTarget] - 1);
+			Missile.Position = FVec3d(FromSteps(Fields[MissilePosition + 0], PositionScale), FromSteps(Fields[MissilePosition + 1], PositionScale),
+				FromSteps(Fields[MissilePosition + 2], PositionScale));
+			Missile.Velocity = FVec3d(FromSteps(Fields[MissileVelocity + 0], VelocityScale), FromSteps(Fields[MissileVelocity + 1], VelocityScale),
+				FromSteps(Fields[MissileVelocity + 2], VelocityScale));
+			Missile.Age = FromStepsF(Fields[MissileAge], TimeScale);
+			Missile.Generation = static_cast<uint32_t>(Fields[MissileGeneration]);
+		}
+
+		// What a delta is taken against: the baseline's fields, with its position carried on by its velocity
+		template<int NumFields>
+		void MakeReference(const int64_t* Base, int PositionField, int VelocityField, int64_t DeltaMicros, int64_t* Reference)
+		{
+			std::memcpy(Reference, Base, sizeof(int64_t) * NumFields);
+			for (int Axis = 0; Axis < 3; ++Axis)
+			{
+				const int64_t Velocity = Base[VelocityField + Axis];
+				if (Velocity >= -MaxPredictedVelocity && Velocity <= MaxPredictedVelocity)
+				{
+					Reference[PositionField + Axis] += DivideRounded(Velocity * PositionStepsPerVelocityStep * DeltaMicros, 1000000);
+				}
+			}
+		}
+
+		// Whole microseconds between the two snapshots, which both ends compute from the same stored times
+		int64_t DeltaMicros(double Time, double BaselineTime)
+		{
+			const double Micros = (Time - BaselineTime) * 1.0e6;
+			if (!(Micros > 0.0))
+			{
+				return 0;
+			}
+			return Micros >= double(MaxPredictedMicros) ? MaxPredictedMicros : std::llround(Micros);
+		}
+
+		template<int NumFields>
+		void WriteEntity(std::vector<uint8_t>& Out, int Id, const int64_t* Fields, const int64_t* Reference)
+		{
+			uint32_t Mask = 0;
+			for (int i = 0; i < NumFields; ++i)
+			{
+				Mask |= uint32_t(Fields[i] != Reference[i]) << i;
+			}
+
+			// Unchanged fields cost nothing beyond their bit in the mask
+			WriteVarint(Out, (uint64_t(uint32_t(Id)) << 1) | (Reference[NumFields] != 0 ? 1 : 0));
+			WriteVarint(Out, Mask);
+			for (int i = 0; i < NumFields; ++i)
+			{
+				if (Mask & (1u << i))
+				{
+					WriteVarint(Out, ZigZag(Fields[i] - Reference[i]));
+				}
+			}
+		}
+
+		template<int NumFields>
+		bool ReadFields(FByteReader& Reader, const int64_t* Reference, int64_t* Fields)
+		{
+			const uint64_t Mask = Reader.ReadVarint();
+			if (Mask >> NumFields)
+			{
+				return false;
+			}
+			for (int i = 0; i < NumFields; ++i)
+			{
+				Fields[i] = Reference[i];
+				if (Mask & (uint64_t(1) << i))
+				{
+					Fields[i] += UnZigZag(Reader.ReadVarint());
+				}
+			}
+			return Reader.bOk;
+		}
+
+		// Files each entity's index under its id; ids out of range are simply never matched
+		template<typename EntityType>
+		void IndexById(const std::vector<EntityType>& Entities, std::vector<int>& Index)
+		{
+			for (int i = 0; i < static_cast<int>(Entities.size()); ++i)
+			{
+				const int Id = Entities[i].Id;
+				if (Id >= 0 && Id < MaxMatchedId)
+				{
+					if (Id >= static_cast<int>(Index.size()))
+					{
+						Index.resize(Id + 1, -1);
+					}
+					Index[Id] = i;
+				}
+			}
+		}
+
+		template<typename EntityType>
+		void ClearIndex(const std::vector<EntityType>& Entities, std::vector<int>& Index)
+		{
+			for (const EntityType& Entity : Entities)
+			{
+				if (Entity.Id >= 0 && Entity.Id < static_cast<int>(Index.size()))
+				{
+					Index[Entity.Id] = -1;
+				}
+			}
+		}
+
+		int FindIndex(const std::vector<int>& Index, int Id)
+		{
+			return Id >= 0 && Id < static_cast<int>(Index.size()) ? Index[Id] : -1;
+		}
+
+		template<typename EntityType, int NumFields>
+		void EncodeEntities(const std::vector<EntityType>& Entities, const std::vector<EntityType>* Baseline, const std::vector<int>& Index,
+			int PositionField, int VelocityField, int64_t Micros, std::vector<uint8_t>& Out)
+		{
+			// One spare slot past the fields says whether a baseline was used
+			int64_t Fields[NumFields];
+			int64_t Base[NumFields];
+			int64_t Reference[NumFields + 1];
+			for (const EntityType& Entity : Entities)
+			{
+				ToFields(Entity, Fields);
+				const int BaseIndex = Baseline ? FindIndex(Index, Entity.Id) : -1;
+				if (BaseIndex >= 0)
+				{
+					ToFields((*Baseline)[BaseIndex], Base);
+					MakeReference<NumFields>(Base, PositionField, VelocityField, Micros, Reference);
+					Reference[NumFields] = 1;
+				}
+				else
+				{
+					std::fill(Reference, Reference + NumFields + 1, 0);
+				}
+				WriteEntity<NumFields>(Out, Entity.Id, Fields, Reference);
+			}
+		}
+
+		template<typename EntityType, int NumFields>
+		bool DecodeEntities(FByteReader& Reader, const std::vector<EntityType>* Baseline, const std::vector<int>& Index,
+			int PositionField, int VelocityField, int64_t Micros, std::vector<EntityType>& Out)
+		{
+			int64_t Fields[NumFields];
+			int64_t Base[NumFields];
+			int64_t Reference[NumFields];
+			for (EntityType& Entity : Out)
+			{
+				const uint64_t Key = Reader.ReadVarint();
+				Entity.Id = static_cast<int>(static_cast<uint32_t>(Key >> 1));
+				if (Key & 1)
+				{
+					const int BaseIndex = Baseline ? FindIndex(Index, Entity.Id) : -1;
+					if (BaseIndex < 0)
+					{
+						return false;
+					}
+					ToFields((*Baseline)[BaseIndex], Base);
+					MakeReference<NumFields>(Base, PositionField, VelocityField, Micros, Reference);
+				}
+				else
+				{
+					std::fill(Reference, Reference + NumFields, 0);
+				}
+
+				if (!ReadFields<NumFields>(Reader, Reference, Fields))
+				{
+					return false;
+				}
+				FromFields(Fields, Entity);
+			}
+			return Reader.bOk;
+		}
+	}
+
+	void FWorldSnapshot::Reset()
+	{
+		Frame = 0;
+		Time = 0.0;
+		Aircraft.clear();
+		Missiles.clear();
+	}
+
+	void FWorldSnapshotCodec::Encode(const FWorldSnapshot& Snapshot, const FWorldSnapshot* Baseline, std::vector<uint8_t>& Out)
+	{
+		uint64_t TimeBits;
+		std::memcpy(&TimeBits, &Snapshot.Time, sizeof(TimeBits));
+
+		WriteFixed(Out, Magic, 4);
+		WriteFixed(Out, Version, 2);
+		WriteFixed(Out, Baseline ? FlagDelta : 0, 2);
+		WriteFixed(Out, Snapshot.Frame, 4);
+		WriteFixed(Out, Baseline ? Baseline->Frame : 0, 4);
+		WriteFixed(Out, TimeBits, 8);
+		WriteVarint(Out, Snapshot.Aircraft.size());
+		WriteVarint(Out, Snapshot.Missiles.size());
+
+		const int64_t Micros = Baseline ? DeltaMicros(Snapshot.Time, Baseline->Time) : 0;
+		if (Baseline)
+		{
+			IndexById(Baseline->Aircraft, BaselineAircraft);
+			IndexById(Baseline->Missiles, BaselineMissiles);
+		}
+
+		EncodeEntities<FAircraftSnapshot, NumAircraftFields>(Snapshot.Aircraft, Baseline ? &Baseline->Aircraft : nullptr, BaselineAircraft,
+			AircraftPosition, AircraftVelocity, Micros, Out);
+		EncodeEntities<FMissileSnapshot, NumMissileFields>(Snapshot.Missiles, Baseline ? &Baseline->Missiles : nullptr, BaselineMissiles,
+			MissilePosition, MissileVelocity, Micros, Out);
+
+		if (Baseline)
+		{
+			ClearIndex(Baseline->Aircraft, BaselineAircraft);
+			ClearIndex(Baseline->Missiles, BaselineMissiles);
+		}
+	}
+
+	bool FWorldSnapshotCodec::Decode(const uint8_t* Data, size_t Size, const FWorldSnapshot* Baseline, FWorldSnapshot& Out, size_t* OutBytesRead)
+	{
+		FByteReader Reader;
+		Reader.Data = Data;
+		Reader.Size = Data ? Size : 0;
+
+		const uint32_t ReadMagic = static_cast<uint32_t>(Reader.ReadFixed(4));
+		const uint16_t ReadVersion = static_cast<uint16_t>(Reader.ReadFixed(2));
+		const uint16_t Flags = static_cast<uint16_t>(Reader.ReadFixed(2));
+		const uint32_t Frame = static_cast<uint32_t>(Reader.ReadFixed(4));
+		const uint32_t BaselineFrame = static_cast<uint32_t>(Reader.ReadFixed(4));
+		const uint64_t TimeBits = Reader.ReadFixed(8);
+		const uint64_t NumAircraft = Reader.ReadVarint();
+		const uint64_t NumMissiles = Reader.ReadVarint();
+		if (!Reader.bOk || ReadMagic != Magic || ReadVersion != Version)
+		{
+			return false;
+		}
+
+		const bool bDelta = (Flags & FlagDelta) != 0;
+		if (bDelta && (!Baseline || Baseline == &Out || Baseline->Frame != BaselineFrame))
+		{
+			return false;
+		}
+
+		// Every entity takes at least two bytes, which bounds what a corrupt count can make us allocate
+		const uint64_t Remaining = Reader.Size - Reader.Offset;
+		if (NumAircraft > Remaining / 2 || NumMissiles > Remaining / 2 || NumAircraft + NumMissiles > Remaining / 2)
+		{
+			return false;
+		}
+
+		Out.Frame = Frame;
+		std::memcpy(&Out.Time, &TimeBits, sizeof(TimeBits));
+		Out.Aircraft.resize(static_cast<size_t>(NumAircraft));
+		Out.Missiles.resize(static_cast<size_t>(NumMissiles));
+
+		const FWorldSnapshot* Base = bDelta ? Baseline : nullptr;
+		const int64_t Micros = Base ? DeltaMicros(Out.Time, Base->Time) : 0;
+		if (Base)
+		{
+			IndexById(Base->Aircraft, BaselineAircraft);
+			IndexById(Base->Missiles, BaselineMissiles);
+		}
+
+		const bool bOk = DecodeEntities<FAircraftSnapshot, NumAircraftFields>(Reader, Base ? &Base->Aircraft : nullptr, BaselineAircraft,
+				AircraftPosition, AircraftVelocity, Micros, Out.Aircraft)
+			&& DecodeEntities<FMissileSnapshot, NumMissileFields>(Reader, Base ? &Base->Missiles : nullptr, BaselineMissiles,
+				MissilePosition, MissileVelocity, Micros, Out.Missiles);
+
+		if (Base)
+		{
+			ClearIndex(Base->Aircraft, BaselineAircraft);
+			ClearIndex(Base->Missiles, BaselineMissiles);
+		}
+
+		if (bOk && OutBytesRead)
+		{
+			*OutBytesRead = Reader.Offset;
+		}
+		return bOk;
+	}
+
+	void FWorldSnapshotCodec::Quantize(FWorldSnapshot& Snapshot)
+	{
+		int64_t Fields[NumAircraftFields];
+		for (FAircraftSnapshot& Aircraft : Snapshot.Aircraft)
+		{
+			ToFields(Aircraft, Fields);
+			FromFields(Fields, Aircraft);
+		}
+		for (FMissileSnapshot& Missile : Snapshot.Missiles)
+		{
+			ToFields(Missile, Fields);
+			FromFields(Fields, Missile);
+		}
+	}
+}
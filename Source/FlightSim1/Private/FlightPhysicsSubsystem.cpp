@@ -0,0 +1,666 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightPhysicsSubsystem.h"
+#include "FlightSim1.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/VectorRegister.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include "PBDRigidsSolver.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+
+DECLARE_CYCLE_STAT(TEXT("Aero Gather"), STAT_FlightAeroGather, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Aero Kernel"), STAT_FlightAeroKernel, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Aero Apply"), STAT_FlightAeroApply, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Aero Physics Step"), STAT_FlightAeroPhysicsStep, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Aero Marshal (GT)"), STAT_FlightAeroMarshal, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aero Bodies"), STAT_FlightAeroBodies, STATGROUP_FlightSim);
+
+// --- FAeroBatch ---
+
+void FAeroBatch::SetNum(int32 NewNum)
+{
+	NumAircraft = NewNum;
+	const int32 Padded = Align(NewNum, 4);
+
+	FAlignedFloatArray* Arrays[] = {
+		&VelX, &VelY, &VelZ, &FwdX, &FwdY, &FwdZ, &RightX, &RightY, &RightZ, &UpX, &UpY, &UpZ,
+		&SpeedScale, &Lift, &Drag, &LiftMode, &Thrust, &Pitch, &Roll, &Yaw,
+		&ForceX, &ForceY, &ForceZ, &TorqueX, &TorqueY, &TorqueZ, &Speed
+	};
+
+	for (FAlignedFloatArray* Array : Arrays)
+	{
+		Array->SetNumZeroed(Padded, EAllowShrinking::No);
+		for (int32 i = NewNum; i < Padded; ++i)
+		{
+			(*Array)[i] = 0.0f;
+		}
+	}
+}
+
+void FAeroBatch::Run()
+{
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+	const VectorRegister4Float Tiny = VectorSetFloat1(UE_SMALL_NUMBER);
+
+	const int32 Padded = Align(NumAircraft, 4);
+	for (int32 i = 0; i < Padded; i += 4)
+	{
+		const VectorRegister4Float Vx = VectorLoadAligned(&VelX[i]);
+		const VectorRegister4Float Vy = VectorLoadAligned(&VelY[i]);
+		const VectorRegister4Float Vz = VectorLoadAligned(&VelZ[i]);
+		const VectorRegister4Float Fx = VectorLoadAligned(&FwdX[i]);
+		const VectorRegister4Float Fy = VectorLoadAligned(&FwdY[i]);
+		const VectorRegister4Float Fz = VectorLoadAligned(&FwdZ[i]);
+		const VectorRegister4Float Rx = VectorLoadAligned(&RightX[i]);
+		const VectorRegister4Float Ry = VectorLoadAligned(&RightY[i]);
+		const VectorRegister4Float Rz = VectorLoadAligned(&RightZ[i]);
+		const VectorRegister4Float Ux = VectorLoadAligned(&UpX[i]);
+		const VectorRegister4Float Uy = VectorLoadAligned(&UpY[i]);
+		const VectorRegister4Float Uz = VectorLoadAligned(&UpZ[i]);
+
+		// Speed and safe velocity direction (zero when the aircraft is at rest)
+		const VectorRegister4Float SpeedSq = VectorMultiplyAdd(Vx, Vx, VectorMultiplyAdd(Vy, Vy, VectorMultiply(Vz, Vz)));
+		const VectorRegister4Float Moving = VectorCompareGT(SpeedSq, Tiny);
+		const VectorRegister4Float InvSpeed = VectorSelect(Moving, VectorReciprocalSqrtAccurate(SpeedSq), Zero);
+		const VectorRegister4Float SpeedV = VectorMultiply(SpeedSq, InvSpeed);
+		const VectorRegister4Float Nx = VectorMultiply(Vx, InvSpeed);
+		const VectorRegister4Float Ny = VectorMultiply(Vy, InvSpeed);
+		const VectorRegister4Float Nz = VectorMultiply(Vz, InvSpeed);
+
+		// Dynamic pressure term in the aircraft's own airspeed units
+		const VectorRegister4Float Scaled = VectorMultiply(SpeedV, VectorLoadAligned(&SpeedScale[i]));
+		const VectorRegister4Float Q = VectorMultiply(Scaled, Scaled);
+
+		// Lift direction: normalize(Velocity x Right) or body up
+		const VectorRegister4Float Cx = VectorNegateMultiplyAdd(Nz, Ry, VectorMultiply(Ny, Rz));
+		const VectorRegister4Float Cy = VectorNegateMultiplyAdd(Nx, Rz, VectorMultiply(Nz, Rx));
+		const VectorRegister4Float Cz = VectorNegateMultiplyAdd(Ny, Rx, VectorMultiply(Nx, Ry));
+		const VectorRegister4Float CrossSq = VectorMultiplyAdd(Cx, Cx, VectorMultiplyAdd(Cy, Cy, VectorMultiply(Cz, Cz)));
+		const VectorRegister4Float InvCross = VectorSelect(VectorCompareGT(CrossSq, Tiny), VectorReciprocalSqrtAccurate(CrossSq), Zero);
+		const VectorRegister4Float UseVelocityNormal = VectorCompareGT(VectorLoadAligned(&LiftMode[i]), Half);
+		const VectorRegister4Float Lx = VectorSelect(UseVelocityNormal, VectorMultiply(Cx, InvCross), Ux);
+		const VectorRegister4Float Ly = VectorSelect(UseVelocityNormal, VectorMultiply(Cy, InvCross), Uy);
+		const VectorRegister4Float Lz = VectorSelect(UseVelocityNormal, VectorMultiply(Cz, InvCross), Uz);
+
+		const VectorRegister4Float LiftMag = VectorMultiply(Q, VectorLoadAligned(&Lift[i]));
+		const VectorRegister4Float DragMag = VectorMultiply(Q, VectorLoadAligned(&Drag[i]));
+		const VectorRegister4Float ThrustMag = VectorLoadAligned(&Thrust[i]);
+
+		// Force = Forward * Thrust + LiftDir * Lift - VelocityDir * Drag
+		VectorStoreAligned(VectorNegateMultiplyAdd(Nx, DragMag, VectorMultiplyAdd(Lx, LiftMag, VectorMultiply(Fx, ThrustMag))), &ForceX[i]);
+		VectorStoreAligned(VectorNegateMultiplyAdd(Ny, DragMag, VectorMultiplyAdd(Ly, LiftMag, VectorMultiply(Fy, ThrustMag))), &ForceY[i]);
+		VectorStoreAligned(VectorNegateMultiplyAdd(Nz, DragMag, VectorMultiplyAdd(Lz, LiftMag, VectorMultiply(Fz, ThrustMag))), &ForceZ[i]);
+
+		// Torque = Right * Pitch + Forward * Roll + Up * Yaw
+		const VectorRegister4Float P = VectorLoadAligned(&Pitch[i]);
+		const VectorRegister4Float R = VectorLoadAligned(&Roll[i]);
+		const VectorRegister4Float Y = VectorLoadAligned(&Yaw[i]);
+		VectorStoreAligned(VectorMultiplyAdd(Ux, Y, VectorMultiplyAdd(Fx, R, VectorMultiply(Rx, P))), &TorqueX[i]);
+		VectorStoreAligned(VectorMultiplyAdd(Uy, Y, VectorMultiplyAdd(Fy, R, VectorMultiply(Ry, P))), &TorqueY[i]);
+		VectorStoreAligned(VectorMultiplyAdd(Uz, Y, VectorMultiplyAdd(Fz, R, VectorMultiply(Rz, P))), &TorqueZ[i]);
+
+		VectorStoreAligned(SpeedV, &Speed[i]);
+	}
+}
+
+void FAeroBatch::RunScalar()
+{
+	for (int32 i = 0; i < NumAircraft; ++i)
+	{
+		using namespace FlightModel;
+
+		FAirframe Airframe;
+		Airframe.SpeedScale = SpeedScale[i];
+		Airframe.LiftCoefficient = Lift[i];
+		Airframe.DragCoefficient = Drag[i];
+		Airframe.bLiftAlongVelocityNormal = LiftMode[i] > 0.5f;
+
+		// Rebuild the attitude from the gathered basis; only the axes matter to the load model
+		const FMatrix Basis(FVector(FwdX[i], FwdY[i], FwdZ[i]), FVector(RightX[i], RightY[i], RightZ[i]), FVector(UpX[i], UpY[i], UpZ[i]), FVector::ZeroVector);
+		const FQuat Rotation(Basis);
+
+		FBodyState State;
+		State.Velocity = FVec3d(VelX[i], VelY[i], VelZ[i]);
+		State.Attitude = FQuatd(Rotation.X, Rotation.Y, Rotation.Z, Rotation.W);
+
+		FControls Controls;
+		Controls.Thrust = Thrust[i];
+		Controls.PitchTorque = Pitch[i];
+		Controls.RollTorque = Roll[i];
+		Controls.YawTorque = Yaw[i];
+
+		const FLoads Loads = ComputeLoads(Airframe, State, Controls);
+		ForceX[i] = Loads.Force.X; ForceY[i] = Loads.Force.Y; ForceZ[i] = Loads.Force.Z;
+		TorqueX[i] = Loads.Torque.X; TorqueY[i] = Loads.Torque.Y; TorqueZ[i] = Loads.Torque.Z;
+		Speed[i] = State.Velocity.Size();
+	}
+}
+
+// --- Async physics callback ---
+
+// One aircraft as handed to the physics thread
+struct FFlightAircraftInput
+{
+	Chaos::FSingleParticlePhysicsProxy* Proxy = nullptr;
+	int32 Handle = INDEX_NONE;
+	FlightModel::FAirframe Airframe;
+	FlightModel::FControls Controls;
+};
+
+// What the game thread needs back for the HUD
+struct FFlightAircraftOutput
+{
+	int32 Handle = INDEX_NONE;
+	float Speed = 0.0f;
+	float Altitude = 0.0f;
+};
+
+struct FFlightAsyncInput : public Chaos::FSimCallbackInput
+{
+	TArray<FFlightAircraftInput> Aircraft;
+
+	void Reset()
+	{
+		Aircraft.Reset();
+	}
+};
+
+struct FFlightAsyncOutput : public Chaos::FSimCallbackOutput
+{
+	TArray<FFlightAircraftOutput> Aircraft;
+
+	void Reset()
+	{
+		Aircraft.Reset();
+	}
+};
+
+// Runs the aero batch before every physics step on the physics thread
+class FFlightAsyncCallback : public Chaos::TSimCallbackObject<FFlightAsyncInput, FFlightAsyncOutput, Chaos::ESimCallbackOptions::Presimulate>
+{
+private:
+	virtual void OnPreSimulate_Internal() override;
+
+	// Latest input from the game thread, reused for steps that have no fresh input
+	TArray<FFlightAircraftInput> Aircraft;
+	TArray<Chaos::FRigidBodyHandle_Internal*> Bodies;
+	FAeroBatch Batch;
+
+	// Table pitching moments, real torques added after the acceleration -> torque conversion
+	TArray<float> TableMoments;
+};
+
+void FFlightAsyncCallback::OnPreSimulate_Internal()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightAeroPhysicsStep);
+
+	if (const FFlightAsyncInput* Input = GetConsumerInput_Internal())
+	{
+		// Into the buffer kept from the last step, which only grows when the fleet does; assignment would
+		// reallocate to fit. Substeps are handed the same input, so it is copied rather than taken.
+		Aircraft.Reset();
+		Aircraft.Append(Input->Aircraft);
+	}
+
+	const int32 Num = Aircraft.Num();
+	SET_DWORD_STAT(STAT_FlightAeroBodies, Num);
+
+	FFlightAsyncOutput& Output = GetProducerOutputData_Internal();
+	Output.Aircraft.Reset(Num);
+	if (Num == 0)
+	{
+		return;
+	}
+
+	Bodies.SetNumUninitialized(Num);
+	Batch.SetNum(Num);
+	TableMoments.SetNumZeroed(Num);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlightAeroGather);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			const FFlightAircraftInput& Entry = Aircraft[i];
+			Chaos::FSingleParticlePhysicsProxy* Proxy = Entry.Proxy;
+			Chaos::FRigidBodyHandle_Internal* Body = (Proxy && !Proxy->GetMarkedDeleted()) ? Proxy->GetPhysicsThreadAPI() : nullptr;
+			if (Body && Body->ObjectState() != Chaos::EObjectStateType::Dynamic)
+			{
+				Body = nullptr;
+			}
+			Bodies[i] = Body;
+			TableMoments[i] = 0.0f;
+
+			if (!Body)
+			{
+				// Produces zero force for this lane
+				Batch.VelX[i] = Batch.VelY[i] = Batch.VelZ[i] = 0.0f;
+				Batch.FwdX[i] = Batch.FwdY[i] = Batch.FwdZ[i] = 0.0f;
+				Batch.RightX[i] = Batch.RightY[i] = Batch.RightZ[i] = 0.0f;
+				Batch.UpX[i] = Batch.UpY[i] = Batch.UpZ[i] = 0.0f;
+				Batch.Thrust[i] = Batch.Pitch[i] = Batch.Roll[i] = Batch.Yaw[i] = 0.0f;
+				Batch.Lift[i] = Batch.Drag[i] = 0.0f;
+				continue;
+			}
+
+			const Chaos::FVec3 Velocity = Body->V();
+			const Chaos::FRotation3 Rotation = Body->R();
+			const FVector Forward = Rotation.GetForwardVector();
+			const FVector Right = Rotation.GetRightVector();
+			const FVector Up = Rotation.GetUpVector();
+
+			Batch.VelX[i] = Velocity.X; Batch.VelY[i] = Velocity.Y; Batch.VelZ[i] = Velocity.Z;
+			Batch.FwdX[i] = Forward.X; Batch.FwdY[i] = Forward.Y; Batch.FwdZ[i] = Forward.Z;
+			Batch.RightX[i] = Right.X; Batch.RightY[i] = Right.Y; Batch.RightZ[i] = Right.Z;
+			Batch.UpX[i] = Up.X; Batch.UpY[i] = Up.Y; Batch.UpZ[i] = Up.Z;
+
+			Batch.Thrust[i] = Entry.Controls.Thrust;
+			Batch.Roll[i] = Entry.Controls.RollTorque;
+			Batch.Yaw[i] = Entry.Controls.YawTorque;
+
+			if (const FlightModel::FAeroTable* Table = Entry.Airframe.AeroTable)
+			{
+				// Table lookup per aircraft; the kernel then treats the coefficients like scalar ones
+				const FVector LocalVelocity = Rotation.UnrotateVector(Velocity);
+				const FlightModel::FAeroCoefficients Coefficients = FlightModel::SampleCoefficients(
+					Entry.Airframe, FlightModel::FVec3d(LocalVelocity.X, LocalVelocity.Y, LocalVelocity.Z), Entry.Controls.Elevator);
+
+				Batch.SpeedScale[i] = 1.0f;
+				Batch.Lift[i] = Entry.Controls.bLiftEnabled ? Entry.Airframe.TableForceScale * Coefficients.CL : 0.0f;
+				Batch.Drag[i] = Entry.Airframe.TableForceScale * Coefficients.CD;
+				Batch.LiftMode[i] = 1.0f;
+				Batch.Pitch[i] = 0.0f;
+				TableMoments[i] = -Velocity.SizeSquared() * Entry.Airframe.TableMomentScale * Coefficients.Cm;
+			}
+			else
+			{
+				Batch.SpeedScale[i] = Entry.Airframe.SpeedScale;
+				Batch.Lift[i] = Entry.Controls.bLiftEnabled ? Entry.Airframe.LiftCoefficient : 0.0f;
+				Batch.Drag[i] = Entry.Airframe.DragCoefficient;
+				Batch.LiftMode[i] = Entry.Airframe.bLiftAlongVelocityNormal ? 1.0f : 0.0f;
+				Batch.Pitch[i] = Entry.Controls.PitchTorque;
+			}
+		}
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlightAeroKernel);
+		Batch.Run();
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlightAeroApply);
+		for (int32 i = 0; i < Num; ++i)
+		{
+			Chaos::FRigidBodyHandle_Internal* Body = Bodies[i];
+			if (!Body)
+			{
+				continue;
+			}
+
+			Body->AddForce(Chaos::FVec3(Batch.ForceX[i], Batch.ForceY[i], Batch.ForceZ[i]));
+
+			Chaos::FVec3 Torque(Batch.TorqueX[i], Batch.TorqueY[i], Batch.TorqueZ[i]);
+			if (Aircraft[i].Airframe.bTorqueAsAcceleration)
+			{
+				// Angular acceleration -> torque through the inertia in the body's mass frame
+				const Chaos::FRotation3 MassFrame = Body->R() * Body->RotationOfMass();
+				const Chaos::FVec3 LocalAcceleration = MassFrame.UnrotateVector(Torque);
+				Torque = MassFrame.RotateVector(LocalAcceleration * Chaos::FVec3(Body->I()));
+			}
+			Torque += Chaos::FVec3(Batch.RightX[i], Batch.RightY[i], Batch.RightZ[i]) * TableMoments[i];
+			Body->AddTorque(Torque);
+
+			FFlightAircraftOutput& Result = Output.Aircraft.AddDefaulted_GetRef();
+			Result.Handle = Aircraft[i].Handle;
+			Result.Speed = Batch.Speed[i];
+			Result.Altitude = Body->X().Z;
+		}
+	}
+}
+
+// --- FFlightPhysicsTickFunction ---
+
+void FFlightPhysicsTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->MarshalToPhysics();
+	}
+}
+
+FString FFlightPhysicsTickFunction::DiagnosticMessage()
+{
+	return TEXT("UFlightPhysicsSubsystem::MarshalToPhysics");
+}
+
+// --- UFlightPhysicsSubsystem ---
+
+bool UFlightPhysicsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFlightPhysicsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+
+	if (FPhysScene* PhysScene = InWorld.GetPhysicsScene())
+	{
+		AsyncCallback = PhysScene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FFlightAsyncCallback>();
+	}
+
+	// Pawns that registered before the tick function existed still need to tick first
+	for (const TWeakObjectPtr<AActor>& Owner : Owners)
+	{
+		if (AActor* Actor = Owner.Get())
+		{
+			TickFunction.AddPrerequisite(Actor, Actor->PrimaryActorTick);
+		}
+	}
+}
+
+void UFlightPhysicsSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	if (AsyncCallback)
+	{
+		UWorld* World = GetWorld();
+		if (FPhysScene* PhysScene = World ? World->GetPhysicsScene() : nullptr)
+		{
+			PhysScene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(AsyncCallback);
+		}
+		AsyncCallback = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+int32 UFlightPhysicsSubsystem::RegisterAircraft(AActor* Owner, UPrimitiveComponent* Body, const FlightModel::FAirframe& Airframe)
+{
+	if (!Owner || !Body)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Handle;
+	if (FreeHandles.Num() > 0)
+	{
+		Handle = FreeHandles.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Handle = HandleToSlot.Add(INDEX_NONE);
+	}
+
+	const int32 Slot = Bodies.Add(Body);
+	Owners.Add(Owner);
+	Slots.Add({ Airframe, FlightModel::FControls() });
+	SlotToHandle.Add(Handle);
+	HandleToSlot[Handle] = Slot;
+
+	// The batch must run after the pawn has written this frame's controls
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.AddPrerequisite(Owner, Owner->PrimaryActorTick);
+	}
+
+	return Handle;
+}
+
+void UFlightPhysicsSubsystem::UnregisterAircraft(int32 Handle)
+{
+	if (!HandleToSlot.IsValidIndex(Handle) || HandleToSlot[Handle] == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 Slot = HandleToSlot[Handle];
+	if (AActor* Owner = Owners[Slot].Get())
+	{
+		if (TickFunction.IsTickFunctionRegistered())
+		{
+			TickFunction.RemovePrerequisite(Owner, Owner->PrimaryActorTick);
+		}
+	}
+
+	// Swap the last slot into the hole and patch its handle
+	const int32 LastSlot = Bodies.Num() - 1;
+	if (Slot != LastSlot)
+	{
+		HandleToSlot[SlotToHandle[LastSlot]] = Slot;
+	}
+
+	Bodies.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Owners.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Slots.RemoveAtSwap(Slot, EAllowShrinking::No);
+	SlotToHandle.RemoveAtSwap(Slot, EAllowShrinking::No);
+
+	HandleToSlot[Handle] = INDEX_NONE;
+	FreeHandles.Add(Handle);
+}
+
+void UFlightPhysicsSubsystem::SetAirframe(int32 Handle, const FlightModel::FAirframe& Airframe)
+{
+	if (HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE)
+	{
+		Slots[HandleToSlot[Handle]].Airframe = Airframe;
+	}
+}
+
+void UFlightPhysicsSubsystem::SetControls(int32 Handle, const FlightModel::FControls& Controls)
+{
+	if (HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE)
+	{
+		Slots[HandleToSlot[Handle]].Controls = Controls;
+	}
+}
+
+float UFlightPhysicsSubsystem::GetSpeed(int32 Handle) const
+{
+	if (HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE)
+	{
+		return Slots[HandleToSlot[Handle]].Speed;
+	}
+	return 0.0f;
+}
+
+float UFlightPhysicsSubsystem::GetAltitude(int32 Handle) const
+{
+	if (HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE)
+	{
+		return Slots[HandleToSlot[Handle]].Altitude;
+	}
+	return 0.0f;
+}
+
+void UFlightPhysicsSubsystem::MarshalToPhysics()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightAeroMarshal);
+
+	if (!AsyncCallback)
+	{
+		return;
+	}
+
+	// Results of every physics step since last frame; the newest one wins
+	while (auto Output = AsyncCallback->PopOutputData_External())
+	{
+		for (const FFlightAircraftOutput& Result : Output->Aircraft)
+		{
+			if (HandleToSlot.IsValidIndex(Result.Handle) && HandleToSlot[Result.Handle] != INDEX_NONE)
+			{
+				FAircraftSlot& Slot = Slots[HandleToSlot[Result.Handle]];
+				Slot.Speed = Result.Speed;
+				Slot.Altitude = Result.Altitude;
+			}
+		}
+	}
+
+	FFlightAsyncInput* Input = AsyncCallback->GetProducerInputData_External();
+	if (!Input)
+	{
+		return;
+	}
+
+	const int32 Num = Bodies.Num();
+	Input->Aircraft.Reset(Num);
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const UPrimitiveComponent* Body = Bodies[i].Get();
+		const FBodyInstance* BodyInstance = Body ? Body->GetBodyInstance() : nullptr;
+		if (!BodyInstance || !BodyInstance->IsInstanceSimulatingPhysics())
+		{
+			continue;
+		}
+
+		FFlightAircraftInput& Entry = Input->Aircraft.AddDefaulted_GetRef();
+		Entry.Proxy = BodyInstance->GetPhysicsActorHandle();
+		Entry.Handle = SlotToHandle[i];
+		Entry.Airframe = Slots[i].Airframe;
+		Entry.Controls = Slots[i].Controls;
+	}
+}
+
+// --- Benchmark ---
+
+namespace FlightPhysicsBenchmark
+{
+	// Mirrors the per-pawn force code this subsystem replaced: AoS state, one aircraft at a time
+	struct FLegacyAircraft
+	{
+		FVector Velocity;
+		FQuat Rotation;
+		float Thrust;
+		float Lift;
+		float Drag;
+		float SpeedScale;
+		float Pitch;
+		float Roll;
+		float Yaw;
+		FVector Force;
+		FVector Torque;
+	};
+
+	static void RunLegacy(TArray<FLegacyAircraft>& Aircraft)
+	{
+		for (FLegacyAircraft& A : Aircraft)
+		{
+			const FVector Forward = A.Rotation.GetForwardVector();
+			const FVector Right = A.Rotation.GetRightVector();
+			const FVector Up = A.Rotation.GetUpVector();
+			const float Airspeed = A.Velocity.Size() * A.SpeedScale;
+
+			A.Force = Forward * A.Thrust;
+			A.Force += -A.Velocity.GetSafeNormal() * Airspeed * Airspeed * A.Drag;
+			A.Force += FVector::CrossProduct(A.Velocity.GetSafeNormal(), Right).GetSafeNormal() * Airspeed * Airspeed * A.Lift;
+			A.Torque = Right * A.Pitch;
+			A.Torque += Forward * A.Roll;
+			A.Torque += Up * A.Yaw;
+		}
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		const int32 NumAircraft = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 256;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1000;
+
+		FRandomStream Random(1234);
+		TArray<FLegacyAircraft> Legacy;
+		Legacy.SetNum(NumAircraft);
+
+		FAeroBatch Batch;
+		Batch.SetNum(NumAircraft);
+
+		for (int32 i = 0; i < NumAircraft; ++i)
+		{
+			FLegacyAircraft& A = Legacy[i];
+			A.Velocity = Random.GetUnitVector() * Random.FRandRange(1000.0f, 30000.0f);
+			A.Rotation = FRotator(Random.FRandRange(-80.0f, 80.0f), Random.FRandRange(0.0f, 360.0f), Random.FRandRange(-180.0f, 180.0f)).Quaternion();
+			A.Thrust = Random.FRandRange(0.0f, 1.0e8f);
+			A.Lift = 0.1f;
+			A.Drag = 0.005f;
+			A.SpeedScale = 0.036f;
+			A.Pitch = Random.FRandRange(-0.5f, 0.5f);
+			A.Roll = Random.FRandRange(-0.8f, 0.8f);
+			A.Yaw = Random.FRandRange(-0.2f, 0.2f);
+
+			const FVector Forward = A.Rotation.GetForwardVector();
+			const FVector Right = A.Rotation.GetRightVector();
+			const FVector Up = A.Rotation.GetUpVector();
+			Batch.VelX[i] = A.Velocity.X; Batch.VelY[i] = A.Velocity.Y; Batch.VelZ[i] = A.Velocity.Z;
+			Batch.FwdX[i] = Forward.X; Batch.FwdY[i] = Forward.Y; Batch.FwdZ[i] = Forward.Z;
+			Batch.RightX[i] = Right.X; Batch.RightY[i] = Right.Y; Batch.RightZ[i] = Right.Z;
+			Batch.UpX[i] = Up.X; Batch.UpY[i] = Up.Y; Batch.UpZ[i] = Up.Z;
+			Batch.SpeedScale[i] = A.SpeedScale;
+			Batch.Lift[i] = A.Lift;
+			Batch.Drag[i] = A.Drag;
+			Batch.LiftMode[i] = 1.0f;
+			Batch.Thrust[i] = A.Thrust;
+			Batch.Pitch[i] = A.Pitch;
+			Batch.Roll[i] = A.Roll;
+			Batch.Yaw[i] = A.Yaw;
+		}
+
+		double Start = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; ++It)
+		{
+			RunLegacy(Legacy);
+		}
+		const double LegacySeconds = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; ++It)
+		{
+			Batch.Run();
+		}
+		const double BatchSeconds = FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		for (int32 It = 0; It < Iterations; ++It)
+		{
+			Batch.RunScalar();
+		}
+		const double ScalarSeconds = FPlatformTime::Seconds() - Start;
+		Batch.Run();
+
+		// Sanity check that the kernel still agrees with the per-aircraft math
+		float MaxError = 0.0f;
+		for (int32 i = 0; i < NumAircraft; ++i)
+		{
+			const FVector BatchForce(Batch.ForceX[i], Batch.ForceY[i], Batch.ForceZ[i]);
+			MaxError = FMath::Max(MaxError, (float)((BatchForce - Legacy[i].Force).Size() / FMath::Max(1.0, Legacy[i].Force.Size())));
+		}
+
+		const double Samples = double(NumAircraft) * Iterations;
+		UE_LOG(LogFlightSim, Display, TEXT("BenchAero: %d aircraft x %d iterations"), NumAircraft, Iterations);
+		UE_LOG(LogFlightSim, Display, TEXT("  per-aircraft AoS: %.2f ns/aircraft"), LegacySeconds * 1.0e9 / Samples);
+		UE_LOG(LogFlightSim, Display, TEXT("  batched SoA SIMD: %.2f ns/aircraft"), BatchSeconds * 1.0e9 / Samples);
+		UE_LOG(LogFlightSim, Display, TEXT("  FlightModel reference (double): %.2f ns/aircraft"), ScalarSeconds * 1.0e9 / Samples);
+		UE_LOG(LogFlightSim, Display, TEXT("  max relative force error: %g"), MaxError);
+	}
+
+	static FAutoConsoleCommand BenchAeroCommand(
+		TEXT("FlightSim.BenchAero"),
+		TEXT("Times the batched aero kernel against the per-aircraft path. Usage: FlightSim.BenchAero [NumAircraft] [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Run));
+}
@@ -0,0 +1,431 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightRecorderSubsystem.h"
+#include "FlightSim1.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DamageLedgerSubsystem.h"
+#include "WorldSnapshotSubsystem.h"
+#include "Containers/Queue.h"
+#include "Engine/World.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+#include <atomic>
+
+DECLARE_CYCLE_STAT(TEXT("Recorder Sample"), STAT_FlightRecorderSample, STATGROUP_FlightSim);
+
+static float GRecorderRate = 30.0f;
+static FAutoConsoleVariableRef CVarRecorderRate(
+	TEXT("FlightSim.Recorder.Rate"),
+	GRecorderRate,
+	TEXT("Frames the flight recorder samples per second of game time. Takes effect on the next recording."));
+
+static float GRecorderMaxKBps = 1024.0f;
+static FAutoConsoleVariableRef CVarRecorderMaxKBps(
+	TEXT("FlightSim.Recorder.MaxKBps"),
+	GRecorderMaxKBps,
+	TEXT("Disk bandwidth the flight recorder may use, KB/s; samples are skipped while it is spent. 0 for no limit."));
+
+static float GRecorderChunkSeconds = 5.0f;
+static FAutoConsoleVariableRef CVarRecorderChunkSeconds(
+	TEXT("FlightSim.Recorder.ChunkSeconds"),
+	GRecorderChunkSeconds,
+	TEXT("Game time per recording chunk, s. A seek decodes at most one chunk, so shorter chunks seek faster but compress less."));
+
+static int32 GRecorderMaxEventsPerFrame = 16384;
+static FAutoConsoleVariableRef CVarRecorderMaxEventsPerFrame(
+	TEXT("FlightSim.Recorder.MaxEventsPerFrame"),
+	GRecorderMaxEventsPerFrame,
+	TEXT("Shots, launches and damage kept between two sampled frames; the rest are dropped."));
+
+// About a second of frames at the default rate before a stalled disk costs samples
+static constexpr int32 NumRecorderFrames = 32;
+
+// --- FFlightRecorderThread ---
+
+// Encodes the frames the game thread hands over and appends the chunks to the file
+class FFlightRecorderThread : public FRunnable
+{
+public:
+	FFlightRecorderThread(IFileHandle* InFile, const FlightModel::FRecordingSettings& InSettings)
+		: File(InFile)
+		, Settings(InSettings)
+		, WorkEvent(FPlatformProcess::GetSynchEventFromPool())
+	{
+		Thread = FRunnableThread::Create(this, TEXT("FlightRecorder"), 0, TPri_BelowNormal);
+	}
+
+	virtual ~FFlightRecorderThread() override
+	{
+		Finish();
+		delete Thread;
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	}
+
+	bool IsRunning() const { return Thread != nullptr; }
+
+	void Submit(FFlightRecorderFrame* Frame)
+	{
+		Pending.Enqueue(Frame);
+		WorkEvent->Trigger();
+	}
+
+	bool Reclaim(FFlightRecorderFrame*& OutFrame)
+	{
+		return Done.Dequeue(OutFrame);
+	}
+
+	// Everything submitted so far is written and the file closed once this returns
+	void Finish()
+	{
+		if (Thread && !bStopping)
+		{
+			bStopping = true;
+			WorkEvent->Trigger();
+			Thread->WaitForCompletion();
+		}
+	}
+
+	int64 GetBytesEncoded() const { return BytesEncoded; }
+	bool HasFailed() const { return bWriteFailed; }
+
+	virtual uint32 Run() override
+	{
+		Encoder.Begin(Buffer, Settings);
+		WriteBuffer();
+
+		for (;;)
+		{
+			// Read before draining, so nothing submitted ahead of the stop is left behind
+			const bool bStop = bStopping;
+
+			FFlightRecorderFrame* Frame;
+			while (Pending.Dequeue(Frame))
+			{
+				Encoder.AddFrame(Frame->Snapshot, Frame->Events.data(), Frame->Events.size(), Buffer);
+				BytesEncoded = int64(Encoder.GetBytesEncoded());
+				Done.Enqueue(Frame);
+				WriteBuffer();
+			}
+
+			if (bStop)
+			{
+				break;
+			}
+			WorkEvent->Wait(100);
+		}
+
+		Encoder.Finish(Buffer);
+		WriteBuffer();
+		File->Flush();
+		File.Reset();
+		return 0;
+	}
+
+private:
+	void WriteBuffer()
+	{
+		if (!Buffer.empty() && !bWriteFailed)
+		{
+			bWriteFailed = !File->Write(Buffer.data(), int64(Buffer.size()));
+		}
+		Buffer.clear();
+	}
+
+	TUniquePtr<IFileHandle> File;
+	FlightModel::FRecordingSettings Settings;
+	FlightModel::FFlightRecordWriter Encoder;
+	std::vector<uint8_t> Buffer;
+
+	// Game thread to writer, and back again once encoded
+	TQueue<FFlightRecorderFrame*, EQueueMode::Spsc> Pending;
+	TQueue<FFlightRecorderFrame*, EQueueMode::Spsc> Done;
+
+	FEvent* WorkEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+
+	std::atomic<bool> bStopping = false;
+	std::atomic<bool> bWriteFailed = false;
+	std::atomic<int64> BytesEncoded = 0;
+};
+
+// --- FFlightRecorderTickFunction ---
+
+void FFlightRecorderTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->Update(DeltaTime);
+	}
+}
+
+FString FFlightRecorderTickFunction::DiagnosticMessage()
+{
+	return TEXT("UFlightRecorderSubsystem::Update");
+}
+
+// --- UFlightRecorderSubsystem ---
+
+bool UFlightRecorderSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFlightRecorderSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldSnapshot = Collection.InitializeDependency<UWorldSnapshotSubsystem>();
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	DamageLedger = Collection.InitializeDependency<UDamageLedgerSubsystem>();
+}
+
+void UFlightRecorderSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+
+	// A sampled frame carries the damage resolved in it, and the health that resulted
+	if (DamageLedger)
+	{
+		TickFunction.AddPrerequisite(DamageLedger, DamageLedger->GetTickFunction());
+	}
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UFlightRecorderSubsystem::Deinitialize()
+{
+	StopRecording();
+
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	FreeFrames.Empty();
+	Frames.Empty();
+	PendingEvents = std::vector<FlightModel::FRecordedEvent>();
+
+	Super::Deinitialize();
+}
+
+bool UFlightRecorderSubsystem::StartRecording(const FString& InPath)
+{
+	StopRecording();
+
+	Path = InPath.IsEmpty()
+		? FPaths::ProjectSavedDir() / TEXT("Recordings") / FString::Printf(TEXT("Flight-%s.frec"), *FDateTime::Now().ToString())
+		: InPath;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+	IFileHandle* File = PlatformFile.OpenWrite(*Path);
+	if (!File)
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("Recorder: could not create %s"), *Path);
+		return false;
+	}
+
+	const float Rate = FMath::Clamp(GRecorderRate, 1.0f, 240.0f);
+	FlightModel::FRecordingSettings Settings;
+	Settings.MaxFramesPerChunk = uint32(FMath::Max(1, FMath::RoundToInt(Rate * FMath::Max(GRecorderChunkSeconds, 0.1f))));
+
+	Writer = new FFlightRecorderThread(File, Settings);
+	if (!Writer->IsRunning())
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("Recorder: could not start the writer thread"));
+		delete Writer;
+		Writer = nullptr;
+		return false;
+	}
+
+	if (Frames.Num() == 0)
+	{
+		for (int32 Index = 0; Index < NumRecorderFrames; ++Index)
+		{
+			Frames.Add(MakeUnique<FFlightRecorderFrame>());
+		}
+	}
+	FreeFrames.Reset();
+	for (const TUniquePtr<FFlightRecorderFrame>& Frame : Frames)
+	{
+		FreeFrames.Add(Frame.Get());
+	}
+
+	PendingEvents.clear();
+	TimeSinceSample = 1.0f / Rate;
+	RecordingStartTime = FPlatformTime::Seconds();
+	BandwidthCredit = 0.0;
+	BytesCharged = 0;
+	Stats = FFlightRecorderStats();
+	Stats.bRecording = true;
+	bRecording = true;
+
+	UE_LOG(LogFlightSim, Log, TEXT("Recorder: recording to %s at %.0f Hz"), *Path, Rate);
+	return true;
+}
+
+void UFlightRecorderSubsystem::StopRecording()
+{
+	if (!bRecording)
+	{
+		return;
+	}
+	bRecording = false;
+	Stats.bRecording = false;
+
+	Writer->Finish();
+	Stats.BytesEncoded = Writer->GetBytesEncoded();
+	const bool bFailed = Writer->HasFailed();
+	delete Writer;
+	Writer = nullptr;
+
+	// The writer is gone, so every frame is free again whatever it was doing
+	FreeFrames.Reset();
+	for (const TUniquePtr<FFlightRecorderFrame>& Frame : Frames)
+	{
+		FreeFrames.Add(Frame.Get());
+	}
+	PendingEvents.clear();
+
+	if (bFailed)
+	{
+		UE_LOG(LogFlightSim, Error, TEXT("Recorder: writing %s failed; the recording is cut short"), *Path);
+	}
+	UE_LOG(LogFlightSim, Log, TEXT("Recorder: %d frames, %.1f MB in %s (%d skipped)"),
+		Stats.NumFrames, double(Stats.BytesEncoded) / (1024.0 * 1024.0), *Path, Stats.NumSkipped);
+}
+
+void UFlightRecorderSubsystem::AddEvent(FlightModel::ERecordedEventType Type, int32 Subject, int32 Other, const FVector& Position, const FVector& Vector,
+	float Value)
+{
+	if (int32(PendingEvents.size()) >= GRecorderMaxEventsPerFrame)
+	{
+		++Stats.NumEventsDropped;
+		return;
+	}
+
+	FlightModel::FRecordedEvent& Event = PendingEvents.emplace_back();
+	Event.Type = Type;
+	Event.Time = GetWorld()->GetTimeSeconds();
+	Event.Subject = Subject;
+	Event.Other = Other;
+	Event.Position = FlightModel::FVec3d(Position.X, Position.Y, Position.Z);
+	Event.Vector = FlightModel::FVec3d(Vector.X, Vector.Y, Vector.Z);
+	Event.Value = Value;
+}
+
+void UFlightRecorderSubsystem::RecordDamage(int32 VictimHandle, float Damage)
+{
+	if (bRecording)
+	{
+		const FVector Location = SpatialIndex && SpatialIndex->IsValidHandle(VictimHandle) ? SpatialIndex->GetLocation(VictimHandle) : FVector::ZeroVector;
+		AddEvent(FlightModel::ERecordedEventType::Damage, VictimHandle, INDEX_NONE, Location, FVector::ZeroVector, Damage);
+	}
+}
+
+void UFlightRecorderSubsystem::ReclaimFrames()
+{
+	FFlightRecorderFrame* Frame;
+	while (Writer->Reclaim(Frame))
+	{
+		FreeFrames.Add(Frame);
+	}
+}
+
+void UFlightRecorderSubsystem::Update(float DeltaTime)
+{
+	if (!bRecording)
+	{
+		return;
+	}
+	if (Writer->HasFailed())
+	{
+		StopRecording();
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlightRecorderSample);
+	ReclaimFrames();
+
+	// Whatever the writer has encoded since the last frame is charged against the budget, which refills at MaxKBps
+	const int64 BytesEncoded = Writer->GetBytesEncoded();
+	const double MaxBytesPerSecond = double(GRecorderMaxKBps) * 1024.0;
+	BandwidthCredit -= double(BytesEncoded - BytesCharged);
+	BytesCharged = BytesEncoded;
+	if (MaxBytesPerSecond > 0.0)
+	{
+		BandwidthCredit = FMath::Min(BandwidthCredit + MaxBytesPerSecond * DeltaTime, MaxBytesPerSecond);
+	}
+
+	Stats.BytesEncoded = BytesEncoded;
+	const double Elapsed = FPlatformTime::Seconds() - RecordingStartTime;
+	Stats.KilobytesPerSecond = Elapsed > 0.0 ? float(double(BytesEncoded) / 1024.0 / Elapsed) : 0.0f;
+
+	const float Interval = 1.0f / FMath::Clamp(GRecorderRate, 1.0f, 240.0f);
+	TimeSinceSample += DeltaTime;
+	if (TimeSinceSample < Interval)
+	{
+		return;
+	}
+
+	// Never more than one sample a frame, and no burst to catch up after a hitch
+	TimeSinceSample = FMath::Min(TimeSinceSample - Interval, Interval);
+	if (FreeFrames.Num() == 0 || (MaxBytesPerSecond > 0.0 && BandwidthCredit < 0.0) || !WorldSnapshot)
+	{
+		++Stats.NumSkipped;
+		return;
+	}
+
+	const double Start = FPlatformTime::Seconds();
+	FFlightRecorderFrame* Frame = FreeFrames.Pop(EAllowShrinking::No);
+	WorldSnapshot->Capture(Frame->Snapshot);
+
+	// The frame takes the events and leaves its old storage behind for the next ones
+	Frame->Events.clear();
+	Frame->Events.swap(PendingEvents);
+	Writer->Submit(Frame);
+
+	++Stats.NumFrames;
+	Stats.SampleMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+// --- Console ---
+
+namespace FlightRecorderCommands
+{
+	static FAutoConsoleCommandWithWorldAndArgs StartCommand(
+		TEXT("FlightSim.Recorder.Start"),
+		TEXT("Starts recording the dogfight for replay. Usage: FlightSim.Recorder.Start [File]; without a file, one is made under Saved/Recordings."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UFlightRecorderSubsystem* Recorder = World ? World->GetSubsystem<UFlightRecorderSubsystem>() : nullptr)
+			{
+				Recorder->StartRecording(Args.Num() > 0 ? Args[0] : FString());
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld StopCommand(
+		TEXT("FlightSim.Recorder.Stop"),
+		TEXT("Stops recording and finishes the file."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UFlightRecorderSubsystem* Recorder = World ? World->GetSubsystem<UFlightRecorderSubsystem>() : nullptr)
+			{
+				Recorder->StopRecording();
+			}
+		}));
+}
@@ -0,0 +1,309 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "FlightReplaySubsystem.h"
+#include "FlightSim1.h"
+#include "FlightRecorderSubsystem.h"
+#include "WorldSnapshotSubsystem.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+
+DECLARE_CYCLE_STAT(TEXT("Replay Update"), STAT_FlightReplayUpdate, STATGROUP_FlightSim);
+
+static int32 GReplayDraw = 1;
+static FAutoConsoleVariableRef CVarReplayDraw(
+	TEXT("FlightSim.Replay.Draw"),
+	GReplayDraw,
+	TEXT("1: draws the replayed aircraft, missiles, shots, launches and hits over the world."));
+
+static int32 GReplayApply = 0;
+static FAutoConsoleVariableRef CVarReplayApply(
+	TEXT("FlightSim.Replay.Apply"),
+	GReplayApply,
+	TEXT("1: restores each replayed frame into the world. Aircraft are matched by handle, so only for a recording of this session."));
+
+static float GReplayShotLength = 20000.0f;
+static FAutoConsoleVariableRef CVarReplayShotLength(
+	TEXT("FlightSim.Replay.ShotLength"),
+	GReplayShotLength,
+	TEXT("Length of the line drawn for each replayed shot, cm."));
+
+// --- FFlightReplayTickFunction ---
+
+void FFlightReplayTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner)
+	{
+		// Real time, so playback runs the same whether or not the game is paused
+		Owner->Update(float(FApp::GetDeltaTime()));
+	}
+}
+
+FString FFlightReplayTickFunction::DiagnosticMessage()
+{
+	return TEXT("UFlightReplaySubsystem::Update");
+}
+
+// --- UFlightReplaySubsystem ---
+
+bool UFlightReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFlightReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WorldSnapshot = Collection.InitializeDependency<UWorldSnapshotSubsystem>();
+}
+
+void UFlightReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = true;
+	TickFunction.TickGroup = TG_PostUpdateWork;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UFlightReplaySubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	Close();
+
+	Super::Deinitialize();
+}
+
+bool UFlightReplaySubsystem::Open(const FString& Path)
+{
+	Close();
+
+	FOpenMappedResult Result = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Path);
+	if (Result.HasError())
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("Replay: could not map %s"), *Path);
+		return false;
+	}
+	MappedFile = Result.StealValue();
+	if (MappedFile->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+	if (!MappedRegion || !Reader.Open(MappedRegion->GetMappedPtr(), size_t(MappedRegion->GetMappedSize())))
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("Replay: %s is not a flight recording"), *Path);
+		Close();
+		return false;
+	}
+
+	Stats = FFlightReplayStats();
+	Stats.bOpen = true;
+	Stats.bRecovered = Reader.WasRecovered();
+	Stats.NumChunks = int32(Reader.GetChunks().size());
+	Stats.NumFrames = int32(Reader.GetNumFrames());
+	Stats.Duration = float(Reader.GetEndTime() - Reader.GetStartTime());
+	Rate = 0.0f;
+	Seek(0.0);
+
+	UE_LOG(LogFlightSim, Log, TEXT("Replay: %s, %d frames over %.1f s in %d chunks%s"), *Path, Stats.NumFrames, Stats.Duration, Stats.NumChunks,
+		Stats.bRecovered ? TEXT(" (unfinished; index rebuilt)") : TEXT(""));
+	return true;
+}
+
+void UFlightReplaySubsystem::Close()
+{
+	Reader.Close();
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	Stats = FFlightReplayStats();
+	Rate = 0.0f;
+}
+
+void UFlightReplaySubsystem::Seek(double Seconds)
+{
+	if (!Reader.IsOpen())
+	{
+		return;
+	}
+
+	const double Start = FPlatformTime::Seconds();
+	PlaybackTime = FMath::Clamp(Reader.GetStartTime() + Seconds, Reader.GetStartTime(), Reader.GetEndTime());
+	const bool bFound = Reader.Seek(PlaybackTime);
+	Stats.LastSeekMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+	Stats.PlaybackSeconds = float(PlaybackTime - Reader.GetStartTime());
+
+	if (bFound)
+	{
+		OnFrameChanged();
+	}
+}
+
+void UFlightReplaySubsystem::Update(float DeltaTime)
+{
+	if (!Reader.IsOpen())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlightReplayUpdate);
+
+	if (Rate != 0.0f)
+	{
+		PlaybackTime = FMath::Clamp(PlaybackTime + double(DeltaTime) * Rate, Reader.GetStartTime(), Reader.GetEndTime());
+		Stats.PlaybackSeconds = float(PlaybackTime - Reader.GetStartTime());
+
+		// Backwards, or more than a chunk ahead, a seek beats decoding every frame in between
+		if (PlaybackTime < Reader.GetFrame().Time || Reader.FindChunk(PlaybackTime) > Reader.GetChunkIndex() + 1)
+		{
+			Seek(PlaybackTime - Reader.GetStartTime());
+		}
+		else
+		{
+			double NextTime;
+			while (Reader.PeekNextTime(NextTime) && NextTime <= PlaybackTime && Reader.Next())
+			{
+				OnFrameChanged();
+			}
+		}
+
+		if (Rate > 0.0f ? PlaybackTime >= Reader.GetEndTime() : PlaybackTime <= Reader.GetStartTime())
+		{
+			Rate = 0.0f;
+		}
+	}
+
+	if (GReplayDraw != 0)
+	{
+		DrawFrame();
+	}
+}
+
+void UFlightReplaySubsystem::OnFrameChanged()
+{
+	if (GReplayDraw != 0)
+	{
+		DrawEvents();
+	}
+	if (GReplayApply != 0 && WorldSnapshot)
+	{
+		WorldSnapshot->Restore(Reader.GetFrame());
+	}
+}
+
+void UFlightReplaySubsystem::DrawFrame() const
+{
+	UWorld* World = GetWorld();
+	const FlightModel::FWorldSnapshot& Frame = Reader.GetFrame();
+	for (const FlightModel::FAircraftSnapshot& Aircraft : Frame.Aircraft)
+	{
+		const FVector Location(Aircraft.Position.X, Aircraft.Position.Y, Aircraft.Position.Z);
+		const FQuat Rotation = FQuat(Aircraft.Attitude.X, Aircraft.Attitude.Y, Aircraft.Attitude.Z, Aircraft.Attitude.W).GetNormalized();
+
+		// Green to red as it takes damage; the nose points along the arrow
+		const FColor Color = Aircraft.Health > 0.0f ? FColor::MakeRedToGreenColorFromScalar(FMath::Clamp(Aircraft.Health / 100.0f, 0.0f, 1.0f)) : FColor::Black;
+		DrawDebugDirectionalArrow(World, Location - Rotation.GetForwardVector() * 800.0f, Location + Rotation.GetForwardVector() * 800.0f, 600.0f, Color,
+			false, -1.0f, 0, 60.0f);
+		DrawDebugLine(World, Location - Rotation.GetRightVector() * 600.0f, Location + Rotation.GetRightVector() * 600.0f, Color, false, -1.0f, 0, 40.0f);
+	}
+	for (const FlightModel::FMissileSnapshot& Missile : Frame.Missiles)
+	{
+		const FVector Location(Missile.Position.X, Missile.Position.Y, Missile.Position.Z);
+		const FVector Velocity(Missile.Velocity.X, Missile.Velocity.Y, Missile.Velocity.Z);
+		DrawDebugLine(World, Location - Velocity * 0.02f, Location, FColor::Orange, false, -1.0f, 0, 30.0f);
+	}
+}
+
+void UFlightReplaySubsystem::DrawEvents() const
+{
+	UWorld* World = GetWorld();
+	for (const FlightModel::FRecordedEvent& Event : Reader.GetEvents())
+	{
+		const FVector Position(Event.Position.X, Event.Position.Y, Event.Position.Z);
+		const FVector Vector(Event.Vector.X, Event.Vector.Y, Event.Vector.Z);
+		switch (Event.Type)
+		{
+		case FlightModel::ERecordedEventType::Shot:
+			DrawDebugLine(World, Position, Position + Vector * GReplayShotLength, FColor::Yellow, false, 0.1f, 0, 10.0f);
+			break;
+		case FlightModel::ERecordedEventType::MissileLaunch:
+			DrawDebugSphere(World, Position, 500.0f, 8, FColor::Orange, false, 0.5f, 0, 20.0f);
+			break;
+		case FlightModel::ERecordedEventType::Damage:
+			DrawDebugSphere(World, Position, 200.0f + 20.0f * Event.Value, 8, FColor::Red, false, 0.25f, 0, 20.0f);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+// --- Console ---
+
+namespace FlightReplayCommands
+{
+	static UFlightReplaySubsystem* GetReplay(UWorld* World)
+	{
+		return World ? World->GetSubsystem<UFlightReplaySubsystem>() : nullptr;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs OpenCommand(
+		TEXT("FlightSim.Replay.Open"),
+		TEXT("Opens a flight recording for playback, paused at its start. Usage: FlightSim.Replay.Open [File]; without a file, the recorder's last one."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UFlightReplaySubsystem* Replay = GetReplay(World);
+			const UFlightRecorderSubsystem* Recorder = World ? World->GetSubsystem<UFlightRecorderSubsystem>() : nullptr;
+			const FString Path = Args.Num() > 0 ? Args[0] : (Recorder ? Recorder->GetPath() : FString());
+			if (Replay && !Path.IsEmpty())
+			{
+				Replay->Open(Path);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorld CloseCommand(
+		TEXT("FlightSim.Replay.Close"),
+		TEXT("Closes the flight recording being played."),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UFlightReplaySubsystem* Replay = GetReplay(World))
+			{
+				Replay->Close();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs SeekCommand(
+		TEXT("FlightSim.Replay.Seek"),
+		TEXT("Jumps to a time in the open recording and logs how long the seek took. Usage: FlightSim.Replay.Seek Seconds"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UFlightReplaySubsystem* Replay = GetReplay(World);
+			if (Replay && Replay->IsOpen() && Args.Num() > 0)
+			{
+				Replay->Seek(FCString::Atod(*Args[0]));
+				const FFlightReplayStats Stats = Replay->GetStats();
+				UE_LOG(LogFlightSim, Log, TEXT("Replay: at %.2f of %.2f s, seek took %.2f ms"), Stats.PlaybackSeconds, Stats.Duration, Stats.LastSeekMilliseconds);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs PlayCommand(
+		TEXT("FlightSim.Replay.Play"),
+		TEXT("Plays the open recording. Usage: FlightSim.Replay.Play [Rate]; 0 pauses, negative plays backwards, 1 by default."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UFlightReplaySubsystem* Replay = GetReplay(World))
+			{
+				Replay->SetRate(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 1.0f);
+			}
+		}));
+}
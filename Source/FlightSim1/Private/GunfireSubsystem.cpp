@@ -0,0 +1,449 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "GunfireSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DamageLedgerSubsystem.h"
+#include "FlightRecorderSubsystem.h"
+#include "HealthComponent.h"
+#include "FlightSim1.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gunfire Resolve"), STAT_FlightGunfireResolve, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gunfire Shots"), STAT_FlightGunfireShots, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gunfire Traces"), STAT_FlightGunfireTraces, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gunfire Hits"), STAT_FlightGunfireHits, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Gunfire Round Step"), STAT_FlightGunfireRoundStep, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gunfire Live Rounds"), STAT_FlightGunfireLiveRounds, STATGROUP_FlightSim);
+
+static float GGunfireRadiusScale = 1.0f;
+static FAutoConsoleVariableRef CVarGunfireRadiusScale(
+	TEXT("FlightSim.Gunfire.RadiusScale"),
+	GGunfireRadiusScale,
+	TEXT("Multiplier on each aircraft's bounding sphere in the gunfire broadphase. Below 1 can miss hits the trace would find."));
+
+static int32 GGunfireBallistic = 0;
+static FAutoConsoleVariableRef CVarGunfireBallistic(
+	TEXT("FlightSim.Gunfire.Ballistic"),
+	GGunfireBallistic,
+	TEXT("0: guns are instant hitscan out to their range. 1: guns fire ballistic rounds with muzzle velocity, drop and time of flight."));
+
+static float GGunfireMuzzleVelocity = 100000.0f;
+static FAutoConsoleVariableRef CVarGunfireMuzzleVelocity(
+	TEXT("FlightSim.Gunfire.MuzzleVelocity"),
+	GGunfireMuzzleVelocity,
+	TEXT("Ballistic round speed relative to the shooter, cm/s."));
+
+static float GGunfireRoundLifetime = 3.0f;
+static FAutoConsoleVariableRef CVarGunfireRoundLifetime(
+	TEXT("FlightSim.Gunfire.RoundLifetime"),
+	GGunfireRoundLifetime,
+	TEXT("Seconds a ballistic round flies before it is retired."));
+
+static int32 GGunfireMaxRounds = 16384;
+static FAutoConsoleVariableRef CVarGunfireMaxRounds(
+	TEXT("FlightSim.Gunfire.MaxRounds"),
+	GGunfireMaxRounds,
+	TEXT("Size of the ballistic round pool, read when the world starts (at most 65535). Rounds fired into a full pool are dropped."));
+
+static int32 GGunfireTerrainChords = 4;
+static FAutoConsoleVariableRef CVarGunfireTerrainChords(
+	TEXT("FlightSim.Gunfire.TerrainChords"),
+	GGunfireTerrainChords,
+	TEXT("Async traces per round, as straight chords along its arc, that find where it meets the terrain (1-16)."));
+
+// Terrain trace user data: round id in the low 16 bits, chord in the next 4, low 12 bits of the id's generation on top
+namespace GunfireTerrainTrace
+{
+	static uint32 Pack(int32 Id, int32 Chord, uint16 Generation)
+	{
+		return uint32(Id) | (uint32(Chord) << 16) | (uint32(Generation & 0xFFF) << 20);
+	}
+}
+
+// --- FGunfireTickFunction ---
+
+void FGunfireTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->UpdateGunfire(DeltaTime);
+	}
+}
+
+FString FGunfireTickFunction::DiagnosticMessage()
+{
+	return TEXT("UGunfireSubsystem::UpdateGunfire");
+}
+
+// --- UGunfireSubsystem ---
+
+bool UGunfireSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGunfireSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	DamageLedger = Collection.InitializeDependency<UDamageLedgerSubsystem>();
+
+	Rounds.Initialize(FMath::Clamp(GGunfireMaxRounds, 0, 0xFFFF));
+	RoundImpacts.reserve(Rounds.GetCapacity());
+	TerrainTraceDelegate.BindUObject(this, &UGunfireSubsystem::OnTerrainTraceDone);
+}
+
+void UGunfireSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PostPhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+
+	Recorder = InWorld.GetSubsystem<UFlightRecorderSubsystem>();
+}
+
+void UGunfireSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+	TerrainTraceDelegate.Unbind();
+
+	Super::Deinitialize();
+}
+
+void UGunfireSubsystem::QueueShot(const FGunShot& Shot)
+{
+	if (Recorder)
+	{
+		Recorder->RecordShot(Shot.ShooterHandle, Shot.Origin, Shot.Direction);
+	}
+
+	if (GGunfireBallistic != 0)
+	{
+		FireRound(Shot);
+		return;
+	}
+
+	QueuedShots.Add(Shot);
+}
+
+void UGunfireSubsystem::UpdateGunfire(float DeltaTime)
+{
+	const double Start = FPlatformTime::Seconds();
+
+	ResolveShots(QueuedShots, Hits);
+	StepRounds(DeltaTime, Hits);
+	ApplyDamage(Hits);
+
+	Stats.ResolveMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+	QueuedShots.Reset();
+}
+
+void UGunfireSubsystem::BuildSpheres()
+{
+	// Every aircraft's bounding sphere, straight from the spatial index's dense arrays
+	const TArrayView<const FVector> Locations = SpatialIndex->GetSlotLocations();
+	const TArrayView<const float> Radii = SpatialIndex->GetSlotRadii();
+	Spheres.Reset();
+	Spheres.Reserve(Locations.Num());
+	SphereHandles.SetNum(Locations.Num(), EAllowShrinking::No);
+	for (int32 Slot = 0; Slot < Locations.Num(); ++Slot)
+	{
+		const FVector& Center = Locations[Slot];
+		Spheres.Add(FlightModel::FVec3d(Center.X, Center.Y, Center.Z), Radii[Slot] * GGunfireRadiusScale);
+		SphereHandles[Slot] = SpatialIndex->GetHandleOfSlot(Slot);
+	}
+}
+
+void UGunfireSubsystem::ResolveShots(TArrayView<const FGunShot> Shots, TArray<FGunHit>& OutHits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightGunfireResolve);
+
+	OutHits.Reset();
+	Stats.NumShots = Shots.Num();
+	Stats.NumTraces = 0;
+	Stats.NumHits = 0;
+	if (Shots.Num() == 0 || !SpatialIndex)
+	{
+		return;
+	}
+
+	BuildSpheres();
+
+	Rays.SetNum(Shots.Num(), EAllowShrinking::No);
+	RayHits.SetNum(Shots.Num(), EAllowShrinking::No);
+	for (int32 i = 0; i < Shots.Num(); ++i)
+	{
+		const FGunShot& Shot = Shots[i];
+		FlightModel::FRay& Ray = Rays[i];
+		Ray.Origin = FlightModel::FVec3d(Shot.Origin.X, Shot.Origin.Y, Shot.Origin.Z);
+		Ray.Direction = FlightModel::FVec3d(Shot.Direction.X, Shot.Direction.Y, Shot.Direction.Z);
+		Ray.Length = Shot.Range;
+		Ray.IgnoreIndex = SpatialIndex->GetSlot(Shot.ShooterHandle);
+	}
+
+	Broadphase.Intersect(Spheres, Rays.GetData(), Rays.Num(), RayHits.GetData());
+
+	// Confirm candidates with a real trace: the mesh is smaller than its sphere and terrain may be in the way
+	UWorld* World = GetWorld();
+	for (int32 i = 0; i < Shots.Num(); ++i)
+	{
+		if (RayHits[i].Index == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FGunShot& Shot = Shots[i];
+		FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(GunfireConfirm), false);
+		if (AActor* Shooter = Shot.Shooter.Get())
+		{
+			CollisionParams.AddIgnoredActor(Shooter);
+		}
+
+		FHitResult HitResult;
+		++Stats.NumTraces;
+		if (World->LineTraceSingleByChannel(HitResult, Shot.Origin, Shot.Origin + Shot.Direction * Shot.Range, ECC_Visibility, CollisionParams))
+		{
+			if (AActor* HitActor = HitResult.GetActor())
+			{
+				FGunHit& Hit = OutHits.AddDefaulted_GetRef();
+				Hit.ShotIndex = i;
+				Hit.Victim = HitActor;
+				Hit.VictimHandle = SpatialIndex->FindHandle(HitResult);
+				Hit.Location = HitResult.ImpactPoint;
+				Hit.Damage = Shot.Damage;
+			}
+		}
+	}
+
+	Stats.NumHits = OutHits.Num();
+	INC_DWORD_STAT_BY(STAT_FlightGunfireShots, Stats.NumShots);
+	INC_DWORD_STAT_BY(STAT_FlightGunfireTraces, Stats.NumTraces);
+	INC_DWORD_STAT_BY(STAT_FlightGunfireHits, Stats.NumHits);
+}
+
+bool UGunfireSubsystem::FireRound(const FGunShot& Shot)
+{
+	// Rounds leave the muzzle with the shooter's own velocity on top
+	FVector Velocity = Shot.Direction * GGunfireMuzzleVelocity;
+	if (SpatialIndex && SpatialIndex->IsValidHandle(Shot.ShooterHandle))
+	{
+		Velocity += SpatialIndex->GetVelocity(Shot.ShooterHandle);
+	}
+
+	const float Lifetime = FMath::Max(GGunfireRoundLifetime, 0.0f);
+	const int32 Id = Rounds.Spawn(FlightModel::FVec3d(Shot.Origin.X, Shot.Origin.Y, Shot.Origin.Z),
+		FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z), Shot.Damage, Lifetime, Shot.ShooterHandle);
+	if (Id == INDEX_NONE)
+	{
+		++RoundsDroppedThisFrame;
+		return false;
+	}
+	++RoundsFiredThisFrame;
+
+	// No drag, so the whole arc is known now; trace it once as chords rather than every frame
+	UWorld* World = GetWorld();
+	const FVector Gravity(0.0f, 0.0f, World->GetGravityZ());
+	const int32 NumChords = FMath::Clamp(GGunfireTerrainChords, 1, 16);
+	const float ChordTime = Lifetime / NumChords;
+	const uint16 Generation = Rounds.GetGeneration(Id);
+	const FCollisionObjectQueryParams TerrainObjects(ECC_WorldStatic);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GunfireRoundTerrain), false);
+
+	FVector ChordStart = Shot.Origin;
+	for (int32 Chord = 0; Chord < NumChords; ++Chord)
+	{
+		const float Time = ChordTime * (Chord + 1);
+		const FVector ChordEnd = Shot.Origin + Velocity * Time + Gravity * (0.5f * Time * Time);
+		World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, ChordStart, ChordEnd, TerrainObjects, QueryParams,
+			&TerrainTraceDelegate, GunfireTerrainTrace::Pack(Id, Chord, Generation));
+		ChordStart = ChordEnd;
+	}
+	return true;
+}
+
+void UGunfireSubsystem::OnTerrainTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if (TraceDatum.OutHits.Num() == 0 || !TraceDatum.OutHits[0].bBlockingHit)
+	{
+		return;
+	}
+
+	const int32 Id = int32(TraceDatum.UserData & 0xFFFF);
+	const int32 Chord = int32((TraceDatum.UserData >> 16) & 0xF);
+	const uint16 PackedGeneration = uint16(TraceDatum.UserData >> 20);
+	if (Id >= Rounds.GetCapacity())
+	{
+		return;
+	}
+
+	// Only the low 12 bits travel with the trace; an id would have to be reused 4096 times in a frame to alias
+	const uint16 Generation = Rounds.GetGeneration(Id);
+	if ((Generation & 0xFFF) != PackedGeneration)
+	{
+		return;
+	}
+
+	// Chords are short and nearly straight, so time along one is close to linear in the hit fraction
+	const float ChordTime = FMath::Max(GGunfireRoundLifetime, 0.0f) / FMath::Clamp(GGunfireTerrainChords, 1, 16);
+	Rounds.SetTerrainTime(Id, Generation, ChordTime * (Chord + TraceDatum.OutHits[0].Time));
+}
+
+void UGunfireSubsystem::StepRounds(float DeltaTime, TArray<FGunHit>& OutHits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightGunfireRoundStep);
+
+	const double Start = FPlatformTime::Seconds();
+	Stats.RoundsFired = RoundsFiredThisFrame;
+	Stats.RoundsDropped = RoundsDroppedThisFrame;
+	Stats.RoundHits = 0;
+	Stats.RoundTerrainImpacts = 0;
+	RoundsFiredThisFrame = 0;
+	RoundsDroppedThisFrame = 0;
+
+	if (Rounds.Num() > 0 && SpatialIndex)
+	{
+		// Hitscan already built the spheres if it had anything to resolve this frame
+		if (QueuedShots.Num() == 0)
+		{
+			BuildSpheres();
+		}
+
+		RoundImpacts.clear();
+		Rounds.Step(DeltaTime, FlightModel::FVec3d(0.0, 0.0, GetWorld()->GetGravityZ()), Spheres, SphereHandles.GetData(), RoundImpacts);
+
+		for (const FlightModel::FBallisticImpact& Impact : RoundImpacts)
+		{
+			if (Impact.Type == FlightModel::EBallisticImpact::Terrain)
+			{
+				++Stats.RoundTerrainImpacts;
+				continue;
+			}
+
+			FGunHit& Hit = OutHits.AddDefaulted_GetRef();
+			Hit.VictimHandle = SphereHandles[Impact.Sphere];
+			Hit.Victim = SpatialIndex->GetActor(Hit.VictimHandle);
+			Hit.Location = FVector(Impact.Location.X, Impact.Location.Y, Impact.Location.Z);
+			Hit.Damage = Impact.Damage;
+			++Stats.RoundHits;
+		}
+	}
+
+	Stats.NumLiveRounds = Rounds.Num();
+	Stats.RoundStepMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+	SET_DWORD_STAT(STAT_FlightGunfireLiveRounds, Stats.NumLiveRounds);
+}
+
+void UGunfireSubsystem::ClearInFlight()
+{
+	QueuedShots.Reset();
+	Rounds.Clear();
+}
+
+void UGunfireSubsystem::ApplyDamage(TArrayView<const FGunHit> InHits)
+{
+	// The ledger sums several rounds into the same aircraft; nothing reacts until it resolves.
+	// Anything hit that is not a registered aircraft (terrain, a parked missile) has no health.
+	VictimHandles.Reset();
+	for (const FGunHit& Hit : InHits)
+	{
+		if (DamageLedger && DamageLedger->IsRegistered(Hit.VictimHandle))
+		{
+			DamageLedger->QueueDamage(Hit.VictimHandle, Hit.Damage);
+			VictimHandles.AddUnique(Hit.VictimHandle);
+		}
+	}
+
+	Stats.NumVictims = VictimHandles.Num();
+}
+
+// --- Benchmark ---
+
+namespace GunfireBenchmark
+{
+	// Same shots through the old per-shot path (trace + FindComponentByClass) and through the resolver, without applying damage
+	static void Run(const TArray<FString>& Args, UWorld* World)
+	{
+		UGunfireSubsystem* Gunfire = World ? World->GetSubsystem<UGunfireSubsystem>() : nullptr;
+		UAircraftSpatialSubsystem* SpatialIndex = World ? World->GetSubsystem<UAircraftSpatialSubsystem>() : nullptr;
+		if (!Gunfire || !SpatialIndex || SpatialIndex->GetNumAircraft() < 2)
+		{
+			UE_LOG(LogFlightSim, Warning, TEXT("BenchGunfire: needs a game world with at least two aircraft"));
+			return;
+		}
+
+		const int32 NumShots = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 1000;
+		const int32 NumAircraft = SpatialIndex->GetNumAircraft();
+
+		// Every shooter fires 500 m guns; half the shots are aimed at another aircraft
+		FRandomStream Random(777);
+		TArray<FGunShot> Shots;
+		Shots.Reserve(NumShots);
+		for (int32 i = 0; i < NumShots; ++i)
+		{
+			const int32 ShooterSlot = i % NumAircraft;
+			const int32 TargetSlot = Random.RandRange(0, NumAircraft - 1);
+			const int32 ShooterHandle = SpatialIndex->GetHandleOfSlot(ShooterSlot);
+
+			FGunShot& Shot = Shots.AddDefaulted_GetRef();
+			Shot.ShooterHandle = ShooterHandle;
+			Shot.Shooter = SpatialIndex->GetActor(ShooterHandle);
+			Shot.Origin = SpatialIndex->GetLocation(ShooterHandle);
+			Shot.Range = 50000.0f;
+			Shot.Damage = 10.0f;
+
+			const FVector Aim = SpatialIndex->GetSlotLocations()[TargetSlot] - Shot.Origin;
+			Shot.Direction = (i & 1) && TargetSlot != ShooterSlot ? Aim.GetSafeNormal() : Random.GetUnitVector();
+		}
+
+		double Start = FPlatformTime::Seconds();
+		int32 LegacyHits = 0;
+		for (const FGunShot& Shot : Shots)
+		{
+			FHitResult HitResult;
+			FCollisionQueryParams CollisionParams;
+			CollisionParams.AddIgnoredActor(Shot.Shooter.Get());
+			if (World->LineTraceSingleByChannel(HitResult, Shot.Origin, Shot.Origin + Shot.Direction * Shot.Range, ECC_Visibility, CollisionParams))
+			{
+				AActor* HitActor = HitResult.GetActor();
+				LegacyHits += HitActor && HitActor->FindComponentByClass<UHealthComponent>() != nullptr;
+			}
+		}
+		const double LegacySeconds = FPlatformTime::Seconds() - Start;
+
+		TArray<FGunHit> Hits;
+		Start = FPlatformTime::Seconds();
+		Gunfire->ResolveShots(Shots, Hits);
+		const double BatchedSeconds = FPlatformTime::Seconds() - Start;
+
+		const UDamageLedgerSubsystem* DamageLedger = World->GetSubsystem<UDamageLedgerSubsystem>();
+		int32 BatchedHits = 0;
+		for (const FGunHit& Hit : Hits)
+		{
+			BatchedHits += DamageLedger && DamageLedger->IsRegistered(Hit.VictimHandle);
+		}
+
+		UE_LOG(LogFlightSim, Display, TEXT("BenchGunfire: %d shots against %d aircraft"), NumShots, NumAircraft);
+		UE_LOG(LogFlightSim, Display, TEXT("  per-shot traces: %.0f shots/ms, %d hits"),
+			NumShots / FMath::Max(LegacySeconds * 1000.0, 1.0e-6), LegacyHits);
+		UE_LOG(LogFlightSim, Display, TEXT("  batched resolver: %.0f shots/ms, %d hits, %d traces"),
+			NumShots / FMath::Max(BatchedSeconds * 1000.0, 1.0e-6), BatchedHits, Gunfire->GetStats().NumTraces);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchCommand(
+		TEXT("FlightSim.BenchGunfire"),
+		TEXT("Times the same shots through per-shot line traces and through the batched gunfire resolver. Usage: FlightSim.BenchGunfire [NumShots]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Run));
+}
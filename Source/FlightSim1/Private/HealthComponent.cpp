@@ -3,9 +3,13 @@
 #include "HealthComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Particles/ParticleSystem.h"
-#include "Components/StaticMeshComponent.h"
+#include "Components/PrimitiveComponent.h"
 #include "Engine/Engine.h"
+#include "ActorPoolSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DamageLedgerSubsystem.h"
 #include "DogfightGameModeBase.h"
+#include "EffectsSubsystem.h"
 
 // Sets default values for this component's properties
 UHealthComponent::UHealthComponent()
@@ -14,6 +18,9 @@ UHealthComponent::UHealthComponent()
 
     MaxHealth = 100.0f;
     CurrentHealth = MaxHealth;
+    bDestroyOwnerOnDeath = true;
+    DamageLedger = nullptr;
+    LedgerHandle = INDEX_NONE;
 }
 
 
@@ -25,6 +32,46 @@ void UHealthComponent::BeginPlay()
     CurrentHealth = MaxHealth;
 }
 
+void UHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UnregisterFromLedger();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UHealthComponent::RegisterWithLedger(int32 AircraftHandle)
+{
+    DamageLedger = GetWorld()->GetSubsystem<UDamageLedgerSubsystem>();
+    if (DamageLedger && AircraftHandle != INDEX_NONE)
+    {
+        LedgerHandle = AircraftHandle;
+        DamageLedger->RegisterAircraft(LedgerHandle, this, CurrentHealth, MaxHealth);
+    }
+    else
+    {
+        DamageLedger = nullptr;
+    }
+}
+
+void UHealthComponent::UnregisterFromLedger()
+{
+    if (DamageLedger)
+    {
+        DamageLedger->UnregisterAircraft(LedgerHandle, this);
+        DamageLedger = nullptr;
+        LedgerHandle = INDEX_NONE;
+    }
+}
+
+void UHealthComponent::SetHealth(float NewHealth)
+{
+    CurrentHealth = FMath::Clamp(NewHealth, 0.0f, MaxHealth);
+    if (DamageLedger)
+    {
+        DamageLedger->RegisterAircraft(LedgerHandle, this, CurrentHealth, MaxHealth);
+    }
+}
+
 void UHealthComponent::TakeDamage(float DamageAmount)
 {
     if (CurrentHealth <= 0.0f)
@@ -32,7 +79,19 @@ void UHealthComponent::TakeDamage(float DamageAmount)
         return;
     }
 
-    CurrentHealth = FMath::Clamp(CurrentHealth - DamageAmount, 0.0f, MaxHealth);
+    if (DamageLedger)
+    {
+        DamageLedger->QueueDamage(LedgerHandle, DamageAmount);
+        return;
+    }
+
+    // Not an aircraft the ledger knows about: resolve on the spot
+    ApplyResolvedDamage(DamageAmount, FMath::Clamp(CurrentHealth - DamageAmount, 0.0f, MaxHealth));
+}
+
+void UHealthComponent::ApplyResolvedDamage(float DamageAmount, float NewHealth)
+{
+    CurrentHealth = NewHealth;
 
     // --- CHANGE 3: Broadcast the OnDamaged event ---
     OnDamaged.Broadcast(GetOwner(), DamageAmount);
@@ -63,19 +122,31 @@ void UHealthComponent::Die()
         }
     }
 
-    if (DeathEffect)
+    if (UEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UEffectsSubsystem>())
     {
-        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), DeathEffect, GetOwner()->GetActorLocation(), GetOwner()->GetActorRotation());
+        Effects->PlayEmitter(DeathEffect, GetOwner()->GetActorLocation(), GetOwner()->GetActorRotation());
     }
 
     AActor* Owner = GetOwner();
-    if (Owner)
+    if (Owner && bDestroyOwnerOnDeath)
     {
-        UStaticMeshComponent* MeshComponent = Owner->FindComponentByClass<UStaticMeshComponent>();
-        if (MeshComponent)
+        // The body the aircraft registered with; our ledger handle is its spatial index handle
+        const UAircraftSpatialSubsystem* SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+        UPrimitiveComponent* Body = SpatialIndex ? SpatialIndex->GetBody(LedgerHandle) : nullptr;
+        if (Body)
+        {
+            Body->SetSimulatePhysics(false);
+        }
+
+        // Pooled aircraft are parked for the next spawn rather than destroyed
+        UActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UActorPoolSubsystem>();
+        if (ActorPool && Cast<IPooledActor>(Owner))
+        {
+            ActorPool->Release(Owner);
+        }
+        else
         {
-            MeshComponent->SetSimulatePhysics(false);
+            Owner->Destroy();
         }
-        Owner->Destroy();
     }
 }
@@ -1,42 +1,39 @@
 // Copyright Your Company Name, Inc. All Rights Reserved.
 
 #include "Missile.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DamageLedgerSubsystem.h"
+#include "EffectsSubsystem.h"
 #include "Components/StaticMeshComponent.h"
-#include "GameFramework/ProjectileMovementComponent.h"
+#include "Engine/CollisionProfile.h"
 #include "Particles/ParticleSystemComponent.h"
-#include "Kismet/GameplayStatics.h"
-#include "HealthComponent.h"
 #include "Particles/ParticleSystem.h"
 
 // Sets default values
 AMissile::AMissile()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Flown by UMissileGuidanceSubsystem, so no per-missile tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create the missile's mesh
 	MissileMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MissileMesh"));
 	RootComponent = MissileMesh;
-	MissileMesh->SetCollisionProfileName(TEXT("BlockAll"));
+	// Guidance settles every hit (aircraft proxies and terrain traces), so the mesh never collides
+	MissileMesh->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
 
 	// Create and configure the particle trail
 	TrailEffect = CreateDefaultSubobject<UParticleSystemComponent>(TEXT("TrailEffect"));
 	TrailEffect->SetupAttachment(RootComponent);
 
-	// Create and configure the projectile movement component
-	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("ProjectileMovement"));
-	ProjectileMovement->InitialSpeed = 40000.f;
-	ProjectileMovement->MaxSpeed = 40000.f;
-	ProjectileMovement->bRotationFollowsVelocity = true;
-	ProjectileMovement->bIsHomingProjectile = true;
-	ProjectileMovement->HomingAccelerationMagnitude = 80000.f;
-
 	// Set default values
 	DamageAmount = 100.0f; // Missiles do a lot of damage
 	TargetActor = nullptr;
+	bInFlight = false;
+	bSpawnedForPool = false;
+	GuidanceHandle = INDEX_NONE;
 
-	// Set the lifespan of the missile to 10 seconds
-	InitialLifeSpan = 10.0f;
+	// Flight time is counted by guidance rather than InitialLifeSpan, which would destroy a pooled missile
+	LifeSeconds = 10.0f;
 }
 
 // Called when the game starts or when spawned
@@ -44,47 +41,114 @@ void AMissile::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Bind the OnHit function to the mesh's OnComponentHit event
-	MissileMesh->OnComponentHit.AddDynamic(this, &AMissile::OnHit);
+	// Missiles spawned directly fly straight away; pooled ones wait for OnAcquiredFromPool, so a parked
+	// missile never registers with guidance or records a launch
+	if (!bSpawnedForPool)
+	{
+		BeginFlight();
+	}
 }
 
-// Called every frame
-void AMissile::Tick(float DeltaTime)
+void AMissile::SetTarget(AActor* NewTarget, int32 TargetHandle)
 {
-	Super::Tick(DeltaTime);
+	TargetActor = NewTarget;
 
-	// If we have a target, update the projectile movement component
-	if (TargetActor)
+	if (UMissileGuidanceSubsystem* GuidanceSubsystem = GetWorld()->GetSubsystem<UMissileGuidanceSubsystem>())
 	{
-		ProjectileMovement->HomingTargetComponent = TargetActor->GetRootComponent();
+		GuidanceSubsystem->SetTarget(GuidanceHandle, NewTarget, TargetHandle);
 	}
 }
 
-void AMissile::SetTarget(AActor* NewTarget)
+void AMissile::OnSpawnedForPool()
 {
-	TargetActor = NewTarget;
+	bSpawnedForPool = true;
+}
+
+void AMissile::OnAcquiredFromPool()
+{
+	BeginFlight();
+}
+
+void AMissile::OnReturnedToPool()
+{
+	EndFlight();
 }
 
-void AMissile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+void AMissile::BeginFlight()
 {
-	// If we hit a valid actor that is not ourselves
-	if (OtherActor && OtherActor != this)
+	bInFlight = true;
+
+	// Launched from the aircraft's own velocity; guidance flies it from here until it fuzes, hits or runs out of time
+	if (UMissileGuidanceSubsystem* GuidanceSubsystem = GetWorld()->GetSubsystem<UMissileGuidanceSubsystem>())
+	{
+		const AActor* Launcher = GetOwner();
+		const UAircraftSpatialSubsystem* SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+		const int32 LauncherHandle = SpatialIndex ? SpatialIndex->FindHandle(Launcher) : INDEX_NONE;
+		const FVector Velocity = GetActorForwardVector() * Guidance.LaunchSpeed + (Launcher ? Launcher->GetVelocity() : FVector::ZeroVector);
+		GuidanceHandle = GuidanceSubsystem->RegisterMissile(this, GetActorLocation(), Velocity, Guidance.ToFlightModel(LifeSeconds), LauncherHandle);
+	}
+
+	TrailEffect->ActivateSystem(true);
+}
+
+void AMissile::EndFlight()
+{
+	bInFlight = false;
+	TargetActor = nullptr;
+
+	if (UMissileGuidanceSubsystem* GuidanceSubsystem = GetWorld()->GetSubsystem<UMissileGuidanceSubsystem>())
+	{
+		GuidanceSubsystem->UnregisterMissile(GuidanceHandle);
+	}
+	GuidanceHandle = INDEX_NONE;
+
+	TrailEffect->DeactivateSystem();
+	TrailEffect->ResetParticles();
+}
+
+void AMissile::ReturnToPool()
+{
+	if (!bInFlight)
+	{
+		return;
+	}
+
+	if (UActorPoolSubsystem* Pool = GetWorld()->GetSubsystem<UActorPoolSubsystem>())
+	{
+		Pool->Release(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void AMissile::Detonate(AActor* Victim, const FVector& Location, int32 VictimHandle)
+{
+	// A terrain trace can land for a missile that already fuzed this frame
+	if (!bInFlight)
+	{
+		return;
+	}
+
+	// Queued with the ledger; the victim hears about it when the frame's damage resolves
+	if (VictimHandle == INDEX_NONE && Victim)
+	{
+		const UAircraftSpatialSubsystem* SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+		VictimHandle = SpatialIndex ? SpatialIndex->FindHandle(Victim) : INDEX_NONE;
+	}
+	UDamageLedgerSubsystem* DamageLedger = GetWorld()->GetSubsystem<UDamageLedgerSubsystem>();
+	if (DamageLedger && DamageLedger->IsRegistered(VictimHandle))
 	{
-		// Try to find a health component on the actor we hit
-		UHealthComponent* HealthComponent = OtherActor->FindComponentByClass<UHealthComponent>();
-		if (HealthComponent)
-		{
-			// Apply damage
-			HealthComponent->TakeDamage(DamageAmount);
-		}
+		DamageLedger->QueueDamage(VictimHandle, DamageAmount);
 	}
 
 	// Spawn the explosion effect at the impact point
-	if (ExplosionEffect)
+	if (UEffectsSubsystem* Effects = GetWorld()->GetSubsystem<UEffectsSubsystem>())
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionEffect, GetActorLocation(), GetActorRotation());
+		Effects->PlayEmitter(ExplosionEffect, Location, GetActorRotation());
 	}
 
-	// Destroy the missile after it hits something
-	Destroy();
+	// Back to the pool for the next launch
+	ReturnToPool();
 }
@@ -0,0 +1,541 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "MissileGuidanceSubsystem.h"
+#include "ActorPoolSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "FighterJetPawn.h"
+#include "FlightRecorderSubsystem.h"
+#include "FlightSim1.h"
+#include "Missile.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Missile Guidance"), STAT_FlightMissileGuidance, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Missile Sync"), STAT_FlightMissileSync, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Missiles In Flight"), STAT_FlightMissilesInFlight, STATGROUP_FlightSim);
+
+static float GMissilesProxyRadiusScale = 1.0f;
+static FAutoConsoleVariableRef CVarMissilesProxyRadiusScale(
+	TEXT("FlightSim.Missiles.ProxyRadiusScale"),
+	GMissilesProxyRadiusScale,
+	TEXT("Multiplier on each aircraft's bounding sphere as a missile collision proxy (the fuze radius is added on top once armed)."));
+
+static int32 GMissilesTerrainTraces = 1;
+static FAutoConsoleVariableRef CVarMissilesTerrainTraces(
+	TEXT("FlightSim.Missiles.TerrainTraces"),
+	GMissilesTerrainTraces,
+	TEXT("1: one async line trace per missile per frame finds terrain, a frame late. 0: missiles fly through terrain."));
+
+// Terrain trace user data: missile handle in the low 16 bits, its generation above
+namespace MissileTerrainTrace
+{
+	static uint32 Pack(int32 Handle, uint16 Generation)
+	{
+		return uint32(Handle) | (uint32(Generation) << 16);
+	}
+}
+
+FlightModel::FMissileParams FMissileGuidanceParams::ToFlightModel(float MaxFlightTime) const
+{
+	FlightModel::FMissileParams Params;
+	Params.NavigationConstant = NavigationConstant;
+	Params.MaxG = MaxG;
+	Params.MotorAcceleration = MotorAcceleration;
+	Params.BurnTime = BurnTime;
+	Params.DragCoefficient = DragCoefficient;
+	Params.FuzeRadius = FuzeRadius;
+	Params.ArmTime = ArmTime;
+	Params.MaxFlightTime = MaxFlightTime;
+	return Params;
+}
+
+// --- FMissileGuidanceTickFunction ---
+
+void FMissileGuidanceTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->UpdateMissiles(DeltaTime);
+	}
+}
+
+FString FMissileGuidanceTickFunction::DiagnosticMessage()
+{
+	return TEXT("UMissileGuidanceSubsystem::UpdateMissiles");
+}
+
+// --- UMissileGuidanceSubsystem ---
+
+bool UMissileGuidanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMissileGuidanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	TerrainTraceDelegate.BindUObject(this, &UMissileGuidanceSubsystem::OnTerrainTraceDone);
+}
+
+void UMissileGuidanceSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+
+	Recorder = InWorld.GetSubsystem<UFlightRecorderSubsystem>();
+}
+
+void UMissileGuidanceSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+	TerrainTraceDelegate.Unbind();
+
+	Super::Deinitialize();
+}
+
+int32 UMissileGuidanceSubsystem::RegisterMissile(AMissile* Missile, const FVector& Location, const FVector& Velocity, const FlightModel::FMissileParams& Params,
+	int32 OwnerHandle)
+{
+	if (!Missile)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Handle;
+	if (FreeHandles.Num() > 0)
+	{
+		Handle = FreeHandles.Pop(EAllowShrinking::No);
+		++HandleGenerations[Handle];
+	}
+	else
+	{
+		Handle = HandleToSlot.Add(INDEX_NONE);
+		HandleGenerations.Add(0);
+	}
+
+	const int32 Slot = Batch.Add(FlightModel::FVec3d(Location.X, Location.Y, Location.Z), FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z),
+		Params, OwnerHandle);
+	Missiles.Add(Missile);
+	Targets.Add(nullptr);
+	TargetHandles.Add(INDEX_NONE);
+	SlotToHandle.Add(Handle);
+	HandleToSlot[Handle] = Slot;
+	check(Missiles.Num() == Batch.Num());
+
+	const uint32 OwnerTeam = SpatialIndex && SpatialIndex->IsValidHandle(OwnerHandle) ? SpatialIndex->GetTeamMask(OwnerHandle) : 0;
+	OwnerTeams.Add(OwnerTeam);
+	for (uint32 Bits = OwnerTeam; Bits != 0; Bits &= Bits - 1)
+	{
+		++TeamLaunches[FMath::CountTrailingZeros(Bits)];
+	}
+
+	if (Recorder)
+	{
+		Recorder->RecordMissileLaunch(Handle, OwnerHandle, Location, Velocity);
+	}
+	return Handle;
+}
+
+void UMissileGuidanceSubsystem::UnregisterMissile(int32 Handle)
+{
+	if (!IsValidHandle(Handle))
+	{
+		return;
+	}
+
+	// Event and sync loops index the batch by slot, so nothing moves until they are done
+	if (bUpdating)
+	{
+		const int32 Slot = HandleToSlot[Handle];
+		Missiles[Slot].Reset();
+		Targets[Slot].Reset();
+		return;
+	}
+
+	RemoveSlot(HandleToSlot[Handle]);
+	HandleToSlot[Handle] = INDEX_NONE;
+	FreeHandles.Add(Handle);
+}
+
+void UMissileGuidanceSubsystem::RemoveSlot(int32 Slot)
+{
+	// Swap the last slot into the hole and patch its handle
+	const int32 LastSlot = Missiles.Num() - 1;
+	if (Slot != LastSlot)
+	{
+		HandleToSlot[SlotToHandle[LastSlot]] = Slot;
+	}
+
+	Batch.RemoveAtSwap(Slot);
+	Missiles.RemoveAtSwap(Slot, EAllowShrinking::No);
+	Targets.RemoveAtSwap(Slot, EAllowShrinking::No);
+	TargetHandles.RemoveAtSwap(Slot, EAllowShrinking::No);
+	OwnerTeams.RemoveAtSwap(Slot, EAllowShrinking::No);
+	SlotToHandle.RemoveAtSwap(Slot, EAllowShrinking::No);
+}
+
+int32 UMissileGuidanceSubsystem::SumTeams(const int32 (&PerTeam)[32], uint32 TeamMask)
+{
+	int32 Sum = 0;
+	for (uint32 Bits = TeamMask; Bits != 0; Bits &= Bits - 1)
+	{
+		Sum += PerTeam[FMath::CountTrailingZeros(Bits)];
+	}
+	return Sum;
+}
+
+void UMissileGuidanceSubsystem::SetTarget(int32 Handle, AActor* Target, int32 TargetHandle)
+{
+	if (!IsValidHandle(Handle))
+	{
+		return;
+	}
+
+	const int32 Slot = HandleToSlot[Handle];
+	Targets[Slot] = Target;
+	TargetHandles[Slot] = Target ? TargetHandle : INDEX_NONE;
+	if (!Target)
+	{
+		Batch.ClearTarget(Slot);
+	}
+}
+
+void UMissileGuidanceSubsystem::BuildProxies()
+{
+	Proxies.Reset();
+	ProxyHandles.Reset();
+	if (!SpatialIndex)
+	{
+		return;
+	}
+
+	const TArrayView<const FVector> Locations = SpatialIndex->GetSlotLocations();
+	const TArrayView<const FVector> Velocities = SpatialIndex->GetSlotVelocities();
+	const TArrayView<const float> Radii = SpatialIndex->GetSlotRadii();
+	Proxies.Reserve(Locations.Num());
+	for (int32 Slot = 0; Slot < Locations.Num(); ++Slot)
+	{
+		const FVector& Center = Locations[Slot];
+		const FVector& Velocity = Velocities[Slot];
+		const int32 Handle = SpatialIndex->GetHandleOfSlot(Slot);
+		Proxies.Add(FlightModel::FVec3d(Center.X, Center.Y, Center.Z), FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z),
+			Radii[Slot] * GMissilesProxyRadiusScale, Handle);
+		ProxyHandles.Add(Handle);
+	}
+}
+
+void UMissileGuidanceSubsystem::TraceTerrain()
+{
+	UWorld* World = GetWorld();
+	const FCollisionObjectQueryParams TerrainObjects(ECC_WorldStatic);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MissileTerrain), false);
+	for (int32 Slot = 0; Slot < Missiles.Num(); ++Slot)
+	{
+		const int32 Handle = SlotToHandle[Slot];
+		if (!Missiles[Slot].IsValid() || Handle > 0xFFFF)
+		{
+			continue;
+		}
+
+		const FlightModel::FVec3d Start = Batch.GetStepStart(Slot);
+		const FlightModel::FVec3d End = Batch.GetPosition(Slot);
+		World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, FVector(Start.X, Start.Y, Start.Z), FVector(End.X, End.Y, End.Z),
+			TerrainObjects, QueryParams, &TerrainTraceDelegate, MissileTerrainTrace::Pack(Handle, HandleGenerations[Handle]));
+	}
+}
+
+void UMissileGuidanceSubsystem::OnTerrainTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if (TraceDatum.OutHits.Num() == 0 || !TraceDatum.OutHits[0].bBlockingHit)
+	{
+		return;
+	}
+
+	const int32 Handle = int32(TraceDatum.UserData & 0xFFFF);
+	if (!IsValidHandle(Handle) || HandleGenerations[Handle] != uint16(TraceDatum.UserData >> 16))
+	{
+		return;
+	}
+
+	if (AMissile* Missile = Missiles[HandleToSlot[Handle]].Get())
+	{
+		++TerrainImpactsThisFrame;
+		Missile->Detonate(nullptr, TraceDatum.OutHits[0].ImpactPoint);
+	}
+}
+
+void UMissileGuidanceSubsystem::UpdateMissiles(float DeltaTime)
+{
+	const int32 NumMissiles = Missiles.Num();
+	Stats = FMissileGuidanceStats();
+	Stats.NumMissiles = NumMissiles;
+	Stats.NumTerrainImpacts = TerrainImpactsThisFrame;
+	TerrainImpactsThisFrame = 0;
+	SET_DWORD_STAT(STAT_FlightMissilesInFlight, NumMissiles);
+	if (NumMissiles == 0)
+	{
+		return;
+	}
+
+	bUpdating = true;
+	UWorld* World = GetWorld();
+
+	double Start = FPlatformTime::Seconds();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlightMissileGuidance);
+
+		// Targets from the spatial index's dense arrays where the handle still names the same aircraft
+		for (int32 Slot = 0; Slot < NumMissiles; ++Slot)
+		{
+			const AActor* Target = Targets[Slot].Get();
+			if (!Target)
+			{
+				Batch.ClearTarget(Slot);
+				continue;
+			}
+
+			const int32 TargetHandle = TargetHandles[Slot];
+			const bool bIndexed = SpatialIndex && SpatialIndex->IsValidHandle(TargetHandle) && SpatialIndex->GetActor(TargetHandle) == Target;
+			const FVector Location = bIndexed ? SpatialIndex->GetLocation(TargetHandle) : Target->GetActorLocation();
+			const FVector Velocity = bIndexed ? SpatialIndex->GetVelocity(TargetHandle) : Target->GetVelocity();
+			Batch.SetTarget(Slot, FlightModel::FVec3d(Location.X, Location.Y, Location.Z), FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z));
+		}
+
+		BuildProxies();
+		Events.clear();
+		Batch.Step(DeltaTime, FlightModel::FVec3d(0.0, 0.0, World->GetGravityZ()), Proxies, Events);
+	}
+	Stats.GuidanceMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+
+	Start = FPlatformTime::Seconds();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_FlightMissileSync);
+
+		for (const FlightModel::FMissileEvent& Event : Events)
+		{
+			AMissile* Missile = Missiles[Event.Index].Get();
+			if (!Missile)
+			{
+				continue;
+			}
+
+			if (Event.Type == FlightModel::EMissileEvent::Detonated)
+			{
+				// On a proxy, the victim is whichever aircraft that was, which need not be the target
+				AActor* Victim = Targets[Event.Index].Get();
+				int32 VictimHandle = Victim ? TargetHandles[Event.Index] : INDEX_NONE;
+				if (Event.Proxy != INDEX_NONE)
+				{
+					VictimHandle = ProxyHandles[Event.Proxy];
+					AActor* ProxyActor = SpatialIndex->GetActor(VictimHandle);
+					Stats.NumProxyHits += ProxyActor != Victim;
+					Victim = ProxyActor;
+				}
+
+				++Stats.NumDetonated;
+				if (VictimHandle != INDEX_NONE)
+				{
+					for (uint32 Bits = OwnerTeams[Event.Index]; Bits != 0; Bits &= Bits - 1)
+					{
+						++TeamHits[FMath::CountTrailingZeros(Bits)];
+					}
+				}
+				Missile->Detonate(Victim, FVector(Event.Location.X, Event.Location.Y, Event.Location.Z), VictimHandle);
+			}
+			else
+			{
+				++Stats.NumExpired;
+				Missile->ReturnToPool();
+			}
+		}
+
+		// Collision is already settled, so the actors are only placed, never swept
+		for (int32 Slot = 0; Slot < NumMissiles; ++Slot)
+		{
+			if (AMissile* Missile = Missiles[Slot].Get())
+			{
+				const FlightModel::FVec3d Position = Batch.GetPosition(Slot);
+				const FlightModel::FVec3d Velocity = Batch.GetVelocity(Slot);
+				Missile->SetActorLocationAndRotation(FVector(Position.X, Position.Y, Position.Z), FVector(Velocity.X, Velocity.Y, Velocity.Z).Rotation(),
+					false, nullptr, ETeleportType::TeleportPhysics);
+			}
+		}
+
+		if (GMissilesTerrainTraces != 0)
+		{
+			TraceTerrain();
+		}
+	}
+	Stats.SyncMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+
+	// Empty slots are missiles that finished this frame, or were destroyed outside the pool and never unregistered
+	bUpdating = false;
+	for (int32 Slot = Missiles.Num() - 1; Slot >= 0; --Slot)
+	{
+		if (!Missiles[Slot].IsValid())
+		{
+			const int32 Handle = SlotToHandle[Slot];
+			RemoveSlot(Slot);
+			HandleToSlot[Handle] = INDEX_NONE;
+			FreeHandles.Add(Handle);
+		}
+	}
+}
+
+void UMissileGuidanceSubsystem::ReturnAllMissiles()
+{
+	// Backwards, since each missile unregisters as it is parked and the last slot is swapped into its place
+	for (int32 Slot = Missiles.Num() - 1; Slot >= 0; --Slot)
+	{
+		AMissile* Missile = Missiles[Slot].Get();
+		if (Missile && Missile->IsInFlight())
+		{
+			Missile->ReturnToPool();
+		}
+		else
+		{
+			// The actor is already gone; only its slot is left
+			const int32 Handle = SlotToHandle[Slot];
+			RemoveSlot(Slot);
+			HandleToSlot[Handle] = INDEX_NONE;
+			FreeHandles.Add(Handle);
+		}
+	}
+}
+
+void UMissileGuidanceSubsystem::CaptureSnapshot(std::vector<FlightModel::FMissileSnapshot>& OutMissiles) const
+{
+	for (int32 Slot = 0; Slot < Missiles.Num(); ++Slot)
+	{
+		if (!Missiles[Slot].IsValid())
+		{
+			continue;
+		}
+
+		FlightModel::FMissileSnapshot& Snapshot = OutMissiles.emplace_back();
+		Snapshot.Id = SlotToHandle[Slot];
+		Snapshot.Generation = HandleGenerations[Snapshot.Id];
+		Snapshot.Owner = Batch.GetOwner(Slot);
+		Snapshot.Target = Targets[Slot].IsValid() ? TargetHandles[Slot] : INDEX_NONE;
+		Snapshot.Position = Batch.GetPosition(Slot);
+		Snapshot.Velocity = Batch.GetVelocity(Slot);
+		Snapshot.Age = Batch.GetAge(Slot);
+	}
+}
+
+int32 UMissileGuidanceSubsystem::RestoreSnapshot(const std::vector<FlightModel::FMissileSnapshot>& InMissiles)
+{
+	check(!bUpdating);
+
+	int32 NumMissing = 0;
+	RestoredHandles.Init(false, HandleToSlot.Num());
+	for (const FlightModel::FMissileSnapshot& Snapshot : InMissiles)
+	{
+		// A recycled handle is a different missile, launched after the snapshot
+		const bool bSameMissile = IsValidHandle(Snapshot.Id) && HandleGenerations[Snapshot.Id] == uint16(Snapshot.Generation);
+		AMissile* Missile = bSameMissile ? Missiles[HandleToSlot[Snapshot.Id]].Get() : nullptr;
+		if (!Missile || !Missile->IsInFlight())
+		{
+			++NumMissing;
+			continue;
+		}
+
+		const int32 Slot = HandleToSlot[Snapshot.Id];
+		Batch.SetState(Slot, Snapshot.Position, Snapshot.Velocity, Snapshot.Age);
+		RestoredHandles[Snapshot.Id] = true;
+
+		AActor* Target = SpatialIndex && SpatialIndex->IsValidHandle(Snapshot.Target) ? SpatialIndex->GetActor(Snapshot.Target) : nullptr;
+		Missile->SetTarget(Target, Target ? Snapshot.Target : INDEX_NONE);
+		Missile->SetActorLocationAndRotation(FVector(Snapshot.Position.X, Snapshot.Position.Y, Snapshot.Position.Z),
+			FVector(Snapshot.Velocity.X, Snapshot.Velocity.Y, Snapshot.Velocity.Z).Rotation(), false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	// Launched after the snapshot was taken, so never launched at all as far as it is concerned; backwards, as in ReturnAllMissiles
+	for (int32 Slot = Missiles.Num() - 1; Slot >= 0; --Slot)
+	{
+		const int32 Handle = SlotToHandle[Slot];
+		if (RestoredHandles[Handle])
+		{
+			continue;
+		}
+
+		AMissile* Missile = Missiles[Slot].Get();
+		if (Missile && Missile->IsInFlight())
+		{
+			Missile->ReturnToPool();
+		}
+		else
+		{
+			RemoveSlot(Slot);
+			HandleToSlot[Handle] = INDEX_NONE;
+			FreeHandles.Add(Handle);
+		}
+	}
+
+	return NumMissing;
+}
+
+// --- Salvo ---
+
+namespace MissileSalvo
+{
+	// Launches Count missiles from the player's jet, spread over every other aircraft, to load guidance with a large salvo
+	static void Run(const TArray<FString>& Args, UWorld* World)
+	{
+		AFighterJetPawn* Jet = World ? Cast<AFighterJetPawn>(UGameplayStatics::GetPlayerPawn(World, 0)) : nullptr;
+		UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr;
+		UAircraftSpatialSubsystem* SpatialIndex = World ? World->GetSubsystem<UAircraftSpatialSubsystem>() : nullptr;
+		if (!Jet || !Jet->MissileClass || !Pool || !SpatialIndex || SpatialIndex->GetNumAircraft() < 2)
+		{
+			UE_LOG(LogFlightSim, Warning, TEXT("Missiles.Salvo: needs the player's jet with a missile class and at least one other aircraft"));
+			return;
+		}
+
+		const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 500;
+		const int32 NumAircraft = SpatialIndex->GetNumAircraft();
+		const FVector Origin = Jet->GetActorLocation();
+
+		int32 Launched = 0;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const int32 TargetHandle = SpatialIndex->GetHandleOfSlot(i % NumAircraft);
+			AActor* Target = SpatialIndex->GetActor(TargetHandle);
+			if (Target == Jet)
+			{
+				continue;
+			}
+
+			// A ring around the jet, pointing at the target, so the launches do not collide with each other
+			const float Angle = 2.0f * PI * i / Count;
+			const FVector Location = Origin + FVector(0.0f, FMath::Cos(Angle), FMath::Sin(Angle)) * 2000.0f;
+			const FRotator Rotation = (SpatialIndex->GetLocation(TargetHandle) - Location).Rotation();
+			if (AMissile* Missile = Pool->Acquire<AMissile>(Jet->MissileClass, FTransform(Rotation, Location), Jet, Jet))
+			{
+				Missile->SetTarget(Target, TargetHandle);
+				++Launched;
+			}
+		}
+
+		UE_LOG(LogFlightSim, Display, TEXT("Missiles.Salvo: launched %d missiles at %d aircraft; see \"stat FlightSim\" for guidance and sync cost"),
+			Launched, NumAircraft - 1);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs SalvoCommand(
+		TEXT("FlightSim.Missiles.Salvo"),
+		TEXT("Launches a salvo from the player's jet spread over every other aircraft. Usage: FlightSim.Missiles.Salvo [Count]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Run));
+}
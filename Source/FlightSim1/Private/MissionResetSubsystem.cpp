@@ -0,0 +1,310 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "MissionResetSubsystem.h"
+#include "FlightSim1.h"
+#include "ActorPoolSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DamageLedgerSubsystem.h"
+#include "FighterJetPawn.h"
+#include "GunfireSubsystem.h"
+#include "HealthComponent.h"
+#include "MissileGuidanceSubsystem.h"
+#include "SpawnDirectorSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Mission Reset"), STAT_FlightMissionReset, STATGROUP_FlightSim);
+
+// --- FMissionResetTickFunction ---
+
+void FMissionResetTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->Update();
+	}
+}
+
+FString FMissionResetTickFunction::DiagnosticMessage()
+{
+	return TEXT("UMissionResetSubsystem::Update");
+}
+
+// --- UMissionResetSubsystem ---
+
+bool UMissionResetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMissionResetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	DamageLedger = Collection.InitializeDependency<UDamageLedgerSubsystem>();
+	ActorPool = Collection.InitializeDependency<UActorPoolSubsystem>();
+	SpawnDirector = Collection.InitializeDependency<USpawnDirectorSubsystem>();
+	MissileGuidance = Collection.InitializeDependency<UMissileGuidanceSubsystem>();
+	Gunfire = Collection.InitializeDependency<UGunfireSubsystem>();
+}
+
+void UMissionResetSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = true;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UMissionResetSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	Roster.Empty();
+	ToRelease.Empty();
+	OnMissionReset.Clear();
+
+	Super::Deinitialize();
+}
+
+void UMissionResetSubsystem::Update()
+{
+	if (bResetRequested)
+	{
+		bResetRequested = false;
+		ResetMission();
+		return;
+	}
+
+	// The mission has started once the player is in and the opening wave has finished spawning
+	if (!bHasSnapshot && UGameplayStatics::GetPlayerPawn(GetWorld(), 0) && (!SpawnDirector || SpawnDirector->GetNumPending() == 0))
+	{
+		CaptureInitialState();
+	}
+}
+
+FMissionAircraftSnapshot UMissionResetSubsystem::CaptureAircraft(AActor* Aircraft, int32 Handle) const
+{
+	FMissionAircraftSnapshot Snapshot;
+	Snapshot.Class = Aircraft->GetClass();
+	Snapshot.Transform = Aircraft->GetActorTransform();
+	Snapshot.TeamMask = SpatialIndex->GetTeamMask(Handle);
+	Snapshot.Health = DamageLedger ? DamageLedger->GetHealth(Handle) : 0.0f;
+
+	const UPrimitiveComponent* Body = SpatialIndex->GetBody(Handle);
+	if (Body && Body->IsSimulatingPhysics())
+	{
+		Snapshot.LinearVelocity = Body->GetPhysicsLinearVelocity();
+		Snapshot.AngularVelocity = Body->GetPhysicsAngularVelocityInRadians();
+	}
+	else
+	{
+		Snapshot.LinearVelocity = SpatialIndex->GetVelocity(Handle);
+	}
+	return Snapshot;
+}
+
+void UMissionResetSubsystem::CaptureInitialState()
+{
+	if (!SpatialIndex)
+	{
+		return;
+	}
+
+	Player = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
+	Roster.Reset();
+	for (int32 Slot = 0; Slot < SpatialIndex->GetNumAircraft(); ++Slot)
+	{
+		const int32 Handle = SpatialIndex->GetHandleOfSlot(Slot);
+		AActor* Aircraft = SpatialIndex->GetActor(Handle);
+		if (!Aircraft)
+		{
+			continue;
+		}
+
+		if (Aircraft == Player.Get())
+		{
+			PlayerSnapshot = CaptureAircraft(Aircraft, Handle);
+		}
+		else
+		{
+			Roster.Add(CaptureAircraft(Aircraft, Handle));
+		}
+	}
+
+	bHasSnapshot = true;
+	UE_LOG(LogFlightSim, Log, TEXT("MissionReset: captured the player and %d other aircraft"), Roster.Num());
+}
+
+void UMissionResetSubsystem::RequestReset()
+{
+	bResetRequested = true;
+}
+
+int32 UMissionResetSubsystem::GetNumSnapshotAircraft(uint32 TeamMask) const
+{
+	int32 Count = 0;
+	for (const FMissionAircraftSnapshot& Snapshot : Roster)
+	{
+		Count += (Snapshot.TeamMask & TeamMask) != 0;
+	}
+	return Count;
+}
+
+void UMissionResetSubsystem::PlaceSnapshotAircraft(uint32 TeamMask, TArrayView<const FTransform> Transforms)
+{
+	int32 Next = 0;
+	for (FMissionAircraftSnapshot& Snapshot : Roster)
+	{
+		if ((Snapshot.TeamMask & TeamMask) == 0)
+		{
+			continue;
+		}
+		if (Next == Transforms.Num())
+		{
+			break;
+		}
+
+		const FTransform& Transform = Transforms[Next++];
+		const FQuat Turn = Transform.GetRotation() * Snapshot.Transform.GetRotation().Inverse();
+		Snapshot.LinearVelocity = Turn.RotateVector(Snapshot.LinearVelocity);
+		Snapshot.AngularVelocity = Turn.RotateVector(Snapshot.AngularVelocity);
+		Snapshot.Transform.SetLocation(Transform.GetLocation());
+		Snapshot.Transform.SetRotation(Transform.GetRotation());
+	}
+}
+
+void UMissionResetSubsystem::RestoreAircraft(AActor* Aircraft, const FMissionAircraftSnapshot& Snapshot) const
+{
+	const int32 Handle = SpatialIndex->FindHandle(Aircraft);
+
+	UPrimitiveComponent* Body = SpatialIndex->GetBody(Handle);
+	if (Body && Body->IsSimulatingPhysics())
+	{
+		Body->SetPhysicsLinearVelocity(Snapshot.LinearVelocity);
+		Body->SetPhysicsAngularVelocityInRadians(Snapshot.AngularVelocity);
+	}
+
+	if (UHealthComponent* Health = DamageLedger ? DamageLedger->GetHealthComponent(Handle) : nullptr)
+	{
+		Health->SetHealth(Snapshot.Health);
+	}
+}
+
+void UMissionResetSubsystem::ResetMission()
+{
+	if (!bHasSnapshot || !SpatialIndex || !ActorPool)
+	{
+		// Too early to have a start to go back to
+		UE_LOG(LogFlightSim, Warning, TEXT("MissionReset: no snapshot yet, reloading the level"));
+		UGameplayStatics::OpenLevel(GetWorld(), FName(*UGameplayStatics::GetCurrentLevelName(GetWorld())), false);
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlightMissionReset);
+	const double Start = FPlatformTime::Seconds();
+
+	// Nothing fired before the reset may land after it
+	if (MissileGuidance)
+	{
+		MissileGuidance->ReturnAllMissiles();
+	}
+	if (Gunfire)
+	{
+		Gunfire->ClearInFlight();
+	}
+	if (DamageLedger)
+	{
+		DamageLedger->CancelPending();
+	}
+	if (SpawnDirector)
+	{
+		SpawnDirector->CancelPending();
+	}
+
+	// Every aircraft but the player goes back to the pool...
+	APawn* PlayerPawn = Player.Get();
+	ToRelease.Reset();
+	for (int32 Slot = 0; Slot < SpatialIndex->GetNumAircraft(); ++Slot)
+	{
+		AActor* Aircraft = SpatialIndex->GetActor(SpatialIndex->GetHandleOfSlot(Slot));
+		if (Aircraft && Aircraft != PlayerPawn)
+		{
+			ToRelease.Add(Aircraft);
+		}
+	}
+	for (AActor* Aircraft : ToRelease)
+	{
+		if (Cast<IPooledActor>(Aircraft))
+		{
+			ActorPool->Release(Aircraft);
+		}
+		else
+		{
+			Aircraft->Destroy();
+		}
+	}
+
+	// ...and the roster comes straight back out of it
+	const int32 SpawnedBefore = ActorPool->GetTotalStats().NumSpawned;
+	for (const FMissionAircraftSnapshot& Snapshot : Roster)
+	{
+		if (AActor* Aircraft = ActorPool->Acquire(Snapshot.Class, Snapshot.Transform))
+		{
+			RestoreAircraft(Aircraft, Snapshot);
+		}
+	}
+	const int32 NumSpawned = ActorPool->GetTotalStats().NumSpawned - SpawnedBefore;
+	Stats.NumSpawned += NumSpawned;
+	Stats.NumRecycled += Roster.Num() - NumSpawned;
+
+	if (PlayerPawn)
+	{
+		if (AFighterJetPawn* Jet = Cast<AFighterJetPawn>(PlayerPawn))
+		{
+			Jet->ResetForMission();
+		}
+		PlayerPawn->SetActorTransform(PlayerSnapshot.Transform, false, nullptr, ETeleportType::ResetPhysics);
+		RestoreAircraft(PlayerPawn, PlayerSnapshot);
+	}
+
+	++Stats.NumResets;
+	Stats.LastResetMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+	UE_LOG(LogFlightSim, Log, TEXT("MissionReset: restored %d aircraft (%d built) in %.2f ms"), Roster.Num(), NumSpawned, Stats.LastResetMilliseconds);
+
+	OnMissionReset.Broadcast();
+}
+
+static FAutoConsoleCommandWithWorld GMissionResetCommand(
+	TEXT("FlightSim.Mission.Reset"),
+	TEXT("Puts the mission back to how it started, in place, and logs how long that took."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UMissionResetSubsystem* MissionReset = World ? World->GetSubsystem<UMissionResetSubsystem>() : nullptr)
+		{
+			MissionReset->ResetMission();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld GMissionCaptureCommand(
+	TEXT("FlightSim.Mission.Capture"),
+	TEXT("Makes the world as it is now the state FlightSim.Mission.Reset and player deaths go back to."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UMissionResetSubsystem* MissionReset = World ? World->GetSubsystem<UMissionResetSubsystem>() : nullptr)
+		{
+			MissionReset->CaptureInitialState();
+		}
+	}));
@@ -0,0 +1,377 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "RadarSubsystem.h"
+#include "AircraftSpatialSubsystem.h"
+#include "FlightSim1.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sensors Update"), STAT_FlightSensorsUpdate, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensor Traces Issued"), STAT_FlightSensorTraces, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensor Trace Backlog"), STAT_FlightSensorBacklog, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sensor Contacts"), STAT_FlightSensorContacts, STATGROUP_FlightSim);
+
+static int32 GSensorMaxTracesPerFrame = 64;
+static FAutoConsoleVariableRef CVarSensorMaxTracesPerFrame(
+	TEXT("FlightSim.Sensors.MaxTracesPerFrame"),
+	GSensorMaxTracesPerFrame,
+	TEXT("Line-of-sight traces the radar may issue per frame; the rest wait for later frames."));
+
+static float GSensorLineOfSightRefresh = 0.5f;
+static FAutoConsoleVariableRef CVarSensorLineOfSightRefresh(
+	TEXT("FlightSim.Sensors.LineOfSightRefresh"),
+	GSensorLineOfSightRefresh,
+	TEXT("Seconds before a sensor/target line-of-sight result is traced again."));
+
+static float GSensorTrackMemory = 2.0f;
+static FAutoConsoleVariableRef CVarSensorTrackMemory(
+	TEXT("FlightSim.Sensors.TrackMemory"),
+	GSensorTrackMemory,
+	TEXT("Seconds a pair that left the cone keeps its line-of-sight result, so a target crossing the cone edge is not traced from scratch."));
+
+// Trace user data packs both handles into 16 bits each
+static constexpr int32 MaxTraceableHandle = 0xFFFF;
+
+// --- FRadarTickFunction ---
+
+void FRadarTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->UpdateSensors(DeltaTime);
+	}
+}
+
+FString FRadarTickFunction::DiagnosticMessage()
+{
+	return TEXT("URadarSubsystem::UpdateSensors");
+}
+
+// --- URadarSubsystem ---
+
+bool URadarSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void URadarSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	TraceDelegate.BindUObject(this, &URadarSubsystem::OnLineOfSightTraceDone);
+}
+
+void URadarSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void URadarSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+	TraceDelegate.Unbind();
+
+	Super::Deinitialize();
+}
+
+void URadarSubsystem::RegisterSensor(int32 AircraftHandle, const FRadarSensorParams& Params, uint32 TargetTeamMask)
+{
+	if (AircraftHandle == INDEX_NONE || !Params.bEnabled)
+	{
+		return;
+	}
+
+	while (AircraftToSensor.Num() <= AircraftHandle)
+	{
+		AircraftToSensor.Add(INDEX_NONE);
+	}
+
+	// Re-registering replaces the old parameters
+	UnregisterSensor(AircraftHandle);
+
+	FSensor& Sensor = Sensors.AddDefaulted_GetRef();
+	Sensor.AircraftHandle = AircraftHandle;
+	Sensor.Range = Params.Range;
+	Sensor.MinCosAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(Params.ConeHalfAngle, 0.0f, 180.0f)));
+	Sensor.TargetTeamMask = TargetTeamMask;
+	AircraftToSensor[AircraftHandle] = Sensors.Num() - 1;
+}
+
+void URadarSubsystem::UnregisterSensor(int32 AircraftHandle)
+{
+	if (!AircraftToSensor.IsValidIndex(AircraftHandle) || AircraftToSensor[AircraftHandle] == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Swap the last sensor into the hole and patch its aircraft's entry. Traces still in flight
+	// for the removed sensor find no sensor (or a new one without that track) and are dropped.
+	const int32 Slot = AircraftToSensor[AircraftHandle];
+	const int32 LastSlot = Sensors.Num() - 1;
+	if (Slot != LastSlot)
+	{
+		AircraftToSensor[Sensors[LastSlot].AircraftHandle] = Slot;
+	}
+
+	Sensors.RemoveAtSwap(Slot, EAllowShrinking::No);
+	AircraftToSensor[AircraftHandle] = INDEX_NONE;
+}
+
+TArrayView<const FRadarContact> URadarSubsystem::GetContacts(int32 AircraftHandle) const
+{
+	if (!AircraftToSensor.IsValidIndex(AircraftHandle) || AircraftToSensor[AircraftHandle] == INDEX_NONE)
+	{
+		return TArrayView<const FRadarContact>();
+	}
+	return Sensors[AircraftToSensor[AircraftHandle]].Contacts;
+}
+
+bool URadarSubsystem::HasContact(int32 AircraftHandle, int32 TargetHandle) const
+{
+	for (const FRadarContact& Contact : GetContacts(AircraftHandle))
+	{
+		if (Contact.Handle == TargetHandle)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool URadarSubsystem::GetNearestContact(int32 AircraftHandle, uint32 TeamMask, FRadarContact& OutContact) const
+{
+	const FRadarContact* Nearest = nullptr;
+	for (const FRadarContact& Contact : GetContacts(AircraftHandle))
+	{
+		if ((Contact.TeamMask & TeamMask) && (!Nearest || Contact.Distance < Nearest->Distance))
+		{
+			Nearest = &Contact;
+		}
+	}
+
+	if (Nearest)
+	{
+		OutContact = *Nearest;
+	}
+	return Nearest != nullptr;
+}
+
+void URadarSubsystem::UpdateSensors(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightSensorsUpdate);
+
+	if (!SpatialIndex)
+	{
+		return;
+	}
+
+	const double Time = GetWorld()->GetTimeSeconds();
+
+	// Cone and range tests for everyone, then contacts from the cached line-of-sight results
+	int32 NumTracks = 0;
+	int32 NumContacts = 0;
+	double TotalAge = 0.0;
+	int32 NumAged = 0;
+	for (FSensor& Sensor : Sensors)
+	{
+		UpdateTracks(Sensor, Time);
+
+		for (const FTrack& Track : Sensor.Tracks)
+		{
+			if (Track.LastInConeTime == Time)
+			{
+				++NumTracks;
+				if (Track.LastTraceTime >= 0.0)
+				{
+					TotalAge += Time - Track.LastTraceTime;
+					++NumAged;
+				}
+			}
+		}
+		NumContacts += Sensor.Contacts.Num();
+	}
+
+	// Line of sight for as many in-cone pairs as the budget allows: never-traced pairs first, then stale ones
+	const int32 Budget = FMath::Max(GSensorMaxTracesPerFrame, 0);
+	const double RefreshSeconds = GSensorLineOfSightRefresh;
+	int32 Remaining = Budget;
+
+	const int32 StartCursor = TraceCursor;
+	if (IssueTraces(Time, Remaining, [](const FTrack& Track) { return Track.LastTraceTime < 0.0; }))
+	{
+		TraceCursor = StartCursor;
+		IssueTraces(Time, Remaining, [Time, RefreshSeconds](const FTrack& Track) { return Time - Track.LastTraceTime >= RefreshSeconds; });
+	}
+
+	// What is still waiting once the budget ran out
+	int32 Backlog = 0;
+	if (Remaining == 0)
+	{
+		for (const FSensor& Sensor : Sensors)
+		{
+			for (const FTrack& Track : Sensor.Tracks)
+			{
+				Backlog += Track.LastInConeTime == Time && !Track.bTracePending && Time - Track.LastTraceTime >= RefreshSeconds;
+			}
+		}
+	}
+
+	Stats.NumSensors = Sensors.Num();
+	Stats.NumTracks = NumTracks;
+	Stats.NumContacts = NumContacts;
+	Stats.TracesIssued = Budget - Remaining;
+	Stats.TraceBacklog = Backlog;
+	Stats.AverageLineOfSightAgeSeconds = NumAged > 0 ? float(TotalAge / NumAged) : 0.0f;
+	Stats.TracesCompleted = TracesCompletedSinceUpdate;
+	TracesCompletedSinceUpdate = 0;
+
+	INC_DWORD_STAT_BY(STAT_FlightSensorTraces, Stats.TracesIssued);
+	INC_DWORD_STAT_BY(STAT_FlightSensorBacklog, Stats.TraceBacklog);
+	INC_DWORD_STAT_BY(STAT_FlightSensorContacts, Stats.NumContacts);
+}
+
+void URadarSubsystem::UpdateTracks(FSensor& Sensor, double Time)
+{
+	Sensor.Contacts.Reset();
+
+	const AActor* SensorActor = SpatialIndex->GetActor(Sensor.AircraftHandle);
+	if (!SensorActor)
+	{
+		return;
+	}
+
+	const FVector Origin = SpatialIndex->GetLocation(Sensor.AircraftHandle);
+	SpatialIndex->QueryCone(Origin, SensorActor->GetActorForwardVector(), Sensor.MinCosAngle, Sensor.Range, Sensor.TargetTeamMask, Candidates);
+
+	for (int32 Handle : Candidates)
+	{
+		if (Handle == Sensor.AircraftHandle)
+		{
+			continue;
+		}
+
+		// Tracks per sensor are few, so a linear search beats keeping a map up to date
+		AActor* TargetActor = SpatialIndex->GetActor(Handle);
+		FTrack* Track = Sensor.Tracks.FindByPredicate([Handle](const FTrack& Existing) { return Existing.TargetHandle == Handle; });
+		if (!Track)
+		{
+			Track = &Sensor.Tracks.AddDefaulted_GetRef();
+		}
+		if (Track->TargetHandle != Handle || Track->TargetActor.Get() != TargetActor)
+		{
+			// New pair, or the handle now belongs to a different aircraft
+			*Track = FTrack();
+			Track->TargetHandle = Handle;
+			Track->TargetActor = TargetActor;
+		}
+		Track->LastInConeTime = Time;
+
+		if (Track->bLineOfSight)
+		{
+			FRadarContact& Contact = Sensor.Contacts.AddDefaulted_GetRef();
+			Contact.Handle = Handle;
+			Contact.TeamMask = SpatialIndex->GetTeamMask(Handle);
+			Contact.Location = SpatialIndex->GetLocation(Handle);
+			Contact.Velocity = SpatialIndex->GetVelocity(Handle);
+			Contact.Distance = FVector::Dist(Origin, Contact.Location);
+		}
+	}
+
+	// Forget pairs that have been out of the cone for a while
+	const double ForgetBefore = Time - GSensorTrackMemory;
+	for (int32 i = Sensor.Tracks.Num() - 1; i >= 0; --i)
+	{
+		const FTrack& Track = Sensor.Tracks[i];
+		if (Track.LastInConeTime < ForgetBefore || !SpatialIndex->IsValidHandle(Track.TargetHandle))
+		{
+			Sensor.Tracks.RemoveAtSwap(i, EAllowShrinking::No);
+		}
+	}
+}
+
+template<typename FilterType>
+bool URadarSubsystem::IssueTraces(double Time, int32& InOutBudget, FilterType&& Filter)
+{
+	UWorld* World = GetWorld();
+	const int32 NumSensors = Sensors.Num();
+	if (NumSensors == 0)
+	{
+		return true;
+	}
+
+	const FCollisionObjectQueryParams TerrainObjects(ECC_WorldStatic);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(RadarLineOfSight), false);
+
+	TraceCursor = TraceCursor % NumSensors;
+	for (int32 Offset = 0; Offset < NumSensors; ++Offset)
+	{
+		const int32 Slot = (TraceCursor + Offset) % NumSensors;
+		FSensor& Sensor = Sensors[Slot];
+		const FVector Origin = SpatialIndex->GetLocation(Sensor.AircraftHandle);
+
+		for (FTrack& Track : Sensor.Tracks)
+		{
+			if (Track.LastInConeTime != Time || Track.bTracePending || !Filter(Track))
+			{
+				continue;
+			}
+
+			if (InOutBudget <= 0)
+			{
+				// Resume from this sensor next frame
+				TraceCursor = Slot;
+				return false;
+			}
+
+			if (Sensor.AircraftHandle > MaxTraceableHandle || Track.TargetHandle > MaxTraceableHandle)
+			{
+				// Cannot be addressed by a trace; cone and range alone decide
+				Track.bLineOfSight = true;
+				Track.LastTraceTime = Time;
+				continue;
+			}
+
+			const uint32 UserData = (uint32(Sensor.AircraftHandle) << 16) | uint32(Track.TargetHandle);
+			World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, Origin, SpatialIndex->GetLocation(Track.TargetHandle),
+				TerrainObjects, QueryParams, &TraceDelegate, UserData);
+
+			Track.bTracePending = true;
+			Track.LastTraceTime = Time;
+			--InOutBudget;
+		}
+	}
+
+	TraceCursor = (TraceCursor + 1) % NumSensors;
+	return true;
+}
+
+void URadarSubsystem::OnLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	++TracesCompletedSinceUpdate;
+
+	const int32 AircraftHandle = int32(TraceDatum.UserData >> 16);
+	const int32 TargetHandle = int32(TraceDatum.UserData & 0xFFFF);
+	if (!AircraftToSensor.IsValidIndex(AircraftHandle) || AircraftToSensor[AircraftHandle] == INDEX_NONE)
+	{
+		return;
+	}
+
+	FSensor& Sensor = Sensors[AircraftToSensor[AircraftHandle]];
+	if (FTrack* Track = Sensor.Tracks.FindByPredicate([TargetHandle](const FTrack& Existing) { return Existing.TargetHandle == TargetHandle; }))
+	{
+		// Anything static in between (terrain, buildings) masks the target
+		Track->bLineOfSight = TraceDatum.OutHits.Num() == 0 || !TraceDatum.OutHits[0].bBlockingHit;
+		Track->bTracePending = false;
+	}
+}
@@ -0,0 +1,221 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "SpawnDirectorSubsystem.h"
+#include "FlightSim1.h"
+#include "ActorPoolSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Director"), STAT_FlightSpawnDirector, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aircraft Spawned"), STAT_FlightSpawnDirectorSpawned, STATGROUP_FlightSim);
+
+static float GSpawnBudgetMs = 2.0f;
+static FAutoConsoleVariableRef CVarSpawnBudgetMs(
+	TEXT("FlightSim.Spawn.BudgetMs"),
+	GSpawnBudgetMs,
+	TEXT("Time per frame spent spawning queued aircraft and prewarming the pool, ms. At least one aircraft spawns per frame while any are queued."));
+
+static int32 GSpawnMaxPerFrame = 16;
+static FAutoConsoleVariableRef CVarSpawnMaxPerFrame(
+	TEXT("FlightSim.Spawn.MaxPerFrame"),
+	GSpawnMaxPerFrame,
+	TEXT("Most aircraft spawned or prewarmed in one frame, however cheap they turn out to be."));
+
+// --- FSpawnDirectorTickFunction ---
+
+void FSpawnDirectorTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Owner && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Owner->UpdateSpawns();
+	}
+}
+
+FString FSpawnDirectorTickFunction::DiagnosticMessage()
+{
+	return TEXT("USpawnDirectorSubsystem::UpdateSpawns");
+}
+
+// --- USpawnDirectorSubsystem ---
+
+bool USpawnDirectorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USpawnDirectorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorPool = Collection.InitializeDependency<UActorPoolSubsystem>();
+}
+
+void USpawnDirectorSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.Owner = this;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bTickEvenWhenPaused = false;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void USpawnDirectorSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Owner = nullptr;
+
+	Pending.Empty();
+	NextPending = 0;
+	PrewarmTargets.Empty();
+
+	Super::Deinitialize();
+}
+
+void USpawnDirectorSubsystem::PlaceWave(const FAircraftSpawnWave& Wave, TArray<FTransform>& OutTransforms)
+{
+	OutTransforms.Reset();
+	if (Wave.Count <= 0)
+	{
+		return;
+	}
+	OutTransforms.Reserve(Wave.Count);
+
+	FRandomStream Random(Wave.Seed != 0 ? Wave.Seed : FMath::Rand());
+	const int32 FormationSize = Wave.Pattern == EAircraftSpawnPattern::Formation ? FMath::Max(Wave.FormationSize, 1) : 1;
+	const int32 NumGroups = FMath::DivideAndRoundUp(Wave.Count, FormationSize);
+	const float Jitter = FMath::Clamp(Wave.AngleJitter, 0.0f, 1.0f);
+
+	for (int32 Group = 0; Group < NumGroups; ++Group)
+	{
+		// Evenly round the ring in radians, each position moved by up to half its share either way
+		const float Angle = UE_TWO_PI * (Group + Jitter * (Random.FRand() - 0.5f)) / NumGroups;
+		const FVector Lead = Wave.Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * Wave.Radius;
+
+		// Facing the centre
+		const FRotator Rotation(0.0f, FMath::RadiansToDegrees(Angle) + 180.0f, 0.0f);
+		const FVector Forward = Rotation.Vector();
+		const FVector Right(-Forward.Y, Forward.X, 0.0f);
+
+		// Wingmen alternate right and left, each pair one step further back and out
+		const int32 NumInGroup = FMath::Min(FormationSize, Wave.Count - Group * FormationSize);
+		for (int32 Member = 0; Member < NumInGroup; ++Member)
+		{
+			const int32 Rank = (Member + 1) / 2;
+			const float Side = (Member & 1) ? 1.0f : -1.0f;
+			const FVector Offset = (Right * Side - Forward) * (Rank * Wave.FormationSpacing);
+			OutTransforms.Emplace(Rotation, Lead + Offset);
+		}
+	}
+}
+
+void USpawnDirectorSubsystem::QueueWave(const FAircraftSpawnWave& Wave)
+{
+	if (!Wave.AircraftClass || Wave.Count <= 0)
+	{
+		return;
+	}
+
+	PlaceWave(Wave, Placement);
+	Pending.Reserve(GetNumPending() + Placement.Num());
+	for (const FTransform& Transform : Placement)
+	{
+		FPendingSpawn& Spawn = Pending.AddDefaulted_GetRef();
+		Spawn.Class = Wave.AircraftClass.Get();
+		Spawn.Transform = Transform;
+	}
+	Stats.NumPending = GetNumPending();
+}
+
+void USpawnDirectorSubsystem::PrewarmPool(TSubclassOf<AActor> AircraftClass, int32 Count)
+{
+	if (AircraftClass && Count > 0)
+	{
+		int32& Target = PrewarmTargets.FindOrAdd(AircraftClass.Get());
+		Target = FMath::Max(Target, Count);
+	}
+}
+
+void USpawnDirectorSubsystem::CancelPending()
+{
+	Pending.Reset();
+	NextPending = 0;
+	Stats.NumPending = 0;
+}
+
+void USpawnDirectorSubsystem::UpdateSpawns()
+{
+	if (GetNumPending() == 0 && PrewarmTargets.Num() == 0)
+	{
+		Stats.SpawnMilliseconds = 0.0f;
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_FlightSpawnDirector);
+	const double Start = FPlatformTime::Seconds();
+	const double Deadline = Start + GSpawnBudgetMs * 0.001;
+	int32 NumThisFrame = 0;
+
+	// The first always goes, so a budget smaller than one spawn still makes progress
+	while (GetNumPending() > 0 && NumThisFrame < GSpawnMaxPerFrame && (NumThisFrame == 0 || FPlatformTime::Seconds() < Deadline))
+	{
+		// A copy: spawning runs BeginPlay, which may queue more
+		const FPendingSpawn Spawn = Pending[NextPending++];
+		++NumThisFrame;
+
+		AActor* Aircraft = ActorPool
+			? ActorPool->Acquire(Spawn.Class, Spawn.Transform)
+			: GetWorld()->SpawnActor<AActor>(Spawn.Class, Spawn.Transform);
+		if (Aircraft)
+		{
+			++Stats.NumSpawned;
+			INC_DWORD_STAT(STAT_FlightSpawnDirectorSpawned);
+		}
+	}
+
+	if (GetNumPending() == 0)
+	{
+		Pending.Reset();
+		NextPending = 0;
+	}
+	Stats.NumPending = GetNumPending();
+
+	// Spares only once the queue is empty, and only from what is left of the budget
+	if (ActorPool && GetNumPending() == 0)
+	{
+		for (auto It = PrewarmTargets.CreateIterator(); It; ++It)
+		{
+			while (NumThisFrame < GSpawnMaxPerFrame && FPlatformTime::Seconds() < Deadline)
+			{
+				const int32 NumFree = ActorPool->GetStats(It->Key).NumFree;
+				if (NumFree >= It->Value)
+				{
+					break;
+				}
+				ActorPool->Prewarm(It->Key, NumFree + 1);
+				if (ActorPool->GetStats(It->Key).NumFree == NumFree)
+				{
+					// Spawning failed or the pool is at FlightSim.ActorPool.MaxFreePerClass; settle for what there is
+					It->Value = NumFree;
+					break;
+				}
+				++Stats.NumPrewarmed;
+				++NumThisFrame;
+			}
+
+			if (ActorPool->GetStats(It->Key).NumFree >= It->Value)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	Stats.SpawnMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+}
@@ -0,0 +1,198 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "TargetingComponent.h"
+#include "AircraftSpatialSubsystem.h"
+#include "RadarSubsystem.h"
+#include "FlightSim1.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Targeting Update"), STAT_FlightTargetingUpdate, STATGROUP_FlightSim);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targeting Candidates"), STAT_FlightTargetingCandidates, STATGROUP_FlightSim);
+
+UTargetingComponent::UTargetingComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	Range = 1000000.0f;
+	ConeHalfAngle = 90.0f;
+	LockAcquireTime = 0.5f;
+	BreakLockTime = 0.5f;
+	SwitchScoreRatio = 1.25f;
+	bRequireRadarContact = true;
+	TargetTeamMask = AircraftTeams::Hostile;
+
+	SpatialIndex = nullptr;
+	RadarSystem = nullptr;
+	OwnerHandle = INDEX_NONE;
+	HeldTime = 0.0f;
+	OutOfConeTime = 0.0f;
+}
+
+void UTargetingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SpatialIndex = GetWorld()->GetSubsystem<UAircraftSpatialSubsystem>();
+	RadarSystem = GetWorld()->GetSubsystem<URadarSubsystem>();
+}
+
+void UTargetingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UpdateTargeting(DeltaTime);
+}
+
+void UTargetingComponent::ClearTarget()
+{
+	Result = FTargetingResult();
+	HeldTime = 0.0f;
+	OutOfConeTime = 0.0f;
+}
+
+void UTargetingComponent::RestoreTarget(AActor* Target, int32 TargetHandle, float LockProgress)
+{
+	ClearTarget();
+	if (!Target || TargetHandle == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The score is refreshed on the next update, before anything compares against it
+	Result.Target = Target;
+	Result.TargetHandle = TargetHandle;
+	Result.LockProgress = FMath::Clamp(LockProgress, 0.0f, 1.0f);
+	Result.bLocked = Result.LockProgress >= 1.0f;
+	HeldTime = Result.LockProgress * LockAcquireTime;
+}
+
+float UTargetingComponent::ScoreOf(int32 Handle, const FVector& Origin, const FVector& Forward, float MinCosAngle) const
+{
+	const FVector ToTarget = SpatialIndex->GetLocation(Handle) - Origin;
+	const float Distance = ToTarget.Size();
+	if (Distance < UE_KINDA_SMALL_NUMBER || Distance > Range)
+	{
+		return -1.0f;
+	}
+
+	const float CosAngle = FVector::DotProduct(Forward, ToTarget) / Distance;
+	if (CosAngle <= 0.0f || CosAngle < MinCosAngle)
+	{
+		return -1.0f;
+	}
+
+	return CosAngle / Distance;
+}
+
+void UTargetingComponent::GatherCandidates(const FVector& Origin, const FVector& Forward, float MinCosAngle, float SearchRadius, bool bUseRadar)
+{
+	if (!bUseRadar)
+	{
+		SpatialIndex->QueryCone(Origin, Forward, MinCosAngle, SearchRadius, TargetTeamMask, Candidates);
+		return;
+	}
+
+	// The radar has already done range, cone and terrain checks for its own cone
+	Candidates.Reset();
+	for (const FRadarContact& Contact : RadarSystem->GetContacts(OwnerHandle))
+	{
+		if ((Contact.TeamMask & TargetTeamMask) && Contact.Distance <= SearchRadius)
+		{
+			Candidates.Add(Contact.Handle);
+		}
+	}
+}
+
+void UTargetingComponent::UpdateTargeting(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightTargetingUpdate);
+
+	const AActor* Owner = GetOwner();
+	if (!SpatialIndex || !Owner)
+	{
+		ClearTarget();
+		return;
+	}
+
+	const FVector Origin = Owner->GetActorLocation();
+	const FVector Forward = Owner->GetActorForwardVector();
+	const float MinCosAngle = FMath::Cos(FMath::DegreesToRadians(ConeHalfAngle));
+	const bool bUseRadar = bRequireRadarContact && RadarSystem && OwnerHandle != INDEX_NONE;
+
+	// Drop a target that was destroyed or whose handle has since been reused
+	if (Result.TargetHandle != INDEX_NONE && (!IsValid(Result.Target) || SpatialIndex->GetActor(Result.TargetHandle) != Result.Target))
+	{
+		ClearTarget();
+	}
+
+	// Re-score the current target first; its score bounds which challengers are worth fetching
+	if (Result.Target)
+	{
+		// Losing the radar contact counts the same as leaving the cone
+		const bool bHasContact = !bUseRadar || RadarSystem->HasContact(OwnerHandle, Result.TargetHandle);
+		const float CurrentScore = bHasContact ? ScoreOf(Result.TargetHandle, Origin, Forward, MinCosAngle) : -1.0f;
+		if (CurrentScore > 0.0f)
+		{
+			Result.Score = CurrentScore;
+			Result.bTargetOutOfCone = false;
+			OutOfConeTime = 0.0f;
+			HeldTime += DeltaTime;
+		}
+		else
+		{
+			Result.bTargetOutOfCone = true;
+			OutOfConeTime += DeltaTime;
+			if (OutOfConeTime > BreakLockTime)
+			{
+				ClearTarget();
+			}
+		}
+	}
+
+	// With a target held, only aircraft within 1 / threshold can score above the threshold
+	const float Threshold = Result.Target ? Result.Score * FMath::Max(SwitchScoreRatio, 1.0f) : 0.0f;
+	const float SearchRadius = Threshold > 0.0f ? FMath::Min(Range, 1.0f / Threshold) : Range;
+
+	GatherCandidates(Origin, Forward, MinCosAngle, SearchRadius, bUseRadar);
+
+	int32 BestHandle = INDEX_NONE;
+	float BestScore = Threshold;
+	int32 NumEvaluated = 0;
+	for (int32 Handle : Candidates)
+	{
+		if (Handle == Result.TargetHandle || SpatialIndex->GetActor(Handle) == Owner)
+		{
+			continue;
+		}
+
+		++NumEvaluated;
+		const float Score = ScoreOf(Handle, Origin, Forward, MinCosAngle);
+
+		// Ties go to the lower handle so the choice never depends on query order
+		if (Score > BestScore || (Score == BestScore && BestHandle != INDEX_NONE && Handle < BestHandle))
+		{
+			BestScore = Score;
+			BestHandle = Handle;
+		}
+	}
+
+	if (BestHandle != INDEX_NONE)
+	{
+		// A new target always starts acquiring from scratch
+		Result.Target = SpatialIndex->GetActor(BestHandle);
+		Result.TargetHandle = BestHandle;
+		Result.Score = BestScore;
+		Result.bTargetOutOfCone = false;
+		HeldTime = 0.0f;
+		OutOfConeTime = 0.0f;
+	}
+
+	Result.LockProgress = !Result.Target ? 0.0f
+		: LockAcquireTime > 0.0f ? FMath::Min(HeldTime / LockAcquireTime, 1.0f) : 1.0f;
+	Result.bLocked = Result.Target && Result.LockProgress >= 1.0f;
+	Result.NumCandidatesEvaluated = NumEvaluated;
+
+	INC_DWORD_STAT_BY(STAT_FlightTargetingCandidates, NumEvaluated);
+}
@@ -0,0 +1,300 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "WorldSnapshotSubsystem.h"
+#include "FlightSim1.h"
+#include "AIAircraftPawn.h"
+#include "AircraftSpatialSubsystem.h"
+#include "DamageLedgerSubsystem.h"
+#include "FighterJetPawn.h"
+#include "GunfireSubsystem.h"
+#include "HealthComponent.h"
+#include "MissileGuidanceSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Snapshot Capture"), STAT_FlightSnapshotCapture, STATGROUP_FlightSim);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Restore"), STAT_FlightSnapshotRestore, STATGROUP_FlightSim);
+
+bool UWorldSnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UWorldSnapshotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SpatialIndex = Collection.InitializeDependency<UAircraftSpatialSubsystem>();
+	DamageLedger = Collection.InitializeDependency<UDamageLedgerSubsystem>();
+	MissileGuidance = Collection.InitializeDependency<UMissileGuidanceSubsystem>();
+	Gunfire = Collection.InitializeDependency<UGunfireSubsystem>();
+}
+
+void UWorldSnapshotSubsystem::Deinitialize()
+{
+	LastCapture.Reset();
+	LastLoaded.Reset();
+	Scratch.Reset();
+	Slots.Empty();
+
+	Super::Deinitialize();
+}
+
+void UWorldSnapshotSubsystem::Capture(FlightModel::FWorldSnapshot& OutSnapshot)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightSnapshotCapture);
+	const double Start = FPlatformTime::Seconds();
+
+	OutSnapshot.Reset();
+	OutSnapshot.Frame = uint32(GFrameCounter);
+	OutSnapshot.Time = GetWorld()->GetTimeSeconds();
+
+	if (SpatialIndex)
+	{
+		OutSnapshot.Aircraft.reserve(SpatialIndex->GetNumAircraft());
+		for (int32 Slot = 0; Slot < SpatialIndex->GetNumAircraft(); ++Slot)
+		{
+			const int32 Handle = SpatialIndex->GetHandleOfSlot(Slot);
+			const AActor* Aircraft = SpatialIndex->GetActor(Handle);
+			if (!Aircraft)
+			{
+				continue;
+			}
+
+			FlightModel::FAircraftSnapshot& Snapshot = OutSnapshot.Aircraft.emplace_back();
+			Snapshot.Id = Handle;
+			Snapshot.Generation = SpatialIndex->GetGeneration(Handle);
+
+			const FVector Location = Aircraft->GetActorLocation();
+			const FQuat Rotation = Aircraft->GetActorQuat();
+			Snapshot.Position = FlightModel::FVec3d(Location.X, Location.Y, Location.Z);
+			Snapshot.Attitude = FlightModel::FQuatd(Rotation.X, Rotation.Y, Rotation.Z, Rotation.W);
+			Snapshot.Health = DamageLedger ? DamageLedger->GetHealth(Handle) : 0.0f;
+
+			if (const AAIAircraftPawn* AIPawn = Cast<AAIAircraftPawn>(Aircraft))
+			{
+				AIPawn->CaptureSnapshot(Snapshot);
+			}
+			else if (const AFighterJetPawn* Jet = Cast<AFighterJetPawn>(Aircraft))
+			{
+				Jet->CaptureSnapshot(Snapshot);
+			}
+			else
+			{
+				const FVector Velocity = SpatialIndex->GetVelocity(Handle);
+				Snapshot.LinearVelocity = FlightModel::FVec3d(Velocity.X, Velocity.Y, Velocity.Z);
+			}
+		}
+	}
+
+	if (MissileGuidance)
+	{
+		MissileGuidance->CaptureSnapshot(OutSnapshot.Missiles);
+	}
+
+	// Restoring this and restoring a decoded copy of it must give the same world
+	FlightModel::FWorldSnapshotCodec::Quantize(OutSnapshot);
+
+	Stats.NumAircraft = int32(OutSnapshot.Aircraft.size());
+	Stats.NumMissiles = int32(OutSnapshot.Missiles.size());
+	Stats.CaptureMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+void UWorldSnapshotSubsystem::Restore(const FlightModel::FWorldSnapshot& Snapshot)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlightSnapshotRestore);
+	const double Start = FPlatformTime::Seconds();
+
+	// Damage queued and rounds fired in the timeline being left behind never land
+	if (DamageLedger)
+	{
+		DamageLedger->CancelPending();
+	}
+	if (Gunfire)
+	{
+		Gunfire->ClearInFlight();
+	}
+
+	int32 NumUnmatched = 0;
+	for (const FlightModel::FAircraftSnapshot& State : Snapshot.Aircraft)
+	{
+		// Handles are recycled; one another aircraft has taken over since the capture is not this aircraft
+		const bool bSameAircraft = SpatialIndex && SpatialIndex->IsValidHandle(State.Id) && SpatialIndex->GetGeneration(State.Id) == State.Generation;
+		AActor* Aircraft = bSameAircraft ? SpatialIndex->GetActor(State.Id) : nullptr;
+		if (!Aircraft)
+		{
+			++NumUnmatched;
+			continue;
+		}
+
+		// Velocities go on after the teleport, which clears them
+		const FQuat Rotation = FQuat(State.Attitude.X, State.Attitude.Y, State.Attitude.Z, State.Attitude.W).GetNormalized();
+		Aircraft->SetActorLocationAndRotation(FVector(State.Position.X, State.Position.Y, State.Position.Z), Rotation,
+			false, nullptr, ETeleportType::ResetPhysics);
+
+		if (AAIAircraftPawn* AIPawn = Cast<AAIAircraftPawn>(Aircraft))
+		{
+			AIPawn->RestoreSnapshot(State);
+		}
+		else if (AFighterJetPawn* Jet = Cast<AFighterJetPawn>(Aircraft))
+		{
+			Jet->RestoreSnapshot(State);
+		}
+
+		UHealthComponent* Health = DamageLedger ? DamageLedger->GetHealthComponent(State.Id) : nullptr;
+		if (Health && Health->GetCurrentHealth() != State.Health)
+		{
+			Health->SetHealth(State.Health);
+		}
+	}
+
+	if (MissileGuidance)
+	{
+		NumUnmatched += MissileGuidance->RestoreSnapshot(Snapshot.Missiles);
+	}
+
+	Stats.NumUnmatched = NumUnmatched;
+	Stats.RestoreMilliseconds = float((FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+void UWorldSnapshotSubsystem::SaveState(std::vector<uint8>& Out, const FlightModel::FWorldSnapshot* Baseline)
+{
+	// Into scratch first, since the baseline may well be the last capture
+	Capture(Scratch);
+	const size_t SizeBefore = Out.size();
+	Codec.Encode(Scratch, Baseline, Out);
+	Stats.LastSizeBytes = int32(Out.size() - SizeBefore);
+	Swap(LastCapture, Scratch);
+}
+
+bool UWorldSnapshotSubsystem::LoadState(const uint8* Data, int64 Size, const FlightModel::FWorldSnapshot* Baseline)
+{
+	if (Size < 0 || !Codec.Decode(Data, size_t(Size), Baseline, Scratch))
+	{
+		UE_LOG(LogFlightSim, Warning, TEXT("Snapshot: %lld bytes did not decode as a version %d snapshot%s"),
+			Size, int32(FlightModel::FWorldSnapshotCodec::Version), Baseline ? TEXT(" against the given baseline") : TEXT(""));
+		return false;
+	}
+
+	Restore(Scratch);
+	Swap(LastLoaded, Scratch);
+	return true;
+}
+
+void UWorldSnapshotSubsystem::SaveSlot(int32 Slot)
+{
+	std::vector<uint8>& Buffer = Slots.FindOrAdd(Slot);
+	Buffer.clear();
+	SaveState(Buffer);
+}
+
+bool UWorldSnapshotSubsystem::LoadSlot(int32 Slot)
+{
+	const std::vector<uint8>* Buffer = Slots.Find(Slot);
+	return Buffer && LoadState(Buffer->data(), int64(Buffer->size()));
+}
+
+// --- Console ---
+
+namespace WorldSnapshotCommands
+{
+	static int32 SlotArg(const TArray<FString>& Args)
+	{
+		return Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+	}
+
+	static void Save(const TArray<FString>& Args, UWorld* World)
+	{
+		if (UWorldSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UWorldSnapshotSubsystem>() : nullptr)
+		{
+			Snapshots->SaveSlot(SlotArg(Args));
+			const FWorldSnapshotStats Stats = Snapshots->GetStats();
+			UE_LOG(LogFlightSim, Display, TEXT("Snapshot: saved %d aircraft and %d missiles to slot %d, %d bytes, captured in %.3f ms"),
+				Stats.NumAircraft, Stats.NumMissiles, SlotArg(Args), Stats.LastSizeBytes, Stats.CaptureMilliseconds);
+		}
+	}
+
+	static void Load(const TArray<FString>& Args, UWorld* World)
+	{
+		UWorldSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UWorldSnapshotSubsystem>() : nullptr;
+		if (!Snapshots || !Snapshots->LoadSlot(SlotArg(Args)))
+		{
+			UE_LOG(LogFlightSim, Warning, TEXT("Snapshot: nothing to load in slot %d"), SlotArg(Args));
+			return;
+		}
+
+		const FWorldSnapshotStats Stats = Snapshots->GetStats();
+		UE_LOG(LogFlightSim, Display, TEXT("Snapshot: loaded slot %d in %.3f ms, %d no longer in the world"),
+			SlotArg(Args), Stats.RestoreMilliseconds, Stats.NumUnmatched);
+	}
+
+	// Capture, full and delta encode, decode and restore of the live world, averaged over a number of rounds
+	static void Bench(const TArray<FString>& Args, UWorld* World)
+	{
+		UWorldSnapshotSubsystem* Snapshots = World ? World->GetSubsystem<UWorldSnapshotSubsystem>() : nullptr;
+		if (!Snapshots)
+		{
+			return;
+		}
+
+		const int32 NumRounds = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+		FlightModel::FWorldSnapshotCodec Codec;
+		FlightModel::FWorldSnapshot Captured;
+		FlightModel::FWorldSnapshot Decoded;
+		std::vector<uint8> Full;
+		std::vector<uint8> Delta;
+
+		Snapshots->Capture(Captured);
+		const FlightModel::FWorldSnapshot Baseline = Captured;
+
+		double CaptureSeconds = 0.0;
+		double EncodeSeconds = 0.0;
+		double DecodeSeconds = 0.0;
+		double RestoreSeconds = 0.0;
+		for (int32 Round = 0; Round < NumRounds; ++Round)
+		{
+			double Start = FPlatformTime::Seconds();
+			Snapshots->Capture(Captured);
+			CaptureSeconds += FPlatformTime::Seconds() - Start;
+
+			Start = FPlatformTime::Seconds();
+			Full.clear();
+			Delta.clear();
+			Codec.Encode(Captured, nullptr, Full);
+			Codec.Encode(Captured, &Baseline, Delta);
+			EncodeSeconds += FPlatformTime::Seconds() - Start;
+
+			Start = FPlatformTime::Seconds();
+			Codec.Decode(Delta.data(), Delta.size(), &Baseline, Decoded);
+			DecodeSeconds += FPlatformTime::Seconds() - Start;
+
+			Start = FPlatformTime::Seconds();
+			Snapshots->Restore(Decoded);
+			RestoreSeconds += FPlatformTime::Seconds() - Start;
+		}
+
+		const double ToMicroseconds = 1.0e6 / NumRounds;
+		UE_LOG(LogFlightSim, Display, TEXT("BenchSnapshot: %d aircraft, %d missiles, %d rounds"),
+			int32(Captured.Aircraft.size()), int32(Captured.Missiles.size()), NumRounds);
+		UE_LOG(LogFlightSim, Display, TEXT("  capture %.1f us, encode full + delta %.1f us, decode %.1f us, restore %.1f us"),
+			CaptureSeconds * ToMicroseconds, EncodeSeconds * ToMicroseconds, DecodeSeconds * ToMicroseconds, RestoreSeconds * ToMicroseconds);
+		UE_LOG(LogFlightSim, Display, TEXT("  %d bytes full, %d bytes as a delta"), int32(Full.size()), int32(Delta.size()));
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs SaveCommand(
+		TEXT("FlightSim.Snapshot.Save"),
+		TEXT("Captures the dogfight into an in-memory slot. Usage: FlightSim.Snapshot.Save [Slot]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Save));
+
+	static FAutoConsoleCommandWithWorldAndArgs LoadCommand(
+		TEXT("FlightSim.Snapshot.Load"),
+		TEXT("Restores the dogfight from an in-memory slot. Usage: FlightSim.Snapshot.Load [Slot]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Load));
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchCommand(
+		TEXT("FlightSim.BenchSnapshot"),
+		TEXT("Times capturing, encoding, decoding and restoring the live dogfight. Usage: FlightSim.BenchSnapshot [NumRounds]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&Bench));
+}
@@ -10,8 +10,21 @@
 #include "Components/SceneComponent.h"
 #include "Particles/ParticleSystem.h"
 #include "Sound/SoundBase.h"
+#include "FlightModel/FlightDynamics.h"
+#include "FlightModel/WorldSnapshot.h"
+#include "RadarSubsystem.h"
+#include "ActorPoolSubsystem.h"
 #include "AIAircraftPawn.generated.h" // This MUST be the last include
 
+class UAIAircraftSubsystem;
+class UAircraftSpatialSubsystem;
+class URadarSubsystem;
+class UGunfireSubsystem;
+class UEffectsSubsystem;
+class UMissileGuidanceSubsystem;
+struct FAIAircraftAgent;
+struct FAIAircraftCommand;
+
 // --- CHANGE 1: Created an enum for the AI's current state ---
 UENUM(BlueprintType)
 enum class EAIState : uint8
@@ -20,8 +33,18 @@ enum class EAIState : uint8
     Evading
 };
 
+// How an AI aircraft is currently being simulated
+UENUM(BlueprintType)
+enum class EAircraftPhysicsLOD : uint8
+{
+    // Chaos rigid body
+    Full,
+    // Physics off, moved by the analytic point-mass integrator
+    PointMass
+};
+
 UCLASS()
-class FLIGHTSIM1_API AAIAircraftPawn : public APawn
+class FLIGHTSIM1_API AAIAircraftPawn : public APawn, public IPooledActor
 {
     GENERATED_BODY()
 
@@ -32,10 +55,27 @@ public:
 protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
-    // Called every frame
-    virtual void Tick(float DeltaTime) override;
+    // --- IPooledActor: spawned by the spawn director and parked again when shot down ---
+    virtual void OnSpawnedForPool() override;
+    virtual void OnAcquiredFromPool() override;
+    virtual void OnReturnedToPool() override;
+
+    // --- Driven by UAIAircraftSubsystem instead of Tick ---
+    // Copies this aircraft's current state into the manager's packed array
+    void GatherAgentState(FAIAircraftAgent& OutAgent) const;
+
+    // Carries out one command from the manager's decide phase
+    void ExecuteCommand(const FAIAircraftCommand& Command, float DeltaTime, double Time);
+
+    // Our handle in the aircraft spatial index (and so in the radar), or INDEX_NONE
+    int32 GetSpatialHandle() const { return SpatialHandle; }
+
+    // Velocities, weapon timing and AI state for UWorldSnapshotSubsystem, which handles the transform and health
+    void CaptureSnapshot(FlightModel::FAircraftSnapshot& OutSnapshot) const;
+    void RestoreSnapshot(const FlightModel::FAircraftSnapshot& Snapshot);
 
     // --- Components ---
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -81,10 +121,45 @@ public:
     UPROPERTY(EditDefaultsOnly, Category = "Weapons")
     USoundBase* FireSound;
 
+    // --- Sensors ---
+    // What this aircraft can see of the player; it only chases what its radar has a contact on
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensors")
+    FRadarSensorParams Radar;
+
+    // --- Physics LOD ---
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics LOD")
+    bool bEnablePhysicsLOD;
+
+    // Closer than this to the player the aircraft is always a full rigid body
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics LOD")
+    float FullPhysicsDistance;
+
+    // Further than this (and not near a missile) it drops to the point-mass integrator; the gap is hysteresis
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics LOD")
+    float PointMassDistance;
+
+    // Both distances are multiplied by this while the aircraft is on screen
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics LOD")
+    float VisibleDistanceScale;
+
+    // A missile inside this radius promotes the aircraft back to a rigid body
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics LOD")
+    float WeaponProximityDistance;
+
+    // Seconds between LOD decisions
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics LOD")
+    float PhysicsLODInterval;
+
+    UFUNCTION(BlueprintPure, Category = "Physics LOD")
+    EAircraftPhysicsLOD GetPhysicsLOD() const { return PhysicsLOD; }
+
 private:
+    // Joins (or leaves) the AI manager, spatial index, radar and damage ledger; BeginPlay/EndPlay and the pool both use these
+    void ActivateAircraft();
+    void DeactivateAircraft();
+
     // AI logic functions
-    void MoveAndTurn(float DeltaTime);
-    void CheckAndFire(float DeltaTime);
+    void ApplyThrust(const FVector& ForwardForce, float DeltaTime);
     void FireWeapon();
 
     // --- CHANGE 3: Added functions for handling evasion ---
@@ -93,10 +168,51 @@ private:
     void BeginEvasion();
     void EndEvasion();
 
+    // Physics LOD
+    void UpdatePhysicsLOD();
+    void SwitchToPointMass();
+    void SwitchToFullPhysics();
+
+    UPROPERTY()
+    UAIAircraftSubsystem* AIManager;
+    int32 AIHandle;
+
+    UPROPERTY()
+    UAircraftSpatialSubsystem* SpatialIndex;
+    int32 SpatialHandle;
+
+    UPROPERTY()
+    URadarSubsystem* RadarSystem;
+
+    UPROPERTY()
+    UGunfireSubsystem* Gunfire;
+
+    UPROPERTY()
+    UEffectsSubsystem* Effects;
+
+    // Asked for missiles in flight near this aircraft by UpdatePhysicsLOD
+    UPROPERTY()
+    UMissileGuidanceSubsystem* MissileGuidance;
+
+    // Reused by UpdatePhysicsLOD for the nearby-player query
+    TArray<int32> NearbyPlayers;
+
+    // Registered and flying, as opposed to parked in the pool
+    bool bActive;
+
+    // Spawned by the actor pool, which activates it on acquire instead of BeginPlay
+    bool bSpawnedForPool;
+
     // Internal state for firing
     float LastFireTime;
 
     // Internal state for AI
     EAIState CurrentState;
     FTimerHandle EvasionTimerHandle;
+
+    // Internal state for physics LOD; the point-mass values are only live while PhysicsLOD == PointMass
+    EAircraftPhysicsLOD PhysicsLOD;
+    FTimerHandle PhysicsLODTimerHandle;
+    FlightModel::FPointMass PointMassBody;
+    FlightModel::FVec3d PointMassVelocity;
 };
@@ -0,0 +1,244 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AIAircraftPawn.h"
+#include "FlightModel/AIPilot.h"
+#include "AIAircraftSubsystem.generated.h"
+
+// Everything one AI aircraft's decision depends on, gathered into a packed array once per frame.
+// The radar contact is only refreshed when the scheduler re-plans the agent.
+struct FAIAircraftAgent
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	float FlightSpeed = 0.0f;
+	float TurnSpeed = 0.0f;
+	float AvoidanceDistance = 0.0f;
+	float EvasionTurnSpeed = 0.0f;
+	float FireRate = 0.0f;
+	double LastFireTime = 0.0;
+
+	EAIState State = EAIState::Seeking;
+
+	// Nearest player aircraft on this agent's radar, if any
+	bool bHasContact = false;
+	FVector ContactLocation = FVector::ZeroVector;
+	FVector ContactVelocity = FVector::ZeroVector;
+};
+
+// Inputs shared by every agent, read from the world once per frame
+struct FAIAircraftFrame
+{
+	// The player pawn, for scheduling priority and physics LOD only; agents steer by their own radar contacts
+	FVector TargetLocation = FVector::ZeroVector;
+	FVector TargetVelocity = FVector::ZeroVector;
+	bool bHasTarget = false;
+	double Time = 0.0;
+	float DeltaTime = 0.0f;
+
+	// How long a plan stays valid after the agent loses its radar contact
+	float ContactMemorySeconds = 0.0f;
+
+	// Agents without a plan turn back once further than PatrolRadius from PatrolCenter (0 disables)
+	FVector PatrolCenter = FVector::ZeroVector;
+	float PatrolRadius = 0.0f;
+};
+
+// An agent's last steering plan, shared with FDogfightEnv. Agents are only re-planned when the
+// scheduler gets to them, which is when the contact is looked up and the heading solved for the
+// target extrapolated to that time; on the frames in between they only keep turning towards that heading.
+struct FAIAircraftPlan : public FlightModel::FAIPilotPlan
+{
+	// Scheduler priority while under fire, set from UHealthComponent::OnDamaged
+	double PriorityUntil = 0.0;
+};
+
+// What the scheduler did in the most recent frame
+USTRUCT(BlueprintType)
+struct FAIAircraftScheduleStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	int32 NumAgents = 0;
+
+	// Agents re-planned this frame, and how many of those were near the player or under fire
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	int32 NumPlanned = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	int32 NumPriorityPlanned = 0;
+
+	// Age of the plans agents are steering with, after this frame's re-planning
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	float AverageStalenessSeconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	float MaxStalenessSeconds = 0.0f;
+
+	// Contact lookups and steering solves for the re-planned agents
+	UPROPERTY(BlueprintReadOnly, Category = "AI")
+	float PlanMilliseconds = 0.0f;
+};
+
+enum class EAIAircraftCommandType : uint8
+{
+	AddThrust,
+	SetRotation,
+	Fire
+};
+
+// One deferred action on one agent, recorded during the decide phase and replayed on the game thread
+struct FAIAircraftCommand
+{
+	int32 Slot = INDEX_NONE;
+	EAIAircraftCommandType Type = EAIAircraftCommandType::AddThrust;
+
+	// AddThrust only, world space
+	FVector Force = FVector::ZeroVector;
+
+	// SetRotation only
+	FQuat Rotation = FQuat::Identity;
+};
+
+// Commands written by one fixed batch of agents. Each batch is filled by exactly one worker,
+// so no locking is needed, and batches are replayed in index order whatever the thread count.
+struct FAIAircraftCommandBuffer
+{
+	TArray<FAIAircraftCommand> Commands;
+
+	void AddThrust(int32 Slot, const FVector& Force);
+	void SetRotation(int32 Slot, const FQuat& Rotation);
+	void Fire(int32 Slot);
+};
+
+// The game's side of FlightModel::AIPilot: converts the packed agent and frame and turns the decision into commands
+namespace AIAircraftLogic
+{
+	// Chooses whether to close in on or turn away from the agent's radar contact, and remembers where
+	// it was going. Without a contact the old plan is kept for ContactMemorySeconds, then dropped.
+	FLIGHTSIM1_API void Plan(const FAIAircraftAgent& Agent, const FAIAircraftFrame& Frame, FAIAircraftPlan& InOutPlan);
+
+	// Solves the heading for the plan's target extrapolated to now (or back to the patrol area
+	// without one) and the fire check, for Decide to use until the agent is re-planned
+	FLIGHTSIM1_API void Steer(const FAIAircraftAgent& Agent, const FAIAircraftFrame& Frame, FAIAircraftPlan& InOutPlan);
+
+	// Per-frame thrust, turn towards the steered heading and evasion, plus the shot Steer decided
+	// on this frame. Only reads its inputs and only writes to Out, so any number of agents can be decided at once.
+	FLIGHTSIM1_API void Decide(int32 Slot, const FAIAircraftAgent& Agent, const FAIAircraftPlan& Plan, const FAIAircraftFrame& Frame, FAIAircraftCommandBuffer& Out);
+
+	// Re-plans and re-steers the agents listed in Slots across the task graph (or inline when bSingleThread)
+	FLIGHTSIM1_API void PlanAll(TArrayView<const FAIAircraftAgent> Agents, const FAIAircraftFrame& Frame,
+		TArrayView<FAIAircraftPlan> Plans, TArrayView<const int32> Slots, bool bSingleThread);
+
+	// Decides every agent in batches of BatchSize across the task graph (or inline when
+	// bSingleThread), resizing Batches to one buffer per batch
+	FLIGHTSIM1_API void DecideAll(TArrayView<const FAIAircraftAgent> Agents, TArrayView<const FAIAircraftPlan> Plans,
+		const FAIAircraftFrame& Frame, TArray<FAIAircraftCommandBuffer>& Batches, int32 BatchSize, bool bSingleThread);
+}
+
+// Runs the AI manager in TG_PrePhysics so thrust lands in this frame's physics step
+USTRUCT()
+struct FAIAircraftTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UAIAircraftSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAIAircraftTickFunction> : public TStructOpsTypeTraitsBase2<FAIAircraftTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Owns every AI aircraft in the world and runs their logic in one place instead of
+ * per-actor ticks. Each frame it reads the player and the clock once, gathers each
+ * pawn's state into a packed array, evaluates all decisions in parallel into command
+ * buffers and then replays the commands (thrust, rotation, weapon fire) on the pawns.
+ *
+ * Re-planning is time-sliced: only as many agents as fit in FlightSim.AI.PlanBudgetMs
+ * have their radar contact looked up, their plan and heading solved and their shot
+ * checked per frame, aircraft near the player or under fire first and the rest
+ * round-robin. Everyone else only keeps turning towards their last solved heading.
+ */
+UCLASS()
+class FLIGHTSIM1_API UAIAircraftSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Returns a handle that stays valid until UnregisterAircraft
+	int32 RegisterAircraft(AAIAircraftPawn* Pawn);
+	void UnregisterAircraft(int32 Handle);
+
+	int32 GetNumAircraft() const { return Pawns.Num(); }
+
+	// Player position as of this frame's update; false if there is no player pawn
+	bool GetTargetLocation(FVector& OutLocation) const;
+
+	// Gives the aircraft scheduling priority for a while; called from its OnDamaged handler
+	void NotifyDamaged(int32 Handle);
+
+	UFUNCTION(BlueprintPure, Category = "AI")
+	FAIAircraftScheduleStats GetScheduleStats() const { return ScheduleStats; }
+
+	// Gather, decide and apply for every registered aircraft
+	void UpdateAircraft(float DeltaTime);
+
+private:
+	void Gather(float DeltaTime);
+	void Schedule();
+	void Decide();
+	void Apply();
+
+	// Dense per-agent data; all arrays share the same index
+	TArray<TWeakObjectPtr<AAIAircraftPawn>> Pawns;
+	TArray<FAIAircraftAgent> Agents;
+	TArray<FAIAircraftPlan> Plans;
+	TArray<int32> SlotToHandle;
+
+	// --- Scheduler ---
+	// Agents to re-plan this frame
+	TArray<int32> PlanSlots;
+	TArray<int32> NormalCandidates;
+
+	// Next slot in round-robin order
+	int32 RoundRobinCursor = 0;
+
+	// Smoothed wall time per re-planned agent, contact lookup included, used to turn the millisecond budget into a count
+	double SecondsPerPlan = 1.0e-6;
+
+	FAIAircraftScheduleStats ScheduleStats;
+
+	// Decide phase output, kept between frames so the buffers are not reallocated
+	TArray<FAIAircraftCommandBuffer> CommandBatches;
+
+	// Sparse handle -> dense slot map so removals can swap without invalidating handles
+	TArray<int32> HandleToSlot;
+	TArray<int32> FreeHandles;
+
+	// Unregistrations that arrive while Apply is iterating
+	TArray<int32> PendingRemovals;
+	bool bApplying = false;
+
+	FAIAircraftFrame Frame;
+
+	FAIAircraftTickFunction TickFunction;
+};
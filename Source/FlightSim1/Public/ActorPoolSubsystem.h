@@ -0,0 +1,125 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "ActorPoolSubsystem.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UPooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Implemented by actors that the pool hands out more than once. The pool itself only
+ * hides the actor, turns off its collision and tick and parks it; anything with state
+ * of its own (movement, effects, timers, delegates) is reset here.
+ */
+class FLIGHTSIM1_API IPooledActor
+{
+	GENERATED_BODY()
+
+public:
+	// Spawned by the pool, before BeginPlay; the actor will be parked or acquired next, so it should not start itself
+	virtual void OnSpawnedForPool() = 0;
+
+	// Already placed at the launch transform, visible and colliding, with its actor tick back on
+	virtual void OnAcquiredFromPool() = 0;
+
+	// About to be parked; stop everything the actor started
+	virtual void OnReturnedToPool() = 0;
+};
+
+// Counters for one pooled class, or all of them added together
+USTRUCT(BlueprintType)
+struct FActorPoolStats
+{
+	GENERATED_BODY()
+
+	// Actors constructed with SpawnActor, including prewarming
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumSpawned = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumAcquired = 0;
+
+	// Acquires served from a parked actor instead of a spawn
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumReused = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumReleased = 0;
+
+	// Released while the class already had FlightSim.ActorPool.MaxFreePerClass parked, so destroyed
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumDestroyed = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumActive = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 NumFree = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Actor Pool")
+	int32 PeakActive = 0;
+};
+
+USTRUCT()
+struct FActorPoolBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AActor*> Free;
+
+	FActorPoolStats Stats;
+};
+
+/**
+ * Per-world pool of parked actors, one free list per class. Acquire reuses a parked
+ * actor when there is one and spawns otherwise; Release parks it again instead of
+ * destroying it, so steady fire costs neither construction nor garbage collection.
+ * Prewarm spawns ahead of time, e.g. when the aircraft that will fire them spawns.
+ */
+UCLASS()
+class FLIGHTSIM1_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	// Makes sure at least Count actors of the class are parked and ready
+	void Prewarm(TSubclassOf<AActor> Class, int32 Count);
+
+	// A parked actor moved to Transform and switched back on, or a fresh one; null if spawning failed
+	AActor* Acquire(TSubclassOf<AActor> Class, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+	template<typename T>
+	T* Acquire(TSubclassOf<T> Class, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr)
+	{
+		return Cast<T>(Acquire(TSubclassOf<AActor>(Class.Get()), Transform, Owner, Instigator));
+	}
+
+	// Switches the actor off and parks it for the next Acquire
+	void Release(AActor* Actor);
+
+	UFUNCTION(BlueprintPure, Category = "Actor Pool")
+	FActorPoolStats GetStats(TSubclassOf<AActor> Class) const;
+
+	UFUNCTION(BlueprintPure, Category = "Actor Pool")
+	FActorPoolStats GetTotalStats() const;
+
+	void LogStats() const;
+
+private:
+	AActor* SpawnPooled(UClass* Class, const FTransform& Transform, FActorPoolBucket& Bucket);
+	void Park(AActor* Actor);
+
+	UPROPERTY()
+	TMap<UClass*, FActorPoolBucket> Buckets;
+};
@@ -0,0 +1,94 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "FlightModel/AeroTable.h"
+#include "AeroCoefficientTable.generated.h"
+
+// Coefficients at one (angle of attack, Mach) grid point
+USTRUCT(BlueprintType)
+struct FAeroCoefficientPoint
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aero")
+	float CL = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aero")
+	float CD = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aero")
+	float Cm = 0.0f;
+
+	// Per radian of elevator deflection
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aero|Control")
+	float CLPerDeflection = 0.0f;
+
+	// Per radian squared of elevator deflection
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aero|Control")
+	float CDPerDeflectionSq = 0.0f;
+
+	// Per radian of elevator deflection
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aero|Control")
+	float CmPerDeflection = 0.0f;
+};
+
+/**
+ * Authored CL/CD/Cm data over angle of attack x Mach (plus elevator deflection terms)
+ * for one aircraft type. The grid is baked into a compact uniform lookup table when the
+ * asset loads, so the flight model only ever pays for a bilinear blend per aircraft.
+ */
+UCLASS(BlueprintType)
+class FLIGHTSIM1_API UAeroCoefficientTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Strictly ascending angles of attack, degrees
+	UPROPERTY(EditAnywhere, Category = "Table")
+	TArray<float> AngleOfAttackDegrees;
+
+	// Strictly ascending Mach numbers
+	UPROPERTY(EditAnywhere, Category = "Table")
+	TArray<float> MachNumbers;
+
+	// Mach-major grid: Points[MachIndex * AngleOfAttackDegrees.Num() + AoAIndex]
+	UPROPERTY(EditAnywhere, Category = "Table")
+	TArray<FAeroCoefficientPoint> Points;
+
+	// 0.5 * air density * wing area, in engine units: force = Speed^2 * ForceScale * C.
+	// Defaults to a 28 m^2 wing at sea level (0.5 * 1.225e-6 kg/cm^3 * 2.8e5 cm^2).
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scaling", meta = (ClampMin = "0"))
+	float ForceScale = 0.17f;
+
+	// ForceScale * mean chord: pitching torque = Speed^2 * MomentScale * Cm. Defaults to a 3.5 m chord.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scaling", meta = (ClampMin = "0"))
+	float MomentScale = 60.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scaling")
+	float MaxElevatorDeflectionDegrees = 20.0f;
+
+	// Fills the grid with FlightModel's generic fighter data as a starting point for tuning
+	UFUNCTION(CallInEditor, Category = "Table")
+	void ResetToGenericFighter();
+
+	// The baked table, or nullptr if the authored grid is malformed. Stays valid for the life of
+	// the asset even if it is re-baked, so aircraft already flying keep the table they were given.
+	const FlightModel::FAeroTable* GetBakedTable() const;
+
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	void Bake();
+
+	// Re-baking builds a new table rather than rewriting this one in place: the physics thread may
+	// be reading it. Earlier bakes are retired while a game world is playing, since its aircraft keep
+	// the table they were given, and freed by the next bake made with nothing playing.
+	TUniquePtr<FlightModel::FAeroTable> Baked;
+	TArray<TUniquePtr<FlightModel::FAeroTable>> RetiredBakes;
+};
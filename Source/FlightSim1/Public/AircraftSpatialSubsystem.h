@@ -0,0 +1,153 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AircraftSpatialSubsystem.generated.h"
+
+class UPrimitiveComponent;
+struct FHitResult;
+
+// Team membership as bits, so a query can ask for any combination of teams at once
+namespace AircraftTeams
+{
+	constexpr uint32 Player = 1u << 0;
+	constexpr uint32 Hostile = 1u << 1;
+	constexpr uint32 All = ~0u;
+}
+
+// Refreshes the index in TG_PostUpdateWork, once every aircraft has its final transform for the frame
+USTRUCT()
+struct FAircraftSpatialTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UAircraftSpatialSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FAircraftSpatialTickFunction> : public TStructOpsTypeTraitsBase2<FAircraftSpatialTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Spatial index over every aircraft in the world. Positions live in dense arrays and
+ * are bucketed into a hashed uniform grid that is updated incrementally (an aircraft
+ * only changes buckets when it crosses a cell boundary). Radius, cone and k-nearest
+ * queries visit only the cells they overlap, so their cost depends on how many
+ * aircraft are nearby rather than how many exist.
+ *
+ * The index is refreshed at the end of each frame, so every query made during a frame
+ * sees the same, consistent snapshot. Queries are read-only and safe from worker threads.
+ *
+ * It is also the registry of aircraft handles: the actor and its collision body map
+ * to the handle, which keys everything else gameplay keeps per aircraft (health in the
+ * damage ledger, team here). Hit paths go from a trace result to a handle with one
+ * hash lookup instead of walking the actor's components.
+ */
+UCLASS()
+class FLIGHTSIM1_API UAircraftSpatialSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Adds an aircraft with a single team bit; Body is the component traces hit. Returns a handle that stays valid until UnregisterAircraft.
+	int32 RegisterAircraft(AActor* Aircraft, uint32 TeamMask, float Radius, UPrimitiveComponent* Body = nullptr);
+	void UnregisterAircraft(int32 Handle);
+
+	// Re-reads every aircraft's transform and moves it between grid cells where needed
+	void UpdateIndex(float DeltaTime);
+
+	// --- Queries; each resets OutHandles and fills it with matching aircraft handles ---
+
+	// Aircraft whose centre is within Radius of Center
+	void QueryRadius(const FVector& Center, float Radius, uint32 TeamMask, TArray<int32>& OutHandles) const;
+
+	// Aircraft within Range of Origin and inside the cone around Direction (unit) with cos(half angle) = MinCosAngle
+	void QueryCone(const FVector& Origin, const FVector& Direction, float MinCosAngle, float Range, uint32 TeamMask, TArray<int32>& OutHandles) const;
+
+	// Up to K aircraft closest to Center within MaxRadius, nearest first
+	void QueryNearest(const FVector& Center, int32 K, float MaxRadius, uint32 TeamMask, TArray<int32>& OutHandles) const;
+
+	// --- Per-aircraft data as of the last update ---
+	bool IsValidHandle(int32 Handle) const { return HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE; }
+	AActor* GetActor(int32 Handle) const;
+	FVector GetLocation(int32 Handle) const;
+	FVector GetVelocity(int32 Handle) const;
+	float GetRadius(int32 Handle) const;
+	uint32 GetTeamMask(int32 Handle) const;
+
+	UPrimitiveComponent* GetBody(int32 Handle) const;
+
+	// Bumped each time a freed handle is given to a new aircraft, so a stored handle can tell it was recycled
+	uint32 GetGeneration(int32 Handle) const { return HandleGenerations.IsValidIndex(Handle) ? HandleGenerations[Handle] : 0; }
+
+	// Handle of a registered aircraft, or INDEX_NONE; a single hash lookup
+	int32 FindHandle(const AActor* Aircraft) const;
+	int32 FindHandle(const UPrimitiveComponent* Body) const;
+
+	// The aircraft a trace hit, by its component and failing that its actor
+	int32 FindHandle(const FHitResult& Hit) const;
+
+	int32 GetNumAircraft() const { return Actors.Num(); }
+
+	// --- Dense per-slot views for batch consumers; slots change on every register/unregister ---
+	int32 GetSlot(int32 Handle) const { return IsValidHandle(Handle) ? HandleToSlot[Handle] : INDEX_NONE; }
+	int32 GetHandleOfSlot(int32 Slot) const { return SlotToHandle[Slot]; }
+	TArrayView<const FVector> GetSlotLocations() const { return Locations; }
+	TArrayView<const FVector> GetSlotVelocities() const { return Velocities; }
+	TArrayView<const float> GetSlotRadii() const { return Radii; }
+
+private:
+	FIntVector CellOf(const FVector& Location) const;
+	void AddToCell(const FIntVector& Cell, int32 Handle);
+	void RemoveFromCell(const FIntVector& Cell, int32 Handle);
+
+	// Calls Visitor(Slot) for every aircraft in the cells overlapping the box, or for every aircraft
+	// when that would mean visiting more cells than there are aircraft
+	template<typename VisitorType>
+	void ForEachInBox(const FVector& Min, const FVector& Max, uint32 TeamMask, VisitorType&& Visitor) const;
+
+	// Dense per-slot data; all arrays share the same index
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	TArray<float> Radii;
+	TArray<uint32> TeamMasks;
+	TArray<FIntVector> CellKeys;
+	TArray<int32> SlotToHandle;
+
+	// Sparse handle -> dense slot map so removals can swap without invalidating handles
+	TArray<int32> HandleToSlot;
+	TArray<int32> FreeHandles;
+
+	// Handle-indexed: the body each aircraft registered with, and the keys it holds in ObjectHandles
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Bodies;
+	TArray<const UObject*> ActorKeys;
+	TArray<const UObject*> BodyKeys;
+	TArray<uint32> HandleGenerations;
+
+	// Registered actor or body -> handle. Keys are never dereferenced, and are removed on unregister.
+	TMap<const UObject*, int32> ObjectHandles;
+
+	// Hashed uniform grid of handles
+	TMap<FIntVector, TArray<int32>> Cells;
+	float CellSize = 100000.0f;
+	float InvCellSize = 1.0f / 100000.0f;
+
+	FAircraftSpatialTickFunction TickFunction;
+};
@@ -12,6 +12,10 @@ class USpringArmComponent;
 class UCameraComponent;
 class UInputMappingContext;
 class UInputAction;
+class UFlightPhysicsSubsystem;
+class UAircraftSpatialSubsystem;
+class UAeroCoefficientTable;
+namespace FlightModel { struct FAirframe; }
 struct FInputActionValue;
 
 UCLASS()
@@ -26,6 +30,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	// Called every frame
@@ -78,6 +83,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Tuning")
 	double ControlStrength = 950000000.0;
 
+	// Optional CL/CD/Cm table by AoA and Mach; replaces the lift/drag coefficients when set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Physics Tuning")
+	TObjectPtr<UAeroCoefficientTable> AeroTable;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Throttle")
 	double ThrottleChangeSpeed = 0.2;
 
@@ -85,6 +94,18 @@ public:
 	double ThrottleRampSpeed = 0.5;
 
 private:
+	// Applies our forces in one batched pass together with every other aircraft
+	UPROPERTY()
+	TObjectPtr<UFlightPhysicsSubsystem> FlightPhysics;
+
+	int32 AeroHandle = INDEX_NONE;
+
+	// Lets AI and targeting find us without scanning every actor
+	UPROPERTY()
+	TObjectPtr<UAircraftSpatialSubsystem> SpatialIndex;
+
+	int32 SpatialHandle = INDEX_NONE;
+
 	// Internal variables that the player doesn't need to change
 	double TargetThrottle = 0.0;
 	double CurrentThrottle = 0.0;
@@ -99,4 +120,6 @@ private:
 	void HandleRoll(const FInputActionValue& Value);
 	void HandleYaw(const FInputActionValue& Value);
 	void ResetPitchRollYaw(const FInputActionValue& Value);
+
+	FlightModel::FAirframe MakeAirframe() const;
 };
@@ -0,0 +1,131 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DamageLedgerSubsystem.generated.h"
+
+class UFlightRecorderSubsystem;
+class UHealthComponent;
+
+// What the most recent resolve did
+USTRUCT(BlueprintType)
+struct FDamageLedgerStats
+{
+	GENERATED_BODY()
+
+	// Damage events queued since the previous resolve
+	UPROPERTY(BlueprintReadOnly, Category = "Damage")
+	int32 NumEvents = 0;
+
+	// Aircraft that took damage; each got one OnDamaged with the sum
+	UPROPERTY(BlueprintReadOnly, Category = "Damage")
+	int32 NumVictims = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Damage")
+	int32 NumDeaths = 0;
+
+	// Applying the damage and notifying the victims, deaths included
+	UPROPERTY(BlueprintReadOnly, Category = "Damage")
+	float ResolveMilliseconds = 0.0f;
+};
+
+// Resolves the frame's damage in TG_PostUpdateWork, after every weapon has fired
+USTRUCT()
+struct FDamageLedgerTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UDamageLedgerSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FDamageLedgerTickFunction> : public TStructOpsTypeTraitsBase2<FDamageLedgerTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Every aircraft's hit points, indexed by its spatial index handle. Hits do not
+ * touch the victim: gunfire, missiles and crashes only add to the victim's damage
+ * for the frame. Once a frame, after all weapons are done, the ledger subtracts
+ * each victim's total, then tells each health component once with the sum. Its
+ * OnDamaged handlers (evasion, AI priority) and any death (score, effect, Destroy)
+ * therefore run at one known point, never from inside a trace or guidance loop.
+ * Damage queued while resolving, by a handler or a death, waits for the next frame.
+ */
+UCLASS()
+class FLIGHTSIM1_API UDamageLedgerSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Takes over Health's hit points under the aircraft's spatial index handle
+	void RegisterAircraft(int32 AircraftHandle, UHealthComponent* Health, float CurrentHealth, float MaxHealth);
+
+	// Drops the aircraft and any damage still queued for it; ignored unless Health is the one registered
+	void UnregisterAircraft(int32 AircraftHandle, const UHealthComponent* Health);
+
+	// Adds to the aircraft's damage for this frame; nothing else happens until ResolveDamage
+	void QueueDamage(int32 AircraftHandle, float Damage);
+
+	// Applies every aircraft's queued damage and notifies each victim once
+	void ResolveDamage();
+
+	// Forgets the damage queued this frame, e.g. for hits that a mission reset has undone
+	void CancelPending();
+
+	bool IsRegistered(int32 AircraftHandle) const { return Components.IsValidIndex(AircraftHandle) && Components[AircraftHandle].IsValid(); }
+
+	// Hit points as of the last resolve; 0 for an unknown handle
+	float GetHealth(int32 AircraftHandle) const { return IsRegistered(AircraftHandle) ? Health[AircraftHandle] : 0.0f; }
+
+	UHealthComponent* GetHealthComponent(int32 AircraftHandle) const { return Components.IsValidIndex(AircraftHandle) ? Components[AircraftHandle].Get() : nullptr; }
+
+	// For systems that must run after damage has resolved
+	FTickFunction& GetTickFunction() { return TickFunction; }
+
+	UFUNCTION(BlueprintPure, Category = "Damage")
+	FDamageLedgerStats GetStats() const { return Stats; }
+
+private:
+	struct FResolvedDamage
+	{
+		TWeakObjectPtr<UHealthComponent> Component;
+		float Damage = 0.0f;
+		float NewHealth = 0.0f;
+	};
+
+	// Handle-indexed
+	TArray<float> Health;
+	TArray<float> MaxHealth;
+	TArray<float> PendingDamage;
+	TArray<TWeakObjectPtr<UHealthComponent>> Components;
+
+	// Handles with PendingDamage, each once
+	TArray<int32> Damaged;
+	int32 NumEventsThisFrame = 0;
+
+	TArray<FResolvedDamage> Resolved;
+
+	// Logs each victim's damage while recording
+	UPROPERTY()
+	UFlightRecorderSubsystem* Recorder;
+
+	FDamageLedgerStats Stats;
+
+	FDamageLedgerTickFunction TickFunction;
+};
@@ -4,11 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h" // --- CHANGE: Corrected .hh to .h ---
+#include "SpawnDirectorSubsystem.h"
 #include "DogfightGameModeBase.generated.h"
 
 class AAIAircraftPawn;
 class UUserWidget;
 
+DECLARE_MULTICAST_DELEGATE(FOnDogfightOutcome);
+
 UCLASS()
 class FLIGHTSIM1_API ADogfightGameModeBase : public AGameModeBase
 {
@@ -18,17 +21,36 @@ public:
 	void EnemyDestroyed();
 	void PlayerDied();
 
+	// Puts the mission back to how it started, in place and without reloading the level; also closes the Game Over screen
+	UFUNCTION(BlueprintCallable, Category = "Mission")
+	void RestartMission();
+
+	// As RestartMission, with the enemy wave placed from Seed rather than where it first spawned
+	void RestartMissionWithSeed(int32 Seed);
+
+	int32 GetNumAliveEnemies() const { return AliveEnemiesCount; }
+
+	// Broadcast from EnemyDestroyed and PlayerDied, before the mission reacts
+	FOnDogfightOutcome OnEnemyDestroyed;
+	FOnDogfightOutcome OnPlayerDied;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
 private:
-	// Function to handle spawning the AI enemies
+	// Hands the enemy wave to the spawn director, which brings it in over the next frames
 	void SpawnEnemies();
 
+	// The opening wave as the properties below describe it
+	FAircraftSpawnWave MakeEnemyWave() const;
+
 	// Function to check if the player has won
 	void CheckWinCondition();
 
+	// The reset has run: recount the enemies and unpause
+	void HandleMissionReset();
+
 protected:
 	// The type of AI pawn to spawn. We can set this to our BP_AIAircraft in the editor.
 	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning")
@@ -42,10 +64,38 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning")
 	float SpawnRadius;
 
+	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning")
+	float SpawnAltitude = 5000.0f;
+
+	// On the ring one by one, or in V formations
+	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning")
+	EAircraftSpawnPattern SpawnPattern = EAircraftSpawnPattern::Ring;
+
+	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning", meta = (EditCondition = "SpawnPattern == EAircraftSpawnPattern::Formation"))
+	int32 FormationSize = 4;
+
+	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning", meta = (EditCondition = "SpawnPattern == EAircraftSpawnPattern::Formation"))
+	float FormationSpacing = 3000.0f;
+
+	// Fixed placement for repeatable runs; 0 places differently every time
+	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning")
+	int32 SpawnSeed = 0;
+
+	// Spare enemies built into the pool once the wave is in, so later spawns need no construction
+	UPROPERTY(EditDefaultsOnly, Category = "AI Spawning")
+	int32 SparesToPrewarm = 4;
+
 	// A property to hold the Game Over widget
 	UPROPERTY(EditDefaultsOnly, Category = "UI")
 	TSubclassOf<UUserWidget> GameOverWidgetClass;
 
+	// Go straight back to the start when the player dies instead of showing Game Over, e.g. for training runs
+	UPROPERTY(EditDefaultsOnly, Category = "Mission")
+	bool bRestartOnPlayerDeath = true;
+
 private:
 	int32 AliveEnemiesCount;
+
+	UPROPERTY()
+	UUserWidget* GameOverWidget = nullptr;
 };
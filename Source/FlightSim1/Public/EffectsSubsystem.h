@@ -0,0 +1,149 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EffectsSubsystem.generated.h"
+
+class UParticleSystem;
+class USoundBase;
+class USceneComponent;
+
+// Running totals since the world started
+USTRUCT(BlueprintType)
+struct FEffectsStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumRequested = 0;
+
+	// New emitter or audio components created for a pool
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumSpawned = 0;
+
+	// Effects played on an idle pooled component
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumReused = 0;
+
+	// Beyond FlightSim.Effects.CullDistance (or the sound distance) from the view
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumCulledDistance = 0;
+
+	// Emitters behind the camera
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumCulledView = 0;
+
+	// Same effect from the same instigator again inside FlightSim.Effects.CoalesceSeconds
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumCoalesced = 0;
+
+	// The effect already had FlightSim.Effects.MaxPerEffect instances playing
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumCapped = 0;
+
+	// Dropped because the frame's FlightSim.Effects.MaxPerFrame was already spent on nearer effects
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	int32 NumOverBudget = 0;
+
+	// Last frame's dispatch
+	UPROPERTY(BlueprintReadOnly, Category = "Effects")
+	float DispatchMilliseconds = 0.0f;
+};
+
+// Components for one particle system or sound; those no longer playing are free
+USTRUCT()
+struct FEffectPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<USceneComponent*> Components;
+};
+
+// Plays the frame's effects in TG_PostUpdateWork, once the camera has moved and the frame's damage (and deaths) resolved
+USTRUCT()
+struct FEffectsTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UEffectsSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FEffectsTickFunction> : public TStructOpsTypeTraitsBase2<FEffectsTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * One place for every transient particle and sound effect. Gameplay code asks for an
+ * effect and the request is queued; once a frame the queue is culled against the view
+ * (too far, or an emitter behind the camera), repeated requests from one instigator
+ * are coalesced (a gun firing at 10 Hz shows one muzzle flash, not one per round), and
+ * what is left is played nearest first until the frame's budget runs out. Effects play
+ * on pooled components that are reused once finished, capped per effect, so a long
+ * dogfight never creates a component per shot.
+ */
+UCLASS()
+class FLIGHTSIM1_API UEffectsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Queues a one-shot emitter; Instigator (e.g. the aircraft firing) keys coalescing and may be null
+	void PlayEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, const AActor* Instigator = nullptr);
+
+	// Queues a one-shot sound
+	void PlaySound(USoundBase* Sound, const FVector& Location, const AActor* Instigator = nullptr);
+
+	// Culls, coalesces and plays everything queued this frame
+	void DispatchEffects();
+
+	UFUNCTION(BlueprintPure, Category = "Effects")
+	FEffectsStats GetStats() const { return Stats; }
+
+	void LogStats() const;
+
+private:
+	struct FEffectRequest
+	{
+		// Weak, as the queue is not seen by the garbage collector; requests whose asset went away are dropped
+		TWeakObjectPtr<UObject> Asset;
+		FVector Location = FVector::ZeroVector;
+		FRotator Rotation = FRotator::ZeroRotator;
+		const AActor* Instigator = nullptr;
+		bool bSound = false;
+		double DistanceSq = 0.0;
+	};
+
+	// Plays the request's Asset on an idle pooled component, or a new one under the cap; false if capped
+	bool Play(UObject* Asset, const FEffectRequest& Request);
+
+	TArray<FEffectRequest> Requests;
+	TArray<FEffectRequest> Visible;
+
+	// When each (effect, instigator) pair last played, for coalescing; pruned as entries age out
+	TMap<TPair<const UObject*, const AActor*>, double> LastPlayed;
+
+	UPROPERTY()
+	TMap<UObject*, FEffectPool> Pools;
+
+	FEffectsStats Stats;
+
+	FEffectsTickFunction TickFunction;
+};
@@ -0,0 +1,282 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "HAL/PlatformProcess.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EngagementRunnerSubsystem.generated.h"
+
+class ADogfightGameModeBase;
+class AFighterJetPawn;
+class UAircraftSpatialSubsystem;
+class UMissileGuidanceSubsystem;
+class UMissionResetSubsystem;
+
+UENUM(BlueprintType)
+enum class EEngagementResult : uint8
+{
+	// Every enemy shot down
+	Win,
+	// The player shot down
+	Loss,
+	// Neither within the time limit
+	Timeout
+};
+
+// One engagement, and one row of the results file
+struct FEngagementOutcome
+{
+	int32 Run = 0;
+	int32 Seed = 0;
+	EEngagementResult Result = EEngagementResult::Timeout;
+
+	// Game time from the start to the result, s
+	float Seconds = 0.0f;
+
+	int32 Enemies = 0;
+	int32 Kills = 0;
+
+	// Game time from the start to the first kill, and the sum over every kill, s
+	float FirstKillSeconds = 0.0f;
+	float KillSecondsSum = 0.0f;
+
+	// Missiles launched by each side, and the ones that detonated on an aircraft
+	int32 PlayerMissiles = 0;
+	int32 PlayerMissileHits = 0;
+	int32 EnemyMissiles = 0;
+	int32 EnemyMissileHits = 0;
+
+	// Real time the engagement took, s
+	float WallSeconds = 0.0f;
+
+	static const TCHAR* CsvHeader();
+	FString ToCsv() const;
+	bool FromCsv(const FString& Line);
+};
+
+// Totals over any number of engagements, written as the summary file
+struct FEngagementSummary
+{
+	int32 Runs = 0;
+	int32 Wins = 0;
+	int32 Losses = 0;
+	int32 Timeouts = 0;
+	int32 Kills = 0;
+	int32 RunsWithKill = 0;
+	double FirstKillSecondsSum = 0.0;
+	double KillSecondsSum = 0.0;
+	double Seconds = 0.0;
+	int32 PlayerMissiles = 0;
+	int32 PlayerMissileHits = 0;
+	int32 EnemyMissiles = 0;
+	int32 EnemyMissileHits = 0;
+
+	void Add(const FEngagementOutcome& Outcome);
+
+	// A header line and one line of totals and rates; WallSeconds is how long the whole batch took
+	FString ToCsv(double WallSeconds) const;
+};
+
+// What the batch is to run; parsed from the -MonteCarlo command line or the console command
+struct FEngagementRunSettings
+{
+	int32 NumRuns = 100;
+
+	// Processes to spread the runs over; 1 runs them in this world
+	int32 NumWorkers = 1;
+
+	// Run i is placed from seed BaseSeed + i
+	int32 BaseSeed = 1;
+
+	// The first run's index, for a worker given part of a batch
+	int32 FirstRun = 0;
+
+	// Game seconds before an engagement is called a draw
+	float MaxSeconds = 300.0f;
+
+	// Fixed game step the engagements are simulated at, Hz
+	float StepHz = 60.0f;
+
+	// Per-engagement rows; the totals go next to it as <name>.summary.csv
+	FString OutPath;
+
+	// Reads -MonteCarloRuns=, -MonteCarloWorkers=, -MonteCarloSeed=, -MonteCarloFirst=, -MonteCarloMaxSeconds=, -MonteCarloStepHz= and -MonteCarloOut=
+	void ParseCommandLine(const TCHAR* CommandLine);
+};
+
+USTRUCT(BlueprintType)
+struct FEngagementRunnerStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	bool bRunning = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	int32 NumRuns = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	int32 NumDone = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	int32 NumWins = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	int32 NumLosses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	int32 NumTimeouts = 0;
+
+	// Game seconds simulated per real second, over the engagements run here
+	UPROPERTY(BlueprintReadOnly, Category = "Monte Carlo")
+	float SpeedUp = 0.0f;
+};
+
+// Flies the player and judges the engagement in TG_PostUpdateWork, once the frame's damage has resolved
+USTRUCT()
+struct FEngagementRunnerTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UEngagementRunnerSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FEngagementRunnerTickFunction> : public TStructOpsTypeTraitsBase2<FEngagementRunnerTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Monte Carlo engagements for tuning the AI and the weapons without flying them by
+ * hand. Started with -MonteCarlo on the command line, the game runs a batch of
+ * ADogfightGameModeBase engagements back to back and writes each one's result (win,
+ * loss or timeout, kills and when they came, missile launches and hits for each
+ * side) to a CSV, with the batch's totals in a second one, then quits.
+ *
+ * Engagement i is the opening mission with the enemy wave placed from seed
+ * BaseSeed + i, restarted in place by UMissionResetSubsystem, so nothing is loaded
+ * between runs. The player's jet is flown by a simple pursuit autopilot: it banks
+ * and pulls towards the nearest enemy, fires the gun when it is in the gun cone and
+ * in range and launches a missile whenever it has a lock. The world ticks at a
+ * fixed step as fast as the machine allows, so an engagement takes as long as its
+ * simulation does, not as long as it would be flown.
+ *
+ * One world ticks on one thread, so a batch is spread over cores as processes:
+ * with -MonteCarloWorkers=N above 1 this process only starts N copies of itself,
+ * each with -nullrhi and its share of the runs, waits for them, and merges their
+ * files. For a whole server overnight, e.g.
+ *
+ *   FlightSim1 <Map> -MonteCarlo -MonteCarloRuns=5000 -MonteCarloWorkers=32 -nullrhi -nosound -unattended
+ *
+ * FlightSim.MonteCarlo.Run runs a batch in the current world, for trying it out.
+ */
+UCLASS()
+class FLIGHTSIM1_API UEngagementRunnerSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Starts a batch: in this world for one worker, otherwise as worker processes. False if one is already going or the output cannot be written.
+	bool StartBatch(const FEngagementRunSettings& InSettings);
+
+	bool IsRunning() const { return Stats.bRunning; }
+
+	// Flies the player, calls timeouts and watches the workers
+	void Update(float DeltaTime);
+
+	UFUNCTION(BlueprintPure, Category = "Monte Carlo")
+	FEngagementRunnerStats GetStats() const { return Stats; }
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		// Waiting for the opening wave, so the mission has a start to go back to
+		WaitingForMission,
+		// The next engagement's reset has been asked for
+		Resetting,
+		Fighting,
+		// Coordinating worker processes
+		Waiting
+	};
+
+	// Engagements in this world
+	void StartNextRun();
+	void HandleMissionReset();
+	void HandleEnemyDestroyed();
+	void HandlePlayerDied();
+	void FinishRun(EEngagementResult Result);
+	void FinishBatch();
+
+	// The autopilot's controls for this frame
+	void FlyPlayer(AFighterJetPawn* Jet);
+
+	// Worker processes
+	bool LaunchWorkers();
+	void UpdateWorkers();
+	void MergeWorkerResults();
+
+	FString GetWorkerPath(int32 Worker) const;
+	FString GetSummaryPath() const;
+
+	UPROPERTY()
+	UMissionResetSubsystem* MissionReset;
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	UMissileGuidanceSubsystem* MissileGuidance;
+
+	TWeakObjectPtr<ADogfightGameModeBase> GameMode;
+
+	FEngagementRunSettings Settings;
+	EPhase Phase = EPhase::Idle;
+
+	// Quit once the batch is written: this process was started to run it
+	bool bExitWhenDone = false;
+
+	// The engagement being fought and where it started from
+	FEngagementOutcome Outcome;
+	int32 RunIndex = 0;
+	double RunStartTime = 0.0;
+	double RunStartWallTime = 0.0;
+	double LastMissileTime = 0.0;
+	int32 PlayerMissilesBefore = 0;
+	int32 PlayerHitsBefore = 0;
+	int32 EnemyMissilesBefore = 0;
+	int32 EnemyHitsBefore = 0;
+
+	// Rows are written as each engagement ends, so a batch cut short keeps what it finished
+	TUniquePtr<FArchive> Results;
+	FEngagementSummary Summary;
+	double BatchStartWallTime = 0.0;
+
+	TArray<FProcHandle> Workers;
+
+	// Reused by the autopilot's nearest-enemy query
+	TArray<int32> Nearest;
+
+	FDelegateHandle MissionResetHandle;
+	FDelegateHandle EnemyDestroyedHandle;
+	FDelegateHandle PlayerDiedHandle;
+
+	FEngagementRunnerStats Stats;
+
+	FEngagementRunnerTickFunction TickFunction;
+};
@@ -12,9 +12,32 @@
 #include "Particles/ParticleSystem.h"
 #include "HealthComponent.h"
 #include "Missile.h"
+#include "TargetingComponent.h"
+#include "RadarSubsystem.h"
+#include "FlightModel/WorldSnapshot.h"
 #include "FighterJetPawn.generated.h"
 
 class USoundBase;
+class UFlightPhysicsSubsystem;
+class UAircraftSpatialSubsystem;
+class URadarSubsystem;
+class UGunfireSubsystem;
+class UEffectsSubsystem;
+class UActorPoolSubsystem;
+class UAeroCoefficientTable;
+namespace FlightModel { struct FAirframe; }
+
+// Controls for a jet flown without a player, e.g. by UEngagementRunnerSubsystem's autopilot. Axes as the
+// input bindings give them, -1..1, except the throttle, which is set outright rather than moved, 0..1.
+struct FFighterPilotCommand
+{
+	float Throttle = 0.0f;
+	float Pitch = 0.0f;
+	float Roll = 0.0f;
+	float Yaw = 0.0f;
+	bool bFireGun = false;
+	bool bFireMissile = false;
+};
 
 UCLASS()
 class FLIGHTSIM1_API AFighterJetPawn : public APawn
@@ -26,11 +49,23 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	virtual void Tick(float DeltaTime) override;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	// Back to the state of a fresh spawn for a mission reset: controls released, weapons idle, body simulating again.
+	// The caller moves the jet and restores its velocity and health.
+	void ResetForMission();
+
+	// Velocities, controls, weapon timing and lock for UWorldSnapshotSubsystem, which handles the transform and health
+	void CaptureSnapshot(FlightModel::FAircraftSnapshot& OutSnapshot) const;
+	void RestoreSnapshot(const FlightModel::FAircraftSnapshot& Snapshot);
+
+	// Takes the place of this frame's input; a missile is only launched with a lock
+	void ApplyPilotCommand(const FFighterPilotCommand& Command);
+
 	// --- Components ---
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UStaticMeshComponent* AircraftMesh;
@@ -47,6 +82,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UHealthComponent* HealthComponent;
 
+	// Lock-on; its per-frame result is what the HUD and missiles read
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UTargetingComponent* TargetingComponent;
+
 	// --- Flight Physics Properties ---
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flight|Thrust")
 	float MaxThrust;
@@ -72,6 +111,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flight|Physics")
 	float DragCoefficient;
 
+	// Optional CL/CD/Cm table by AoA and Mach; replaces the two coefficients above when set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Flight|Physics")
+	UAeroCoefficientTable* AeroTable;
+
 	// --- HUD Variables ---
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD")
 	float Airspeed;
@@ -79,6 +122,7 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD")
 	float Altitude;
 
+	// Mirrors TargetingComponent's target once the lock is acquired
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "HUD")
 	AActor* LockedTarget;
 
@@ -98,6 +142,15 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Weapons")
 	TSubclassOf<AMissile> MissileClass;
 
+	// Missiles parked in the actor pool when the jet spawns, so the first salvo does not spawn actors
+	UPROPERTY(EditDefaultsOnly, Category = "Weapons")
+	int32 MissilePoolPrewarm;
+
+	// --- Sensors ---
+	// Targeting can only lock what this radar has a contact on
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensors")
+	FRadarSensorParams Radar;
+
 
 protected:
 	// --- HUD Management ---
@@ -107,6 +160,28 @@ protected:
 	UPROPERTY()
 	UUserWidget* HUDWidgetInstance;
 
+	// Applies our forces in one batched pass together with every other aircraft
+	UPROPERTY()
+	UFlightPhysicsSubsystem* FlightPhysics;
+
+	// Lets AI and targeting find us without scanning every actor
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	URadarSubsystem* RadarSystem;
+
+	// Guns queue their shots here instead of tracing one by one
+	UPROPERTY()
+	UGunfireSubsystem* Gunfire;
+
+	// Muzzle flashes and gun sounds go through the pooled, budgeted dispatcher
+	UPROPERTY()
+	UEffectsSubsystem* Effects;
+
+	UPROPERTY()
+	UActorPoolSubsystem* ActorPool;
+
 
 private:
 	// --- Input Handling Functions ---
@@ -129,13 +204,13 @@ private:
 	bool bIsOnGround;
 	bool bIsFiring;
 	float LastFireTime;
+	int32 AeroHandle;
+	int32 SpatialHandle;
 
 	// --- Physics Functions ---
 	void ApplyAerodynamics(float DeltaTime);
 	void CheckIfOnGround();
+	FlightModel::FAirframe MakeAirframe() const;
 
 	void HandleDeath();
-
-	// --- Targeting Function ---
-	void UpdateLockedTarget();
 };
@@ -0,0 +1,97 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// The AI aircraft's decisions, without the engine: UAIAircraftSubsystem runs them on its packed
+// agents (through AIAircraftLogic) and FDogfightEnv on its enemies, so the game and the training
+// environment fly the same AI. Radar, weapons and physics stay with the caller.
+
+#include "FlightModel/FlightMath.h"
+
+namespace FlightModel
+{
+	// Everything one AI aircraft's decision depends on
+	struct FAIPilotAgent
+	{
+		FVec3d Location;
+		FRotatord Rotation;
+
+		double FlightSpeed = 0.0;
+		double TurnSpeed = 0.0;
+		double AvoidanceDistance = 0.0;
+		double EvasionTurnSpeed = 0.0;
+		double FireRate = 0.0;
+		double LastFireTime = 0.0;
+
+		// Yawing away after a hit instead of seeking
+		bool bEvading = false;
+
+		// The contact the agent's radar reports, if any
+		bool bHasContact = false;
+		FVec3d ContactLocation;
+		FVec3d ContactVelocity;
+	};
+
+	// Inputs shared by every agent
+	struct FAIPilotFrame
+	{
+		double Time = 0.0;
+		double DeltaTime = 0.0;
+
+		// How long a plan stays valid after the agent loses its radar contact
+		double ContactMemorySeconds = 0.0;
+
+		// Agents without a plan turn back once further than PatrolRadius from PatrolCenter (0 disables)
+		FVec3d PatrolCenter;
+		double PatrolRadius = 0.0;
+	};
+
+	// An agent's last steering plan. Plan and Steer only need to run when the agent is re-planned;
+	// Decide keeps turning towards the solved heading on the frames in between.
+	struct FAIPilotPlan
+	{
+		FVec3d TargetLocation;
+		FVec3d TargetVelocity;
+		double PlanTime = 0.0;
+
+		// Steer away from the target instead of towards it (inside AvoidanceDistance when planned)
+		bool bAvoid = false;
+		bool bValid = false;
+
+		// Heading solved when last steered; without it the agent holds course
+		FRotatord SteerRotation;
+		bool bSteer = false;
+
+		// The contact was ahead and the gun had cycled when last steered; fires on that frame only
+		bool bFire = false;
+		double ServiceTime = -1.0;
+	};
+
+	// What one agent does this frame
+	struct FAIPilotDecision
+	{
+		// World-space force along the heading from before this frame's turn
+		FVec3d Thrust;
+
+		// The agent's new heading, when it turns this frame
+		FRotatord Rotation;
+		bool bTurn = false;
+
+		bool bFire = false;
+	};
+
+	namespace AIPilot
+	{
+		// Chooses whether to close in on or turn away from the agent's radar contact, and remembers where
+		// it was going. Without a contact the old plan is kept for ContactMemorySeconds, then dropped.
+		void Plan(const FAIPilotAgent& Agent, const FAIPilotFrame& Frame, FAIPilotPlan& InOutPlan);
+
+		// Solves the heading for the plan's target extrapolated to now (or back to the patrol area
+		// without one) and the fire check, for Decide to use until the agent is re-planned
+		void Steer(const FAIPilotAgent& Agent, const FAIPilotFrame& Frame, FAIPilotPlan& InOutPlan);
+
+		// Thrust, the turn towards the steered heading or the evasion yaw, and the shot Steer decided on
+		// this frame. Only reads its inputs, so any number of agents can be decided at once.
+		FAIPilotDecision Decide(const FAIPilotAgent& Agent, const FAIPilotPlan& Plan, const FAIPilotFrame& Frame);
+	}
+}
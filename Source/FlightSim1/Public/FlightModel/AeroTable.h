@@ -0,0 +1,87 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Aerodynamic coefficient tables over angle of attack x Mach, with linear control
+// deflection terms. Authored data (any grid spacing) is baked into a uniform grid of
+// 32-byte nodes so a lookup is two clamps, two truncations and one bilinear blend,
+// with no searching and no branches.
+
+#include <vector>
+
+namespace FlightModel
+{
+	// Speed of sound at sea level, cm/s
+	constexpr double SpeedOfSound = 34300.0;
+
+	// Coefficients at a single (AoA, Mach) grid point
+	struct FAeroTablePoint
+	{
+		double CL = 0.0;
+		double CD = 0.0;
+		double Cm = 0.0;
+
+		// Change per radian of control deflection (CD grows with deflection squared)
+		double CLPerDeflection = 0.0;
+		double CDPerDeflectionSq = 0.0;
+		double CmPerDeflection = 0.0;
+	};
+
+	// Authored table. Points are Mach-major: Points[MachIndex * AngleOfAttack.size() + AoAIndex].
+	struct FAeroTableSource
+	{
+		std::vector<double> AngleOfAttack;	// radians, strictly ascending
+		std::vector<double> Mach;			// strictly ascending
+		std::vector<FAeroTablePoint> Points;
+	};
+
+	struct FAeroCoefficients
+	{
+		double CL = 0.0;
+		double CD = 0.0;
+		double Cm = 0.0;
+	};
+
+	class FAeroTable
+	{
+	public:
+		// Resamples Source onto a uniform grid. Returns false (and leaves the table empty) if Source is malformed.
+		bool Bake(const FAeroTableSource& Source, int MaxAoASamples = 128, int MaxMachSamples = 32);
+
+		bool IsValid() const { return !Nodes.empty(); }
+
+		// Bilinear in AoA and Mach, clamped to the table range; Deflection in radians
+		FAeroCoefficients Lookup(double AngleOfAttack, double Mach, double Deflection) const;
+
+		int GetNumAoA() const { return NumAoA; }
+		int GetNumMach() const { return NumMach; }
+
+	private:
+		// One grid node; the two AoA neighbours of a cell corner are a single contiguous 64-byte read
+		struct alignas(32) FNode
+		{
+			float CL;
+			float CD;
+			float Cm;
+			float CLPerDeflection;
+			float CDPerDeflectionSq;
+			float CmPerDeflection;
+			float Padding[2];
+		};
+		static_assert(sizeof(FNode) == 32, "Aero table nodes must stay 32 bytes");
+
+		std::vector<FNode> Nodes;
+		int NumAoA = 0;
+		int NumMach = 0;
+		double AoAMin = 0.0;
+		double AoAInvStep = 0.0;
+		double AoAMaxIndex = 0.0;
+		double MachMin = 0.0;
+		double MachInvStep = 0.0;
+		double MachMaxIndex = 0.0;
+	};
+
+	// A generic single-seat fighter: linear lift up to a 15 degree stall, post-stall lift
+	// loss, induced drag and a transonic drag rise. Used when no authored table exists.
+	FAeroTableSource MakeGenericFighterTable();
+}
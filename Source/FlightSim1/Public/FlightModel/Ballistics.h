@@ -0,0 +1,106 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Fixed-capacity pool of ballistic gun rounds. Live rounds are packed
+// structure-of-arrays, so one step is a few straight loops over float streams:
+// integrate every round, sweep every round's segment for this step against the
+// bounding spheres filed in its cell of a small hashed grid (rebuilt each step,
+// since aircraft move), then retire the rounds that hit something or ran out of time.
+// All storage is sized once by Initialize; spawning and retiring never allocate.
+
+#include "FlightModel/Broadphase.h"
+#include "FlightModel/FlightMath.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace FlightModel
+{
+	enum class EBallisticImpact : uint8_t
+	{
+		// Hit the sphere in FBallisticImpact::Sphere
+		Sphere,
+		// Reached the terrain time set by SetTerrainTime
+		Terrain
+	};
+
+	struct FBallisticImpact
+	{
+		EBallisticImpact Type = EBallisticImpact::Sphere;
+		int Sphere = -1;
+		int Owner = -1;
+		float Damage = 0.0f;
+		FVec3d Location;
+	};
+
+	class FBallisticPool
+	{
+	public:
+		// Sizes every buffer for Capacity rounds and drops any live ones
+		void Initialize(int InCapacity);
+
+		// Retires every live round; generations still advance, so late terrain results for them are ignored
+		void Clear();
+
+		int GetCapacity() const { return Capacity; }
+		int Num() const { return NumLive; }
+
+		// Stable id of the new round, or -1 if the pool is full. Owner is matched against the
+		// sphere owners passed to Step so a round never hits the aircraft that fired it.
+		int Spawn(const FVec3d& Origin, const FVec3d& Velocity, float Damage, float Lifetime, int Owner);
+
+		// Incremented each time an id is reused, so late results for an old round can be told apart
+		uint16_t GetGeneration(int Id) const { return Generations[Id]; }
+
+		// Time of flight at which the round meets the terrain; ignored if the id has since been reused
+		void SetTerrainTime(int Id, uint16_t Generation, float Time);
+
+		// Advances every round by DeltaTime under Gravity and appends what they hit to OutImpacts.
+		// SphereOwners gives the owner of each sphere (one entry per sphere in Spheres).
+		void Step(double DeltaTime, const FVec3d& Gravity, const FSphereSet& Spheres, const int* SphereOwners,
+			std::vector<FBallisticImpact>& OutImpacts);
+
+		// Rounds retired at the end of their lifetime by the last Step
+		int GetNumExpired() const { return NumExpired; }
+
+		FVec3d GetPosition(int Id) const;
+
+	private:
+		void Retire(int Index);
+
+		int Capacity = 0;
+		int NumLive = 0;
+		int NumExpired = 0;
+
+		// Live rounds, packed in [0, NumLive)
+		std::vector<float> PositionX;
+		std::vector<float> PositionY;
+		std::vector<float> PositionZ;
+		std::vector<float> VelocityX;
+		std::vector<float> VelocityY;
+		std::vector<float> VelocityZ;
+		std::vector<float> Age;
+		std::vector<float> Lifetime;
+		std::vector<float> TerrainTime;
+		std::vector<float> Damage;
+		std::vector<int> Owner;
+		std::vector<int> IndexToId;
+
+		// Per-step scratch: this step's displacement and the nearest sphere along it
+		std::vector<float> SegmentX;
+		std::vector<float> SegmentY;
+		std::vector<float> SegmentZ;
+		std::vector<float> InvSegmentLengthSq;
+		std::vector<float> HitFraction;
+		std::vector<int> HitSphere;
+
+		// The aircraft spheres, rebuilt every step since they move
+		FSphereGrid SphereGrid;
+
+		// Id -> packed index (-1 when free), plus the free ids
+		std::vector<int> IdToIndex;
+		std::vector<uint16_t> Generations;
+		std::vector<int> FreeIds;
+	};
+}
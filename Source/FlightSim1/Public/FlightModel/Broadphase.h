@@ -0,0 +1,87 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Batched ray queries against a flat list of bounding spheres (one per aircraft).
+// Spheres are stored structure-of-arrays so the per-sphere test is a straight,
+// branch-free loop over four float streams that the compiler vectorizes; only the
+// few spheres a ray actually touches go through the scalar square root.
+
+#include "FlightModel/FlightMath.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace FlightModel
+{
+	// Bounding spheres, one stream per component
+	struct FSphereSet
+	{
+		std::vector<float> X;
+		std::vector<float> Y;
+		std::vector<float> Z;
+		std::vector<float> Radius;
+
+		void Reset();
+		void Reserve(int Num);
+		void Add(const FVec3d& Center, double InRadius);
+		int Num() const { return static_cast<int>(X.size()); }
+	};
+
+	struct FRay
+	{
+		FVec3d Origin;
+		FVec3d Direction;		// unit length
+		double Length = 0.0;
+
+		// Sphere the ray never hits, e.g. the shooter's own; -1 for none
+		int IgnoreIndex = -1;
+	};
+
+	struct FRayHit
+	{
+		// Nearest sphere the ray enters within its length, or -1
+		int Index = -1;
+
+		// Where the ray enters and leaves that sphere (entry is 0 if the ray starts inside)
+		double EntryDistance = 0.0;
+		double ExitDistance = 0.0;
+	};
+
+	class FRayBroadphase
+	{
+	public:
+		// Nearest sphere hit for each ray. Reuses its scratch buffer between calls.
+		void Intersect(const FSphereSet& Spheres, const FRay* Rays, int NumRays, FRayHit* OutHits);
+
+	private:
+		// Per-sphere discriminant for the current ray, negative where the ray misses
+		std::vector<float> Discriminants;
+	};
+
+	// Hashed uniform grid for segment-against-sphere sweeps. Each sphere is filed under every
+	// cell its box, grown by Reach, touches; with Reach at least a sphere's radius plus half the
+	// longest segment, a segment within that radius of a centre has its midpoint inside the box,
+	// so a query only needs the cell of its midpoint. Cells are twice Reach, so a sphere is in at
+	// most 8. Rebuilt whenever the spheres move; storage is reused between builds.
+	class FSphereGrid
+	{
+	public:
+		void Build(const float* X, const float* Y, const float* Z, int Num, float Reach);
+
+		// Spheres filed under the cell containing the point; OutNum is 0 when there are none
+		const int* Find(float X, float Y, float Z, int& OutNum) const;
+
+	private:
+		float CellSize = 1.0f;
+
+		// Open-addressed cell keys with each cell's range in CellSpheres
+		std::vector<int64_t> CellKeys;
+		std::vector<int> CellStart;
+		std::vector<int> CellCount;
+		std::vector<int> CellSpheres;
+	};
+
+	// Reference ray/sphere test in double precision; used to check the batched path
+	bool IntersectRaySphere(const FRay& Ray, const FVec3d& Center, double Radius, double& OutEntry, double& OutExit);
+}
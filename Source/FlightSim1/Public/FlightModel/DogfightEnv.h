@@ -0,0 +1,330 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Batched reinforcement-learning environment over the flight model: N independent
+// engagements, each one agent-flown fighter jet against a few AI aircraft, stepped
+// in lock-step at a fixed rate. The agent's jet is the same 6-DOF model
+// AFighterJetPawn flies, the AI the same decisions as AIAircraftLogic flown as a
+// point mass, and the guns, missiles, lock and damage follow the game's rules.
+//
+// Everything the trainer exchanges with the batch lives in flat float/byte buffers
+// allocated once at construction: the trainer writes NumEnvs x ActionSize actions,
+// calls Step, and reads NumEnvs x ObservationSize observations plus a reward and
+// done flags per engagement, in place. A finished engagement restarts inside the
+// same Step (its last observation is kept in the final observation buffer), so the
+// batch never stops. Nothing is allocated after construction, and each engagement
+// only ever reads its own state, so the batch is split over worker threads without
+// locks and gives the same results for any thread count.
+
+#include "FlightModel/AIPilot.h"
+#include "FlightModel/FlightDynamics.h"
+#include "FlightModel/MissileGuidance.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FlightModel
+{
+	// The agent's jet, with AFighterJetPawn's defaults
+	struct FDogfightJetParams
+	{
+		FAirframe Airframe;
+
+		// Full-throttle thrust, N (kg*cm/s^2), and the turn rates at full stick, degrees/s
+		double MaxThrust = 1.0e8;
+		double PitchSpeed = 30.0;
+		double RollSpeed = 50.0;
+		double YawSpeed = 10.0;
+
+		double MaxHealth = 100.0;
+
+		// Hitscan gun: seconds between rounds, range in cm, damage per round
+		double FireRate = 0.1;
+		double WeaponRange = 50000.0;
+		double GunDamage = 10.0;
+
+		// Radar the lock is taken from, and UTargetingComponent's lock timing
+		double RadarRange = 1000000.0;
+		double RadarConeHalfAngle = 60.0;
+		double LockAcquireTime = 0.5;
+		double BreakLockTime = 0.5;
+		double SwitchScoreRatio = 1.25;
+
+		// Launched at LaunchSpeed on top of the jet's velocity; one launch per press of the missile action
+		FMissileParams Missile;
+		double MissileLaunchSpeed = 40000.0;
+		double MissileDamage = 100.0;
+
+		// Missiles one engagement can have in flight; launches past this are ignored
+		int MaxMissilesInFlight = 4;
+
+		FDogfightJetParams();
+	};
+
+	// The AI aircraft, with AAIAircraftPawn's and UAIAircraftSubsystem's defaults
+	struct FDogfightAIParams
+	{
+		// Forward thrust, force along the heading, and the point-mass body it pushes
+		double FlightSpeed = 5000.0;
+		FPointMass Body;
+
+		// RInterpTo speed towards the target heading, and the distance inside which it turns away
+		double TurnSpeed = 2.0;
+		double AvoidanceDistance = 15000.0;
+
+		// After a hit: seconds spent yawing away, degrees per step
+		double EvasionDuration = 2.0;
+		double EvasionTurnSpeed = 8.0;
+
+		double MaxHealth = 100.0;
+
+		double FireRate = 0.2;
+		double WeaponRange = 50000.0;
+		double GunDamage = 10.0;
+
+		double RadarRange = 800000.0;
+		double RadarConeHalfAngle = 60.0;
+
+		// How long a lost contact is still chased, and how far from the centre the AI patrols without one
+		double ContactMemorySeconds = 8.0;
+		double PatrolRadius = 600000.0;
+
+		FDogfightAIParams();
+	};
+
+	// Reward for each decision step; all terms are summed over the step's physics steps
+	struct FDogfightRewards
+	{
+		double Kill = 1.0;
+		double Win = 1.0;
+
+		// Shot down or flown into the ground
+		double Loss = -1.0;
+
+		// Per point of damage dealt and taken
+		double DamageDealt = 0.005;
+		double DamageTaken = -0.005;
+
+		// Every decision step, to hurry the agent along
+		double Step = 0.0;
+	};
+
+	struct FDogfightEnvConfig
+	{
+		int NumEnvs = 64;
+		int NumEnemies = 4;
+
+		// Threads stepping the batch, the calling thread included
+		int NumThreads = 1;
+
+		// Physics step, and how many of them one decision (one Step call) covers
+		double StepSize = 1.0 / 60.0;
+		int ActionRepeat = 1;
+
+		// Game seconds before an engagement is truncated
+		double MaxEpisodeSeconds = 120.0;
+
+		// The agent starts at the centre at SpawnAltitude on a random heading at StartSpeed;
+		// the AI on a ring of SpawnRadius around it facing inwards, as PlaceWave places a wave
+		double SpawnRadius = 200000.0;
+		double SpawnAltitude = 300000.0;
+		double StartSpeed = 20000.0;
+		double SpawnAngleJitter = 0.5;
+
+		// Bounding sphere radius of every aircraft, for the guns and the missile fuze, cm
+		double AircraftRadius = 1000.0;
+
+		// The agent crashes below this height
+		double GroundZ = 0.0;
+
+		FDogfightJetParams Jet;
+		FDogfightAIParams AI;
+		FDogfightRewards Rewards;
+	};
+
+	// Layout of one engagement's observation row. Positions are scaled by 1e-5 (km),
+	// velocities by 1e-4; everything relative is in the agent's body frame.
+	namespace DogfightObservation
+	{
+		enum : int
+		{
+			// The agent
+			VelocityX, VelocityY, VelocityZ,
+			Altitude,
+			UpX, UpY, UpZ,
+			AngularVelocityX, AngularVelocityY, AngularVelocityZ,
+			Throttle,
+			Health,
+			GunReady,
+			LockProgress,
+			MissilesInFlight,
+			TimeLeft,
+			NumAgent
+		};
+
+		// Then one block per AI aircraft, in a fixed order; zeros once it is shot down
+		enum : int
+		{
+			Alive,
+			RelativePositionX, RelativePositionY, RelativePositionZ,
+			RelativeVelocityX, RelativeVelocityY, RelativeVelocityZ,
+			ForwardX, ForwardY, ForwardZ,
+			EnemyHealth,
+			IsLockTarget,
+			NumPerEnemy
+		};
+	}
+
+	// One engagement's action row: throttle in [0, 1], stick in [-1, 1], weapons fire above 0.5
+	namespace DogfightAction
+	{
+		enum : int
+		{
+			Throttle,
+			Pitch,
+			Roll,
+			Yaw,
+			FireGun,
+			FireMissile,
+			Num
+		};
+	}
+
+	// How an engagement ended, as of the last Step
+	enum class EDogfightOutcome : uint8_t
+	{
+		None,
+		Win,
+		Loss,
+		Timeout
+	};
+
+	class FDogfightEnv
+	{
+	public:
+		explicit FDogfightEnv(const FDogfightEnvConfig& InConfig);
+		~FDogfightEnv();
+
+		FDogfightEnv(const FDogfightEnv&) = delete;
+		FDogfightEnv& operator=(const FDogfightEnv&) = delete;
+
+		// Starts every engagement over; engagement i is placed from a stream seeded with Seed and i
+		void Reset(uint64_t Seed);
+
+		// Advances every engagement by one decision with the actions in GetActions
+		void Step();
+
+		int GetNumEnvs() const { return Config.NumEnvs; }
+		int GetObservationSize() const { return ObservationSize; }
+		int GetActionSize() const { return DogfightAction::Num; }
+		const FDogfightEnvConfig& GetConfig() const { return Config; }
+
+		// Buffers, NumEnvs rows each; the pointers stay valid for the life of the env
+		float* GetActions() { return Actions.data(); }
+		const float* GetObservations() const { return Observations.data(); }
+		const float* GetRewards() const { return Rewards.data(); }
+
+		// An engagement that ended last Step has Terminated (won or lost) or Truncated (out of time)
+		// set, its observation already from the restarted engagement and its last one in FinalObservations
+		const uint8_t* GetTerminated() const { return Terminated.data(); }
+		const uint8_t* GetTruncated() const { return Truncated.data(); }
+		const float* GetFinalObservations() const { return FinalObservations.data(); }
+
+		// Set only on the Step an engagement ended: an EDogfightOutcome, the reward it collected and its length in Steps
+		const uint8_t* GetOutcomes() const { return Outcomes.data(); }
+		const float* GetEpisodeReturns() const { return EpisodeReturns.data(); }
+		const int32_t* GetEpisodeLengths() const { return EpisodeLengths.data(); }
+
+	private:
+		struct FEngagement
+		{
+			FBodyState Jet;
+			double JetHealth = 0.0;
+			double Throttle = 0.0;
+			double LastFireTime = 0.0;
+			bool bMissileHeld = false;
+
+			// Lock as UTargetingComponent keeps it: the candidate, how long it has been held and out of the cone
+			int LockTarget = -1;
+			double LockScore = 0.0;
+			double LockHeldTime = 0.0;
+			double LockOutOfConeTime = 0.0;
+
+			int NumAlive = 0;
+			double Time = 0.0;
+			int NumSteps = 0;
+			double Return = 0.0;
+
+			uint64_t Random = 0;
+			FMissileBatch Missiles;
+
+			// The locked target each missile was launched at, -1 once it is gone
+			std::vector<int> MissileTargets;
+			std::vector<FMissileEvent> MissileEvents;
+		};
+
+		// One AI aircraft; its heading is a rotator in degrees, turned like an actor's
+		struct FEnemy
+		{
+			FVec3d Position;
+			FVec3d Velocity;
+			FRotatord Rotation;
+			double Health = 0.0;
+			double LastFireTime = 0.0;
+			double EvadeUntil = -1.0;
+			bool bAlive = false;
+
+			// The same plan UAIAircraftSubsystem keeps, re-planned every step
+			FAIPilotPlan Plan;
+		};
+
+		// Steps this thread's share of the batch
+		void StepSlice(int Slice);
+		void StepEngagement(int Env);
+
+		// One physics step of one engagement; returns its reward and sets Outcome when it ends
+		double Simulate(int Env, EDogfightOutcome& OutOutcome);
+		void FlyEnemies(FEngagement& Engagement, FEnemy* Enemies, double& InOutReward);
+		void UpdateLock(FEngagement& Engagement, const FEnemy* Enemies);
+		void FlyMissiles(FEngagement& Engagement, FEnemy* Enemies, double& InOutReward);
+
+		// Applies a hit to an AI aircraft, returning the reward for it
+		double DamageEnemy(FEngagement& Engagement, FEnemy& Enemy, double Damage);
+
+		void ResetEngagement(int Env);
+		void WriteObservation(int Env, float* Out) const;
+
+		void WorkerLoop(int Worker);
+
+		FDogfightEnvConfig Config;
+		int ObservationSize = 0;
+
+		std::vector<FEngagement> Engagements;
+
+		// NumEnvs x NumEnemies
+		std::vector<FEnemy> Enemies;
+
+		std::vector<float> Actions;
+		std::vector<float> Observations;
+		std::vector<float> FinalObservations;
+		std::vector<float> Rewards;
+		std::vector<uint8_t> Terminated;
+		std::vector<uint8_t> Truncated;
+		std::vector<uint8_t> Outcomes;
+		std::vector<float> EpisodeReturns;
+		std::vector<int32_t> EpisodeLengths;
+
+		// Worker threads, each stepping a fixed slice of the batch; the caller takes slice 0
+		std::vector<std::thread> Workers;
+		std::mutex WorkMutex;
+		std::condition_variable WorkReady;
+		std::condition_variable WorkDone;
+		uint64_t WorkGeneration = 0;
+		int WorkPending = 0;
+		bool bStopping = false;
+	};
+}
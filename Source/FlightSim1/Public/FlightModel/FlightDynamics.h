@@ -0,0 +1,153 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Engine-independent 6-DOF flight model: thrust, lift, drag and control torques
+// plus a fixed-step rigid-body integrator. No UObject or engine dependency, so the
+// same code runs inside FlightSim1 and in the standalone build under Tools/FlightModel.
+// Units follow the engine: centimetres, kilograms, seconds, radians.
+
+#include "FlightModel/AeroTable.h"
+#include "FlightModel/FlightMath.h"
+
+namespace FlightModel
+{
+	// Per-aircraft tuning that does not change from frame to frame
+	struct FAirframe
+	{
+		// Converts velocity (cm/s) into the airspeed units the coefficients were tuned for
+		double SpeedScale = 1.0;
+
+		double LiftCoefficient = 0.0;
+		double DragCoefficient = 0.0;
+
+		// true: lift is perpendicular to the velocity in the aircraft's plane of symmetry (FighterJet)
+		// false: lift acts along the body up vector (Airplane)
+		bool bLiftAlongVelocityNormal = false;
+
+		// true: control torques are angular accelerations (mass independent), false: real torques
+		bool bTorqueAsAcceleration = false;
+
+		// --- Coefficient table, replaces LiftCoefficient/DragCoefficient when set ---
+		// Not owned; the baked table must outlive every airframe that points at it.
+		const FAeroTable* AeroTable = nullptr;
+
+		// 0.5 * rho * S: force = Speed^2 * TableForceScale * C
+		double TableForceScale = 0.0;
+
+		// 0.5 * rho * S * chord: pitching torque = Speed^2 * TableMomentScale * Cm. Always a real torque,
+		// divided by Inertia.Y when bTorqueAsAcceleration is set
+		double TableMomentScale = 0.0;
+
+		// Elevator deflection at full pitch input, radians
+		double MaxElevatorDeflection = 0.35;
+
+		// --- Rigid body, only used when the model integrates itself (Chaos does this in game) ---
+		double Mass = 1000.0;
+
+		// Principal moments of inertia about the forward/right/up body axes, kg*cm^2
+		FVec3d Inertia = FVec3d(1.0e8, 1.0e8, 1.0e8);
+
+		double LinearDamping = 0.01;
+		double AngularDamping = 0.0;
+		double GravityZ = -980.0;
+	};
+
+	// Per-step pilot commands, already scaled into physics units
+	struct FControls
+	{
+		// Thrust force along the forward vector
+		double Thrust = 0.0;
+
+		// Torques about the right/forward/up body axes, in radians
+		double PitchTorque = 0.0;
+		double RollTorque = 0.0;
+		double YawTorque = 0.0;
+
+		// Normalized pitch input [-1, 1]; drives the elevator when the airframe has a coefficient table,
+		// in which case PitchTorque is ignored
+		double Elevator = 0.0;
+
+		// Lift is switched off while the aircraft is sitting on the ground
+		bool bLiftEnabled = true;
+	};
+
+	// World-space rigid body state
+	struct FBodyState
+	{
+		FVec3d Position;
+		FVec3d Velocity;
+		FQuatd Attitude;
+		FVec3d AngularVelocity;
+	};
+
+	// World-space force and torque acting on the body
+	struct FLoads
+	{
+		FVec3d Force;
+		FVec3d Torque;
+	};
+
+	// Angle of attack (radians, positive nose above the flight path) from the body-space velocity
+	double ComputeAngleOfAttack(const FVec3d& LocalVelocity);
+
+	// Table coefficients for the current flow; the airframe must have an AeroTable
+	FAeroCoefficients SampleCoefficients(const FAirframe& Airframe, const FVec3d& LocalVelocity, double Elevator);
+
+	// Evaluates the aerodynamic, thrust and control loads for the current state
+	FLoads ComputeLoads(const FAirframe& Airframe, const FBodyState& State, const FControls& Controls);
+
+	// Advances the body by one step with semi-implicit Euler, including gravity and damping
+	void Step(const FAirframe& Airframe, FBodyState& State, const FControls& Controls, double StepSize);
+
+	// Translation-only body for aircraft far from anything that could interact with them.
+	// Uses the same force, gravity and damping terms as the rigid body so an aircraft can
+	// switch between the two without a jump in velocity.
+	struct FPointMass
+	{
+		double Mass = 1000.0;
+		double LinearDamping = 0.01;
+		double GravityZ = -980.0;
+
+		// Speed is clamped to this after every step, 0 for no limit
+		double MaxSpeed = 0.0;
+	};
+
+	// Advances a point mass by one step under Force (world space) with semi-implicit Euler
+	void StepPointMass(const FPointMass& Body, FVec3d& Position, FVec3d& Velocity, const FVec3d& Force, double StepSize);
+
+	struct FGroundContact
+	{
+		bool bOnGround = false;
+
+		// Set on the step the aircraft touched down faster than the airframe can take
+		bool bHardLanding = false;
+	};
+
+	// Ground check for the current step. HeightAboveGround < 0 means no ground was found below.
+	FGroundContact EvaluateGroundContact(double HeightAboveGround, double VerticalSpeed, bool bWasOnGround,
+		double ContactHeight = 300.0, double MaxLandingSpeed = 500.0);
+
+	/**
+	 * Converts variable frame times into a whole number of fixed steps, carrying the
+	 * remainder over to the next frame so the simulation is frame-rate independent.
+	 */
+	class FFixedStepClock
+	{
+	public:
+		explicit FFixedStepClock(double InStepSize = 1.0 / 120.0, int InMaxStepsPerFrame = 8);
+
+		// Returns how many fixed steps to run for a frame of FrameSeconds
+		int Advance(double FrameSeconds);
+
+		double GetStepSize() const { return StepSize; }
+
+		// Fraction of a step left in the accumulator, for render interpolation
+		double GetAlpha() const { return Accumulator / StepSize; }
+
+	private:
+		double StepSize;
+		double Accumulator;
+		int MaxStepsPerFrame;
+	};
+}
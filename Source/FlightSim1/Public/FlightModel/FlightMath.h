@@ -0,0 +1,236 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Engine-independent vector, quaternion and rotator types used by the flight model.
+// This header must not include any Unreal headers so the flight model can be
+// built and benchmarked outside the editor (see Tools/FlightModel).
+
+#include <cmath>
+
+namespace FlightModel
+{
+	// Double-precision 3D vector, same axis convention as FVector (X forward, Y right, Z up)
+	struct FVec3d
+	{
+		double X = 0.0;
+		double Y = 0.0;
+		double Z = 0.0;
+
+		constexpr FVec3d() = default;
+		constexpr FVec3d(double InX, double InY, double InZ) : X(InX), Y(InY), Z(InZ) {}
+
+		constexpr FVec3d operator+(const FVec3d& V) const { return FVec3d(X + V.X, Y + V.Y, Z + V.Z); }
+		constexpr FVec3d operator-(const FVec3d& V) const { return FVec3d(X - V.X, Y - V.Y, Z - V.Z); }
+		constexpr FVec3d operator-() const { return FVec3d(-X, -Y, -Z); }
+		constexpr FVec3d operator*(double Scale) const { return FVec3d(X * Scale, Y * Scale, Z * Scale); }
+		constexpr FVec3d operator/(double Scale) const { return FVec3d(X / Scale, Y / Scale, Z / Scale); }
+
+		FVec3d& operator+=(const FVec3d& V) { X += V.X; Y += V.Y; Z += V.Z; return *this; }
+		FVec3d& operator-=(const FVec3d& V) { X -= V.X; Y -= V.Y; Z -= V.Z; return *this; }
+		FVec3d& operator*=(double Scale) { X *= Scale; Y *= Scale; Z *= Scale; return *this; }
+
+		constexpr double SizeSquared() const { return X * X + Y * Y + Z * Z; }
+		double Size() const { return std::sqrt(SizeSquared()); }
+
+		// Unit vector, or zero if the vector is too short to normalize
+		FVec3d GetSafeNormal(double Tolerance = 1.e-8) const
+		{
+			const double SquareSum = SizeSquared();
+			if (SquareSum <= Tolerance)
+			{
+				return FVec3d();
+			}
+			return *this * (1.0 / std::sqrt(SquareSum));
+		}
+
+		static constexpr double Dot(const FVec3d& A, const FVec3d& B)
+		{
+			return A.X * B.X + A.Y * B.Y + A.Z * B.Z;
+		}
+
+		static constexpr FVec3d Cross(const FVec3d& A, const FVec3d& B)
+		{
+			return FVec3d(A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X);
+		}
+	};
+
+	constexpr FVec3d operator*(double Scale, const FVec3d& V)
+	{
+		return V * Scale;
+	}
+
+	// Double-precision unit quaternion, same layout and rotation convention as FQuat
+	struct FQuatd
+	{
+		double X = 0.0;
+		double Y = 0.0;
+		double Z = 0.0;
+		double W = 1.0;
+
+		constexpr FQuatd() = default;
+		constexpr FQuatd(double InX, double InY, double InZ, double InW) : X(InX), Y(InY), Z(InZ), W(InW) {}
+
+		static FQuatd FromAxisAngle(const FVec3d& Axis, double AngleRad)
+		{
+			const FVec3d Unit = Axis.GetSafeNormal();
+			const double S = std::sin(AngleRad * 0.5);
+			return FQuatd(Unit.X * S, Unit.Y * S, Unit.Z * S, std::cos(AngleRad * 0.5));
+		}
+
+		// Hamilton product: applying the result rotates by Q first, then by this
+		constexpr FQuatd operator*(const FQuatd& Q) const
+		{
+			return FQuatd(
+				W * Q.X + X * Q.W + Y * Q.Z - Z * Q.Y,
+				W * Q.Y - X * Q.Z + Y * Q.W + Z * Q.X,
+				W * Q.Z + X * Q.Y - Y * Q.X + Z * Q.W,
+				W * Q.W - X * Q.X - Y * Q.Y - Z * Q.Z);
+		}
+
+		constexpr FQuatd Inverse() const { return FQuatd(-X, -Y, -Z, W); }
+
+		constexpr double SizeSquared() const { return X * X + Y * Y + Z * Z + W * W; }
+
+		void Normalize()
+		{
+			const double SquareSum = SizeSquared();
+			if (SquareSum > 1.e-12)
+			{
+				const double Scale = 1.0 / std::sqrt(SquareSum);
+				X *= Scale; Y *= Scale; Z *= Scale; W *= Scale;
+			}
+			else
+			{
+				*this = FQuatd();
+			}
+		}
+
+		FVec3d RotateVector(const FVec3d& V) const
+		{
+			// v' = v + 2w(q x v) + q x (2(q x v))
+			const FVec3d Q(X, Y, Z);
+			const FVec3d T = FVec3d::Cross(Q, V) * 2.0;
+			return V + T * W + FVec3d::Cross(Q, T);
+		}
+
+		FVec3d UnrotateVector(const FVec3d& V) const
+		{
+			return Inverse().RotateVector(V);
+		}
+
+		FVec3d GetForwardVector() const { return RotateVector(FVec3d(1.0, 0.0, 0.0)); }
+		FVec3d GetRightVector() const { return RotateVector(FVec3d(0.0, 1.0, 0.0)); }
+		FVec3d GetUpVector() const { return RotateVector(FVec3d(0.0, 0.0, 1.0)); }
+	};
+
+	// Double-precision rotator in degrees, same axes and conversions as FRotator
+	struct FRotatord
+	{
+		double Pitch = 0.0;
+		double Yaw = 0.0;
+		double Roll = 0.0;
+
+		constexpr FRotatord() = default;
+		constexpr FRotatord(double InPitch, double InYaw, double InRoll) : Pitch(InPitch), Yaw(InYaw), Roll(InRoll) {}
+
+		static constexpr double DegToRad = 3.14159265358979323846 / 180.0;
+		static constexpr double RadToDeg = 180.0 / 3.14159265358979323846;
+
+		// FRotator::NormalizeAxis: the same angle in (-180, 180]
+		static double NormalizeAxis(double Angle)
+		{
+			Angle = std::fmod(Angle, 360.0);
+			if (Angle < 0.0)
+			{
+				Angle += 360.0;
+			}
+			return Angle > 180.0 ? Angle - 360.0 : Angle;
+		}
+
+		FRotatord GetNormalized() const { return FRotatord(NormalizeAxis(Pitch), NormalizeAxis(Yaw), NormalizeAxis(Roll)); }
+
+		// FRotator::Vector
+		FVec3d Vector() const
+		{
+			const double CP = std::cos(Pitch * DegToRad);
+			return FVec3d(CP * std::cos(Yaw * DegToRad), CP * std::sin(Yaw * DegToRad), std::sin(Pitch * DegToRad));
+		}
+
+		// FRotator::Quaternion
+		FQuatd Quaternion() const
+		{
+			const double SP = std::sin(Pitch * DegToRad * 0.5);
+			const double CP = std::cos(Pitch * DegToRad * 0.5);
+			const double SY = std::sin(Yaw * DegToRad * 0.5);
+			const double CY = std::cos(Yaw * DegToRad * 0.5);
+			const double SR = std::sin(Roll * DegToRad * 0.5);
+			const double CR = std::cos(Roll * DegToRad * 0.5);
+			return FQuatd(
+				CR * SP * SY - SR * CP * CY,
+				-CR * SP * CY - SR * CP * SY,
+				CR * CP * SY - SR * SP * CY,
+				CR * CP * CY + SR * SP * SY);
+		}
+
+		// FQuat::Rotator
+		static FRotatord FromQuat(const FQuatd& Q)
+		{
+			const double SingularityTest = Q.Z * Q.X - Q.W * Q.Y;
+			const double YawY = 2.0 * (Q.W * Q.Z + Q.X * Q.Y);
+			const double YawX = 1.0 - 2.0 * (Q.Y * Q.Y + Q.Z * Q.Z);
+			const double SingularityThreshold = 0.4999995;
+
+			FRotatord Result;
+			Result.Yaw = std::atan2(YawY, YawX) * RadToDeg;
+			if (SingularityTest < -SingularityThreshold)
+			{
+				Result.Pitch = -90.0;
+				Result.Roll = NormalizeAxis(-Result.Yaw - 2.0 * std::atan2(Q.X, Q.W) * RadToDeg);
+			}
+			else if (SingularityTest > SingularityThreshold)
+			{
+				Result.Pitch = 90.0;
+				Result.Roll = NormalizeAxis(Result.Yaw - 2.0 * std::atan2(Q.X, Q.W) * RadToDeg);
+			}
+			else
+			{
+				Result.Pitch = std::asin(2.0 * SingularityTest) * RadToDeg;
+				Result.Roll = std::atan2(-2.0 * (Q.W * Q.X + Q.Y * Q.Z), 1.0 - 2.0 * (Q.X * Q.X + Q.Y * Q.Y)) * RadToDeg;
+			}
+			return Result;
+		}
+
+		// FRotationMatrix::MakeFromX(Direction).Rotator(), which has no roll
+		static FRotatord FromDirection(const FVec3d& Direction)
+		{
+			return FRotatord(
+				std::atan2(Direction.Z, std::sqrt(Direction.X * Direction.X + Direction.Y * Direction.Y)) * RadToDeg,
+				std::atan2(Direction.Y, Direction.X) * RadToDeg,
+				0.0);
+		}
+	};
+
+	// FMath::RInterpTo: each axis the short way round, a DeltaTime * InterpSpeed fraction of the way per call
+	inline FRotatord RInterpTo(const FRotatord& Current, const FRotatord& Target, double DeltaTime, double InterpSpeed)
+	{
+		if (DeltaTime == 0.0 || (Current.Pitch == Target.Pitch && Current.Yaw == Target.Yaw && Current.Roll == Target.Roll))
+		{
+			return Current;
+		}
+		if (InterpSpeed <= 0.0)
+		{
+			return Target;
+		}
+
+		const double Tolerance = 1.e-4;
+		const FRotatord Delta = FRotatord(Target.Pitch - Current.Pitch, Target.Yaw - Current.Yaw, Target.Roll - Current.Roll).GetNormalized();
+		if (std::fabs(Delta.Pitch) <= Tolerance && std::fabs(Delta.Yaw) <= Tolerance && std::fabs(Delta.Roll) <= Tolerance)
+		{
+			return Target;
+		}
+
+		const double Alpha = std::fmin(std::fmax(DeltaTime * InterpSpeed, 0.0), 1.0);
+		return FRotatord(Current.Pitch + Delta.Pitch * Alpha, Current.Yaw + Delta.Yaw * Alpha, Current.Roll + Delta.Roll * Alpha).GetNormalized();
+	}
+}
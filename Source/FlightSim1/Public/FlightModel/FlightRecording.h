@@ -0,0 +1,180 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// The flight recorder's file format. A recording is a file header followed by
+// self-contained chunks, appended as they fill: each chunk opens with a keyframe
+// (a full world snapshot) and carries a few seconds of frames as snapshot deltas
+// against the frame before, each frame followed by the shots, missile launches
+// and damage logged since the previous one. Closing the file appends an index of
+// every chunk's offset and time span with a trailer pointing at it, so a reader
+// over the whole file (e.g. memory-mapped) seeks to any time by decoding at most
+// one chunk. A file cut short by a crash has no trailer; the reader rebuilds the
+// index from the chunk headers and drops the incomplete chunk at the end.
+//
+// Nothing here touches files or threads: the writer appends bytes to a buffer the
+// caller flushes wherever it likes, and the reader works on a borrowed buffer.
+
+#include "FlightModel/FlightMath.h"
+#include "FlightModel/WorldSnapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FlightModel
+{
+	enum class ERecordedEventType : uint8_t
+	{
+		// Subject fired a round from Position along the unit vector Vector
+		Shot,
+		// Subject launched missile Other from Position at velocity Vector
+		MissileLaunch,
+		// Subject, at Position, took Value damage
+		Damage,
+		Count
+	};
+
+	struct FRecordedEvent
+	{
+		ERecordedEventType Type = ERecordedEventType::Shot;
+
+		// World time, s; stored to the millisecond relative to its frame
+		double Time = 0.0;
+
+		// Aircraft ids, as in FAircraftSnapshot, and a missile id for launches; -1 for none
+		int Subject = -1;
+		int Other = -1;
+
+		FVec3d Position;
+		FVec3d Vector;
+		float Value = 0.0f;
+	};
+
+	// Where a chunk lives in the file and what it covers
+	struct FRecordingChunkInfo
+	{
+		uint64_t Offset = 0;
+		uint32_t Size = 0;
+		uint32_t FirstFrame = 0;
+		uint32_t NumFrames = 0;
+		double StartTime = 0.0;
+		double EndTime = 0.0;
+	};
+
+	struct FRecordingSettings
+	{
+		// A chunk is closed at whichever comes first; together they bound the work of a seek
+		uint32_t MaxFramesPerChunk = 150;
+		uint32_t MaxChunkBytes = 1 << 20;
+	};
+
+	// Builds a recording frame by frame. Output only ever grows at the end, so the
+	// bytes appended to Out can go straight to disk.
+	class FFlightRecordWriter
+	{
+	public:
+		static constexpr uint32_t Magic = 0x43455246u;
+		static constexpr uint16_t Version = 1;
+
+		// Appends the file header; call once, first
+		void Begin(std::vector<uint8_t>& Out, const FRecordingSettings& InSettings = FRecordingSettings());
+
+		// Adds a frame to the open chunk, appending the chunk to Out once it fills. The snapshot must be
+		// quantized (FWorldSnapshotCodec::Quantize) and later than the frame before; events are the ones
+		// logged since that frame.
+		void AddFrame(const FWorldSnapshot& Snapshot, const FRecordedEvent* Events, size_t NumEvents, std::vector<uint8_t>& Out);
+
+		// Appends the open chunk, if any, so everything added so far is in the file
+		void FlushChunk(std::vector<uint8_t>& Out);
+
+		// Flushes and appends the chunk index and the trailer; nothing may be added after
+		void Finish(std::vector<uint8_t>& Out);
+
+		// Everything appended to Out, plus the open chunk
+		uint64_t GetBytesEncoded() const { return FileSize + Chunk.size(); }
+
+		uint32_t GetNumFrames() const { return NumFrames; }
+		const std::vector<FRecordingChunkInfo>& GetChunks() const { return Chunks; }
+
+	private:
+		FRecordingSettings Settings;
+		FWorldSnapshotCodec Codec;
+
+		// The frame the next delta is taken against
+		FWorldSnapshot Previous;
+
+		// The open chunk, header included
+		std::vector<uint8_t> Chunk;
+		FRecordingChunkInfo OpenChunk;
+
+		std::vector<FRecordingChunkInfo> Chunks;
+		uint64_t FileSize = 0;
+		uint32_t NumFrames = 0;
+	};
+
+	// Plays a recording back from a buffer holding the whole file, which it borrows
+	class FFlightRecordReader
+	{
+	public:
+		// Reads the header and the chunk index, rebuilding the index if the trailer is missing; false if this is not a recording
+		bool Open(const uint8_t* InData, size_t InSize);
+		void Close();
+
+		bool IsOpen() const { return Data != nullptr; }
+
+		// Whether the index had to be rebuilt, i.e. the recorder never finished the file
+		bool WasRecovered() const { return bRecovered; }
+
+		const std::vector<FRecordingChunkInfo>& GetChunks() const { return Chunks; }
+		uint32_t GetNumFrames() const;
+		double GetStartTime() const { return Chunks.empty() ? 0.0 : Chunks.front().StartTime; }
+		double GetEndTime() const { return Chunks.empty() ? 0.0 : Chunks.back().EndTime; }
+
+		// The chunk holding Time: the last one starting at or before it, or the first
+		int FindChunk(double Time) const;
+
+		// The chunk the current frame is in, or -1 before the first Seek or Next
+		int GetChunkIndex() const { return ChunkIndex; }
+
+		// Makes the current frame the last one at or before Time (the first frame if Time is earlier)
+		bool Seek(double Time);
+
+		// Moves on to the next frame; false at the end of the recording or on a corrupt chunk
+		bool Next();
+
+		// Time of the frame Next would move to, without decoding it
+		bool PeekNextTime(double& OutTime) const;
+
+		// The current frame and the events logged with it; empty until a Seek or Next succeeds
+		const FWorldSnapshot& GetFrame() const { return Current; }
+		const std::vector<FRecordedEvent>& GetEvents() const { return Events; }
+
+	private:
+		bool ReadIndex();
+		void RebuildIndex();
+
+		// Starts decoding Chunks[Index] from its keyframe
+		bool EnterChunk(int Index);
+
+		// Decodes the frame at Cursor into Current, against Current as it was
+		bool DecodeFrame();
+
+		const uint8_t* Data = nullptr;
+		size_t Size = 0;
+		bool bRecovered = false;
+		std::vector<FRecordingChunkInfo> Chunks;
+
+		FWorldSnapshotCodec Codec;
+		FWorldSnapshot Current;
+		FWorldSnapshot Decoding;
+		std::vector<FRecordedEvent> Events;
+
+		// Playback position: the chunk, the next frame's offset in the file and the frames left after the current one
+		int ChunkIndex = -1;
+		size_t Cursor = 0;
+		size_t ChunkEnd = 0;
+		uint32_t FramesLeft = 0;
+		bool bHasFrame = false;
+	};
+}
@@ -0,0 +1,174 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Batched missile flight: proportional navigation toward a target, a g-limit on
+// the commanded turn, a boost/coast motor with quadratic drag, and a proximity
+// fuze. Missiles are stored structure-of-arrays and stepped in one branch-free
+// loop, so a salvo costs a few nanoseconds per missile rather than a component
+// tick each.
+//
+// Collision is continuous: each step, every missile's segment is tested against
+// the aircraft proxy spheres near it, each moving at its own velocity, as an
+// analytic closest approach of the relative motion. Nothing tunnels at any frame
+// rate, and no physics sweep is needed.
+
+#include "FlightModel/Broadphase.h"
+#include "FlightModel/FlightMath.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace FlightModel
+{
+	struct FMissileParams
+	{
+		// Navigation constant N; 3-5 is typical, higher turns harder earlier
+		double NavigationConstant = 4.0;
+
+		// Turn limit, in g
+		double MaxG = 30.0;
+
+		// Along-track acceleration while the motor burns, cm/s^2, and for how long
+		double MotorAcceleration = 30000.0;
+		double BurnTime = 3.0;
+
+		// Drag deceleration is DragCoefficient * speed^2, 1/cm
+		double DragCoefficient = 2.0e-6;
+
+		// Detonates when the closest approach to the target this step is inside FuzeRadius (cm), after ArmTime
+		double FuzeRadius = 1000.0;
+		double ArmTime = 0.3;
+
+		double MaxFlightTime = 10.0;
+	};
+
+	enum class EMissileEvent : uint8_t
+	{
+		// Fuzed on the target; Location is the missile at closest approach
+		Detonated,
+		// Reached MaxFlightTime
+		Expired
+	};
+
+	struct FMissileEvent
+	{
+		int Index = -1;
+		EMissileEvent Type = EMissileEvent::Expired;
+		FVec3d Location;
+		double MissDistance = 0.0;
+
+		// Proxy the missile detonated on, or -1 for its target (or an expiry)
+		int Proxy = -1;
+	};
+
+	// Aircraft collision volumes for one step: a sphere moving at constant velocity
+	struct FMissileProxySet
+	{
+		std::vector<float> X;
+		std::vector<float> Y;
+		std::vector<float> Z;
+		std::vector<float> VelocityX;
+		std::vector<float> VelocityY;
+		std::vector<float> VelocityZ;
+		std::vector<float> Radius;
+
+		// Matched against each missile's owner, so a missile never hits the aircraft that launched it
+		std::vector<int> Owner;
+
+		void Reset();
+		void Reserve(int Num);
+		void Add(const FVec3d& Center, const FVec3d& Velocity, double InRadius, int InOwner);
+		int Num() const { return static_cast<int>(X.size()); }
+	};
+
+	class FMissileBatch
+	{
+	public:
+		void Reserve(int Capacity);
+
+		// Index of the new missile, always Num() - 1. Owner is the proxy owner id of the launcher, or -1.
+		int Add(const FVec3d& Position, const FVec3d& Velocity, const FMissileParams& Params, int Owner = -1);
+
+		// Moves the last missile into Index, like TArray::RemoveAtSwap
+		void RemoveAtSwap(int Index);
+
+		int Num() const { return static_cast<int>(PositionX.size()); }
+
+		// Where the target is now and how it is moving; guidance leads it from this each step
+		void SetTarget(int Index, const FVec3d& Position, const FVec3d& Velocity);
+
+		// Flies on without steering; the motor, drag and gravity still apply
+		void ClearTarget(int Index);
+
+		// Advances every missile by DeltaTime. Missiles that detonate or expire are reported in
+		// OutEvents in ascending index order but stay in the batch; remove them from the back.
+		void Step(double DeltaTime, const FVec3d& Gravity, std::vector<FMissileEvent>& OutEvents);
+
+		// As above, and detonates missiles whose path this step comes within a proxy's radius, or its
+		// radius plus the fuze radius once armed. The proxy reached earliest in the step wins, target included.
+		void Step(double DeltaTime, const FVec3d& Gravity, const FMissileProxySet& Proxies, std::vector<FMissileEvent>& OutEvents);
+
+		FVec3d GetPosition(int Index) const { return FVec3d(PositionX[Index], PositionY[Index], PositionZ[Index]); }
+		FVec3d GetVelocity(int Index) const { return FVec3d(VelocityX[Index], VelocityY[Index], VelocityZ[Index]); }
+		float GetAge(int Index) const { return Age[Index]; }
+		int GetOwner(int Index) const { return Owner[Index]; }
+
+		// Puts a missile back where a snapshot had it; its parameters and target are left alone
+		void SetState(int Index, const FVec3d& Position, const FVec3d& Velocity, float InAge);
+
+		// Where the missile was before the last Step
+		FVec3d GetStepStart(int Index) const { return FVec3d(StepStartX[Index], StepStartY[Index], StepStartZ[Index]); }
+
+		// Whether any missile is within Radius of Point; one pass over the positions
+		bool AnyWithin(const FVec3d& Point, double Radius) const;
+
+	private:
+		// Detonates missiles on the earliest proxy contact of the step just taken
+		void SweepProxies(float Dt, const FMissileProxySet& Proxies);
+
+		// State
+		std::vector<float> PositionX;
+		std::vector<float> PositionY;
+		std::vector<float> PositionZ;
+		std::vector<float> VelocityX;
+		std::vector<float> VelocityY;
+		std::vector<float> VelocityZ;
+		std::vector<float> Age;
+
+		// Target as of the last SetTarget; HasTarget is 1 or 0 so it can scale the steering
+		std::vector<float> TargetX;
+		std::vector<float> TargetY;
+		std::vector<float> TargetZ;
+		std::vector<float> TargetVelocityX;
+		std::vector<float> TargetVelocityY;
+		std::vector<float> TargetVelocityZ;
+		std::vector<float> HasTarget;
+
+		// Parameters
+		std::vector<float> NavigationConstant;
+		std::vector<float> MaxAcceleration;
+		std::vector<float> MotorAcceleration;
+		std::vector<float> BurnTime;
+		std::vector<float> DragCoefficient;
+		std::vector<float> FuzeRadius;
+		std::vector<float> ArmTime;
+		std::vector<float> MaxFlightTime;
+		std::vector<int> Owner;
+
+		// Per-step results: 0 flying, 1 detonated, 2 expired, with the closest approach fraction and distance
+		std::vector<uint8_t> Outcome;
+		std::vector<float> ClosestFraction;
+		std::vector<float> MissDistance;
+		std::vector<float> StepStartX;
+		std::vector<float> StepStartY;
+		std::vector<float> StepStartZ;
+		std::vector<int> HitProxy;
+
+		// Proxy centres halfway through the step, filed in a grid so each missile only tests those near its path
+		std::vector<float> ProxyMidX;
+		std::vector<float> ProxyMidY;
+		std::vector<float> ProxyMidZ;
+		FSphereGrid ProxyGrid;
+	};
+}
@@ -0,0 +1,114 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// Compact binary snapshots of a dogfight: every aircraft's rigid-body state,
+// controls, health, AI state and lock, and every missile in flight. Fields are
+// quantized to fixed steps and written as variable-length integers, either
+// outright or as the difference from a baseline snapshot matched entity by entity
+// (positions relative to where the baseline's velocity would have carried them),
+// so a frame-to-frame delta of a 200-aircraft fight is a few bytes per aircraft.
+// Every buffer starts with a magic number and a format version; anything else, a
+// truncated buffer or a delta decoded without its baseline is rejected.
+
+#include "FlightModel/FlightMath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace FlightModel
+{
+	struct FAircraftSnapshot
+	{
+		// Stable id of the aircraft; the game uses its spatial index handle
+		int Id = -1;
+
+		// Which use of a recycled Id this is; the game uses the handle's generation, so a snapshot
+		// never lands on another aircraft that has taken the handle over since
+		uint32_t Generation = 0;
+
+		// cm, cm/s and rad/s
+		FVec3d Position;
+		FQuatd Attitude;
+		FVec3d LinearVelocity;
+		FVec3d AngularVelocity;
+
+		// 0 to 1, and the stick and rudder, -1 to 1
+		float Throttle = 0.0f;
+		float Pitch = 0.0f;
+		float Roll = 0.0f;
+		float Yaw = 0.0f;
+
+		float Health = 0.0f;
+
+		// Seconds since the guns last fired, up to a minute
+		float TimeSinceFire = 0.0f;
+		bool bFiring = false;
+
+		// Game-defined AI state, and how long the current evasion has left, s
+		uint8_t AIState = 0;
+		float EvasionTimeLeft = 0.0f;
+
+		// Id of the aircraft being tracked, or -1, with how far the lock has come, 0 to 1
+		int LockTarget = -1;
+		float LockProgress = 0.0f;
+		bool bLocked = false;
+	};
+
+	struct FMissileSnapshot
+	{
+		int Id = -1;
+
+		// As for aircraft: the guidance handle's generation
+		uint32_t Generation = 0;
+
+		// Aircraft ids of the launcher and the target, or -1
+		int Owner = -1;
+		int Target = -1;
+
+		FVec3d Position;
+		FVec3d Velocity;
+		float Age = 0.0f;
+	};
+
+	struct FWorldSnapshot
+	{
+		uint32_t Frame = 0;
+
+		// World time, s; stored exactly
+		double Time = 0.0;
+
+		std::vector<FAircraftSnapshot> Aircraft;
+		std::vector<FMissileSnapshot> Missiles;
+
+		// Empties both lists but keeps their storage
+		void Reset();
+	};
+
+	// Writes and reads snapshots. Holds only lookup scratch, sized by the largest id
+	// seen, so once warm neither direction allocates beyond growing the output.
+	class FWorldSnapshotCodec
+	{
+	public:
+		static constexpr uint32_t Magic = 0x53574653u;
+		static constexpr uint16_t Version = 2;
+
+		// Appends the snapshot to Out. With a baseline, entities the baseline also has are written
+		// as differences from it. The reader must hold that exact baseline: a snapshot it decoded,
+		// or one passed through Quantize before either side used it.
+		void Encode(const FWorldSnapshot& Snapshot, const FWorldSnapshot* Baseline, std::vector<uint8_t>& Out);
+
+		// Reads one snapshot from the front of Data into Out (which must not be Baseline). Fails on a
+		// foreign or newer buffer, a truncated one, or a delta whose baseline frame is not Baseline's.
+		bool Decode(const uint8_t* Data, size_t Size, const FWorldSnapshot* Baseline, FWorldSnapshot& Out, size_t* OutBytesRead = nullptr);
+
+		// Snaps every field to the value it decodes to, so a live snapshot and a decoded copy of it agree exactly
+		static void Quantize(FWorldSnapshot& Snapshot);
+
+	private:
+		// Baseline index by id, -1 elsewhere; filled and cleared again around each call
+		std::vector<int> BaselineAircraft;
+		std::vector<int> BaselineMissiles;
+	};
+}
@@ -0,0 +1,134 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlightModel/FlightDynamics.h"
+#include "FlightPhysicsSubsystem.generated.h"
+
+class UPrimitiveComponent;
+class FFlightAsyncCallback;
+
+/**
+ * Structure-of-arrays storage for every registered aircraft, plus the vectorized
+ * force kernel. Each array is padded to a multiple of four so the kernel can
+ * always process whole SIMD lanes.
+ */
+struct FLIGHTSIM1_API FAeroBatch
+{
+	using FAlignedFloatArray = TArray<float, TAlignedHeapAllocator<16>>;
+
+	// --- Inputs ---
+	FAlignedFloatArray VelX, VelY, VelZ;
+	FAlignedFloatArray FwdX, FwdY, FwdZ;
+	FAlignedFloatArray RightX, RightY, RightZ;
+	FAlignedFloatArray UpX, UpY, UpZ;
+	FAlignedFloatArray SpeedScale;
+	FAlignedFloatArray Lift;	// LiftCoefficient, zeroed when lift is disabled
+	FAlignedFloatArray Drag;
+	FAlignedFloatArray LiftMode;	// 1 = velocity normal, 0 = body up
+	FAlignedFloatArray Thrust;
+	FAlignedFloatArray Pitch, Roll, Yaw;
+
+	// --- Outputs ---
+	FAlignedFloatArray ForceX, ForceY, ForceZ;
+	FAlignedFloatArray TorqueX, TorqueY, TorqueZ;
+	FAlignedFloatArray Speed;
+
+	int32 Num() const { return NumAircraft; }
+
+	// Resizes every array to hold NewNum aircraft (rounded up to whole lanes), zeroing the padding
+	void SetNum(int32 NewNum);
+
+	// Computes ForceXYZ/TorqueXYZ/Speed for every aircraft in one vectorized pass
+	void Run();
+
+	// Same outputs computed one aircraft at a time by FlightModel::ComputeLoads, the reference the kernel must match
+	void RunScalar();
+
+private:
+	int32 NumAircraft = 0;
+};
+
+// Marshals pilot inputs to the physics thread in TG_PrePhysics, after every registered pawn has ticked
+USTRUCT()
+struct FFlightPhysicsTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UFlightPhysicsSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FFlightPhysicsTickFunction> : public TStructOpsTypeTraitsBase2<FFlightPhysicsTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Owns the flight state of every aircraft in the world. Thrust, lift, drag and control
+ * torques are applied for all of them in a single batched pass inside a Chaos sim
+ * callback, once per physics step, so with async physics enabled the flight model runs
+ * at the fixed physics rate off the game thread. Pawns register their physics body at
+ * BeginPlay, push control inputs from Tick and read back speed/altitude for the HUD.
+ */
+UCLASS()
+class FLIGHTSIM1_API UFlightPhysicsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Adds an aircraft to the batch. Returns a handle that stays valid until UnregisterAircraft.
+	int32 RegisterAircraft(AActor* Owner, UPrimitiveComponent* Body, const FlightModel::FAirframe& Airframe);
+	void UnregisterAircraft(int32 Handle);
+
+	void SetAirframe(int32 Handle, const FlightModel::FAirframe& Airframe);
+	void SetControls(int32 Handle, const FlightModel::FControls& Controls);
+
+	// Speed (cm/s) and altitude (cm) from the most recent physics step, 0 for unknown handles
+	float GetSpeed(int32 Handle) const;
+	float GetAltitude(int32 Handle) const;
+
+	int32 GetNumAircraft() const { return Bodies.Num(); }
+
+	// Sends this frame's airframes and controls to the physics thread and collects its results
+	void MarshalToPhysics();
+
+private:
+	struct FAircraftSlot
+	{
+		FlightModel::FAirframe Airframe;
+		FlightModel::FControls Controls;
+
+		// Marshalled back from the physics thread
+		float Speed = 0.0f;
+		float Altitude = 0.0f;
+	};
+
+	// Dense per-slot data, kept parallel to the batch arrays
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Bodies;
+	TArray<TWeakObjectPtr<AActor>> Owners;
+	TArray<FAircraftSlot> Slots;
+	TArray<int32> SlotToHandle;
+
+	// Sparse handle -> dense slot map so removals can swap without invalidating handles
+	TArray<int32> HandleToSlot;
+	TArray<int32> FreeHandles;
+
+	FFlightPhysicsTickFunction TickFunction;
+
+	// Owned by the physics solver, created in OnWorldBeginPlay
+	FFlightAsyncCallback* AsyncCallback = nullptr;
+};
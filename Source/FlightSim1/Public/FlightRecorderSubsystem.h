@@ -0,0 +1,173 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlightModel/FlightRecording.h"
+#include "FlightRecorderSubsystem.generated.h"
+
+class FFlightRecorderThread;
+class UAircraftSpatialSubsystem;
+class UDamageLedgerSubsystem;
+class UWorldSnapshotSubsystem;
+
+// One sampled frame on its way to the writer thread; recycled through a fixed set
+struct FFlightRecorderFrame
+{
+	FlightModel::FWorldSnapshot Snapshot;
+	std::vector<FlightModel::FRecordedEvent> Events;
+};
+
+USTRUCT(BlueprintType)
+struct FFlightRecorderStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	bool bRecording = false;
+
+	// Frames handed to the writer thread since recording started
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	int32 NumFrames = 0;
+
+	// Samples skipped because the writer was behind or the bandwidth budget was spent; their events go with the next frame
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	int32 NumSkipped = 0;
+
+	// Events thrown away because too many piled up between frames
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	int32 NumEventsDropped = 0;
+
+	// Encoded so far, and the average rate since recording started
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	int64 BytesEncoded = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	float KilobytesPerSecond = 0.0f;
+
+	// Game thread time of the last sample: the capture and the hand-off
+	UPROPERTY(BlueprintReadOnly, Category = "Recorder")
+	float SampleMilliseconds = 0.0f;
+};
+
+// Samples the world in TG_PostUpdateWork, after the damage ledger has resolved the frame
+USTRUCT()
+struct FFlightRecorderTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UFlightRecorderSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FFlightRecorderTickFunction> : public TStructOpsTypeTraitsBase2<FFlightRecorderTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Flight recorder for after-action review. At FlightSim.Recorder.Rate samples a
+ * second the game thread captures the world through UWorldSnapshotSubsystem, which
+ * brings every aircraft's pose and controls, and hands it with the shots, missile
+ * launches and damage logged since the last sample to a writer thread. The writer
+ * encodes it into a FlightModel::FFlightRecordWriter chunk (a keyframe, then deltas)
+ * and appends each chunk to the file as it fills; stopping writes the chunk index.
+ *
+ * The game thread never waits on the writer or the disk: frames travel through a
+ * fixed set of buffers, and a sample is skipped when none is free, or when the
+ * recording is ahead of FlightSim.Recorder.MaxKBps, which bounds disk bandwidth
+ * however large the fight gets. UFlightReplaySubsystem plays the files back.
+ */
+UCLASS()
+class FLIGHTSIM1_API UFlightRecorderSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Starts a new recording; an empty path picks a fresh file under Saved/Recordings. False if the file cannot be created.
+	bool StartRecording(const FString& InPath = FString());
+
+	// Hands over the last frame and waits for the writer to finish the file
+	void StopRecording();
+
+	bool IsRecording() const { return bRecording; }
+	const FString& GetPath() const { return Path; }
+
+	// Logged with the next sampled frame. Handles are spatial index handles, missiles' their guidance handles.
+	void RecordShot(int32 ShooterHandle, const FVector& Origin, const FVector& Direction)
+	{
+		if (bRecording)
+		{
+			AddEvent(FlightModel::ERecordedEventType::Shot, ShooterHandle, INDEX_NONE, Origin, Direction, 0.0f);
+		}
+	}
+
+	void RecordMissileLaunch(int32 MissileHandle, int32 LauncherHandle, const FVector& Location, const FVector& Velocity)
+	{
+		if (bRecording)
+		{
+			AddEvent(FlightModel::ERecordedEventType::MissileLaunch, LauncherHandle, MissileHandle, Location, Velocity, 0.0f);
+		}
+	}
+
+	void RecordDamage(int32 VictimHandle, float Damage);
+
+	// Samples the world if one is due
+	void Update(float DeltaTime);
+
+	UFUNCTION(BlueprintPure, Category = "Recorder")
+	FFlightRecorderStats GetStats() const { return Stats; }
+
+private:
+	void AddEvent(FlightModel::ERecordedEventType Type, int32 Subject, int32 Other, const FVector& Position, const FVector& Vector, float Value);
+
+	// Gives every frame the writer has finished with back to FreeFrames
+	void ReclaimFrames();
+
+	UPROPERTY()
+	UWorldSnapshotSubsystem* WorldSnapshot;
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	UDamageLedgerSubsystem* DamageLedger;
+
+	bool bRecording = false;
+	FString Path;
+
+	// Every frame buffer, owned here; the queues only pass pointers
+	TArray<TUniquePtr<FFlightRecorderFrame>> Frames;
+	TArray<FFlightRecorderFrame*> FreeFrames;
+
+	// Events since the last sample, swapped into the frame that carries them
+	std::vector<FlightModel::FRecordedEvent> PendingEvents;
+
+	// Owns the file while recording; created by StartRecording and deleted by StopRecording
+	FFlightRecorderThread* Writer = nullptr;
+
+	float TimeSinceSample = 0.0f;
+	double RecordingStartTime = 0.0;
+
+	// Bytes the bandwidth budget still allows; the writer's output is charged against it as it comes
+	double BandwidthCredit = 0.0;
+	int64 BytesCharged = 0;
+
+	FFlightRecorderStats Stats;
+
+	FFlightRecorderTickFunction TickFunction;
+};
@@ -0,0 +1,139 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Async/MappedFileHandle.h"
+#include "FlightModel/FlightRecording.h"
+#include "FlightReplaySubsystem.generated.h"
+
+class UWorldSnapshotSubsystem;
+
+USTRUCT(BlueprintType)
+struct FFlightReplayStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	bool bOpen = false;
+
+	// The file has no chunk index because the recorder never finished it; every complete chunk is still played
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	bool bRecovered = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	int32 NumChunks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	int32 NumFrames = 0;
+
+	// Length of the recording and where playback is in it, s
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	float Duration = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	float PlaybackSeconds = 0.0f;
+
+	// Decoding from the chunk's keyframe to the frame sought
+	UPROPERTY(BlueprintReadOnly, Category = "Replay")
+	float LastSeekMilliseconds = 0.0f;
+};
+
+// Advances playback in TG_PostUpdateWork, paused or not, so a paused game can still be scrubbed
+USTRUCT()
+struct FFlightReplayTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UFlightReplaySubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FFlightReplayTickFunction> : public TStructOpsTypeTraitsBase2<FFlightReplayTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Plays back a UFlightRecorderSubsystem recording. The file is memory-mapped, not
+ * read: opening it only reads the chunk index from the end, and a seek decodes the
+ * one chunk holding the time, from its keyframe, so scrubbing through hours of
+ * recording costs the same as through a minute. Playing on decodes frame by frame
+ * and falls back to a seek when it would otherwise have to catch up a long way.
+ *
+ * Each frame is drawn over the world (FlightSim.Replay.Draw): every aircraft's pose,
+ * the missiles and the shots, launches and hits logged with it. With
+ * FlightSim.Replay.Apply it is also restored into the world through
+ * UWorldSnapshotSubsystem, which matches aircraft by handle and so only makes sense
+ * for a recording of the session being played.
+ */
+UCLASS()
+class FLIGHTSIM1_API UFlightReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Maps the recording and shows its first frame, paused; false if it is missing or not a recording
+	bool Open(const FString& Path);
+	void Close();
+
+	bool IsOpen() const { return Reader.IsOpen(); }
+
+	// Seconds from the start of the recording, clamped to it
+	void Seek(double Seconds);
+
+	// Plays at Rate times game speed; 0 pauses, negative plays backwards
+	void SetRate(float InRate) { Rate = InRate; }
+	float GetRate() const { return Rate; }
+
+	// The frame being shown and the events logged with it
+	const FlightModel::FWorldSnapshot& GetFrame() const { return Reader.GetFrame(); }
+	const FlightModel::FFlightRecordReader& GetReader() const { return Reader; }
+
+	// Moves playback on and draws the frame
+	void Update(float DeltaTime);
+
+	UFUNCTION(BlueprintPure, Category = "Replay")
+	FFlightReplayStats GetStats() const { return Stats; }
+
+private:
+	// A new frame is being shown: draw its events and, if asked, restore it
+	void OnFrameChanged();
+
+	// The aircraft and missiles, for this frame only
+	void DrawFrame() const;
+
+	// Shots, launches and hits, left up briefly so they can be seen at speed
+	void DrawEvents() const;
+
+	UPROPERTY()
+	UWorldSnapshotSubsystem* WorldSnapshot;
+
+	// The region is declared last so it is unmapped before its file is closed
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	FlightModel::FFlightRecordReader Reader;
+
+	// World time in the recording
+	double PlaybackTime = 0.0;
+	float Rate = 0.0f;
+
+	FFlightReplayStats Stats;
+
+	FFlightReplayTickFunction TickFunction;
+};
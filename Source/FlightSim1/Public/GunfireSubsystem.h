@@ -0,0 +1,194 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlightModel/Broadphase.h"
+#include "FlightModel/Ballistics.h"
+#include "GunfireSubsystem.generated.h"
+
+class UAircraftSpatialSubsystem;
+class UDamageLedgerSubsystem;
+class UFlightRecorderSubsystem;
+
+// One round from a gun: resolved as hitscan with the rest of the frame's gunfire, or in
+// ballistic mode (FlightSim.Gunfire.Ballistic) launched into the round pool
+struct FGunShot
+{
+	FVector Origin = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+	float Range = 0.0f;
+	float Damage = 0.0f;
+
+	// The shooter is never hit by its own rounds
+	TWeakObjectPtr<AActor> Shooter;
+	int32 ShooterHandle = INDEX_NONE;
+};
+
+struct FGunHit
+{
+	// Index of the hitscan shot, or INDEX_NONE for a ballistic round
+	int32 ShotIndex = INDEX_NONE;
+	TWeakObjectPtr<AActor> Victim;
+	// The victim's spatial index handle, or INDEX_NONE if what was hit is not an indexed aircraft
+	int32 VictimHandle = INDEX_NONE;
+	FVector Location = FVector::ZeroVector;
+	float Damage = 0.0f;
+};
+
+// What the resolver did in the most recent frame
+USTRUCT(BlueprintType)
+struct FGunfireStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 NumShots = 0;
+
+	// Shots whose ray touched an aircraft's bounding sphere; only these were traced
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 NumTraces = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 NumHits = 0;
+
+	// Aircraft that took damage; the damage ledger tells each once, with the sum
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 NumVictims = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	float ResolveMilliseconds = 0.0f;
+
+	// Ballistic rounds in flight after this frame's step
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 NumLiveRounds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 RoundsFired = 0;
+
+	// Rounds not fired because the pool was full
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 RoundsDropped = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 RoundHits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	int32 RoundTerrainImpacts = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Gunfire")
+	float RoundStepMilliseconds = 0.0f;
+};
+
+// Resolves the frame's gunfire and steps the rounds in flight in TG_PostPhysics, against the same aircraft positions the shots were fired from
+USTRUCT()
+struct FGunfireTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UGunfireSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGunfireTickFunction> : public TStructOpsTypeTraitsBase2<FGunfireTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Batched hitscan for every gun in the world. Weapons queue shots instead of tracing;
+ * once per frame all queued rays are tested together against every aircraft's bounding
+ * sphere (FlightModel::FRayBroadphase, a vectorized pass over the spatial index's dense
+ * arrays). Only rays that touch a sphere get a physics trace, which settles the exact
+ * hit and any terrain in between; a ray that touches no sphere cannot hit an aircraft.
+ * Damage is then summed per victim and applied in one pass.
+ *
+ * In ballistic mode a shot becomes a round in a fixed-size FlightModel::FBallisticPool
+ * instead: muzzle velocity plus the shooter's own, gravity drop and time of flight.
+ * Each frame every live round's swept segment is tested against the aircraft spheres,
+ * so nothing tunnels through at 1 km/s. Terrain is settled once per round at launch:
+ * with no drag its arc is fixed, so a few async traces along it (as chords) give the
+ * time it would reach the ground. Rounds are never actors and never allocate.
+ */
+UCLASS()
+class FLIGHTSIM1_API UGunfireSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Resolved with the rest of this frame's shots, or launched as a round in ballistic mode
+	void QueueShot(const FGunShot& Shot);
+
+	// Broadphase plus confirming traces; no side effects, so it can be timed on its own
+	void ResolveShots(TArrayView<const FGunShot> Shots, TArray<FGunHit>& OutHits);
+
+	// Queues each hit's damage with the damage ledger, which resolves it later in the frame
+	void ApplyDamage(TArrayView<const FGunHit> Hits);
+
+	// Resolves everything queued this frame, steps the rounds in flight and applies the damage
+	void UpdateGunfire(float DeltaTime);
+
+	// Launches one ballistic round; false if the pool is full
+	bool FireRound(const FGunShot& Shot);
+
+	// Advances every round in flight and appends the aircraft they hit
+	void StepRounds(float DeltaTime, TArray<FGunHit>& OutHits);
+
+	// Drops the queued shots and every round in flight
+	void ClearInFlight();
+
+	UFUNCTION(BlueprintPure, Category = "Gunfire")
+	FGunfireStats GetStats() const { return Stats; }
+
+private:
+	// Every aircraft's bounding sphere from the spatial index, with its handle
+	void BuildSpheres();
+
+	void OnTerrainTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	UDamageLedgerSubsystem* DamageLedger;
+
+	// Logs every shot while recording
+	UPROPERTY()
+	UFlightRecorderSubsystem* Recorder;
+
+	TArray<FGunShot> QueuedShots;
+	TArray<FGunHit> Hits;
+
+	// Broadphase working set, kept between frames so nothing is reallocated
+	FlightModel::FSphereSet Spheres;
+	FlightModel::FRayBroadphase Broadphase;
+	TArray<FlightModel::FRay> Rays;
+	TArray<FlightModel::FRayHit> RayHits;
+	TArray<int32> VictimHandles;
+	TArray<int32> SphereHandles;
+
+	// Ballistic rounds, sized once from FlightSim.Gunfire.MaxRounds
+	FlightModel::FBallisticPool Rounds;
+	std::vector<FlightModel::FBallisticImpact> RoundImpacts;
+	int32 RoundsFiredThisFrame = 0;
+	int32 RoundsDroppedThisFrame = 0;
+	FTraceDelegate TerrainTraceDelegate;
+
+	FGunfireStats Stats;
+
+	FGunfireTickFunction TickFunction;
+};
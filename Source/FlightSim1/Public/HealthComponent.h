@@ -11,6 +11,7 @@
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDamagedSignature, AActor*, DamagedActor, float, Damage);
 
 class UParticleSystem;
+class UDamageLedgerSubsystem;
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class FLIGHTSIM1_API UHealthComponent : public UActorComponent
@@ -28,15 +29,40 @@ public:
 protected:
     // Called when the game starts
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
-    // Function to be called when this component takes damage
+    // Function to be called when this component takes damage.
+    // Once registered with the damage ledger this only queues it; OnDamaged fires when the ledger resolves the frame.
     UFUNCTION(BlueprintCallable, Category = "Health")
     void TakeDamage(float DamageAmount);
 
+    // Hands our hit points to the world's damage ledger under the owner's spatial index handle
+    void RegisterWithLedger(int32 AircraftHandle);
+    void UnregisterFromLedger();
+
+    // Sets the hit points outright, with no OnDamaged; the ledger (if registered) is updated and pending damage dropped
+    void SetHealth(float NewHealth);
+
+    // Back to full health, e.g. for an aircraft coming out of a pool
+    void ResetHealth() { SetHealth(MaxHealth); }
+
+    // Everything taken since the last resolve, summed; broadcasts OnDamaged once and dies at zero
+    void ApplyResolvedDamage(float DamageAmount, float NewHealth);
+
     UFUNCTION(BlueprintPure, Category = "Health")
     bool IsDead() const;
 
+    UFUNCTION(BlueprintPure, Category = "Health")
+    float GetCurrentHealth() const { return CurrentHealth; }
+
+    UFUNCTION(BlueprintPure, Category = "Health")
+    float GetMaxHealth() const { return MaxHealth; }
+
+    // Destroy (or, if pooled, park) the owner on death; off for aircraft that are reset in place, like the player's
+    UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Health")
+    bool bDestroyOwnerOnDeath;
+
 protected:
     // The maximum health of the actor
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Health")
@@ -53,4 +79,9 @@ protected:
 private:
     // Function to handle the death of the actor
     void Die();
+
+    UPROPERTY()
+    UDamageLedgerSubsystem* DamageLedger;
+
+    int32 LedgerHandle;
 };
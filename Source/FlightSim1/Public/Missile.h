@@ -4,16 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "ActorPoolSubsystem.h"
+#include "MissileGuidanceSubsystem.h"
 #include "Missile.generated.h"
 
 class UStaticMeshComponent;
-class UProjectileMovementComponent;
 class UParticleSystemComponent;
 class UParticleSystem;
 class AActor;
 
+// Launched from UActorPoolSubsystem and handed back to it on impact or timeout, so a salvo reuses parked missiles.
+// Does not tick: UMissileGuidanceSubsystem flies it with every other missile and moves the actor to the result.
 UCLASS()
-class FLIGHTSIM1_API AMissile : public AActor
+class FLIGHTSIM1_API AMissile : public AActor, public IPooledActor
 {
 	GENERATED_BODY()
 
@@ -26,20 +29,29 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Function to set the target for the missile to home in on; TargetHandle is its spatial index handle, if known
+	void SetTarget(AActor* NewTarget, int32 TargetHandle = INDEX_NONE);
 
-	// Function to set the target for the missile to home in on
-	void SetTarget(AActor* NewTarget);
+	// Guidance fuzed or hit at Location: damages the victim (if any), explodes and goes back to the pool.
+	// VictimHandle is the victim's spatial index handle when known; the damage then goes straight to the ledger.
+	void Detonate(AActor* Victim, const FVector& Location, int32 VictimHandle = INDEX_NONE);
+
+	// Back to the pool, or destroyed if there is none
+	void ReturnToPool();
+
+	// IPooledActor
+	virtual void OnSpawnedForPool() override;
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReturnedToPool() override;
+
+	// False while parked in the pool
+	bool IsInFlight() const { return bInFlight; }
 
 protected:
 	// --- Components ---
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UStaticMeshComponent* MissileMesh;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
-	UProjectileMovementComponent* ProjectileMovement;
-
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UParticleSystemComponent* TrailEffect;
 
@@ -50,12 +62,27 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Damage")
 	UParticleSystem* ExplosionEffect;
 
+	// Seconds of flight before the missile gives up and goes back to the pool
+	UPROPERTY(EditDefaultsOnly, Category = "Flight")
+	float LifeSeconds;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Flight")
+	FMissileGuidanceParams Guidance;
+
 private:
 	// This will hold the actor the missile is currently homing towards
 	UPROPERTY()
 	AActor* TargetActor;
 
-	// Function to handle what happens when the missile hits something
-	UFUNCTION()
-	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+	// Launch and shutdown, shared by the pool callbacks and missiles spawned outside it
+	void BeginFlight();
+	void EndFlight();
+
+	bool bInFlight;
+
+	// Spawned by the actor pool, which starts the flight on acquire instead of BeginPlay
+	bool bSpawnedForPool;
+
+	// Handle in UMissileGuidanceSubsystem while in flight
+	int32 GuidanceHandle;
 };
@@ -0,0 +1,223 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlightModel/MissileGuidance.h"
+#include "FlightModel/WorldSnapshot.h"
+#include "MissileGuidanceSubsystem.generated.h"
+
+class AMissile;
+class UAircraftSpatialSubsystem;
+class UFlightRecorderSubsystem;
+
+// How one missile type flies; see FlightModel::FMissileParams
+USTRUCT(BlueprintType)
+struct FMissileGuidanceParams
+{
+	GENERATED_BODY()
+
+	// Speed added to the launching aircraft's own along the launch direction, cm/s
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float LaunchSpeed = 40000.0f;
+
+	// Proportional navigation constant; 3-5 is typical, higher turns harder earlier
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float NavigationConstant = 4.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float MaxG = 30.0f;
+
+	// Along-track acceleration while the motor burns, cm/s^2
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float MotorAcceleration = 30000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float BurnTime = 3.0f;
+
+	// Drag deceleration is DragCoefficient * speed^2
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float DragCoefficient = 2.0e-6f;
+
+	// Detonates when it passes within this distance of its target or any other aircraft's proxy, once armed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float FuzeRadius = 1000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Guidance")
+	float ArmTime = 0.3f;
+
+	FlightModel::FMissileParams ToFlightModel(float MaxFlightTime) const;
+};
+
+// What guidance did in the most recent frame
+USTRUCT(BlueprintType)
+struct FMissileGuidanceStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	int32 NumMissiles = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	int32 NumDetonated = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	int32 NumExpired = 0;
+
+	// Detonations on an aircraft other than the missile's target
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	int32 NumProxyHits = 0;
+
+	// Detonations on terrain found by the previous frame's traces
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	int32 NumTerrainImpacts = 0;
+
+	// Gathering targets and proxies and stepping the batch, collision included
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	float GuidanceMilliseconds = 0.0f;
+
+	// Moving the missile actors to where guidance put them
+	UPROPERTY(BlueprintReadOnly, Category = "Missiles")
+	float SyncMilliseconds = 0.0f;
+};
+
+// Steps every missile in TG_PrePhysics, against the aircraft as the spatial index last saw them
+USTRUCT()
+struct FMissileGuidanceTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UMissileGuidanceSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMissileGuidanceTickFunction> : public TStructOpsTypeTraitsBase2<FMissileGuidanceTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Flies every missile in the world in one pass. Missiles register at launch and
+ * are stepped together in a FlightModel::FMissileBatch: proportional navigation
+ * against the target's position and velocity from the spatial index, a g-limit,
+ * a boost/coast motor and a proximity fuze swept over the whole step. The missile
+ * actors no longer tick; they are only moved to the batch's result, and told to
+ * detonate or go back to the pool when guidance says so.
+ *
+ * Aircraft hits are continuous collision against every aircraft's bounding sphere
+ * from the spatial index (its proxy), so a missile cannot tunnel through one at a
+ * low frame rate and no physics sweep is made against aircraft meshes. Missile
+ * actors do not collide at all; terrain is found by one async line trace per
+ * missile along each step, and the missile detonates where it hit on the next frame.
+ */
+UCLASS()
+class FLIGHTSIM1_API UMissileGuidanceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Adds a missile to the batch; returns its handle. OwnerHandle is the launcher's spatial index handle, which it never hits.
+	int32 RegisterMissile(AMissile* Missile, const FVector& Location, const FVector& Velocity, const FlightModel::FMissileParams& Params,
+		int32 OwnerHandle = INDEX_NONE);
+	void UnregisterMissile(int32 Handle);
+
+	// The target to home on; TargetHandle is its spatial index handle when known, which saves reading the actor
+	void SetTarget(int32 Handle, AActor* Target, int32 TargetHandle = INDEX_NONE);
+
+	// Gathers targets, steps the batch, handles detonations and moves the actors
+	void UpdateMissiles(float DeltaTime);
+
+	// Sends every missile in flight back to the pool without detonating it
+	void ReturnAllMissiles();
+
+	// Appends every missile in flight, by handle, with its launcher and target as spatial index handles
+	void CaptureSnapshot(std::vector<FlightModel::FMissileSnapshot>& OutMissiles) const;
+
+	// Puts the snapshot's missiles back as they were and returns every other one to the pool. Missiles that
+	// have finished since, including those whose handle a later launch has taken, are not brought back;
+	// returns how many of those there were.
+	int32 RestoreSnapshot(const std::vector<FlightModel::FMissileSnapshot>& InMissiles);
+
+	UFUNCTION(BlueprintPure, Category = "Missiles")
+	FMissileGuidanceStats GetStats() const { return Stats; }
+
+	bool IsValidHandle(int32 Handle) const { return HandleToSlot.IsValidIndex(Handle) && HandleToSlot[Handle] != INDEX_NONE; }
+
+	// Bumped each time a freed handle is given to a new missile
+	uint16 GetGeneration(int32 Handle) const { return HandleGenerations.IsValidIndex(Handle) ? HandleGenerations[Handle] : 0; }
+
+	// Whether a missile in flight is within Radius of Location, as of the last guidance step. Pooled missiles are not in the batch.
+	bool IsAnyMissileWithin(const FVector& Location, float Radius) const { return Batch.AnyWithin(FlightModel::FVec3d(Location.X, Location.Y, Location.Z), Radius); }
+
+	// Since the world started, by the launcher's team as it was at launch: missiles launched, and those that detonated on an aircraft
+	int32 GetNumLaunched(uint32 TeamMask) const { return SumTeams(TeamLaunches, TeamMask); }
+	int32 GetNumHits(uint32 TeamMask) const { return SumTeams(TeamHits, TeamMask); }
+
+private:
+	static int32 SumTeams(const int32 (&PerTeam)[32], uint32 TeamMask);
+
+
+	void RemoveSlot(int32 Slot);
+
+	// Every aircraft's bounding sphere and velocity from the spatial index, with its handle
+	void BuildProxies();
+
+	// One async trace per missile along the step just taken
+	void TraceTerrain();
+	void OnTerrainTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	// Logs every launch while recording
+	UPROPERTY()
+	UFlightRecorderSubsystem* Recorder;
+
+	FlightModel::FMissileBatch Batch;
+	std::vector<FlightModel::FMissileEvent> Events;
+	FlightModel::FMissileProxySet Proxies;
+	TArray<int32> ProxyHandles;
+
+	// Slot-indexed, parallel to the batch
+	TArray<TWeakObjectPtr<AMissile>> Missiles;
+	TArray<TWeakObjectPtr<AActor>> Targets;
+	TArray<int32> TargetHandles;
+	TArray<uint32> OwnerTeams;
+	TArray<int32> SlotToHandle;
+
+	TArray<int32> HandleToSlot;
+	TArray<int32> FreeHandles;
+
+	// Bumped each time a handle is reused, so a terrain trace that outlived its missile is ignored
+	TArray<uint16> HandleGenerations;
+	FTraceDelegate TerrainTraceDelegate;
+	int32 TerrainImpactsThisFrame = 0;
+
+	// One count per team bit
+	int32 TeamLaunches[32] = {};
+	int32 TeamHits[32] = {};
+
+	// Handles a restore has placed, so the rest can be sent back
+	TBitArray<> RestoredHandles;
+
+	// Set while the batch is being walked; missiles unregistered then only have their slot emptied until the update is done
+	bool bUpdating = false;
+
+	FMissileGuidanceStats Stats;
+
+	FMissileGuidanceTickFunction TickFunction;
+};
@@ -0,0 +1,167 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MissionResetSubsystem.generated.h"
+
+class UActorPoolSubsystem;
+class UAircraftSpatialSubsystem;
+class UDamageLedgerSubsystem;
+class UGunfireSubsystem;
+class UMissileGuidanceSubsystem;
+class USpawnDirectorSubsystem;
+
+DECLARE_MULTICAST_DELEGATE(FOnMissionReset);
+
+// One aircraft as the mission started
+USTRUCT()
+struct FMissionAircraftSnapshot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<AActor> Class;
+
+	FTransform Transform;
+	FVector LinearVelocity = FVector::ZeroVector;
+	FVector AngularVelocity = FVector::ZeroVector;
+	float Health = 0.0f;
+	uint32 TeamMask = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FMissionResetStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	int32 NumResets = 0;
+
+	// Aircraft restored from a parked actor over every reset
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	int32 NumRecycled = 0;
+
+	// Aircraft the pool had to build because too few were parked
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	int32 NumSpawned = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mission")
+	float LastResetMilliseconds = 0.0f;
+};
+
+// Takes the snapshot and carries out requested resets in TG_PrePhysics, even while paused (Game Over pauses)
+USTRUCT()
+struct FMissionResetTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UMissionResetSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMissionResetTickFunction> : public TStructOpsTypeTraitsBase2<FMissionResetTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Restarts a mission in place instead of reloading the level. Once the opening wave
+ * is in, every aircraft is recorded: class, transform, velocity, health and team.
+ * A reset clears everything in flight (missiles go back to their pool, rounds and
+ * queued damage are dropped, pending spawns cancelled), parks every aircraft but the
+ * player and takes the recorded roster straight back out of the actor pool, then
+ * puts the player back at the start. Nothing is loaded and almost nothing is
+ * constructed, so it completes within one frame.
+ */
+UCLASS()
+class FLIGHTSIM1_API UMissionResetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Records the player and every other aircraft as they are now; happens by itself once the opening spawns are done
+	UFUNCTION(BlueprintCallable, Category = "Mission")
+	void CaptureInitialState();
+
+	bool HasSnapshot() const { return bHasSnapshot; }
+
+	// Resets at the start of the next frame; safe to call from damage handlers and deaths
+	UFUNCTION(BlueprintCallable, Category = "Mission")
+	void RequestReset();
+
+	// Resets now; without a snapshot the level is reloaded instead
+	void ResetMission();
+
+	// Aircraft in the snapshot on any of the teams, not counting the player
+	int32 GetNumSnapshotAircraft(uint32 TeamMask) const;
+
+	// Moves the snapshot's aircraft on any of the teams to these transforms, in turn, for every later reset, e.g. a
+	// wave placed from another seed. Their velocities turn with them; extra transforms are ignored.
+	void PlaceSnapshotAircraft(uint32 TeamMask, TArrayView<const FTransform> Transforms);
+
+	// Broadcast after each reset, once the world is back in its starting state
+	FOnMissionReset OnMissionReset;
+
+	// Captures once the opening wave is in and runs a requested reset
+	void Update();
+
+	UFUNCTION(BlueprintPure, Category = "Mission")
+	FMissionResetStats GetStats() const { return Stats; }
+
+private:
+	FMissionAircraftSnapshot CaptureAircraft(AActor* Aircraft, int32 Handle) const;
+
+	// Velocity and health, once the actor is back at the snapshot's transform
+	void RestoreAircraft(AActor* Aircraft, const FMissionAircraftSnapshot& Snapshot) const;
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	UDamageLedgerSubsystem* DamageLedger;
+
+	UPROPERTY()
+	UActorPoolSubsystem* ActorPool;
+
+	UPROPERTY()
+	USpawnDirectorSubsystem* SpawnDirector;
+
+	UPROPERTY()
+	UMissileGuidanceSubsystem* MissileGuidance;
+
+	UPROPERTY()
+	UGunfireSubsystem* Gunfire;
+
+	TWeakObjectPtr<APawn> Player;
+
+	UPROPERTY()
+	FMissionAircraftSnapshot PlayerSnapshot;
+
+	UPROPERTY()
+	TArray<FMissionAircraftSnapshot> Roster;
+
+	// Aircraft to park, gathered first since parking changes the spatial index
+	TArray<AActor*> ToRelease;
+
+	bool bHasSnapshot = false;
+	bool bResetRequested = false;
+
+	FMissionResetStats Stats;
+
+	FMissionResetTickFunction TickFunction;
+};
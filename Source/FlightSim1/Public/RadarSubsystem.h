@@ -0,0 +1,189 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "RadarSubsystem.generated.h"
+
+class UAircraftSpatialSubsystem;
+
+// Radar coverage of one aircraft
+USTRUCT(BlueprintType)
+struct FRadarSensorParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Radar")
+	bool bEnabled = true;
+
+	// Detection range, cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Radar")
+	float Range = 800000.0f;
+
+	// Half angle of the scan cone around the nose, degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Radar")
+	float ConeHalfAngle = 60.0f;
+};
+
+// An aircraft a sensor currently sees: inside its cone and range, with terrain line of sight
+struct FRadarContact
+{
+	// Spatial index handle of the detected aircraft
+	int32 Handle = INDEX_NONE;
+	uint32 TeamMask = 0;
+
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	float Distance = 0.0f;
+};
+
+// What the sensor update did in the most recent frame
+USTRUCT(BlueprintType)
+struct FRadarSensorStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	int32 NumSensors = 0;
+
+	// Sensor/target pairs inside a cone, and how many of those are contacts
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	int32 NumTracks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	int32 NumContacts = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	int32 TracesIssued = 0;
+
+	// Line-of-sight results that arrived this frame
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	int32 TracesCompleted = 0;
+
+	// Pairs that wanted a fresh trace but did not fit in this frame's budget
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	int32 TraceBacklog = 0;
+
+	// Age of the line-of-sight results behind the current tracks
+	UPROPERTY(BlueprintReadOnly, Category = "Radar")
+	float AverageLineOfSightAgeSeconds = 0.0f;
+};
+
+// Runs the sensors in TG_PrePhysics, against the spatial index snapshot from the end of the last frame
+USTRUCT()
+struct FRadarTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class URadarSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FRadarTickFunction> : public TStructOpsTypeTraitsBase2<FRadarTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Radar for every aircraft that registers a sensor. Cone and range tests run each
+ * frame against the aircraft spatial index, which is cheap; terrain masking needs a
+ * line trace per sensor/target pair, so those are issued as async traces under a
+ * fixed per-frame budget (FlightSim.Sensors.MaxTracesPerFrame). Pairs that have never
+ * been traced go first, then pairs whose result is older than
+ * FlightSim.Sensors.LineOfSightRefresh, round-robin across sensors. Results land the
+ * next frame and are cached on the pair until it is traced again.
+ *
+ * Each sensor publishes a contact list, rebuilt once per frame, that AI and targeting
+ * read directly instead of looking at the world themselves.
+ */
+UCLASS()
+class FLIGHTSIM1_API URadarSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Gives an aircraft already in the spatial index a radar that detects the given teams
+	void RegisterSensor(int32 AircraftHandle, const FRadarSensorParams& Params, uint32 TargetTeamMask);
+	void UnregisterSensor(int32 AircraftHandle);
+
+	// The aircraft's contacts as of this frame's update; empty if it has no sensor
+	TArrayView<const FRadarContact> GetContacts(int32 AircraftHandle) const;
+
+	bool HasContact(int32 AircraftHandle, int32 TargetHandle) const;
+
+	// Closest contact on any of the given teams; false if there is none
+	bool GetNearestContact(int32 AircraftHandle, uint32 TeamMask, FRadarContact& OutContact) const;
+
+	UFUNCTION(BlueprintPure, Category = "Radar")
+	FRadarSensorStats GetStats() const { return Stats; }
+
+	// Cone tests, contact lists and this frame's share of line-of-sight traces
+	void UpdateSensors(float DeltaTime);
+
+private:
+	// One sensor/target pair inside the cone, with its cached line-of-sight result
+	struct FTrack
+	{
+		int32 TargetHandle = INDEX_NONE;
+		TWeakObjectPtr<AActor> TargetActor;
+
+		double LastInConeTime = 0.0;
+		double LastTraceTime = -1.0;
+		bool bLineOfSight = false;
+		bool bTracePending = false;
+	};
+
+	struct FSensor
+	{
+		int32 AircraftHandle = INDEX_NONE;
+		float Range = 0.0f;
+		float MinCosAngle = 0.0f;
+		uint32 TargetTeamMask = 0;
+
+		TArray<FTrack> Tracks;
+		TArray<FRadarContact> Contacts;
+	};
+
+	void UpdateTracks(FSensor& Sensor, double Time);
+
+	// Issues traces for in-cone tracks that pass Filter, starting at TraceCursor; returns false once the budget is spent
+	template<typename FilterType>
+	bool IssueTraces(double Time, int32& InOutBudget, FilterType&& Filter);
+
+	void OnLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	// Dense sensors, plus aircraft handle -> sensor slot (INDEX_NONE where an aircraft has no radar)
+	TArray<FSensor> Sensors;
+	TArray<int32> AircraftToSensor;
+
+	// Reused by the cone queries
+	TArray<int32> Candidates;
+
+	// Sensor the trace round-robin resumes from
+	int32 TraceCursor = 0;
+
+	FTraceDelegate TraceDelegate;
+	FRadarSensorStats Stats;
+
+	// Trace delegates run between updates; counted here and published with the next update's stats
+	int32 TracesCompletedSinceUpdate = 0;
+
+	FRadarTickFunction TickFunction;
+};
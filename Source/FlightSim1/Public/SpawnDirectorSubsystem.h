@@ -0,0 +1,167 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SpawnDirectorSubsystem.generated.h"
+
+class UActorPoolSubsystem;
+
+UENUM(BlueprintType)
+enum class EAircraftSpawnPattern : uint8
+{
+	// Spread evenly around the ring, each facing its centre
+	Ring,
+	// Groups of FormationSize flying a V, the groups spread around the ring
+	Formation
+};
+
+// A batch of aircraft to bring in
+USTRUCT(BlueprintType)
+struct FAircraftSpawnWave
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	TSubclassOf<AActor> AircraftClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	int32 Count = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	EAircraftSpawnPattern Pattern = EAircraftSpawnPattern::Ring;
+
+	// Centre of the ring; aircraft spawn at its height
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	FVector Center = FVector(0.0f, 0.0f, 5000.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	float Radius = 100000.0f;
+
+	// Random share of the even spacing each position may be moved round the ring by, 0-1
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	float AngleJitter = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	int32 FormationSize = 4;
+
+	// Distance between neighbours in a formation, back and to the side
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	float FormationSpacing = 3000.0f;
+
+	// Placement is repeatable for a given seed; 0 picks one at random
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawning")
+	int32 Seed = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FSpawnDirectorStats
+{
+	GENERATED_BODY()
+
+	// Aircraft queued but not yet in the world
+	UPROPERTY(BlueprintReadOnly, Category = "Spawning")
+	int32 NumPending = 0;
+
+	// Since the world started, whether newly built or taken from the pool
+	UPROPERTY(BlueprintReadOnly, Category = "Spawning")
+	int32 NumSpawned = 0;
+
+	// Spare aircraft built into the pool with what was left of a frame's budget
+	UPROPERTY(BlueprintReadOnly, Category = "Spawning")
+	int32 NumPrewarmed = 0;
+
+	// Last frame's spawning and prewarming
+	UPROPERTY(BlueprintReadOnly, Category = "Spawning")
+	float SpawnMilliseconds = 0.0f;
+};
+
+// Spawns the frame's share of the queue in TG_PrePhysics, so new aircraft fly the same frame
+USTRUCT()
+struct FSpawnDirectorTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class USpawnDirectorSubsystem* Owner = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSpawnDirectorTickFunction> : public TStructOpsTypeTraitsBase2<FSpawnDirectorTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Brings aircraft into the world a few at a time. A queued wave is placed up front
+ * (on a ring or in formations) and then spawned over as many frames as it takes,
+ * each frame stopping once FlightSim.Spawn.BudgetMs is spent, so a large wave never
+ * stalls a frame and the level is playable from its first frame. Aircraft come from
+ * the actor pool, which takes shot-down aircraft back, so later waves reuse them.
+ * Budget left over once the queue is empty builds spare aircraft into the pool.
+ */
+UCLASS()
+class FLIGHTSIM1_API USpawnDirectorSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Places the wave and queues it; the aircraft arrive over the next frames
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void QueueWave(const FAircraftSpawnWave& Wave);
+
+	// Builds spare aircraft into the pool until it holds Count of the class, from leftover budget
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void PrewarmPool(TSubclassOf<AActor> AircraftClass, int32 Count);
+
+	// Drops everything queued and not yet spawned
+	void CancelPending();
+
+	// Spawns from the queue, then prewarms, until the frame's budget is spent
+	void UpdateSpawns();
+
+	// Where the wave's aircraft go, in spawn order
+	static void PlaceWave(const FAircraftSpawnWave& Wave, TArray<FTransform>& OutTransforms);
+
+	int32 GetNumPending() const { return Pending.Num() - NextPending; }
+
+	UFUNCTION(BlueprintPure, Category = "Spawning")
+	FSpawnDirectorStats GetStats() const { return Stats; }
+
+private:
+	struct FPendingSpawn
+	{
+		UClass* Class = nullptr;
+		FTransform Transform;
+	};
+
+	UPROPERTY()
+	UActorPoolSubsystem* ActorPool;
+
+	// Consumed from NextPending on; reset once empty
+	TArray<FPendingSpawn> Pending;
+	int32 NextPending = 0;
+
+	// Classes and how many spares each should have parked
+	UPROPERTY()
+	TMap<UClass*, int32> PrewarmTargets;
+
+	TArray<FTransform> Placement;
+
+	FSpawnDirectorStats Stats;
+
+	FSpawnDirectorTickFunction TickFunction;
+};
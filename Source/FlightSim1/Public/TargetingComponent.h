@@ -0,0 +1,138 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TargetingComponent.generated.h"
+
+class UAircraftSpatialSubsystem;
+class URadarSubsystem;
+
+// This frame's targeting state, computed once by UTargetingComponent and read by weapons and the HUD
+USTRUCT(BlueprintType)
+struct FTargetingResult
+{
+	GENERATED_BODY()
+
+	// The aircraft being tracked, locked or not yet; null when there is nothing in the cone
+	UPROPERTY(BlueprintReadOnly, Category = "Targeting")
+	AActor* Target = nullptr;
+
+	// Cone score (cos(angle off the nose) / distance) the target last had while inside the cone
+	UPROPERTY(BlueprintReadOnly, Category = "Targeting")
+	float Score = 0.0f;
+
+	// 0 when the target was just picked up, 1 once LockAcquireTime has passed
+	UPROPERTY(BlueprintReadOnly, Category = "Targeting")
+	float LockProgress = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Targeting")
+	bool bLocked = false;
+
+	// The target has left the cone and the lock breaks once BreakLockTime runs out
+	UPROPERTY(BlueprintReadOnly, Category = "Targeting")
+	bool bTargetOutOfCone = false;
+
+	// Challengers scored this frame
+	UPROPERTY(BlueprintReadOnly, Category = "Targeting")
+	int32 NumCandidatesEvaluated = 0;
+
+	// Spatial index handle of Target
+	int32 TargetHandle = INDEX_NONE;
+};
+
+/**
+ * Temporally coherent lock-on. Once a target is held, only aircraft close enough to
+ * beat its score by SwitchScoreRatio are even fetched from the spatial index (a score
+ * can never exceed 1 / distance), so a stable lock costs one small query per frame.
+ * A new target must be held for LockAcquireTime before it counts as locked, and a
+ * locked target may leave the cone for BreakLockTime before the lock drops, so equal
+ * or near-equal scores never make the lock flicker.
+ *
+ * With bRequireRadarContact, candidates come from the owner's radar contact list, so
+ * only aircraft the radar can see (range, cone, terrain) can be locked.
+ *
+ * The result is computed once per tick; everything else reads GetResult().
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class FLIGHTSIM1_API UTargetingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTargetingComponent();
+
+	// Aircraft further away than this are never considered
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float Range;
+
+	// Half angle of the lock cone around the nose, degrees
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float ConeHalfAngle;
+
+	// Seconds a new target has to stay in the cone before it is locked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float LockAcquireTime;
+
+	// Seconds the target may spend outside the cone before the lock breaks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float BreakLockTime;
+
+	// A challenger has to score this many times the current target's score to take over
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	float SwitchScoreRatio;
+
+	// Only lock aircraft the owner's radar has a contact on
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Targeting")
+	bool bRequireRadarContact;
+
+	// Team bits (AircraftTeams) that may be targeted
+	uint32 TargetTeamMask;
+
+	// The owner's spatial index handle, which is also its radar's key
+	void SetOwnerAircraft(int32 Handle) { OwnerHandle = Handle; }
+
+	UFUNCTION(BlueprintPure, Category = "Targeting")
+	const FTargetingResult& GetResult() const { return Result; }
+
+	// Drops the current target and lock progress
+	UFUNCTION(BlueprintCallable, Category = "Targeting")
+	void ClearTarget();
+
+	// Tracks Target again with the lock as far along as LockProgress (0-1), as a restored snapshot had it
+	void RestoreTarget(AActor* Target, int32 TargetHandle, float LockProgress);
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	void UpdateTargeting(float DeltaTime);
+
+	// Cone score of an aircraft, or a negative value if it is outside the cone or out of range
+	float ScoreOf(int32 Handle, const FVector& Origin, const FVector& Forward, float MinCosAngle) const;
+
+	// Gathers this frame's candidates within SearchRadius into Candidates
+	void GatherCandidates(const FVector& Origin, const FVector& Forward, float MinCosAngle, float SearchRadius, bool bUseRadar);
+
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	URadarSubsystem* RadarSystem;
+
+	int32 OwnerHandle;
+
+	// A UPROPERTY so the garbage collector sees, and clears, the target actor it holds
+	UPROPERTY()
+	FTargetingResult Result;
+
+	// Time the current target has been held inside the cone, and time it has been outside it
+	float HeldTime;
+	float OutOfConeTime;
+
+	// Reused so the per-frame query does not allocate
+	TArray<int32> Candidates;
+};
@@ -0,0 +1,109 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FlightModel/WorldSnapshot.h"
+#include "WorldSnapshotSubsystem.generated.h"
+
+class UAircraftSpatialSubsystem;
+class UDamageLedgerSubsystem;
+class UGunfireSubsystem;
+class UMissileGuidanceSubsystem;
+
+USTRUCT(BlueprintType)
+struct FWorldSnapshotStats
+{
+	GENERATED_BODY()
+
+	// In the last capture
+	UPROPERTY(BlueprintReadOnly, Category = "Snapshot")
+	int32 NumAircraft = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Snapshot")
+	int32 NumMissiles = 0;
+
+	// Aircraft and missiles in the last restore that are no longer in the world, and so stayed gone
+	UPROPERTY(BlueprintReadOnly, Category = "Snapshot")
+	int32 NumUnmatched = 0;
+
+	// Size of the last buffer written by SaveState
+	UPROPERTY(BlueprintReadOnly, Category = "Snapshot")
+	int32 LastSizeBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Snapshot")
+	float CaptureMilliseconds = 0.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Snapshot")
+	float RestoreMilliseconds = 0.0f;
+};
+
+/**
+ * Captures and restores the state of the dogfight for rollback, fast-forward and save
+ * states: every aircraft's transform, velocities, controls, health, AI state with its
+ * remaining evasion time and lock, and every missile in flight. A capture is quantized
+ * on the spot, so restoring it and restoring a decoded copy of it give the same world.
+ * SaveState and LoadState wrap FlightModel::FWorldSnapshotCodec's compact binary form,
+ * optionally as a delta against a snapshot both sides hold.
+ *
+ * Restores match by handle and the handle's generation: an aircraft or missile that has
+ * left the world since the capture is not brought back (see FWorldSnapshotStats::NumUnmatched),
+ * even if a newer one has been given its recycled handle, and missiles launched since are
+ * returned to their pool.
+ */
+UCLASS()
+class FLIGHTSIM1_API UWorldSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Overwrites OutSnapshot, reusing its storage
+	void Capture(FlightModel::FWorldSnapshot& OutSnapshot);
+	void Restore(const FlightModel::FWorldSnapshot& Snapshot);
+
+	// Captures into LastCapture and appends its encoding to Out, as a delta when given a baseline the reader also holds
+	void SaveState(std::vector<uint8>& Out, const FlightModel::FWorldSnapshot* Baseline = nullptr);
+
+	// Decodes into LastLoaded and restores it; false, with the world untouched, if the buffer does not decode
+	bool LoadState(const uint8* Data, int64 Size, const FlightModel::FWorldSnapshot* Baseline = nullptr);
+
+	// What SaveState last captured and LoadState last decoded, for use as the next delta's baseline
+	const FlightModel::FWorldSnapshot& GetLastCapture() const { return LastCapture; }
+	const FlightModel::FWorldSnapshot& GetLastLoaded() const { return LastLoaded; }
+
+	// In-memory save slots for the console commands
+	void SaveSlot(int32 Slot);
+	bool LoadSlot(int32 Slot);
+
+	UFUNCTION(BlueprintPure, Category = "Snapshot")
+	FWorldSnapshotStats GetStats() const { return Stats; }
+
+private:
+	UPROPERTY()
+	UAircraftSpatialSubsystem* SpatialIndex;
+
+	UPROPERTY()
+	UDamageLedgerSubsystem* DamageLedger;
+
+	UPROPERTY()
+	UMissileGuidanceSubsystem* MissileGuidance;
+
+	UPROPERTY()
+	UGunfireSubsystem* Gunfire;
+
+	FlightModel::FWorldSnapshotCodec Codec;
+	FlightModel::FWorldSnapshot LastCapture;
+	FlightModel::FWorldSnapshot LastLoaded;
+
+	// Captured or decoded into before being swapped into one of the above, which may be the baseline
+	FlightModel::FWorldSnapshot Scratch;
+
+	TMap<int32, std::vector<uint8>> Slots;
+
+	FWorldSnapshotStats Stats;
+};
@@ -0,0 +1,144 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#include "DogfightEnvApi.h"
+
+#include "FlightModel/DogfightEnv.h"
+
+using FlightModel::FDogfightEnv;
+using FlightModel::FDogfightEnvConfig;
+
+// The handle is the env itself
+struct DogfightEnv : public FDogfightEnv
+{
+	using FDogfightEnv::FDogfightEnv;
+};
+
+void DogfightEnv_DefaultConfig(DogfightEnvConfig* Config)
+{
+	if (!Config)
+	{
+		return;
+	}
+
+	const FDogfightEnvConfig Defaults;
+	Config->NumEnvs = Defaults.NumEnvs;
+	Config->NumEnemies = Defaults.NumEnemies;
+	Config->NumThreads = Defaults.NumThreads;
+	Config->StepSize = static_cast<float>(Defaults.StepSize);
+	Config->ActionRepeat = Defaults.ActionRepeat;
+	Config->MaxEpisodeSeconds = static_cast<float>(Defaults.MaxEpisodeSeconds);
+	Config->SpawnRadius = static_cast<float>(Defaults.SpawnRadius);
+	Config->SpawnAltitude = static_cast<float>(Defaults.SpawnAltitude);
+	Config->StartSpeed = static_cast<float>(Defaults.StartSpeed);
+	Config->KillReward = static_cast<float>(Defaults.Rewards.Kill);
+	Config->WinReward = static_cast<float>(Defaults.Rewards.Win);
+	Config->LossReward = static_cast<float>(Defaults.Rewards.Loss);
+	Config->DamageDealtReward = static_cast<float>(Defaults.Rewards.DamageDealt);
+	Config->DamageTakenReward = static_cast<float>(Defaults.Rewards.DamageTaken);
+	Config->StepReward = static_cast<float>(Defaults.Rewards.Step);
+}
+
+DogfightEnv* DogfightEnv_Create(const DogfightEnvConfig* Config)
+{
+	FDogfightEnvConfig EnvConfig;
+	if (Config)
+	{
+		EnvConfig.NumEnvs = Config->NumEnvs;
+		EnvConfig.NumEnemies = Config->NumEnemies;
+		EnvConfig.NumThreads = Config->NumThreads;
+		EnvConfig.ActionRepeat = Config->ActionRepeat;
+		if (Config->StepSize > 0.0f)
+		{
+			EnvConfig.StepSize = Config->StepSize;
+		}
+		if (Config->MaxEpisodeSeconds > 0.0f)
+		{
+			EnvConfig.MaxEpisodeSeconds = Config->MaxEpisodeSeconds;
+		}
+		EnvConfig.SpawnRadius = Config->SpawnRadius;
+		EnvConfig.SpawnAltitude = Config->SpawnAltitude;
+		EnvConfig.StartSpeed = Config->StartSpeed;
+		EnvConfig.Rewards.Kill = Config->KillReward;
+		EnvConfig.Rewards.Win = Config->WinReward;
+		EnvConfig.Rewards.Loss = Config->LossReward;
+		EnvConfig.Rewards.DamageDealt = Config->DamageDealtReward;
+		EnvConfig.Rewards.DamageTaken = Config->DamageTakenReward;
+		EnvConfig.Rewards.Step = Config->StepReward;
+	}
+	return new DogfightEnv(EnvConfig);
+}
+
+void DogfightEnv_Destroy(DogfightEnv* Env)
+{
+	delete Env;
+}
+
+int32_t DogfightEnv_NumEnvs(const DogfightEnv* Env)
+{
+	return Env->GetNumEnvs();
+}
+
+int32_t DogfightEnv_ObservationSize(const DogfightEnv* Env)
+{
+	return Env->GetObservationSize();
+}
+
+int32_t DogfightEnv_ActionSize(const DogfightEnv* Env)
+{
+	return Env->GetActionSize();
+}
+
+void DogfightEnv_Reset(DogfightEnv* Env, uint64_t Seed)
+{
+	Env->Reset(Seed);
+}
+
+void DogfightEnv_Step(DogfightEnv* Env)
+{
+	Env->Step();
+}
+
+float* DogfightEnv_Actions(DogfightEnv* Env)
+{
+	return Env->GetActions();
+}
+
+const float* DogfightEnv_Observations(const DogfightEnv* Env)
+{
+	return Env->GetObservations();
+}
+
+const float* DogfightEnv_FinalObservations(const DogfightEnv* Env)
+{
+	return Env->GetFinalObservations();
+}
+
+const float* DogfightEnv_Rewards(const DogfightEnv* Env)
+{
+	return Env->GetRewards();
+}
+
+const uint8_t* DogfightEnv_Terminated(const DogfightEnv* Env)
+{
+	return Env->GetTerminated();
+}
+
+const uint8_t* DogfightEnv_Truncated(const DogfightEnv* Env)
+{
+	return Env->GetTruncated();
+}
+
+const uint8_t* DogfightEnv_Outcomes(const DogfightEnv* Env)
+{
+	return Env->GetOutcomes();
+}
+
+const float* DogfightEnv_EpisodeReturns(const DogfightEnv* Env)
+{
+	return Env->GetEpisodeReturns();
+}
+
+const int32_t* DogfightEnv_EpisodeLengths(const DogfightEnv* Env)
+{
+	return Env->GetEpisodeLengths();
+}
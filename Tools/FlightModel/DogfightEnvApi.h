@@ -0,0 +1,85 @@
+// Copyright Your Company Name, Inc. All Rights Reserved.
+
+#pragma once
+
+// C interface to FlightModel::FDogfightEnv, built as the DogfightEnv shared library
+// for training frameworks to load (ctypes, cffi, a pybind shim, ...). The buffer
+// functions return pointers into the env's own storage, valid until
+// DogfightEnv_Destroy, so a trainer wraps them once as arrays and reads and
+// writes them in place every step without copying:
+//
+//   actions            NumEnvs x ActionSize float, written by the caller before each step
+//   observations       NumEnvs x ObservationSize float
+//   final observations NumEnvs x ObservationSize float, the last one of an engagement that just ended
+//   rewards            NumEnvs float
+//   terminated         NumEnvs uint8, won or lost this step
+//   truncated          NumEnvs uint8, out of time this step
+//
+// An engagement that ends is restarted within the same step. Not thread safe: one
+// caller per env, which splits each step over its own NumThreads.
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define DOGFIGHTENV_API __declspec(dllexport)
+#else
+#define DOGFIGHTENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	// The knobs a trainer usually wants; everything else keeps FDogfightEnvConfig's defaults
+	typedef struct DogfightEnvConfig
+	{
+		int32_t NumEnvs;
+		int32_t NumEnemies;
+		int32_t NumThreads;
+		float StepSize;
+		int32_t ActionRepeat;
+		float MaxEpisodeSeconds;
+		float SpawnRadius;
+		float SpawnAltitude;
+		float StartSpeed;
+
+		float KillReward;
+		float WinReward;
+		float LossReward;
+		float DamageDealtReward;
+		float DamageTakenReward;
+		float StepReward;
+	} DogfightEnvConfig;
+
+	typedef struct DogfightEnv DogfightEnv;
+
+	// Fills Config with the defaults
+	DOGFIGHTENV_API void DogfightEnv_DefaultConfig(DogfightEnvConfig* Config);
+
+	// Allocates every buffer and starts the worker threads; null Config for the defaults
+	DOGFIGHTENV_API DogfightEnv* DogfightEnv_Create(const DogfightEnvConfig* Config);
+	DOGFIGHTENV_API void DogfightEnv_Destroy(DogfightEnv* Env);
+
+	DOGFIGHTENV_API int32_t DogfightEnv_NumEnvs(const DogfightEnv* Env);
+	DOGFIGHTENV_API int32_t DogfightEnv_ObservationSize(const DogfightEnv* Env);
+	DOGFIGHTENV_API int32_t DogfightEnv_ActionSize(const DogfightEnv* Env);
+
+	DOGFIGHTENV_API void DogfightEnv_Reset(DogfightEnv* Env, uint64_t Seed);
+	DOGFIGHTENV_API void DogfightEnv_Step(DogfightEnv* Env);
+
+	DOGFIGHTENV_API float* DogfightEnv_Actions(DogfightEnv* Env);
+	DOGFIGHTENV_API const float* DogfightEnv_Observations(const DogfightEnv* Env);
+	DOGFIGHTENV_API const float* DogfightEnv_FinalObservations(const DogfightEnv* Env);
+	DOGFIGHTENV_API const float* DogfightEnv_Rewards(const DogfightEnv* Env);
+	DOGFIGHTENV_API const uint8_t* DogfightEnv_Terminated(const DogfightEnv* Env);
+	DOGFIGHTENV_API const uint8_t* DogfightEnv_Truncated(const DogfightEnv* Env);
+
+	// Per engagement, set on the step it ended: 1 win, 2 loss, 3 timeout, its total reward and its length in steps
+	DOGFIGHTENV_API const uint8_t* DogfightEnv_Outcomes(const DogfightEnv* Env);
+	DOGFIGHTENV_API const float* DogfightEnv_EpisodeReturns(const DogfightEnv* Env);
+	DOGFIGHTENV_API const int32_t* DogfightEnv_EpisodeLengths(const DogfightEnv* Env);
+
+#ifdef __cplusplus
+}
+#endif